@@ -0,0 +1,62 @@
+#pragma once
+
+#include "core/timing.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace trading_engine::bench {
+    // TSC calibration and profiler setup, once per process
+    inline void initialize_clock() {
+        static const bool initialized = [] {
+            TimestampManager::initialize();
+            LatencyProfiler::initialize();
+            return true;
+        }();
+        (void) initialized;
+    }
+
+    // Per-op latency from the TSC, reported next to Google Benchmark's wall time
+    //
+    // Ops are timed in blocks of BlockSize so that the two TSC reads stay small
+    // next to very cheap ops such as a queue push; each block records its
+    // per-op average. cycles_per_op counts TSC ticks, which run at the nominal
+    // frequency rather than the core clock, so turbo shows up as fewer cycles.
+    template<std::uint32_t BlockSize = 1>
+    class TscSampler {
+        LatencyHistogram histogram;
+        std::uint64_t block_start{0};
+
+    public:
+        TscSampler() {
+            initialize_clock();
+        }
+
+        FORCE_INLINE void begin() noexcept {
+            block_start = TimestampManager::get_hardware_timestamp();
+        }
+
+        FORCE_INLINE void end() noexcept {
+            histogram.record((TimestampManager::get_hardware_timestamp() - block_start) / BlockSize);
+        }
+
+        // Adds cycles_per_op and latency percentiles in ns to the benchmark's
+        // counters; threads of a multi-threaded run are averaged
+        void report(benchmark::State &state) const {
+            const LatencyProfiler::ProfileResults results = LatencyProfiler::summarize(histogram);
+            const auto counter = [](const double value) {
+                return benchmark::Counter(value, benchmark::Counter::kAvgThreads);
+            };
+
+            state.counters["cycles_per_op"] = counter(
+                histogram.total_samples > 0
+                    ? static_cast<double>(histogram.total_latency) / static_cast<double>(histogram.total_samples)
+                    : 0.0);
+            state.counters["p50_ns"] = counter(results.p50_latency_us * 1000.0);
+            state.counters["p99_ns"] = counter(results.p99_latency_us * 1000.0);
+            state.counters["p999_ns"] = counter(results.p999_latency_us * 1000.0);
+            state.counters["max_ns"] = counter(results.max_latency_us * 1000.0);
+        }
+    };
+}
@@ -0,0 +1,132 @@
+#include "benchmark_common.h"
+
+#include "persistence/journal.h"
+
+#include <filesystem>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace trading_engine;
+using namespace trading_engine::bench;
+
+#ifndef _WIN32
+namespace {
+    std::string bench_directory(const char *name) {
+        return (std::filesystem::temp_directory_path() /
+                (std::string(name) + "-" + std::to_string(::getpid()))).string();
+    }
+
+    JournalConfig bench_config(const std::string &directory, const bool sync) {
+        return JournalConfig{
+            .directory = directory,
+            .direct_io = true,
+            .sync = sync,
+            .segment_bytes = JournalConfig{}.segment_bytes,
+            .snapshot_interval = std::chrono::milliseconds{0},
+            .placement = ThreadPlacement{},
+            .wait = JournalConfig{}.wait
+        };
+    }
+
+    Order bench_order(const uint64_t id) {
+        return Order{
+            .orderID = id,
+            .symbolID = 1,
+            .side = (id & 1) != 0 ? Side::Buy : Side::Sell,
+            .orderType = OrderType::Limit,
+            .price = 100 * PriceScale,
+            .quantity = 10
+        };
+    }
+}
+
+// Matching thread's cost per journaled request while the writer group-commits
+// behind it. Argument 1 syncs every commit, 0 leaves flushing to the OS;
+// a full ring shows up as producer stalls rather than being absorbed.
+static void BM_Journal_Append(benchmark::State &state) {
+    TscSampler<64> sampler;
+    const std::string directory = bench_directory("journal-append");
+    std::filesystem::remove_all(directory);
+
+    JournalWriter::JournalStats stats{};
+    {
+        JournalWriter writer(bench_config(directory, state.range(0) != 0), {-1});
+        JournalWriter::ShardLog &log = writer.log(0);
+        if (!writer.start()) {
+            state.SkipWithError("journal failed to start");
+            return;
+        }
+
+        LatencyProfiler::reset(LatencyProfiler::Journal_commit);
+        uint64_t id = 0;
+        for (auto _: state) {
+            sampler.begin();
+            for (int i = 0; i < 64; ++i) {
+                log.append_request(bench_order(++id));
+            }
+            sampler.end();
+        }
+        writer.stop();
+        stats = writer.get_statistics();
+    }
+    std::filesystem::remove_all(directory);
+
+    sampler.report(state);
+    state.counters["records_per_commit"] = stats.records_per_commit;
+    state.counters["commit_p99_us"] = stats.commit_latency.p99_latency_us;
+    state.counters["stalls"] = static_cast<double>(stats.producer_stalls);
+    state.counters["direct_io"] = stats.direct_io ? 1.0 : 0.0;
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 64);
+}
+
+BENCHMARK(BM_Journal_Append)
+    ->ArgName("sync")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+
+// Recovery's read side: validating and visiting the records of a journal
+// of range(0) requests, as a restart without a recent snapshot would
+static void BM_Journal_Scan(benchmark::State &state) {
+    const auto records = static_cast<uint64_t>(state.range(0));
+    const std::string directory = bench_directory("journal-scan");
+    std::filesystem::remove_all(directory);
+    {
+        JournalWriter writer(bench_config(directory, false), {-1});
+        if (!writer.start()) {
+            state.SkipWithError("journal failed to start");
+            return;
+        }
+        for (uint64_t id = 1; id <= records; ++id) {
+            writer.log(0).append_request(bench_order(id));
+        }
+        writer.stop();
+    }
+
+    const JournalReader reader(directory);
+    uint64_t visited = 0;
+    for (auto _: state) {
+        Quantity quantity = 0;
+        const JournalReader::ScanStats stats = reader.scan(0, [&quantity](const JournalRecord &record) {
+            quantity += record.order().quantity;
+        });
+        benchmark::DoNotOptimize(quantity);
+        visited += stats.records;
+    }
+    std::filesystem::remove_all(directory);
+
+    if (visited != records * state.iterations()) {
+        state.SkipWithError("scan did not read back every record");
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(visited));
+    state.SetBytesProcessed(static_cast<int64_t>(visited * sizeof(JournalRecord)));
+}
+
+BENCHMARK(BM_Journal_Scan)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
+#endif
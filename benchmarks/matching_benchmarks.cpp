@@ -0,0 +1,234 @@
+#include "benchmark_common.h"
+
+#include "matching/matching_engine.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace trading_engine;
+using namespace trading_engine::bench;
+
+namespace {
+    constexpr SymbolID BenchSymbol = 1;
+    constexpr Price MidPrice = 100 * PriceScale;
+    constexpr Price TickSize = PriceScale / 100; // One cent
+    constexpr size_t BookDepth = 20; // Levels per side
+    constexpr size_t OrdersPerLevel = 5;
+    constexpr size_t OpSequenceSize = 8192; // Power of two
+
+    // The run is rebuilt from a fresh book once this many orders rest, which
+    // keeps the book and the live list at a steady size
+    constexpr size_t MaxRestingOrders = 8000;
+
+    // Stands in for the trade ring: keeps each fill observable, costs nothing
+    struct BenchSink {
+        static void on_trade(const Trade &trade) noexcept {
+            benchmark::DoNotOptimize(trade);
+        }
+
+        static void on_order_update(const Order &) noexcept {
+        }
+    };
+
+    enum class Action : std::uint8_t { Add, Cancel, Match };
+
+    struct Op {
+        Action action;
+        Side side;
+        std::uint32_t level; // 1-based distance from the mid for adds
+        std::uint32_t pick; // Which live order a cancel targets
+        Quantity quantity;
+    };
+
+    std::vector<Op> make_ops(const std::int64_t add_percent, const std::int64_t cancel_percent) {
+        std::mt19937_64 rng(7);
+        std::uniform_int_distribution<std::int64_t> percent(0, 99);
+        std::geometric_distribution<std::uint32_t> distance(0.3);
+        std::uniform_int_distribution<Quantity> quantity(1, 200);
+
+        std::vector<Op> ops(OpSequenceSize);
+        for (Op &op: ops) {
+            const std::int64_t roll = percent(rng);
+            op = Op{
+                .action = roll < add_percent
+                              ? Action::Add
+                              : roll < add_percent + cancel_percent ? Action::Cancel : Action::Match,
+                .side = rng() % 2 == 0 ? Side::Buy : Side::Sell,
+                .level = 1 + distance(rng) % static_cast<std::uint32_t>(BookDepth),
+                .pick = static_cast<std::uint32_t>(rng()),
+                .quantity = quantity(rng)
+            };
+        }
+        return ops;
+    }
+
+    // A symmetric book around the mid plus the IDs resting in it
+    class BenchBook {
+        std::unique_ptr<MatchingEngine> engine;
+        std::vector<OrderID> live;
+        OrderID next_order_id{1};
+        BenchSink sink;
+
+    public:
+        void rebuild() {
+            engine = std::make_unique<MatchingEngine>();
+            (void) engine->configure_price_ladder(TickSize);
+            live.clear();
+            live.reserve(MaxRestingOrders + OpSequenceSize);
+            for (std::uint32_t level = 1; level <= BookDepth; ++level) {
+                for (size_t n = 0; n < OrdersPerLevel; ++n) {
+                    add(Side::Buy, level, 100);
+                    add(Side::Sell, level, 100);
+                }
+            }
+        }
+
+        [[nodiscard]] bool worn_out() const noexcept {
+            return live.size() >= MaxRestingOrders;
+        }
+
+        [[nodiscard]] Order make_order(const Side side, const Price price, const Quantity quantity) noexcept {
+            return Order{
+                .orderID = next_order_id++,
+                .symbolID = BenchSymbol,
+                .side = side,
+                .orderType = OrderType::Limit,
+                .timeInForce = TimeInForce::Day,
+                .price = price,
+                .quantity = quantity
+            };
+        }
+
+        // Passive order that never crosses: bids below the mid, asks above
+        Order passive_order(const Side side, const std::uint32_t level, const Quantity quantity) noexcept {
+            const Price offset = level * TickSize;
+            return make_order(side, side == Side::Buy ? MidPrice - offset : MidPrice + offset, quantity);
+        }
+
+        void add(const Side side, const std::uint32_t level, const Quantity quantity) {
+            const Order order = passive_order(side, level, quantity);
+            (void) engine->process_order(order, sink);
+            live.push_back(order.orderID);
+        }
+
+        // Marketable order that fills against the touch without sweeping it;
+        // an empty side turns into a zero-quantity order
+        [[nodiscard]] Order aggressive_order(const Side side, const Quantity quantity) noexcept {
+            const MatchingEngine::BookState book = engine->get_book_state(BenchSymbol);
+            if (side == Side::Buy) {
+                return make_order(side, book.best_ask, book.best_ask_qty > 0 ? std::min(quantity, book.best_ask_qty) : 0);
+            }
+            return make_order(side, book.best_bid, book.best_bid_qty > 0 ? std::min(quantity, book.best_bid_qty) : 0);
+        }
+
+        // Orders that already filled stay listed: their cancels miss, as late
+        // cancels do on a real venue
+        [[nodiscard]] OrderID take_live(const std::uint32_t pick) noexcept {
+            if (live.empty()) {
+                return 0;
+            }
+            const size_t index = pick % live.size();
+            const OrderID order_id = live[index];
+            live[index] = live.back();
+            live.pop_back();
+            return order_id;
+        }
+
+        void track(const OrderID order_id) {
+            live.push_back(order_id);
+        }
+
+        [[nodiscard]] MatchingEngine &matching() noexcept {
+            return *engine;
+        }
+
+        [[nodiscard]] BenchSink &output() noexcept {
+            return sink;
+        }
+    };
+}
+
+// Add/cancel/match mix against a 20-level book. Arguments are the add and
+// cancel percentages; the rest are marketable orders.
+static void BM_MatchingEngine_Mix(benchmark::State &state) {
+    TscSampler sampler;
+    const auto ops = make_ops(state.range(0), state.range(1));
+    BenchBook book;
+    book.rebuild();
+
+    size_t next = 0;
+    for (auto _: state) {
+        if (UNLIKELY(book.worn_out())) {
+            state.PauseTiming();
+            book.rebuild();
+            state.ResumeTiming();
+        }
+
+        const Op &op = ops[next++ & (OpSequenceSize - 1)];
+        switch (op.action) {
+            case Action::Add: {
+                const Order order = book.passive_order(op.side, op.level, op.quantity);
+                sampler.begin();
+                const auto summary = book.matching().process_order(order, book.output());
+                sampler.end();
+                benchmark::DoNotOptimize(summary);
+                book.track(order.orderID);
+                break;
+            }
+            case Action::Cancel: {
+                const OrderID order_id = book.take_live(op.pick);
+                sampler.begin();
+                const bool cancelled = book.matching().cancel_order(order_id, book.output());
+                sampler.end();
+                benchmark::DoNotOptimize(cancelled);
+                break;
+            }
+            case Action::Match: {
+                const Order order = book.aggressive_order(op.side, op.quantity);
+                sampler.begin();
+                const auto summary = book.matching().process_order(order, book.output());
+                sampler.end();
+                benchmark::DoNotOptimize(summary);
+                break;
+            }
+        }
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_MatchingEngine_Mix)
+    ->ArgNames({"add_pct", "cancel_pct"})
+    ->Args({50, 45}) // Market maker quoting: mostly adds and cancels
+    ->Args({50, 40})
+    ->Args({40, 20}); // Aggressive flow
+
+// Marketable order filling against a single resting order
+static void BM_MatchingEngine_MatchOne(benchmark::State &state) {
+    TscSampler sampler;
+    BenchBook book;
+    book.rebuild();
+
+    for (auto _: state) {
+        if (UNLIKELY(book.worn_out())) {
+            state.PauseTiming();
+            book.rebuild();
+            state.ResumeTiming();
+        }
+
+        // Refill the touch, then take it
+        book.add(Side::Sell, 1, 100);
+        const Order order = book.aggressive_order(Side::Buy, 100);
+        sampler.begin();
+        const auto summary = book.matching().process_order(order, book.output());
+        sampler.end();
+        benchmark::DoNotOptimize(summary);
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_MatchingEngine_MatchOne);
@@ -0,0 +1,113 @@
+#include "benchmark_common.h"
+
+#include "core/memory.h"
+
+#include <array>
+#include <memory>
+
+using namespace trading_engine;
+using namespace trading_engine::bench;
+
+namespace {
+    constexpr std::uint32_t PoolBlock = 16;
+
+    using OrderPool = LockFreeMemoryPool<Order, 4096>;
+}
+
+// Acquire then release on one thread; the free-list head stays in cache
+static void BM_MemoryPool_AcquireRelease(benchmark::State &state) {
+    TscSampler<PoolBlock> sampler;
+    auto pool = std::make_unique<OrderPool>();
+
+    while (state.KeepRunningBatch(PoolBlock)) {
+        sampler.begin();
+        for (std::uint32_t i = 0; i < PoolBlock; ++i) {
+            Order *order = pool->acquire();
+            benchmark::DoNotOptimize(order);
+            pool->release(order);
+        }
+        sampler.end();
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_MemoryPool_AcquireRelease);
+
+// Same through a thread cache: no CAS until a batch moves
+static void BM_MemoryPool_CachedAcquireRelease(benchmark::State &state) {
+    TscSampler<PoolBlock> sampler;
+    auto pool = std::make_unique<OrderPool>();
+    OrderPool::LocalCache cache(*pool);
+
+    while (state.KeepRunningBatch(PoolBlock)) {
+        sampler.begin();
+        for (std::uint32_t i = 0; i < PoolBlock; ++i) {
+            Order *order = cache.acquire();
+            benchmark::DoNotOptimize(order);
+            cache.release(order);
+        }
+        sampler.end();
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_MemoryPool_CachedAcquireRelease);
+
+// Acquire a burst, then release it, as a matching pass over many fills does.
+// The argument is the burst size; ops are counted per acquire/release pair.
+static void BM_MemoryPool_Burst(benchmark::State &state) {
+    TscSampler<PoolBlock> sampler;
+    auto pool = std::make_unique<OrderPool>();
+    const auto burst = static_cast<size_t>(state.range(0));
+    std::array<Order *, 1024> held{};
+
+    while (state.KeepRunningBatch(PoolBlock)) {
+        sampler.begin();
+        for (std::uint32_t i = 0; i < PoolBlock; ++i) {
+            for (size_t n = 0; n < burst; ++n) {
+                held[n] = pool->acquire();
+            }
+            benchmark::DoNotOptimize(held.data());
+            for (size_t n = 0; n < burst; ++n) {
+                pool->release(held[n]);
+            }
+        }
+        sampler.end();
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BM_MemoryPool_Burst)->Arg(8)->Arg(64)->Arg(1024);
+
+namespace {
+    OrderPool shared_pool;
+}
+
+// Every thread acquires and releases on one shared free list; the argument
+// selects direct (0) or cached (1) access
+static void BM_MemoryPool_Contended(benchmark::State &state) {
+    TscSampler<PoolBlock> sampler;
+    const bool cached = state.range(0) != 0;
+    OrderPool::LocalCache cache(shared_pool);
+
+    while (state.KeepRunningBatch(PoolBlock)) {
+        sampler.begin();
+        for (std::uint32_t i = 0; i < PoolBlock; ++i) {
+            Order *order = cached ? cache.acquire() : shared_pool.acquire();
+            benchmark::DoNotOptimize(order);
+            cached ? cache.release(order) : shared_pool.release(order);
+        }
+        sampler.end();
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_MemoryPool_Contended)->ArgName("cached")->Arg(0)->Arg(1)->Threads(2)->Threads(4)->UseRealTime();
@@ -0,0 +1,98 @@
+#include "benchmark_common.h"
+
+#include "market_data/order_book.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace trading_engine;
+using namespace trading_engine::bench;
+
+namespace {
+    constexpr Price MidPrice = 100 * PriceScale;
+    constexpr Price TickSize = PriceScale / 100; // One cent
+    constexpr size_t OpSequenceSize = 4096; // Power of two
+
+    // Bids MidPrice - TickSize * (1..depth), asks MidPrice + TickSize * (1..depth)
+    std::unique_ptr<OrderBook<> > make_book(const size_t depth) {
+        auto book = std::make_unique<OrderBook<> >();
+        for (size_t level = 1; level <= depth; ++level) {
+            book->update_level(Side::Buy, MidPrice - level * TickSize, 100 * level);
+            book->update_level(Side::Sell, MidPrice + level * TickSize, 100 * level);
+        }
+        return book;
+    }
+
+    struct LevelUpdate {
+        Side side;
+        Price price;
+        Quantity quantity;
+    };
+
+    // Updates spread over the whole populated depth, skewed towards the top
+    // of book the way real feeds are
+    std::vector<LevelUpdate> make_updates(const size_t depth) {
+        std::mt19937_64 rng(42);
+        std::geometric_distribution<size_t> distance(depth > 10 ? 0.2 : 0.5);
+        std::uniform_int_distribution<Quantity> quantity(1, 10000);
+
+        std::vector<LevelUpdate> updates(OpSequenceSize);
+        for (size_t i = 0; i < updates.size(); ++i) {
+            const size_t level = 1 + distance(rng) % depth;
+            const Side side = i % 2 == 0 ? Side::Buy : Side::Sell;
+            updates[i] = LevelUpdate{
+                .side = side,
+                .price = side == Side::Buy ? MidPrice - level * TickSize : MidPrice + level * TickSize,
+                .quantity = quantity(rng)
+            };
+        }
+        return updates;
+    }
+}
+
+// Quantity change on an existing level; the argument is the book depth
+static void BM_OrderBook_UpdateLevel(benchmark::State &state) {
+    TscSampler sampler;
+    const auto depth = static_cast<size_t>(state.range(0));
+    const auto book = make_book(depth);
+    const auto updates = make_updates(depth);
+
+    size_t next = 0;
+    for (auto _: state) {
+        const LevelUpdate &update = updates[next++ & (OpSequenceSize - 1)];
+        sampler.begin();
+        book->update_level(update.side, update.price, update.quantity);
+        sampler.end();
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_OrderBook_UpdateLevel)->Arg(1)->Arg(10)->Arg(100)->Arg(500)->Arg(1000);
+
+// Removes a level and adds it back, shifting every level behind it twice.
+// Ops are counted per update_level call.
+static void BM_OrderBook_RemoveInsertLevel(benchmark::State &state) {
+    TscSampler sampler;
+    const auto depth = static_cast<size_t>(state.range(0));
+    const auto book = make_book(depth);
+    const auto updates = make_updates(depth);
+
+    size_t next = 0;
+    for (auto _: state) {
+        const LevelUpdate &update = updates[next++ & (OpSequenceSize - 1)];
+        sampler.begin();
+        book->update_level(update.side, update.price, 0);
+        sampler.end();
+        sampler.begin();
+        book->update_level(update.side, update.price, update.quantity);
+        sampler.end();
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 2);
+}
+
+BENCHMARK(BM_OrderBook_RemoveInsertLevel)->Arg(10)->Arg(100)->Arg(500)->Arg(999);
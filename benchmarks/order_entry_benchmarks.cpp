@@ -0,0 +1,146 @@
+#include "benchmark_common.h"
+
+#include "order_entry/order_entry_gateway.h"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace trading_engine;
+using namespace trading_engine::bench;
+
+#ifdef __linux__
+namespace {
+    constexpr SymbolID BenchSymbol = 1;
+
+    int connect_loopback(const uint16_t port) {
+        const int fd = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+            return -1;
+        }
+        constexpr int enable = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        return fd;
+    }
+
+    template<typename Message>
+    bool send_message(const int fd, const Message &message) {
+        return ::send(fd, &message, sizeof(message), 0) == static_cast<ssize_t>(sizeof(message));
+    }
+
+    // Blocks, so the client leaves the cores to the engine while it waits
+    bool receive_report(const int fd, ExecutionReportMessage &report) {
+        return ::recv(fd, &report, sizeof(report), MSG_WAITALL) == static_cast<ssize_t>(sizeof(report));
+    }
+
+    // False on a dropped session or a reject, which would otherwise leave
+    // the client waiting for a report that never comes
+    bool receive_until(const int fd, const ExecutionType type) {
+        ExecutionReportMessage report{};
+        do {
+            if (!receive_report(fd, report) || report.exec_type == ExecutionType::Rejected ||
+                report.exec_type == ExecutionType::CancelReject || report.exec_type == ExecutionType::AmendReject) {
+                return false;
+            }
+        } while (report.exec_type != type);
+        return true;
+    }
+}
+
+// Wire to wire over loopback: a passive order goes in, the client times the
+// trip to its Accepted report, then cancels it untimed so the book stays
+// empty. Argument 1 times the trip to the cancel's Cancelled report
+// instead, through risk and matching. gw_* counters are the gateway's own
+// read-to-writev view of the same trips.
+static void BM_OrderEntry_RoundTrip(benchmark::State &state) {
+    TscSampler sampler;
+    const bool through_matching = state.range(0) != 0;
+
+    TradingEngine engine(EngineConfig{.gateway = GatewayConfig{}, .scheduler = SchedulerConfig{}});
+    const RiskLimits limits{.max_orders_per_second = 100000000};
+    engine.set_risk_limits(limits);
+    engine.set_symbol_risk_limits(BenchSymbol, limits);
+    engine.register_symbols(std::span(&BenchSymbol, 1));
+    OrderEntryGateway gateway(engine, OrderEntryConfig{.bind_address = "127.0.0.1"});
+    if (!engine.start() || !gateway.start()) {
+        state.SkipWithError("engine or gateway failed to start");
+        return;
+    }
+
+    const int fd = connect_loopback(gateway.listening_port());
+    if (fd < 0) {
+        state.SkipWithError("connect failed");
+        return;
+    }
+    LatencyProfiler::reset(LatencyProfiler::Order_entry_ack);
+    LatencyProfiler::reset(LatencyProfiler::Order_entry_response);
+
+    uint64_t client_order_id = 0;
+    for (auto _: state) {
+        const NewOrderMessage order{
+            .header = order_entry_header(MessageType::NewOrder, sizeof(NewOrderMessage)),
+            .client_order_id = ++client_order_id,
+            .price = 100 * PriceScale,
+            .stop_price = 0,
+            .quantity = 10,
+            .symbol_id = BenchSymbol,
+            .side = Side::Buy,
+            .order_type = OrderType::Limit,
+            .time_in_force = TimeInForce::Day,
+            .reserved = 0
+        };
+
+        if (!through_matching) {
+            sampler.begin();
+        }
+        ExecutionReportMessage accepted{};
+        if (!send_message(fd, order) || !receive_report(fd, accepted)) {
+            state.SkipWithError("session lost");
+            break;
+        }
+        if (!through_matching) {
+            sampler.end();
+        }
+
+        const CancelOrderMessage cancel{
+            .header = order_entry_header(MessageType::CancelOrder, sizeof(CancelOrderMessage)),
+            .order_id = accepted.order_id
+        };
+        if (through_matching) {
+            sampler.begin();
+        }
+        if (!send_message(fd, cancel) || !receive_until(fd, ExecutionType::Cancelled)) {
+            state.SkipWithError("session lost or cancel rejected");
+            break;
+        }
+        if (through_matching) {
+            sampler.end();
+        }
+    }
+
+    ::close(fd);
+    const OrderEntryGateway::OrderEntryStats stats = gateway.get_statistics();
+    engine.stop();
+    gateway.stop();
+
+    sampler.report(state);
+    const LatencyProfiler::ProfileResults &gateway_side = through_matching ? stats.response_latency : stats.ack_latency;
+    state.counters["gw_p50_ns"] = gateway_side.p50_latency_us * 1000.0;
+    state.counters["gw_p99_ns"] = gateway_side.p99_latency_us * 1000.0;
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_OrderEntry_RoundTrip)
+    ->ArgName("through_matching")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+#endif
@@ -0,0 +1,243 @@
+#include "benchmark_common.h"
+
+#include "core/queue.h"
+
+#include <array>
+#include <span>
+#include <thread>
+
+using namespace trading_engine;
+using namespace trading_engine::bench;
+
+namespace {
+    constexpr std::uint32_t QueueBlock = 32;
+
+    // Spin briefly, then give the core away; the other side may share it
+    FORCE_INLINE void back_off(std::uint32_t &spins) noexcept {
+        if (++spins < 64) {
+            cpu_relax();
+        } else {
+            spins = 0;
+            std::this_thread::yield();
+        }
+    }
+
+    template<typename Queue, typename T>
+    FORCE_INLINE void push_blocking(Queue &queue, const T &item) noexcept {
+        std::uint32_t spins = 0;
+        while (!queue.try_push(item)) {
+            back_off(spins);
+        }
+    }
+
+    template<typename Queue, typename T>
+    FORCE_INLINE void pop_blocking(Queue &queue, T &item) noexcept {
+        std::uint32_t spins = 0;
+        while (!queue.try_pop(item)) {
+            back_off(spins);
+        }
+    }
+
+    // Moves a whole span, however many bulk calls that takes
+    template<typename Queue, typename T>
+    FORCE_INLINE void push_bulk_blocking(Queue &queue, std::span<const T> items) noexcept {
+        std::uint32_t spins = 0;
+        while (!items.empty()) {
+            const size_t pushed = queue.try_push_bulk(items);
+            items = items.subspan(pushed);
+            if (pushed == 0) {
+                back_off(spins);
+            }
+        }
+    }
+
+    template<typename Queue, typename T>
+    FORCE_INLINE void pop_bulk_blocking(Queue &queue, std::span<T> items) noexcept {
+        std::uint32_t spins = 0;
+        while (!items.empty()) {
+            const size_t popped = queue.try_pop_bulk(items);
+            items = items.subspan(popped);
+            if (popped == 0) {
+                back_off(spins);
+            }
+        }
+    }
+
+    constexpr MarketTick SampleTick{
+        .symbol_id = 1,
+        .price = 100 * PriceScale,
+        .quantity = 10,
+        .timestamp = 0,
+        .sequence = 0,
+        .side = Side::Buy
+    };
+
+    constexpr Trade SampleTrade{
+        .trade_id = 1,
+        .buy_order_id = 1,
+        .sell_order_id = 2,
+        .price = 100 * PriceScale,
+        .quantity = 10,
+        .timestamp = 0,
+        .symbol_id = 1,
+        .aggressor_side = Side::Buy
+    };
+
+    // Same element types and capacities as the engine's queues
+    SPSCQueue<MarketTick, 4096> tick_queue;
+    MPSCQueue<Trade, 2048> trade_queue;
+    MPMCQueue<Order, 4096> order_queue;
+}
+
+// Uncontended push then pop on one thread: the cost floor of a hop
+static void BM_SPSCQueue_PushPop(benchmark::State &state) {
+    TscSampler<QueueBlock> sampler;
+    MarketTick tick = SampleTick;
+    MarketTick out{};
+
+    while (state.KeepRunningBatch(QueueBlock)) {
+        sampler.begin();
+        for (std::uint32_t i = 0; i < QueueBlock; ++i) {
+            tick.sequence = i;
+            (void) tick_queue.try_push(tick);
+            (void) tick_queue.try_pop(out);
+        }
+        sampler.end();
+        benchmark::DoNotOptimize(out);
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_SPSCQueue_PushPop);
+
+// Gateway to shard: thread 0 produces ticks, thread 1 consumes them
+static void BM_SPSCQueue_Transfer(benchmark::State &state) {
+    TscSampler<QueueBlock> sampler;
+    const bool producer = state.thread_index() == 0;
+    MarketTick tick = SampleTick;
+
+    while (state.KeepRunningBatch(QueueBlock)) {
+        sampler.begin();
+        for (std::uint32_t i = 0; i < QueueBlock; ++i) {
+            if (producer) {
+                ++tick.sequence;
+                push_blocking(tick_queue, tick);
+            } else {
+                pop_blocking(tick_queue, tick);
+            }
+        }
+        sampler.end();
+    }
+    benchmark::DoNotOptimize(tick);
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_SPSCQueue_Transfer)->Threads(2)->UseRealTime();
+
+// Same hop in blocks of QueueBlock: one index update per block, not per tick
+static void BM_SPSCQueue_TransferBulk(benchmark::State &state) {
+    TscSampler<QueueBlock> sampler;
+    const bool producer = state.thread_index() == 0;
+    std::array<MarketTick, QueueBlock> ticks;
+    ticks.fill(SampleTick);
+
+    while (state.KeepRunningBatch(QueueBlock)) {
+        sampler.begin();
+        if (producer) {
+            ++ticks[0].sequence;
+            push_bulk_blocking(tick_queue, std::span<const MarketTick>(ticks));
+        } else {
+            pop_bulk_blocking(tick_queue, std::span<MarketTick>(ticks));
+        }
+        sampler.end();
+    }
+    benchmark::DoNotOptimize(ticks);
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_SPSCQueue_TransferBulk)->Threads(2)->UseRealTime();
+
+// Trade notifications: thread 0 drains, every other thread produces
+static void BM_MPSCQueue_Transfer(benchmark::State &state) {
+    TscSampler<QueueBlock> sampler;
+    const bool consumer = state.thread_index() == 0;
+    const auto producers = static_cast<std::uint32_t>(state.threads() - 1);
+    Trade trade = SampleTrade;
+
+    while (state.KeepRunningBatch(QueueBlock)) {
+        sampler.begin();
+        for (std::uint32_t i = 0; i < QueueBlock; ++i) {
+            if (consumer) {
+                for (std::uint32_t p = 0; p < producers; ++p) {
+                    pop_blocking(trade_queue, trade);
+                }
+            } else {
+                push_blocking(trade_queue, trade);
+            }
+        }
+        sampler.end();
+    }
+    benchmark::DoNotOptimize(trade);
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_MPSCQueue_Transfer)->Threads(2)->Threads(3)->Threads(5)->UseRealTime();
+
+// Order intake: even threads submit, odd threads consume
+static void BM_MPMCQueue_Transfer(benchmark::State &state) {
+    TscSampler<QueueBlock> sampler;
+    const bool producer = state.thread_index() % 2 == 0;
+    Order order{.orderID = 1, .symbolID = 1, .price = 100 * PriceScale, .quantity = 10};
+
+    while (state.KeepRunningBatch(QueueBlock)) {
+        sampler.begin();
+        for (std::uint32_t i = 0; i < QueueBlock; ++i) {
+            if (producer) {
+                ++order.orderID;
+                push_blocking(order_queue, order);
+            } else {
+                pop_blocking(order_queue, order);
+            }
+        }
+        sampler.end();
+    }
+    benchmark::DoNotOptimize(order);
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_MPMCQueue_Transfer)->Threads(2)->Threads(4)->UseRealTime();
+
+// Order intake in blocks: one CAS claims a run of cells
+static void BM_MPMCQueue_TransferBulk(benchmark::State &state) {
+    TscSampler<QueueBlock> sampler;
+    const bool producer = state.thread_index() % 2 == 0;
+    std::array<Order, QueueBlock> orders;
+    orders.fill(Order{.orderID = 1, .symbolID = 1, .price = 100 * PriceScale, .quantity = 10});
+
+    while (state.KeepRunningBatch(QueueBlock)) {
+        sampler.begin();
+        if (producer) {
+            ++orders[0].orderID;
+            push_bulk_blocking(order_queue, std::span<const Order>(orders));
+        } else {
+            pop_bulk_blocking(order_queue, std::span<Order>(orders));
+        }
+        sampler.end();
+    }
+    benchmark::DoNotOptimize(orders);
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_MPMCQueue_TransferBulk)->Threads(2)->Threads(4)->UseRealTime();
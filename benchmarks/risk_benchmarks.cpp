@@ -0,0 +1,121 @@
+#include "benchmark_common.h"
+
+#include "risk/risk_manager.h"
+
+#include <array>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace trading_engine;
+using namespace trading_engine::bench;
+
+namespace {
+    constexpr Price ReferencePrice = 100 * PriceScale;
+    constexpr size_t OpSequenceSize = 4096; // Power of two
+
+    // Rate limits high enough that every order takes the full approved path
+    constexpr RiskLimits UnthrottledLimits{
+        .max_orders_per_second = 4'000'000'000U
+    };
+
+    std::unique_ptr<RiskManager> make_risk_manager(const size_t symbol_count, const RiskLimits &limits) {
+        auto risk_manager = std::make_unique<RiskManager>();
+        risk_manager->set_global_limits(limits);
+        for (SymbolID symbol = 1; symbol <= symbol_count; ++symbol) {
+            risk_manager->set_symbol_limits(symbol, limits);
+            risk_manager->update_reference_price(symbol, ReferencePrice);
+        }
+        return risk_manager;
+    }
+
+    // Small orders near the reference, spread uniformly over the symbols
+    std::vector<Order> make_orders(const size_t symbol_count) {
+        std::mt19937_64 rng(11);
+        std::uniform_int_distribution<SymbolID> symbol(1, static_cast<SymbolID>(symbol_count));
+        std::uniform_int_distribution<Quantity> quantity(1, 500);
+        std::uniform_int_distribution<std::int64_t> ticks(-100, 100);
+
+        std::vector<Order> orders(OpSequenceSize);
+        for (size_t i = 0; i < orders.size(); ++i) {
+            orders[i] = Order{
+                .orderID = i + 1,
+                .symbolID = symbol(rng),
+                .side = i % 2 == 0 ? Side::Buy : Side::Sell,
+                .orderType = OrderType::Limit,
+                .price = static_cast<Price>(static_cast<std::int64_t>(ReferencePrice) + ticks(rng) * 1000000),
+                .quantity = quantity(rng)
+            };
+        }
+        return orders;
+    }
+}
+
+// Approved orders; the argument is the number of symbols the flow spans
+static void BM_RiskManager_CheckOrder(benchmark::State &state) {
+    TscSampler sampler;
+    const auto symbol_count = static_cast<size_t>(state.range(0));
+    const auto risk_manager = make_risk_manager(symbol_count, UnthrottledLimits);
+    const auto orders = make_orders(symbol_count);
+
+    size_t next = 0;
+    for (auto _: state) {
+        const Order &order = orders[next++ & (OpSequenceSize - 1)];
+        sampler.begin();
+        const RiskManager::RiskResult result = risk_manager->check_order(order);
+        sampler.end();
+        benchmark::DoNotOptimize(result);
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_RiskManager_CheckOrder)->Arg(1)->Arg(64)->Arg(1024);
+
+// Default limits: once the burst allowance is spent nearly every order is
+// turned away by the rate limiter, the path a runaway strategy hits
+static void BM_RiskManager_CheckOrder_RateLimited(benchmark::State &state) {
+    TscSampler sampler;
+    const auto risk_manager = make_risk_manager(1, RiskLimits{});
+    const auto orders = make_orders(1);
+
+    size_t next = 0;
+    for (auto _: state) {
+        const Order &order = orders[next++ & (OpSequenceSize - 1)];
+        sampler.begin();
+        const RiskManager::RiskResult result = risk_manager->check_order(order);
+        sampler.end();
+        benchmark::DoNotOptimize(result);
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_RiskManager_CheckOrder_RateLimited);
+
+// check_orders over full batches; latency is per order
+static void BM_RiskManager_CheckOrders(benchmark::State &state) {
+    constexpr auto BatchSize = static_cast<std::uint32_t>(RiskManager::MaxBatchSize);
+    TscSampler<BatchSize> sampler;
+    const auto symbol_count = static_cast<size_t>(state.range(0));
+    const auto risk_manager = make_risk_manager(symbol_count, UnthrottledLimits);
+    const auto orders = make_orders(symbol_count);
+    std::array<RiskManager::RiskResult, BatchSize> results{};
+
+    size_t next = 0;
+    while (state.KeepRunningBatch(BatchSize)) {
+        const std::span<const Order> batch(orders.data() + next, BatchSize);
+        next = (next + BatchSize) & (OpSequenceSize - 1);
+        sampler.begin();
+        risk_manager->check_orders(batch, results);
+        sampler.end();
+        benchmark::DoNotOptimize(results.data());
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_RiskManager_CheckOrders)->Arg(1)->Arg(64)->Arg(1024);
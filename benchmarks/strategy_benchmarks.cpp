@@ -0,0 +1,137 @@
+#include "benchmark_common.h"
+
+#include "strategy/rolling_stats.h"
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace trading_engine;
+using namespace trading_engine::bench;
+
+namespace {
+    constexpr size_t PriceSequenceSize = 4096; // Power of two
+    constexpr size_t BasketLanes = 512;
+
+    // A random walk of cent moves around 100
+    std::vector<Price> make_prices() {
+        std::mt19937_64 rng(5);
+        std::uniform_int_distribution<std::int64_t> ticks(-3, 3);
+
+        std::vector<Price> prices(PriceSequenceSize);
+        auto price = static_cast<std::int64_t>(100 * PriceScale);
+        for (Price &sample: prices) {
+            price += ticks(rng) * (PriceScale / 100);
+            sample = static_cast<Price>(price);
+        }
+        return prices;
+    }
+}
+
+// One tick into the window plus its z-score; the argument is the window length
+static void BM_RollingStats_Push(benchmark::State &state) {
+    TscSampler<64> sampler;
+    RollingStats<128> stats(static_cast<size_t>(state.range(0)));
+    const auto prices = make_prices();
+
+    size_t i = 0;
+    for (auto _: state) {
+        sampler.begin();
+        for (int op = 0; op < 64; ++op) {
+            const Price price = prices[i++ & (PriceSequenceSize - 1)];
+            stats.push(price, 100);
+            benchmark::DoNotOptimize(stats.z_score(price));
+        }
+        sampler.end();
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 64);
+}
+
+BENCHMARK(BM_RollingStats_Push)->Arg(20)->Arg(128);
+
+// What the mean reversion strategy did before: mean and deviation recomputed
+// over the whole window in two passes on every tick
+static void BM_RollingStats_TwoPassBaseline(benchmark::State &state) {
+    TscSampler<64> sampler;
+    const auto window = static_cast<size_t>(state.range(0));
+    std::array<Price, 128> history{};
+    const auto prices = make_prices();
+
+    size_t i = 0;
+    for (auto _: state) {
+        sampler.begin();
+        for (int op = 0; op < 64; ++op, ++i) {
+            const Price price = prices[i & (PriceSequenceSize - 1)];
+            history[i % window] = price;
+
+            double sum = 0.0;
+            for (size_t k = 0; k < window; ++k) {
+                sum += from_scaled_price(history[k]);
+            }
+            const double mean = sum / static_cast<double>(window);
+            double squares = 0.0;
+            for (size_t k = 0; k < window; ++k) {
+                const double difference = from_scaled_price(history[k]) - mean;
+                squares += difference * difference;
+            }
+            benchmark::DoNotOptimize((from_scaled_price(price) - mean) /
+                                     std::sqrt(squares / static_cast<double>(window)));
+        }
+        sampler.end();
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 64);
+}
+
+BENCHMARK(BM_RollingStats_TwoPassBaseline)->Arg(20)->Arg(128);
+
+// A burst's vectorised scoring of every lane of a full 512-symbol bank;
+// items are lanes scored
+static void BM_RollingStatsBank_ZScores(benchmark::State &state) {
+    TscSampler sampler;
+    const auto bank = std::make_unique<RollingStatsBank<BasketLanes> >(20);
+    const auto prices = make_prices();
+    for (size_t i = 0; i < PriceSequenceSize * 8; ++i) {
+        bank->push(i % BasketLanes, prices[i & (PriceSequenceSize - 1)]);
+    }
+
+    alignas(CacheLineSize) std::array<double, BasketLanes> scores{};
+    for (auto _: state) {
+        sampler.begin();
+        bank->z_scores(scores, 20);
+        sampler.end();
+        benchmark::DoNotOptimize(scores.data());
+        benchmark::ClobberMemory();
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * BasketLanes));
+}
+
+BENCHMARK(BM_RollingStatsBank_ZScores);
+
+// One tick into one lane, as a basket strategy's process_tick() does it
+static void BM_RollingStatsBank_Push(benchmark::State &state) {
+    TscSampler<64> sampler;
+    const auto bank = std::make_unique<RollingStatsBank<BasketLanes> >(20);
+    const auto prices = make_prices();
+
+    size_t i = 0;
+    for (auto _: state) {
+        sampler.begin();
+        for (int op = 0; op < 64; ++op, ++i) {
+            bank->push((i * 7) % BasketLanes, prices[i & (PriceSequenceSize - 1)]);
+        }
+        sampler.end();
+    }
+
+    sampler.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 64);
+}
+
+BENCHMARK(BM_RollingStatsBank_Push);
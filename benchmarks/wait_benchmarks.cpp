@@ -0,0 +1,91 @@
+#include "benchmark_common.h"
+
+#include "core/queue.h"
+#include "core/wait_strategy.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace trading_engine;
+using namespace trading_engine::bench;
+
+// Idle to first message: each message reaches a consumer that has been idle
+// for the gap, so it is spinning, yielding or parked by then. The iteration
+// time is the producer-stamped latency to the consumer's pop; cpu_pct is the
+// share of a core the consumer burnt, waiting included.
+static void BM_WaitStrategy_Wakeup(benchmark::State &state) {
+    initialize_clock();
+    const auto policy = static_cast<WaitPolicy>(state.range(0));
+    const auto gap = std::chrono::microseconds(state.range(1));
+
+    SPSCQueue<std::uint64_t, 64> queue;
+    WakeSignal wake(policy);
+    WaitStrategy wait(WaitConfig{.policy = policy}, &wake, "bench");
+    std::atomic<bool> running{true};
+    std::atomic<std::uint64_t> received{0};
+    std::atomic<std::uint64_t> last_latency{0};
+
+    std::thread consumer([&] {
+        const auto ready = [&] {
+            return !queue.empty() || !running.load(std::memory_order_acquire);
+        };
+
+        wait.begin();
+        std::uint64_t stamp = 0;
+        while (running.load(std::memory_order_acquire)) {
+            if (!queue.try_pop(stamp)) {
+                wait.idle(ready);
+                continue;
+            }
+            wait.on_work();
+            last_latency.store(TimestampManager::get_hardware_timestamp() - stamp, std::memory_order_relaxed);
+            received.fetch_add(1, std::memory_order_release);
+        }
+        wait.end();
+    });
+
+    LatencyHistogram histogram;
+    std::uint64_t sent = 0;
+    for (auto _: state) {
+        std::this_thread::sleep_for(gap);
+
+        (void) queue.try_push(TimestampManager::get_hardware_timestamp());
+        wake.notify();
+        ++sent;
+        while (received.load(std::memory_order_acquire) != sent) {
+            std::this_thread::yield();
+        }
+
+        const std::uint64_t latency = last_latency.load(std::memory_order_relaxed);
+        histogram.record(latency);
+        state.SetIterationTime(static_cast<double>(TimestampManager::tsc_to_nanoseconds(latency).count()) / 1e9);
+    }
+
+    running.store(false, std::memory_order_release);
+    wake.wake_all();
+    consumer.join();
+
+    const LatencyProfiler::ProfileResults results = LatencyProfiler::summarize(histogram);
+    const WaitStats stats = wait.get_statistics();
+    state.counters["p50_ns"] = results.p50_latency_us * 1000.0;
+    state.counters["p99_ns"] = results.p99_latency_us * 1000.0;
+    state.counters["cpu_pct"] = stats.cpu_utilisation * 100.0;
+    state.counters["parks"] = static_cast<double>(stats.parks);
+    state.SetLabel(to_string(policy));
+}
+
+BENCHMARK(BM_WaitStrategy_Wakeup)
+    ->ArgNames({"policy", "gap_us"})
+    ->ArgsProduct({
+        {
+            static_cast<int64_t>(WaitPolicy::BusySpin),
+            static_cast<int64_t>(WaitPolicy::SpinPause),
+            static_cast<int64_t>(WaitPolicy::SpinThenYield),
+            static_cast<int64_t>(WaitPolicy::SpinThenPark),
+            static_cast<int64_t>(WaitPolicy::Block)
+        },
+        {50}
+    })
+    ->Iterations(2000) // Manual time is tiny next to the gaps, so fix the count
+    ->UseManualTime();
@@ -0,0 +1,476 @@
+#pragma once
+
+#include "types.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace trading_engine {
+    // NUMA placement
+    //
+    // Memory a role's thread lives on (its queues, books, pools) goes on the
+    // node of that thread's core. mbind is called through syscall() so the
+    // build needs no libnuma; every call degrades to ordinary allocation when
+    // the kernel or platform says no, since placement is an optimisation only.
+    namespace numa_detail {
+        constexpr int PolicyPreferred = 1; // MPOL_PREFERRED: node first, fall back when full
+        constexpr unsigned MoveExisting = 1U << 1; // MPOL_MF_MOVE: migrate pages already faulted in
+
+        inline size_t page_size() noexcept {
+#ifdef __linux__
+            static const auto size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            return size;
+#else
+            return 4096;
+#endif
+        }
+    }
+
+    // Prefer `node` for the whole pages inside [address, address + bytes),
+    // migrating any that are already resident; false if nothing was bound
+    inline bool bind_to_node(void *address, const size_t bytes, const int node) noexcept {
+#ifdef __linux__
+        if (node < 0 || node >= 64) {
+            return false;
+        }
+        const size_t page = numa_detail::page_size();
+        const auto start = (reinterpret_cast<uintptr_t>(address) + page - 1) & ~(page - 1);
+        const auto end = (reinterpret_cast<uintptr_t>(address) + bytes) & ~(page - 1);
+        if (end <= start) {
+            return false;
+        }
+        const unsigned long node_mask = 1UL << node;
+        return syscall(SYS_mbind, start, end - start, numa_detail::PolicyPreferred, &node_mask,
+                       sizeof(node_mask) * 8, numa_detail::MoveExisting) == 0;
+#else
+        (void) address;
+        (void) bytes;
+        (void) node;
+        return false;
+#endif
+    }
+
+    // Touch every page so the first access on the hot path never faults
+    inline void prefault(void *address, const size_t bytes) noexcept {
+        auto *bytes_ptr = static_cast<volatile char *>(address);
+        const size_t page = numa_detail::page_size();
+        for (size_t offset = 0; offset < bytes; offset += page) {
+            bytes_ptr[offset] = bytes_ptr[offset];
+        }
+    }
+
+    // Node that mappings without an explicit node go on, for the calling
+    // thread. make_node_local sets it while constructing, so pools and queues
+    // inside a node-local object follow it onto the node.
+    class NodeScope {
+        inline static thread_local int current_node = -1;
+        int previous;
+
+    public:
+        explicit NodeScope(const int node) noexcept : previous(current_node) {
+            current_node = node;
+        }
+
+        ~NodeScope() {
+            current_node = previous;
+        }
+
+        NodeScope(const NodeScope &) = delete;
+
+        NodeScope &operator=(const NodeScope &) = delete;
+
+        [[nodiscard]] static int current() noexcept {
+            return current_node;
+        }
+    };
+
+    enum class PageKind : uint8_t {
+        None, // Nothing mapped
+        Small, // Base pages
+        Transparent, // Base pages with transparent huge pages requested
+        Huge2M, // hugetlbfs 2MB pages
+        Huge1G // hugetlbfs 1GB pages
+    };
+
+    // Anonymous, prefaulted memory that owns its pages
+    //
+    // map() tries the largest huge page the size justifies and falls back to
+    // smaller ones: hugetlbfs pages only exist when reserved up front (e.g.
+    // vm.nr_hugepages), so base pages with a THP hint are the common result.
+    class PageMapping {
+        static constexpr size_t HugePage2M = 2ULL << 20;
+        static constexpr size_t HugePage1G = 1ULL << 30;
+
+        void *base{nullptr};
+        size_t bytes{0};
+        PageKind kind{PageKind::None};
+
+        PageMapping(void *mapped, const size_t mapped_bytes, const PageKind page_kind) noexcept
+            : base(mapped), bytes(mapped_bytes), kind(page_kind) {
+        }
+
+    public:
+        PageMapping() noexcept = default;
+
+        PageMapping(PageMapping &&other) noexcept
+            : base(std::exchange(other.base, nullptr)),
+              bytes(std::exchange(other.bytes, 0)),
+              kind(std::exchange(other.kind, PageKind::None)) {
+        }
+
+        PageMapping &operator=(PageMapping &&other) noexcept {
+            if (this != &other) {
+                reset();
+                base = std::exchange(other.base, nullptr);
+                bytes = std::exchange(other.bytes, 0);
+                kind = std::exchange(other.kind, PageKind::None);
+            }
+            return *this;
+        }
+
+        ~PageMapping() {
+            reset();
+        }
+
+        // At least `size` bytes on `node` (-1: the NodeScope node, if any).
+        // Empty if the OS has no memory to give.
+        [[nodiscard]] static PageMapping map(const size_t size, int node = -1) noexcept {
+            if (size == 0) {
+                return {};
+            }
+            if (node < 0) {
+                node = NodeScope::current();
+            }
+
+            PageMapping mapping = map_pages(size, node, nullptr, 0);
+            if (mapping.base != nullptr) {
+                prefault(mapping.base, mapping.bytes);
+            }
+            return mapping;
+        }
+
+#ifdef __linux__
+        // Same, but placed at `address` inside a PROT_NONE reservation with
+        // `room` bytes free there; page sizes that do not fit are skipped.
+        // The result must be given up with release() rather than reset:
+        // unmapping would leave a hole in the reservation.
+        [[nodiscard]] static PageMapping map_at(void *address, const size_t size, const size_t room,
+                                                int node = -1) noexcept {
+            if (size == 0 || size > room) {
+                return {};
+            }
+            if (node < 0) {
+                node = NodeScope::current();
+            }
+
+            PageMapping mapping = map_pages(size, node, address, room);
+            if (mapping.base != nullptr) {
+                prefault(mapping.base, mapping.bytes);
+            }
+            return mapping;
+        }
+#endif
+
+        // Forgets the pages without unmapping them; whoever reserved the
+        // range unmaps it
+        void release() noexcept {
+            base = nullptr;
+            bytes = 0;
+            kind = PageKind::None;
+        }
+
+        void reset() noexcept {
+            if (base == nullptr) {
+                return;
+            }
+#ifdef _WIN32
+            VirtualFree(base, 0, MEM_RELEASE);
+#elif defined(__linux__)
+            munmap(base, bytes);
+#else
+            ::operator delete(base, std::align_val_t{4096});
+#endif
+            base = nullptr;
+            bytes = 0;
+            kind = PageKind::None;
+        }
+
+        [[nodiscard]] void *data() const noexcept {
+            return base;
+        }
+
+        [[nodiscard]] size_t size() const noexcept {
+            return bytes;
+        }
+
+        [[nodiscard]] PageKind page_kind() const noexcept {
+            return kind;
+        }
+
+        explicit operator bool() const noexcept {
+            return base != nullptr;
+        }
+
+    private:
+        static size_t round_up(const size_t size, const size_t page) noexcept {
+            return (size + page - 1) & ~(page - 1);
+        }
+
+        // `address` null lets the kernel pick; otherwise the pages replace
+        // `room` reserved bytes from there
+        static PageMapping map_pages(const size_t size, const int node, void *address, const size_t room) noexcept {
+#ifdef __linux__
+            const auto fits = [size, address, room](const size_t page) {
+                return address == nullptr ||
+                       (reinterpret_cast<uintptr_t>(address) % page == 0 && round_up(size, page) <= room);
+            };
+
+            // hugetlbfs pages once the request fills at least half of one
+            constexpr int HugeShift = 26; // MAP_HUGE_SHIFT
+            if (size >= HugePage1G / 2 && fits(HugePage1G)) {
+                if (PageMapping mapping = map_anonymous(address, round_up(size, HugePage1G),
+                                                        MAP_HUGETLB | (30 << HugeShift), node, PageKind::Huge1G)) {
+                    return mapping;
+                }
+            }
+            if (size >= HugePage2M / 2 && fits(HugePage2M)) {
+                if (PageMapping mapping = map_anonymous(address, round_up(size, HugePage2M),
+                                                        MAP_HUGETLB | (21 << HugeShift), node, PageKind::Huge2M)) {
+                    return mapping;
+                }
+            }
+
+            PageMapping mapping = map_anonymous(address, round_up(size, numa_detail::page_size()), 0, node,
+                                                PageKind::Small);
+            if (mapping && size >= HugePage2M && madvise(mapping.base, mapping.bytes, MADV_HUGEPAGE) == 0) {
+                mapping.kind = PageKind::Transparent;
+            }
+            return mapping;
+#elif defined(_WIN32)
+            (void) address;
+            (void) room;
+            const size_t mapped_bytes = round_up(size, numa_detail::page_size());
+            void *memory = node >= 0
+                               ? VirtualAllocExNuma(GetCurrentProcess(), nullptr, mapped_bytes,
+                                                    MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE,
+                                                    static_cast<DWORD>(node))
+                               : VirtualAlloc(nullptr, mapped_bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+            return memory != nullptr ? PageMapping(memory, mapped_bytes, PageKind::Small) : PageMapping{};
+#else
+            (void) node;
+            (void) address;
+            (void) room;
+            const size_t mapped_bytes = round_up(size, 4096);
+            void *memory = ::operator new(mapped_bytes, std::align_val_t{4096}, std::nothrow);
+            return memory != nullptr ? PageMapping(memory, mapped_bytes, PageKind::Small) : PageMapping{};
+#endif
+        }
+
+#ifdef __linux__
+        static PageMapping map_anonymous(void *address, const size_t size, const int flags, const int node,
+                                         const PageKind page_kind) noexcept {
+            void *memory = mmap(address, size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS | flags | (address != nullptr ? MAP_FIXED : 0), -1, 0);
+            if (memory == MAP_FAILED) {
+                // A failed MAP_FIXED may have unmapped the range; put the
+                // reservation back before anything else can land there
+                if (address != nullptr) {
+                    (void) mmap(address, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED,
+                                -1, 0);
+                }
+                return {};
+            }
+            // Bind before the first touch so pages fault in on the node
+            (void) bind_to_node(memory, size, node);
+            return {memory, size, page_kind};
+        }
+#endif
+    };
+
+    // Equal-sized chunks of prefaulted pages, added under a lock and never
+    // given back until the arena goes away. Chunk addresses are published
+    // with release stores, so readers index them without locking.
+    //
+    // On Linux the arena reserves address space for every chunk it may ever
+    // hold up front, one power-of-two stride apart, and maps each chunk into
+    // its slot as it is added; find_chunk() is then a subtract and a shift.
+    // Elsewhere, or if the reservation fails, it scans the chunks.
+    class HugePageArena {
+    public:
+        static constexpr uint32_t MaxChunks = 64;
+
+    private:
+        std::array<PageMapping, MaxChunks> mappings{};
+        std::array<std::atomic<std::byte *>, MaxChunks> bases{};
+        std::atomic<uint32_t> chunk_count{0};
+        std::mutex grow_mutex;
+        size_t chunk_bytes;
+        uint32_t max_chunks;
+        int numa_node;
+
+        std::byte *reserved{nullptr}; // Start of chunk 0's slot; null without a reservation
+        size_t reserved_bytes{0};
+        int stride_shift{0};
+
+    public:
+        HugePageArena(const size_t bytes_per_chunk, const uint32_t chunk_limit, const int node = -1) noexcept
+            : chunk_bytes(bytes_per_chunk),
+              max_chunks(std::min(std::max(chunk_limit, 1U), MaxChunks)),
+              numa_node(node >= 0 ? node : NodeScope::current()) {
+            reserve();
+        }
+
+        ~HugePageArena() {
+#ifdef __linux__
+            if (reserved != nullptr) {
+                for (PageMapping &mapping: mappings) {
+                    mapping.release();
+                }
+                munmap(reserved, reserved_bytes);
+            }
+#endif
+        }
+
+        HugePageArena(const HugePageArena &) = delete;
+
+        HugePageArena &operator=(const HugePageArena &) = delete;
+
+        // Maps one more chunk and returns its index; MaxChunks at the chunk
+        // limit or when out of memory. Cold: takes a lock and faults in every page.
+        uint32_t add_chunk() noexcept {
+            std::lock_guard lock(grow_mutex);
+            const uint32_t index = chunk_count.load(std::memory_order_relaxed);
+            if (index >= max_chunks) {
+                return MaxChunks;
+            }
+
+            PageMapping mapping = reserved != nullptr
+                                      ? map_slot(index)
+                                      : PageMapping::map(chunk_bytes, numa_node);
+            if (!mapping) {
+                return MaxChunks;
+            }
+
+            bases[index].store(static_cast<std::byte *>(mapping.data()), std::memory_order_release);
+            mappings[index] = std::move(mapping);
+            chunk_count.store(index + 1, std::memory_order_release);
+            return index;
+        }
+
+        [[nodiscard]] std::byte *chunk(const uint32_t index) const noexcept {
+            return bases[index].load(std::memory_order_acquire);
+        }
+
+        // Chunk holding `address`, or MaxChunks if none does
+        [[nodiscard]] uint32_t find_chunk(const void *address) const noexcept {
+            const auto *byte = static_cast<const std::byte *>(address);
+            const uint32_t count = chunk_count.load(std::memory_order_acquire);
+            if (reserved != nullptr) {
+                // Addresses below the reservation wrap to huge offsets
+                const uintptr_t offset = reinterpret_cast<uintptr_t>(byte) - reinterpret_cast<uintptr_t>(reserved);
+                const uintptr_t index = offset >> stride_shift;
+                const bool inside = index < count && (offset & ((uintptr_t{1} << stride_shift) - 1)) < chunk_bytes;
+                return inside ? static_cast<uint32_t>(index) : MaxChunks;
+            }
+            for (uint32_t index = 0; index < count; ++index) {
+                const std::byte *base = bases[index].load(std::memory_order_relaxed);
+                if (byte >= base && byte < base + chunk_bytes) {
+                    return index;
+                }
+            }
+            return MaxChunks;
+        }
+
+        [[nodiscard]] uint32_t chunks() const noexcept {
+            return chunk_count.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] uint32_t chunk_limit() const noexcept {
+            return max_chunks;
+        }
+
+        [[nodiscard]] bool can_grow() const noexcept {
+            return chunks() < max_chunks;
+        }
+
+        [[nodiscard]] size_t bytes_per_chunk() const noexcept {
+            return chunk_bytes;
+        }
+
+        // Page size backing the first chunk; later chunks may fall back further
+        [[nodiscard]] PageKind page_kind() const noexcept {
+            return chunks() > 0 ? mappings[0].page_kind() : PageKind::None;
+        }
+
+        [[nodiscard]] size_t mapped_bytes() const noexcept {
+            size_t total = 0;
+            const uint32_t count = chunks();
+            for (uint32_t index = 0; index < count; ++index) {
+                total += mappings[index].size();
+            }
+            return total;
+        }
+
+    private:
+        // Address space for max_chunks slots of bit_ceil(chunk_bytes), aligned
+        // to the stride so any huge page size up to it can map a slot.
+        // PROT_NONE and MAP_NORESERVE: nothing is committed until a chunk is
+        // mapped.
+        void reserve() noexcept {
+#ifdef __linux__
+            if (chunk_bytes == 0 || chunk_bytes > (size_t{1} << 40)) {
+                return;
+            }
+            const size_t page = numa_detail::page_size();
+            const size_t stride = std::bit_ceil((chunk_bytes + page - 1) & ~(page - 1));
+            const size_t span = stride * max_chunks;
+            const size_t padded = span + stride; // Slack to align the start
+            void *memory = mmap(nullptr, padded, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (memory == MAP_FAILED) {
+                return;
+            }
+
+            auto *start = static_cast<std::byte *>(memory);
+            auto *aligned = reinterpret_cast<std::byte *>(
+                (reinterpret_cast<uintptr_t>(start) + stride - 1) & ~(stride - 1));
+            if (aligned > start) {
+                munmap(start, static_cast<size_t>(aligned - start));
+            }
+            if (const size_t tail = padded - static_cast<size_t>(aligned - start) - span; tail > 0) {
+                munmap(aligned + span, tail);
+            }
+
+            reserved = aligned;
+            reserved_bytes = span;
+            stride_shift = std::countr_zero(stride);
+#endif
+        }
+
+        [[nodiscard]] PageMapping map_slot(const uint32_t index) const noexcept {
+#ifdef __linux__
+            const size_t stride = size_t{1} << stride_shift;
+            return PageMapping::map_at(reserved + index * stride, chunk_bytes, stride, numa_node);
+#else
+            (void) index;
+            return {};
+#endif
+        }
+    };
+}
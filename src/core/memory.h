@@ -1,10 +1,16 @@
 #pragma once
 
 #include "types.h"
+#include "huge_page_arena.h"
+#include "topology.h"
 
 #include <array>
 #include <atomic>
+#include <bit>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <cstddef>
 
@@ -12,6 +18,7 @@
 #include <windows.h>
 #include <processthreadsapi.h>
 #else
+#include <immintrin.h>
 #endif
 
 namespace trading_engine {
@@ -31,6 +38,15 @@ namespace trading_engine {
 #define FORCE_INLINE __attribute__((always_inline)) inline
 #endif
 
+    // CPU hint for spin-wait loops
+    FORCE_INLINE void cpu_relax() noexcept {
+#ifdef _WIN32
+        YieldProcessor();
+#else
+        _mm_pause();
+#endif
+    }
+
     // Memory prefetching
     class PrefetchOptimizer {
     public:
@@ -49,84 +65,390 @@ namespace trading_engine {
         }
     };
 
+    struct MemoryPoolConfig {
+        uint32_t max_chunks{1}; // 1 keeps the pool at a fixed size, as bounded queues need
+        int numa_node{-1}; // -1: the NodeScope node, if any
+    };
+
+    struct MemoryPoolStats {
+        size_t capacity; // Nodes in mapped chunks
+        size_t in_use; // Out of the free list, including nodes parked in thread caches
+        size_t high_water; // Most ever in use at once
+        uint32_t chunks;
+        uint32_t max_chunks;
+        uint64_t growths; // Chunks added because the free list ran dry
+        uint64_t exhausted; // Acquires that failed at the chunk limit
+        size_t mapped_bytes;
+        PageKind page_kind;
+
+        // Adds another pool's figures; high_water becomes a sum of peaks
+        MemoryPoolStats &operator+=(const MemoryPoolStats &other) noexcept {
+            capacity += other.capacity;
+            in_use += other.in_use;
+            high_water += other.high_water;
+            chunks += other.chunks;
+            max_chunks += other.max_chunks;
+            growths += other.growths;
+            exhausted += other.exhausted;
+            mapped_bytes += other.mapped_bytes;
+            page_kind = page_kind == PageKind::None ? other.page_kind : page_kind;
+            return *this;
+        }
+    };
+
     // Lock-free memory pool
-    template<typename T, size_t PoolSize = 1024>
+    //
+    // Nodes live in chunks of prefaulted huge-page memory, each holding
+    // bit_ceil(ChunkSize) nodes packed at sizeof(T) with their free-list
+    // links in a separate array. The pool starts with one chunk and adds
+    // more, up to max_chunks, when reserve() or maintain() ask for it or
+    // when acquire() finds the free list empty; acquires and releases never
+    // allocate otherwise.
+    template<typename T, size_t ChunkSize = 1024>
     class LockFreeMemoryPool {
-        struct alignas(CacheLineSize) Node {
-            T data{};
-            Node *next{};
-        };
-
-        alignas(CacheLineSize) std::atomic<Node *> free_list_head{nullptr};
-        alignas(CacheLineSize) std::array<Node, PoolSize> pool;
+        static constexpr uint32_t ChunkNodes = std::bit_ceil(static_cast<uint32_t>(ChunkSize));
+        static constexpr int ChunkShift = std::countr_zero(ChunkNodes);
+        static constexpr uint32_t NullIndex = 0xFFFFFFFF;
+        static constexpr size_t LinkOffset =
+            (ChunkNodes * sizeof(T) + alignof(std::atomic<uint32_t>) - 1) & ~(alignof(std::atomic<uint32_t>) - 1);
+        static constexpr size_t ChunkBytes = LinkOffset + ChunkNodes * sizeof(std::atomic<uint32_t>);
+
+        static_assert(alignof(T) <= 4096, "Chunks are only page aligned");
+        static_assert(uint64_t{ChunkNodes} * HugePageArena::MaxChunks < NullIndex, "Node indices must fit 32 bits");
+
+        // Free-list head: node index in the low half and a tag bumped on
+        // every change in the high half, so a pop that read a stale head can
+        // never swap it back in (ABA)
+        alignas(CacheLineSize) std::atomic<uint64_t> free_head{pack(NullIndex, 0)};
         alignas(CacheLineSize) std::atomic<size_t> allocated_count{0};
+        std::atomic<size_t> high_water{0};
+        std::atomic<uint64_t> demand_growths{0};
+        std::atomic<uint64_t> exhausted_count{0};
+        HugePageArena arena;
 
     public:
-        LockFreeMemoryPool() {
-            // Initialize free list
-            for (size_t i = 0; i < PoolSize - 1; ++i) {
-                pool[i].next = &pool[i + 1];
+        // Thread-private stash of free nodes that moves to and from the
+        // shared list in batches, one CAS per batch instead of per node.
+        // Owned by one thread; returns its nodes when destroyed.
+        class LocalCache {
+            static constexpr uint32_t Capacity = 64;
+            static constexpr uint32_t Batch = Capacity / 2;
+
+            LockFreeMemoryPool &pool;
+            std::array<uint32_t, Capacity> indices{};
+            uint32_t count{0};
+
+        public:
+            explicit LocalCache(LockFreeMemoryPool &owner) noexcept : pool(owner) {
             }
-            pool[PoolSize - 1].next = nullptr;
-            free_list_head.store(&pool[0], std::memory_order_relaxed);
+
+            ~LocalCache() {
+                flush();
+            }
+
+            LocalCache(const LocalCache &) = delete;
+
+            LocalCache &operator=(const LocalCache &) = delete;
+
+            FORCE_INLINE T *acquire() noexcept {
+                if (UNLIKELY(count == 0)) {
+                    count = pool.take(indices.data(), Batch);
+                    if (count == 0) {
+                        return pool.acquire(); // Grows, or fails at the limit
+                    }
+                }
+                return pool.slot(indices[--count]);
+            }
+
+            FORCE_INLINE void release(T *ptr) noexcept {
+                if (ptr == nullptr) return;
+                if (UNLIKELY(count == Capacity)) {
+                    count -= Batch;
+                    pool.give(indices.data() + count, Batch);
+                }
+                indices[count++] = pool.index_of(ptr);
+            }
+
+            void flush() noexcept {
+                pool.give(indices.data(), count);
+                count = 0;
+            }
+        };
+
+        explicit LockFreeMemoryPool(const MemoryPoolConfig config = {})
+            : arena(ChunkBytes, config.max_chunks, config.numa_node) {
+            (void) grow();
         }
 
+        ~LockFreeMemoryPool() {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (uint32_t chunk = 0; chunk < arena.chunks(); ++chunk) {
+                    for (uint32_t offset = 0; offset < ChunkNodes; ++offset) {
+                        slot((chunk << ChunkShift) | offset)->~T();
+                    }
+                }
+            }
+        }
+
+        LockFreeMemoryPool(const LockFreeMemoryPool &) = delete;
+
+        LockFreeMemoryPool &operator=(const LockFreeMemoryPool &) = delete;
+
         T *acquire() noexcept {
-            Node *head = free_list_head.load(std::memory_order_acquire);
-            while (head != nullptr) {
-                Node *next = head->next;
-                if (free_list_head.compare_exchange_weak(
-                    head, next, std::memory_order_release, std::memory_order_acquire)) {
-                    allocated_count.fetch_add(1, std::memory_order_relaxed);
-                    return &head->data;
+            uint32_t index = pop();
+            if (UNLIKELY(index == NullIndex)) {
+                index = acquire_slow();
+                if (index == NullIndex) {
+                    return nullptr; // At the chunk limit
                 }
             }
-            return nullptr; // Pool exhausted
+            note_acquired(1);
+            return slot(index);
         }
 
         void release(T *ptr) noexcept {
             if (ptr == nullptr) return;
 
-            Node *node = reinterpret_cast<Node *>(
-                reinterpret_cast<char *>(ptr) - offsetof(Node, data));
+            push(index_of(ptr));
+            allocated_count.fetch_sub(1, std::memory_order_relaxed);
+        }
 
-            Node *head = free_list_head.load(std::memory_order_acquire);
-            do {
-                node->next = head;
-            } while (!free_list_head.compare_exchange_weak(
-                head, node, std::memory_order_release, std::memory_order_acquire));
+        // Grows until at least `nodes` fit; false at the chunk limit. Cold:
+        // call at startup or from idle time.
+        bool reserve(const size_t nodes) noexcept {
+            while (capacity() < nodes) {
+                if (!grow()) {
+                    return false;
+                }
+            }
+            return true;
+        }
 
-            allocated_count.fetch_sub(1, std::memory_order_relaxed);
+        // Adds a chunk ahead of need once fewer than a quarter chunk of nodes
+        // are free, so acquire() seldom has to. Cheap when there is nothing to
+        // do; meant for a thread's idle loop.
+        bool maintain() noexcept {
+            if (LIKELY(capacity() - size() >= ChunkNodes / 4) || !arena.can_grow()) {
+                return false;
+            }
+            return grow();
+        }
+
+        [[nodiscard]] bool owns(const T *ptr) const noexcept {
+            return arena.find_chunk(ptr) != HugePageArena::MaxChunks;
         }
 
         [[nodiscard]] size_t size() const noexcept {
             return allocated_count.load(std::memory_order_relaxed);
         }
 
-        [[nodiscard]] static size_t capacity() noexcept {
-            return PoolSize;
+        [[nodiscard]] size_t capacity() const noexcept {
+            return static_cast<size_t>(arena.chunks()) * ChunkNodes;
         }
 
         [[nodiscard]] bool empty() const noexcept {
-            return allocated_count.load(std::memory_order_relaxed) == 0;
+            return size() == 0;
         }
 
         [[nodiscard]] bool full() const noexcept {
-            return allocated_count.load(std::memory_order_relaxed) == PoolSize;
+            return size() >= capacity() && !arena.can_grow();
+        }
+
+        [[nodiscard]] MemoryPoolStats get_statistics() const noexcept {
+            return MemoryPoolStats{
+                .capacity = capacity(),
+                .in_use = size(),
+                .high_water = high_water.load(std::memory_order_relaxed),
+                .chunks = arena.chunks(),
+                .max_chunks = arena.chunk_limit(),
+                .growths = demand_growths.load(std::memory_order_relaxed),
+                .exhausted = exhausted_count.load(std::memory_order_relaxed),
+                .mapped_bytes = arena.mapped_bytes(),
+                .page_kind = arena.page_kind()
+            };
+        }
+
+    private:
+        static constexpr uint64_t pack(const uint32_t index, const uint32_t tag) noexcept {
+            return static_cast<uint64_t>(tag) << 32 | index;
+        }
+
+        static constexpr uint32_t index_part(const uint64_t head) noexcept {
+            return static_cast<uint32_t>(head);
+        }
+
+        static constexpr uint32_t next_tag(const uint64_t head) noexcept {
+            return static_cast<uint32_t>(head >> 32) + 1;
+        }
+
+        FORCE_INLINE T *slot(const uint32_t index) const noexcept {
+            std::byte *base = arena.chunk(index >> ChunkShift);
+            return std::launder(reinterpret_cast<T *>(base + (index & (ChunkNodes - 1)) * sizeof(T)));
+        }
+
+        FORCE_INLINE std::atomic<uint32_t> &link(const uint32_t index) const noexcept {
+            std::byte *base = arena.chunk(index >> ChunkShift);
+            return reinterpret_cast<std::atomic<uint32_t> *>(base + LinkOffset)[index & (ChunkNodes - 1)];
+        }
+
+        FORCE_INLINE uint32_t index_of(const T *ptr) const noexcept {
+            const uint32_t chunk = arena.find_chunk(ptr);
+            const auto offset = static_cast<uint32_t>(
+                (reinterpret_cast<const std::byte *>(ptr) - arena.chunk(chunk)) / sizeof(T));
+            return chunk << ChunkShift | offset;
+        }
+
+        FORCE_INLINE void note_acquired(const size_t nodes) noexcept {
+            const size_t in_use = allocated_count.fetch_add(nodes, std::memory_order_relaxed) + nodes;
+            size_t peak = high_water.load(std::memory_order_relaxed);
+            while (UNLIKELY(in_use > peak) &&
+                   !high_water.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+            }
+        }
+
+        FORCE_INLINE uint32_t pop() noexcept {
+            uint64_t head = free_head.load(std::memory_order_acquire);
+            while (index_part(head) != NullIndex) {
+                const uint32_t next = link(index_part(head)).load(std::memory_order_relaxed);
+                if (free_head.compare_exchange_weak(head, pack(next, next_tag(head)),
+                                                    std::memory_order_acquire, std::memory_order_acquire)) {
+                    return index_part(head);
+                }
+            }
+            return NullIndex;
+        }
+
+        // Links first..last, already chained through their links, onto the list
+        FORCE_INLINE void push_chain(const uint32_t first, const uint32_t last) noexcept {
+            uint64_t head = free_head.load(std::memory_order_relaxed);
+            do {
+                link(last).store(index_part(head), std::memory_order_relaxed);
+            } while (!free_head.compare_exchange_weak(head, pack(first, next_tag(head)),
+                                                      std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        FORCE_INLINE void push(const uint32_t index) noexcept {
+            push_chain(index, index);
+        }
+
+        // Pops up to `max` nodes in one CAS. Nodes on the list only change
+        // after being popped, which moves the head, so a CAS that succeeds
+        // proves the walked chain was intact.
+        uint32_t take(uint32_t *out, const uint32_t max) noexcept {
+            uint64_t head = free_head.load(std::memory_order_acquire);
+            while (true) {
+                uint32_t taken = 0;
+                uint32_t next = index_part(head);
+                while (next != NullIndex && taken < max) {
+                    out[taken++] = next;
+                    next = link(next).load(std::memory_order_relaxed);
+                }
+                if (taken == 0) {
+                    return 0;
+                }
+                if (free_head.compare_exchange_weak(head, pack(next, next_tag(head)),
+                                                    std::memory_order_acquire, std::memory_order_acquire)) {
+                    note_acquired(taken);
+                    return taken;
+                }
+            }
+        }
+
+        void give(const uint32_t *indices, const uint32_t count) noexcept {
+            if (count == 0) {
+                return;
+            }
+            for (uint32_t i = 0; i + 1 < count; ++i) {
+                link(indices[i]).store(indices[i + 1], std::memory_order_relaxed);
+            }
+            push_chain(indices[0], indices[count - 1]);
+            allocated_count.fetch_sub(count, std::memory_order_relaxed);
+        }
+
+        uint32_t acquire_slow() noexcept {
+            while (grow()) {
+                demand_growths.fetch_add(1, std::memory_order_relaxed);
+                if (const uint32_t index = pop(); index != NullIndex) {
+                    return index;
+                }
+            }
+            exhausted_count.fetch_add(1, std::memory_order_relaxed);
+            return NullIndex;
+        }
+
+        // Maps a chunk, constructs its nodes and publishes them as one chain
+        bool grow() noexcept {
+            const uint32_t chunk = arena.add_chunk();
+            if (chunk == HugePageArena::MaxChunks) {
+                return false;
+            }
+
+            std::byte *base = arena.chunk(chunk);
+            const uint32_t first = chunk << ChunkShift;
+            for (uint32_t offset = 0; offset < ChunkNodes; ++offset) {
+                new(base + offset * sizeof(T)) T{};
+                new(base + LinkOffset + offset * sizeof(std::atomic<uint32_t>)) std::atomic<uint32_t>(
+                    first + offset + 1);
+            }
+            push_chain(first, first + ChunkNodes - 1);
+            return true;
         }
     };
 
+    // Frees what make_node_local handed out: its mapping when it got one, heap otherwise
+    template<typename T>
+    struct NodeLocalDeleter {
+        PageMapping mapping{};
+
+        void operator()(T *object) noexcept {
+            if (object == nullptr) {
+                return;
+            }
+            if (!mapping) {
+                delete object;
+                return;
+            }
+            object->~T();
+            mapping.reset();
+        }
+    };
+
+    template<typename T>
+    using NodeLocalPtr = std::unique_ptr<T, NodeLocalDeleter<T> >;
+
+    // Constructs a T in freshly mapped, prefaulted pages on `node`. Pools and
+    // queues the constructor maps land on the same node. A negative node, or
+    // no memory to map, gives a plain heap object.
+    template<typename T, typename... Args>
+    NodeLocalPtr<T> make_node_local(const int node, Args &&... args) {
+        if (node < 0) {
+            return NodeLocalPtr<T>(new T(std::forward<Args>(args)...), NodeLocalDeleter<T>{});
+        }
+
+        NodeScope scope(node);
+        PageMapping mapping = PageMapping::map(sizeof(T), node);
+        if (!mapping) {
+            return NodeLocalPtr<T>(new T(std::forward<Args>(args)...), NodeLocalDeleter<T>{});
+        }
+
+        T *object = new(mapping.data()) T(std::forward<Args>(args)...);
+        return NodeLocalPtr<T>(object, NodeLocalDeleter<T>{std::move(mapping)});
+    }
+
     // NUMA-aware allocator
     class NUMAAllocator {
     private:
+        static constexpr MemoryPoolConfig GrowablePool{.max_chunks = 16, .numa_node = -1};
+
+        // Chunks follow the pool onto its core's node through NodeScope
         struct alignas(CacheLineSize) PerCorePool {
-            LockFreeMemoryPool<Order, 1024> orders;
-            LockFreeMemoryPool<MarketTick, 2048> ticks;
-            LockFreeMemoryPool<Trade, 512> trades;
+            LockFreeMemoryPool<Order, 1024> orders{GrowablePool};
+            LockFreeMemoryPool<MarketTick, 2048> ticks{GrowablePool};
+            LockFreeMemoryPool<Trade, 512> trades{GrowablePool};
         };
 
         inline static thread_local PerCorePool *local_pool = nullptr;
-        std::vector<std::unique_ptr<PerCorePool> > pools;
+        std::vector<NodeLocalPtr<PerCorePool> > pools;
         std::atomic<uint32_t> pool_count{0};
 
     public:
@@ -135,14 +457,28 @@ namespace trading_engine {
             return allocator;
         }
 
+        // Each core's pool lives on that core's node. Safe to call again (every
+        // engine start does); it only adds pools for cores not seen before.
         void initialize(uint32_t num_cores) {
+            if (num_cores <= pools.size()) {
+                return;
+            }
             pools.reserve(num_cores);
-            for (uint32_t i = 0; i < num_cores; ++i) {
-                pools.emplace_back(std::make_unique<PerCorePool>());
+            for (auto core = static_cast<uint32_t>(pools.size()); core < num_cores; ++core) {
+                pools.emplace_back(make_node_local<PerCorePool>(numa_node_of_cpu(core)));
             }
             pool_count.store(num_cores, std::memory_order_release);
         }
 
+        // Uses `cpu`'s pool from now on; threads call this once pinned, since
+        // the lazy sched_getcpu() pick only holds while a thread stays put
+        void bind_current_thread(const uint32_t cpu) noexcept {
+            const uint32_t count = pool_count.load(std::memory_order_acquire);
+            if (count > 0) {
+                local_pool = pools[cpu < count ? cpu : 0].get();
+            }
+        }
+
         template<typename T>
         T *allocate() {
             if (local_pool == nullptr) {
@@ -154,30 +490,41 @@ namespace trading_engine {
                 }
             }
 
-            if constexpr (std::is_same_v<T, Order>) {
-                return local_pool->orders.acquire();
-            } else if constexpr (std::is_same_v<T, MarketTick>) {
-                return local_pool->ticks.acquire();
-            } else if constexpr (std::is_same_v<T, Trade>) {
-                return local_pool->trades.acquire();
-            }
-            return nullptr;
+            return pool_for<T>(*local_pool).acquire();
         }
 
+        // Returns the node to the pool it came from, which is another core's
+        // when the object was handed between threads
         template<typename T>
         void deallocate(T *ptr) {
             if (ptr == nullptr) return;
 
+            if (LIKELY(local_pool != nullptr) && pool_for<T>(*local_pool).owns(ptr)) {
+                pool_for<T>(*local_pool).release(ptr);
+                return;
+            }
+            const uint32_t count = pool_count.load(std::memory_order_acquire);
+            for (uint32_t core = 0; core < count; ++core) {
+                if (auto &pool = pool_for<T>(*pools[core]); pool.owns(ptr)) {
+                    pool.release(ptr);
+                    return;
+                }
+            }
+        }
+
+    private:
+        template<typename T>
+        static auto &pool_for(PerCorePool &pool) noexcept {
             if constexpr (std::is_same_v<T, Order>) {
-                local_pool->orders.release(ptr);
+                return pool.orders;
             } else if constexpr (std::is_same_v<T, MarketTick>) {
-                local_pool->ticks.release(ptr);
-            } else if constexpr (std::is_same_v<T, Trade>) {
-                local_pool->trades.release(ptr);
+                return pool.ticks;
+            } else {
+                static_assert(std::is_same_v<T, Trade>, "NUMAAllocator pools orders, ticks and trades");
+                return pool.trades;
             }
         }
 
-    private:
         static uint32_t get_current_core_id() {
             // Platform-specific core ID detection
 #ifdef _WIN32
@@ -188,6 +535,16 @@ namespace trading_engine {
         }
     };
 
+    // Applies a role's placement to the calling thread and points its
+    // NUMAAllocator pool at the core it now runs on
+    inline bool place_current_thread(const ThreadPlacement &placement, const uint32_t instance = 0) noexcept {
+        const bool applied = apply_thread_placement(placement, instance);
+        if (placement.pinned()) {
+            NUMAAllocator::instance().bind_current_thread(placement.core_for(instance));
+        }
+        return applied;
+    }
+
     // Circular buffer for strategy data
     template<typename T, size_t Size>
     class CircularBuffer {
@@ -2,19 +2,33 @@
 
 #include "types.h"
 #include "memory.h"
+#include "seqlock.h"
 
+#include <algorithm>
 #include <atomic>
 #include <array>
+#include <bit>
+#include <span>
+#include <type_traits>
 
 namespace trading_engine {
     // Single Producer Single Consumer Queue
+    //
+    // Each side keeps a private copy of the other side's index and only
+    // reloads it when that copy says the queue is full (producer) or empty
+    // (consumer), so most operations touch no shared cache line. The bulk
+    // calls move a whole span per index update.
     template<typename T, size_t Size>
     class SPSCQueue {
         static_assert((Size & (Size - 1)) == 0, "Size must be power of 2");
         static constexpr size_t mask = Size - 1;
 
         alignas(CacheLineSize) std::atomic<size_t> head{0};
+        size_t cached_tail{0}; // Consumer's last view of tail
+
         alignas(CacheLineSize) std::atomic<size_t> tail{0};
+        size_t cached_head{0}; // Producer's last view of head
+
         alignas(CacheLineSize) std::array<T, Size> buffer;
 
     public:
@@ -22,8 +36,11 @@ namespace trading_engine {
             const size_t current_tail = tail.load(std::memory_order_relaxed);
             const size_t next_tail = (current_tail + 1) & mask;
 
-            if (next_tail == head.load(std::memory_order_acquire)) {
-                return false; // Queue is full
+            if (UNLIKELY(next_tail == cached_head)) {
+                cached_head = head.load(std::memory_order_acquire);
+                if (next_tail == cached_head) {
+                    return false; // Queue is full
+                }
             }
 
             buffer[current_tail] = item;
@@ -34,8 +51,11 @@ namespace trading_engine {
         bool try_pop(T &item) noexcept {
             const size_t current_head = head.load(std::memory_order_relaxed);
 
-            if (current_head == tail.load(std::memory_order_acquire)) {
-                return false; // Queue is empty
+            if (UNLIKELY(current_head == cached_tail)) {
+                cached_tail = tail.load(std::memory_order_acquire);
+                if (current_head == cached_tail) {
+                    return false; // Queue is empty
+                }
             }
 
             item = buffer[current_head];
@@ -43,8 +63,52 @@ namespace trading_engine {
             return true;
         }
 
+        // Pushes as many leading items as fit; returns how many
+        size_t try_push_bulk(std::span<const T> items) noexcept {
+            const size_t current_tail = tail.load(std::memory_order_relaxed);
+
+            size_t room = (cached_head - current_tail - 1) & mask;
+            if (room < items.size()) {
+                cached_head = head.load(std::memory_order_acquire);
+                room = (cached_head - current_tail - 1) & mask;
+            }
+
+            const size_t count = std::min(room, items.size());
+            const size_t first = std::min(count, Size - current_tail); // Up to the end of the ring
+            std::copy_n(items.begin(), first, buffer.begin() + current_tail);
+            std::copy_n(items.begin() + first, count - first, buffer.begin());
+
+            if (count > 0) {
+                tail.store((current_tail + count) & mask, std::memory_order_release);
+            }
+            return count;
+        }
+
+        // Pops up to items.size() into the front of items; returns how many
+        size_t try_pop_bulk(std::span<T> items) noexcept {
+            const size_t current_head = head.load(std::memory_order_relaxed);
+
+            size_t available = (cached_tail - current_head) & mask;
+            if (available < items.size()) {
+                cached_tail = tail.load(std::memory_order_acquire);
+                available = (cached_tail - current_head) & mask;
+            }
+
+            const size_t count = std::min(available, items.size());
+            const size_t first = std::min(count, Size - current_head);
+            std::copy_n(buffer.begin() + current_head, first, items.begin());
+            std::copy_n(buffer.begin(), count - first, items.begin() + first);
+
+            if (count > 0) {
+                head.store((current_head + count) & mask, std::memory_order_release);
+            }
+            return count;
+        }
+
+        // Consumer side only
         void clear() noexcept {
-            head.store(tail.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            cached_tail = tail.load(std::memory_order_acquire);
+            head.store(cached_tail, std::memory_order_release);
         }
 
         [[nodiscard]] size_t size() const noexcept {
@@ -211,18 +275,86 @@ namespace trading_engine {
             return true;
         }
 
+        // Claims a run of free cells with one CAS and fills them; returns how
+        // many leading items were pushed
+        size_t try_push_bulk(std::span<const T> items) noexcept {
+            size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+            size_t count;
+
+            for (;;) {
+                count = 0;
+                while (count < items.size() &&
+                       buffer[(pos + count) & mask].sequence.load(std::memory_order_acquire) == pos + count) {
+                    ++count;
+                }
+                if (count == 0) {
+                    // Full, or another producer moved on first
+                    const size_t current = enqueue_pos.load(std::memory_order_relaxed);
+                    if (current == pos) {
+                        return 0;
+                    }
+                    pos = current;
+                    continue;
+                }
+                if (enqueue_pos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                Cell &cell = buffer[(pos + i) & mask];
+                cell.data = items[i];
+                cell.sequence.store(pos + i + 1, std::memory_order_release);
+            }
+            return count;
+        }
+
+        // Claims a run of filled cells with one CAS and drains them; returns
+        // how many were popped into the front of items
+        size_t try_pop_bulk(std::span<T> items) noexcept {
+            size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+            size_t count;
+
+            for (;;) {
+                count = 0;
+                while (count < items.size() &&
+                       buffer[(pos + count) & mask].sequence.load(std::memory_order_acquire) == pos + count + 1) {
+                    ++count;
+                }
+                if (count == 0) {
+                    // Empty, or another consumer moved on first
+                    const size_t current = dequeue_pos.load(std::memory_order_relaxed);
+                    if (current == pos) {
+                        return 0;
+                    }
+                    pos = current;
+                    continue;
+                }
+                if (dequeue_pos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                Cell &cell = buffer[(pos + i) & mask];
+                items[i] = cell.data;
+                cell.sequence.store(pos + i + mask + 1, std::memory_order_release);
+            }
+            return count;
+        }
+
+        // A cell holds data once its sequence is past its position
         [[nodiscard]] bool empty() const noexcept {
             const size_t pos = dequeue_pos.load(std::memory_order_acquire);
-            Cell *cell = &buffer[pos & mask];
-            const size_t seq = cell->sequence.load(std::memory_order_acquire);
-            return seq <= pos;
+            const Cell &cell = buffer[pos & mask];
+            return cell.sequence.load(std::memory_order_acquire) <= pos;
         }
 
+        // ...and is free again once its sequence catches up with the position
         [[nodiscard]] bool full() const noexcept {
-            size_t pos = enqueue_pos.load(std::memory_order_acquire);
-            Cell *cell = &buffer[pos & mask];
-            size_t seq = cell->sequence.load(std::memory_order_acquire);
-            return seq <= pos;
+            const size_t pos = enqueue_pos.load(std::memory_order_acquire);
+            const Cell &cell = buffer[pos & mask];
+            return cell.sequence.load(std::memory_order_acquire) < pos;
         }
 
         [[nodiscard]] static constexpr size_t capacity() noexcept {
@@ -308,4 +440,76 @@ namespace trading_engine {
             highest_priority.store(next_priority, std::memory_order_release);
         }
     };
+
+    // Latest-value mailbox keyed by a small dense index
+    //
+    // Each key holds only its newest value: publishing overwrites it and marks
+    // the key dirty, and drain() hands the consumer each dirty key once. Memory is
+    // bounded by KeyCount and producers never block or fail; values the consumer
+    // didn't get to in time are conflated away. Each key must have a single
+    // writer at a time, while different keys may be written from different threads.
+    template<typename T, size_t KeyCount>
+    class ConflatingMailbox {
+        static_assert(std::is_trivially_copyable_v<T>, "Mailbox values are copied under a seqlock");
+        static constexpr size_t WordCount = (KeyCount + 63) / 64;
+
+        struct alignas(CacheLineSize) Slot {
+            SeqLock lock;
+            T value{};
+        };
+
+        std::array<Slot, KeyCount> slots;
+        alignas(CacheLineSize) std::array<std::atomic<std::uint64_t>, WordCount> dirty{};
+
+    public:
+        // Returns true if an unread value for this key was overwritten
+        bool publish(const size_t key, const T &value) noexcept {
+            Slot &slot = slots[key];
+            slot.lock.write_begin();
+            slot.value = value;
+            slot.lock.write_end();
+
+            const std::uint64_t bit = 1ULL << (key % 64);
+            return (dirty[key / 64].fetch_or(bit, std::memory_order_acq_rel) & bit) != 0;
+        }
+
+        // Calls consumer(key, value) for every key published since the last drain
+        template<typename Consumer>
+        size_t drain(Consumer &&consumer) {
+            size_t delivered = 0;
+
+            for (size_t word = 0; word < WordCount; ++word) {
+                if (dirty[word].load(std::memory_order_relaxed) == 0) {
+                    continue;
+                }
+
+                // Clear before reading so a concurrent publish re-marks the key
+                std::uint64_t bits = dirty[word].exchange(0, std::memory_order_acq_rel);
+                while (bits != 0) {
+                    const size_t key = word * 64 + static_cast<size_t>(std::countr_zero(bits));
+                    bits &= bits - 1;
+
+                    const Slot &slot = slots[key];
+                    const T value = slot.lock.read([&slot] { return slot.value; });
+                    consumer(key, value);
+                    ++delivered;
+                }
+            }
+
+            return delivered;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            for (const auto &word: dirty) {
+                if (word.load(std::memory_order_acquire) != 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        [[nodiscard]] static constexpr size_t capacity() noexcept {
+            return KeyCount;
+        }
+    };
 }
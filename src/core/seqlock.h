@@ -0,0 +1,60 @@
+#pragma once
+
+#include "types.h"
+#include "memory.h"
+
+#include <atomic>
+
+namespace trading_engine {
+    // Sequence lock for data with a single writer
+    //
+    // The counter is even while the protected data is stable and odd while the
+    // writer is updating it. Readers never block the writer: they copy the data
+    // and retry if the counter changed underneath them.
+    class SeqLock {
+        std::atomic<std::uint64_t> sequence{0};
+
+    public:
+        void write_begin() noexcept {
+            const std::uint64_t seq = sequence.load(std::memory_order_relaxed);
+            sequence.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        void write_end() noexcept {
+            const std::uint64_t seq = sequence.load(std::memory_order_relaxed);
+            sequence.store(seq + 1, std::memory_order_release);
+        }
+
+        [[nodiscard]] std::uint64_t read_begin() const noexcept {
+            std::uint64_t seq = sequence.load(std::memory_order_acquire);
+            while (UNLIKELY(seq & 1)) {
+                cpu_relax();
+                seq = sequence.load(std::memory_order_acquire);
+            }
+            return seq;
+        }
+
+        [[nodiscard]] bool read_retry(const std::uint64_t seq) const noexcept {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return sequence.load(std::memory_order_relaxed) != seq;
+        }
+
+        // Run reader until it observes a stable copy
+        template<typename Reader>
+        auto read(Reader &&reader) const {
+            while (true) {
+                const std::uint64_t seq = read_begin();
+                auto result = reader();
+                if (!read_retry(seq)) {
+                    return result;
+                }
+            }
+        }
+
+        // Number of completed writes times two while stable
+        [[nodiscard]] std::uint64_t current() const noexcept {
+            return sequence.load(std::memory_order_acquire);
+        }
+    };
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "types.h"
+#include "memory.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+namespace trading_engine {
+    // Fixed-capacity, append-only map from SymbolID to per-symbol state
+    //
+    // Lookups are lock-free: an open-addressed table of (key, pointer) slots
+    // published with release stores. Entries are never removed, so readers need
+    // no reclamation scheme. Registration takes a mutex and should happen at
+    // startup; entries live in chunks of ChunkSize so small per-symbol state
+    // stays contiguous while large objects (books, queues) can use chunks of 1.
+    template<typename T, size_t Capacity = MaxSymbolCount, size_t ChunkSize = 64>
+    class SymbolDirectory {
+        static_assert(Capacity > 0 && ChunkSize > 0, "Directory must hold at least one entry");
+
+        static constexpr size_t TableSize = std::bit_ceil(Capacity * 2); // Load factor <= 0.5
+        static constexpr size_t TableMask = TableSize - 1;
+        static constexpr int TableBits = std::countr_zero(TableSize);
+        static constexpr size_t ChunkCount = (Capacity + ChunkSize - 1) / ChunkSize;
+
+        struct Slot {
+            std::atomic<SymbolID> key{EmptyKey};
+            std::atomic<T *> value{nullptr};
+        };
+
+        std::unique_ptr<Slot[]> table;
+        std::array<std::unique_ptr<T[]>, ChunkCount> chunks;
+        std::unique_ptr<SymbolID[]> symbols; // Registration order, for iteration
+        alignas(CacheLineSize) std::atomic<uint32_t> entry_count{0};
+        std::mutex insert_mutex;
+        int numa_node{-1}; // Guarded by insert_mutex
+
+    public:
+        static constexpr SymbolID EmptyKey = std::numeric_limits<SymbolID>::max();
+
+        SymbolDirectory()
+            : table(std::make_unique<Slot[]>(TableSize)),
+              symbols(std::make_unique<SymbolID[]>(Capacity)) {
+        }
+
+        SymbolDirectory(const SymbolDirectory &) = delete;
+
+        SymbolDirectory &operator=(const SymbolDirectory &) = delete;
+
+        // Chunks created from now on are moved to `node` and prefaulted;
+        // meant for the node of the threads that own the entries
+        void place_on_node(const int node) {
+            std::lock_guard lock(insert_mutex);
+            numa_node = node;
+        }
+
+        [[nodiscard]] T *find(const SymbolID symbol_id) const noexcept {
+            size_t slot = hash(symbol_id);
+
+            while (true) {
+                const SymbolID key = table[slot].key.load(std::memory_order_acquire);
+                if (LIKELY(key == symbol_id)) {
+                    return table[slot].value.load(std::memory_order_relaxed);
+                }
+                if (key == EmptyKey) {
+                    return nullptr;
+                }
+                slot = (slot + 1) & TableMask;
+            }
+        }
+
+        // Returns nullptr once the directory is full
+        T *get_or_create(const SymbolID symbol_id) {
+            return get_or_create(symbol_id, [](T &) {
+            });
+        }
+
+        // init runs on a new entry before it becomes visible to readers
+        template<typename Init>
+        T *get_or_create(const SymbolID symbol_id, Init &&init) {
+            if (T *existing = find(symbol_id)) {
+                return existing;
+            }
+
+            if (UNLIKELY(symbol_id == EmptyKey)) {
+                return nullptr;
+            }
+
+            std::lock_guard lock(insert_mutex);
+
+            // Double-check in case another thread registered it
+            if (T *existing = find(symbol_id)) {
+                return existing;
+            }
+
+            const uint32_t index = entry_count.load(std::memory_order_relaxed);
+            if (UNLIKELY(index >= Capacity)) {
+                return nullptr;
+            }
+
+            auto &chunk = chunks[index / ChunkSize];
+            if (!chunk) {
+                chunk = std::make_unique<T[]>(ChunkSize);
+                if (numa_node >= 0) {
+                    (void) bind_to_node(chunk.get(), sizeof(T) * ChunkSize, numa_node);
+                    prefault(chunk.get(), sizeof(T) * ChunkSize);
+                }
+            }
+
+            T *entry = &chunk[index % ChunkSize];
+            init(*entry);
+            symbols[index] = symbol_id;
+
+            size_t slot = hash(symbol_id);
+            while (table[slot].key.load(std::memory_order_relaxed) != EmptyKey) {
+                slot = (slot + 1) & TableMask;
+            }
+            table[slot].value.store(entry, std::memory_order_relaxed);
+            table[slot].key.store(symbol_id, std::memory_order_release);
+
+            entry_count.store(index + 1, std::memory_order_release);
+            return entry;
+        }
+
+        // Visits entries in registration order; safe alongside registration
+        template<typename Visitor>
+        void for_each(Visitor &&visitor) const {
+            const uint32_t count = entry_count.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < count; ++i) {
+                visitor(symbols[i], chunks[i / ChunkSize][i % ChunkSize]);
+            }
+        }
+
+        [[nodiscard]] size_t size() const noexcept {
+            return entry_count.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        [[nodiscard]] static constexpr size_t capacity() noexcept {
+            return Capacity;
+        }
+
+    private:
+        static size_t hash(const SymbolID symbol_id) noexcept {
+            // Fibonacci hashing spreads dense symbol ranges across the table
+            return static_cast<size_t>((static_cast<std::uint64_t>(symbol_id) * 0x9E3779B97F4A7C15ULL)
+                                       >> (64 - TableBits));
+        }
+    };
+}
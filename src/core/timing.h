@@ -2,10 +2,18 @@
 
 #include "types.h"
 #include "memory.h"
+#include "wait_strategy.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <bit>
 #include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 #ifdef _WIN32
 #include <intrin.h>
 #else
@@ -108,20 +116,168 @@ namespace trading_engine {
         }
     };
 
+    // Log-linear latency histogram, HDR style: values below 128 ticks get one
+    // bucket each, and every power of two above that is split into 64 linear
+    // sub-buckets, so a bucket is within 1/64 (~1.6%) of any value it holds.
+    // Values past 2^40 ticks (several minutes) land in the top bucket.
+    class LatencyHistogram {
+    public:
+        static constexpr std::uint32_t SubBucketBits = 6;
+        static constexpr std::uint32_t SubBucketCount = 1U << SubBucketBits;
+        static constexpr std::uint32_t MaxValueBits = 40;
+        static constexpr size_t BucketCount = (MaxValueBits - SubBucketBits + 1) * SubBucketCount;
+
+        std::array<std::uint64_t, BucketCount> counts{};
+        std::uint64_t total_samples{0};
+        std::uint64_t total_latency{0};
+        std::uint64_t min_latency{UINT64_MAX};
+        std::uint64_t max_latency{0};
+
+        static constexpr size_t bucket_index(std::uint64_t value) noexcept {
+            value = std::min<std::uint64_t>(value, (1ULL << MaxValueBits) - 1);
+            const std::uint32_t msb = static_cast<std::uint32_t>(std::bit_width(value | 1)) - 1;
+            const std::uint32_t shift = msb > SubBucketBits ? msb - SubBucketBits : 0;
+            return (static_cast<size_t>(shift) << SubBucketBits) + (value >> shift);
+        }
+
+        // Highest value that maps to the bucket
+        static constexpr std::uint64_t bucket_upper_bound(const size_t index) noexcept {
+            if (index < 2 * SubBucketCount) {
+                return index;
+            }
+            const std::uint32_t shift = static_cast<std::uint32_t>(index >> SubBucketBits) - 1;
+            const std::uint64_t mantissa = index - (static_cast<size_t>(shift) << SubBucketBits);
+            return (mantissa << shift) + ((1ULL << shift) - 1);
+        }
+
+        // Single-writer recording, for histograms owned by one thread
+        void record(const std::uint64_t value) noexcept {
+            ++counts[bucket_index(value)];
+            ++total_samples;
+            total_latency += value;
+            min_latency = std::min(min_latency, value);
+            max_latency = std::max(max_latency, value);
+        }
+
+        // Smallest recorded bucket value covering the given fraction of samples
+        [[nodiscard]] std::uint64_t value_at_percentile(const double percentile) const noexcept {
+            if (total_samples == 0) {
+                return 0;
+            }
+
+            const auto target = std::max<std::uint64_t>(
+                static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(total_samples))), 1);
+            std::uint64_t seen = 0;
+            for (size_t i = 0; i < BucketCount; ++i) {
+                seen += counts[i];
+                if (seen >= target) {
+                    return std::min(bucket_upper_bound(i), max_latency);
+                }
+            }
+            return max_latency;
+        }
+
+        void merge(const LatencyHistogram &other) noexcept {
+            for (size_t i = 0; i < BucketCount; ++i) {
+                counts[i] += other.counts[i];
+            }
+            total_samples += other.total_samples;
+            total_latency += other.total_latency;
+            min_latency = std::min(min_latency, other.min_latency);
+            max_latency = std::max(max_latency, other.max_latency);
+        }
+
+        // Samples recorded since an earlier snapshot of the same profile. Min and
+        // max are rebuilt from the populated buckets, so they are bucket-accurate.
+        [[nodiscard]] LatencyHistogram since(const LatencyHistogram &earlier) const noexcept {
+            LatencyHistogram interval;
+            if (earlier.total_samples > total_samples) {
+                return *this; // Profile was reset in between
+            }
+
+            for (size_t i = 0; i < BucketCount; ++i) {
+                interval.counts[i] = counts[i] - std::min(counts[i], earlier.counts[i]);
+                if (interval.counts[i] != 0) {
+                    interval.min_latency = std::min(interval.min_latency, bucket_upper_bound(i));
+                    interval.max_latency = bucket_upper_bound(i);
+                }
+            }
+            interval.total_samples = total_samples - earlier.total_samples;
+            interval.total_latency = total_latency - earlier.total_latency;
+            interval.max_latency = std::min(interval.max_latency, max_latency);
+            return interval;
+        }
+    };
+
     // Latency measurement utilities
+    //
+    // Each thread records into its own histogram per profile with plain
+    // (single-writer) stores; readers merge every thread's histogram. reset()
+    // bumps the profile's epoch and each recorder clears its own histogram the
+    // next time it records, so samples racing a reset may land on either side.
     class LatencyProfiler {
-        struct LatencyStats {
-            std::atomic<std::uint64_t> total_samples;
-            std::atomic<std::uint64_t> total_latency;
-            std::atomic<std::uint64_t> min_latency;
-            std::atomic<std::uint64_t> max_latency;
+        static constexpr size_t Max_profiles = 32;
 
-            LatencyStats() : total_samples(0), total_latency(0), min_latency(UINT64_MAX), max_latency(0) {
+        // One thread's samples for one profile
+        struct alignas(CacheLineSize) ThreadHistogram {
+            std::atomic<std::uint32_t> epoch{0};
+            std::atomic<std::uint64_t> total_samples{0};
+            std::atomic<std::uint64_t> total_latency{0};
+            std::atomic<std::uint64_t> min_latency{UINT64_MAX};
+            std::atomic<std::uint64_t> max_latency{0};
+            std::array<std::atomic<std::uint64_t>, LatencyHistogram::BucketCount> counts{};
+
+            // Owner thread only
+            FORCE_INLINE void record(const std::uint64_t latency_tsc, const std::uint32_t current_epoch) noexcept {
+                if (UNLIKELY(epoch.load(std::memory_order_relaxed) != current_epoch)) {
+                    clear(current_epoch);
+                }
+
+                bump(counts[LatencyHistogram::bucket_index(latency_tsc)]);
+                bump(total_samples);
+                total_latency.store(total_latency.load(std::memory_order_relaxed) + latency_tsc,
+                                    std::memory_order_relaxed);
+                if (latency_tsc < min_latency.load(std::memory_order_relaxed)) {
+                    min_latency.store(latency_tsc, std::memory_order_relaxed);
+                }
+                if (latency_tsc > max_latency.load(std::memory_order_relaxed)) {
+                    max_latency.store(latency_tsc, std::memory_order_relaxed);
+                }
+            }
+
+            void add_to(LatencyHistogram &merged) const noexcept {
+                for (size_t i = 0; i < LatencyHistogram::BucketCount; ++i) {
+                    merged.counts[i] += counts[i].load(std::memory_order_relaxed);
+                }
+                merged.total_samples += total_samples.load(std::memory_order_relaxed);
+                merged.total_latency += total_latency.load(std::memory_order_relaxed);
+                merged.min_latency = std::min(merged.min_latency, min_latency.load(std::memory_order_relaxed));
+                merged.max_latency = std::max(merged.max_latency, max_latency.load(std::memory_order_relaxed));
+            }
+
+        private:
+            static FORCE_INLINE void bump(std::atomic<std::uint64_t> &counter) noexcept {
+                counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+
+            void clear(const std::uint32_t current_epoch) noexcept {
+                for (auto &count: counts) {
+                    count.store(0, std::memory_order_relaxed);
+                }
+                total_samples.store(0, std::memory_order_relaxed);
+                total_latency.store(0, std::memory_order_relaxed);
+                min_latency.store(UINT64_MAX, std::memory_order_relaxed);
+                max_latency.store(0, std::memory_order_relaxed);
+                epoch.store(current_epoch, std::memory_order_release);
             }
         };
 
-        static constexpr size_t Max_profiles = 32;
-        inline static std::array<LatencyStats, Max_profiles> profiles;
+        // Histograms outlive their threads so exited threads still count
+        inline static std::mutex registry_mutex;
+        inline static std::vector<std::unique_ptr<ThreadHistogram> > registry[Max_profiles];
+        inline static thread_local std::array<ThreadHistogram *, Max_profiles> local_histograms{};
+
+        inline static std::array<std::atomic<std::uint32_t>, Max_profiles> reset_epochs{};
         inline static std::atomic<size_t> profile_count{0};
 
     public:
@@ -131,7 +287,10 @@ namespace trading_engine {
             Order_matching = 2,
             Risk_check = 3,
             Strategy_signal = 4,
-            Trade_reporting = 5
+            Trade_reporting = 5,
+            Order_entry_ack = 6, // Order entry request read to its ack's writev
+            Order_entry_response = 7, // ...to the writev of the engine's first answer
+            Journal_commit = 8 // One group commit: write plus sync
         };
 
         static void record(ProfileID id, std::uint64_t latency_tsc) {
@@ -139,28 +298,11 @@ namespace trading_engine {
                 return;
             }
 
-            LatencyStats &stats = profiles[id];
-
-            stats.total_samples.fetch_add(1, std::memory_order_relaxed);
-            stats.total_latency.fetch_add(latency_tsc, std::memory_order_relaxed);
-
-            // Update min
-            std::uint64_t current_min = stats.min_latency.load(std::memory_order_relaxed);
-            while (latency_tsc < current_min) {
-                if (stats.min_latency.compare_exchange_weak(
-                    current_min, latency_tsc, std::memory_order_relaxed)) {
-                    break;
-                }
-            }
-
-            // Update max
-            std::uint64_t current_max = stats.max_latency.load(std::memory_order_relaxed);
-            while (latency_tsc > current_max) {
-                if (stats.max_latency.compare_exchange_weak(
-                    current_max, latency_tsc, std::memory_order_relaxed)) {
-                    break;
-                }
+            ThreadHistogram *histogram = local_histograms[id];
+            if (UNLIKELY(histogram == nullptr)) {
+                histogram = register_thread(id);
             }
+            histogram->record(latency_tsc, reset_epochs[id].load(std::memory_order_relaxed));
         }
 
         struct ProfileResults {
@@ -168,24 +310,67 @@ namespace trading_engine {
             double avg_latency_us;
             double min_latency_us;
             double max_latency_us;
+            double p50_latency_us;
+            double p90_latency_us;
+            double p99_latency_us;
+            double p999_latency_us;
+            double p9999_latency_us;
         };
 
+        // All threads' samples since the last reset
+        static LatencyHistogram snapshot(ProfileID id) {
+            LatencyHistogram merged;
+            if (id >= profile_count.load(std::memory_order_relaxed)) {
+                return merged;
+            }
+
+            const std::uint32_t current_epoch = reset_epochs[id].load(std::memory_order_acquire);
+            std::lock_guard lock(registry_mutex);
+            for (const auto &histogram: registry[id]) {
+                // Not yet cleared since the last reset: its samples are stale
+                if (histogram->epoch.load(std::memory_order_acquire) == current_epoch) {
+                    histogram->add_to(merged);
+                }
+            }
+            return merged;
+        }
+
         static ProfileResults get_stats(ProfileID id) {
             if (id >= profile_count.load(std::memory_order_relaxed)) {
                 return {};
             }
+            return summarize(snapshot(id));
+        }
+
+        // Stats for the samples recorded since `previous`, which is then advanced
+        // to now. Start from a default LatencyHistogram to cover everything so far.
+        static ProfileResults get_interval_stats(ProfileID id, LatencyHistogram &previous) {
+            if (id >= profile_count.load(std::memory_order_relaxed)) {
+                return {};
+            }
 
-            const LatencyStats &stats = profiles[id];
-            const std::uint64_t samples = stats.total_samples.load(std::memory_order_relaxed);
-            const std::uint64_t total = stats.total_latency.load(std::memory_order_relaxed);
-            const std::uint64_t min_lat = stats.min_latency.load(std::memory_order_relaxed);
-            const std::uint64_t max_lat = stats.max_latency.load(std::memory_order_relaxed);
+            LatencyHistogram current = snapshot(id);
+            const ProfileResults results = summarize(current.since(previous));
+            previous = std::move(current);
+            return results;
+        }
+
+        static ProfileResults summarize(const LatencyHistogram &histogram) {
+            const std::uint64_t samples = histogram.total_samples;
+            const auto to_us = [](const std::uint64_t tsc) {
+                return TimestampManager::tsc_to_microseconds(tsc);
+            };
 
             return ProfileResults{
                 .sample_count = samples,
-                .avg_latency_us = samples > 0 ? TimestampManager::tsc_to_microseconds(total / samples) : 0.0,
-                .min_latency_us = min_lat != UINT64_MAX ? TimestampManager::tsc_to_microseconds(min_lat) : 0.0,
-                .max_latency_us = TimestampManager::tsc_to_microseconds(max_lat)
+                .avg_latency_us = samples > 0 ? to_us(histogram.total_latency / samples) : 0.0,
+                .min_latency_us = histogram.min_latency != UINT64_MAX ? to_us(histogram.min_latency) : 0.0,
+                .max_latency_us = to_us(histogram.max_latency),
+                .p50_latency_us = to_us(histogram.value_at_percentile(50.0)),
+                .p90_latency_us = to_us(histogram.value_at_percentile(90.0)),
+                .p99_latency_us = to_us(histogram.value_at_percentile(99.0)),
+                .p999_latency_us = to_us(histogram.value_at_percentile(99.9)),
+                .p9999_latency_us = to_us(histogram.value_at_percentile(99.99))
             };
         }
 
@@ -194,15 +379,22 @@ namespace trading_engine {
                 return;
             }
 
-            LatencyStats &stats = profiles[id];
-            stats.total_samples.store(0, std::memory_order_relaxed);
-            stats.total_latency.store(0, std::memory_order_relaxed);
-            stats.min_latency.store(UINT64_MAX, std::memory_order_relaxed);
-            stats.max_latency.store(0, std::memory_order_relaxed);
+            reset_epochs[id].fetch_add(1, std::memory_order_acq_rel);
         }
 
         static void initialize() {
-            profile_count.store(6, std::memory_order_release); // Number of predefined profiles
+            profile_count.store(9, std::memory_order_release); // Number of predefined profiles
+        }
+
+    private:
+        static ThreadHistogram *register_thread(const ProfileID id) {
+            auto histogram = std::make_unique<ThreadHistogram>();
+            histogram->epoch.store(reset_epochs[id].load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+            std::lock_guard lock(registry_mutex);
+            local_histograms[id] = histogram.get();
+            registry[id].push_back(std::move(histogram));
+            return local_histograms[id];
         }
     };
 
@@ -238,26 +430,21 @@ namespace trading_engine {
         std::thread timer_thread;
 
     public:
+        // Calls callback every interval. The wait between calls follows
+        // wait.policy: the spinning policies poll the TSC, the parking ones
+        // sleep until park_timeout before the deadline and spin the rest.
         template<typename Func>
-        void start(std::chrono::nanoseconds interval, Func &&callback) {
+        void start(std::chrono::nanoseconds interval, Func &&callback,
+                   const WaitConfig wait = {.policy = WaitPolicy::SpinPause}) {
             running.store(true, std::memory_order_release);
 
-            timer_thread = std::thread([this, interval, callback = std::forward<Func>(callback)]() {
+            timer_thread = std::thread([this, interval, wait, callback = std::forward<Func>(callback)]() {
                 std::uint64_t next_wakeup = TimestampManager::get_hardware_timestamp();
                 const std::uint64_t interval_tsc = interval.count() * TimestampManager::get_frequency() / 1000000000ULL;
 
                 while (running.load(std::memory_order_acquire)) {
                     next_wakeup += interval_tsc;
-
-                    // Busy wait for precise timing
-                    while (TimestampManager::get_hardware_timestamp() < next_wakeup) {
-#ifdef _WIN32
-                        YieldProcessor(); // Windows equivalent of _mm_pause
-#else
-                        _mm_pause(); // CPU hint for spin loops
-#endif
-                    }
-
+                    wait_until(next_wakeup, wait);
                     callback();
                 }
             });
@@ -273,5 +460,32 @@ namespace trading_engine {
         ~HighFrequencyTimer() {
             stop();
         }
+
+    private:
+        static void wait_until(const std::uint64_t deadline_tsc, const WaitConfig &wait) {
+            if (parks(wait.policy)) {
+                const std::uint64_t now = TimestampManager::get_hardware_timestamp();
+                if (deadline_tsc > now) {
+                    const auto remaining = TimestampManager::tsc_to_nanoseconds(deadline_tsc - now);
+                    if (remaining > wait.park_timeout) {
+                        std::this_thread::sleep_for(remaining - wait.park_timeout);
+                    }
+                }
+            }
+
+            // Busy wait for precise timing
+            while (TimestampManager::get_hardware_timestamp() < deadline_tsc) {
+                switch (wait.policy) {
+                    case WaitPolicy::BusySpin:
+                        break;
+                    case WaitPolicy::SpinThenYield:
+                        std::this_thread::yield();
+                        break;
+                    default:
+                        cpu_relax();
+                        break;
+                }
+            }
+        }
     };
 }
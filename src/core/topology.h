@@ -0,0 +1,138 @@
+#pragma once
+
+#include "types.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace trading_engine {
+    // Pin the calling thread to one logical CPU; false if the OS refuses
+    inline bool pin_current_thread(const std::uint32_t cpu) noexcept {
+#ifdef _WIN32
+        if (cpu >= 64) {
+            return false;
+        }
+        return SetThreadAffinityMask(GetCurrentThread(), 1ULL << cpu) != 0;
+#elif defined(__linux__)
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu, &cpu_set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+        (void) cpu;
+        return false;
+#endif
+    }
+
+    enum class SchedulingPolicy : uint8_t {
+        Default, // Leave the OS time-sharing policy alone
+        Fifo, // Real-time: runs until it blocks or something of higher priority wakes
+        RoundRobin // Real-time, time-sliced between threads of equal priority
+    };
+
+    // Real-time policies need CAP_SYS_NICE (or an rtprio rlimit) on Linux;
+    // on Windows both map to time-critical priority. False if refused.
+    inline bool set_current_thread_policy(const SchedulingPolicy policy, const int priority) noexcept {
+        if (policy == SchedulingPolicy::Default) {
+            return true;
+        }
+#ifdef _WIN32
+        (void) priority;
+        return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#elif defined(__linux__)
+        const int native = policy == SchedulingPolicy::Fifo ? SCHED_FIFO : SCHED_RR;
+        sched_param param{};
+        param.sched_priority = std::clamp(priority, sched_get_priority_min(native), sched_get_priority_max(native));
+        return pthread_setschedparam(pthread_self(), native, &param) == 0;
+#else
+        (void) priority;
+        return false;
+#endif
+    }
+
+    // NUMA node of a logical CPU, or -1 when the platform does not say
+    inline int numa_node_of_cpu(const std::uint32_t cpu) noexcept {
+#ifdef _WIN32
+        if (cpu >= 64) {
+            return -1;
+        }
+        UCHAR node = 0;
+        return GetNumaProcessorNode(static_cast<UCHAR>(cpu), &node) && node != 0xFF ? node : -1;
+#elif defined(__linux__)
+        // Each node links its CPUs under /sys/devices/system/node/nodeN/;
+        // nodes are numbered densely, so the first missing one ends the search
+        char path[96];
+        for (int node = 0; node < 1024; ++node) {
+            std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d", node);
+            if (access(path, F_OK) != 0) {
+                return -1;
+            }
+            std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpu%u", node, cpu);
+            if (access(path, F_OK) == 0) {
+                return node;
+            }
+        }
+        return -1;
+#else
+        (void) cpu;
+        return -1;
+#endif
+    }
+
+    // Where one thread role runs. Instance i of a role (shard i, worker i) is
+    // pinned to cores[i % cores.size()]; no cores leaves the role unpinned.
+    struct ThreadPlacement {
+        std::vector<std::uint32_t> cores{};
+        SchedulingPolicy policy{SchedulingPolicy::Default};
+        int priority{0}; // Real-time priority for Fifo and RoundRobin
+
+        [[nodiscard]] bool pinned() const noexcept {
+            return !cores.empty();
+        }
+
+        [[nodiscard]] bool configured() const noexcept {
+            return pinned() || policy != SchedulingPolicy::Default;
+        }
+
+        [[nodiscard]] std::uint32_t core_for(const std::uint32_t instance) const noexcept {
+            return cores[instance % cores.size()];
+        }
+
+        // Node the role's memory belongs on: that of its first core, -1 if unpinned
+        [[nodiscard]] int numa_node() const noexcept {
+            return pinned() ? numa_node_of_cpu(cores.front()) : -1;
+        }
+    };
+
+    // Placement for every engine thread role. Roles left empty keep whatever
+    // the gateway and scheduler configs say, and float otherwise.
+    struct ThreadTopology {
+        ThreadPlacement receiver{}; // Feed receiver
+        ThreadPlacement gateway_shards{}; // Book-building shards; owns books and tick queues
+        ThreadPlacement risk{}; // Staged pipeline only
+        ThreadPlacement matching{}; // Also runs risk checks in the inline pipeline
+        ThreadPlacement strategies{}; // Scheduler workers
+        ThreadPlacement trade_notifications{}; // Staged pipeline only
+        ThreadPlacement journal{}; // Journal writer, when a journal is configured
+    };
+
+    // Pin and set the policy for instance `instance` of a role; true when
+    // everything asked for was applied, including when nothing was asked for
+    inline bool apply_thread_placement(const ThreadPlacement &placement, const std::uint32_t instance = 0) noexcept {
+        bool applied = true;
+        if (placement.pinned()) {
+            applied = pin_current_thread(placement.core_for(instance));
+        }
+        return set_current_thread_policy(placement.policy, placement.priority) && applied;
+    }
+}
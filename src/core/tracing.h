@@ -0,0 +1,243 @@
+#pragma once
+
+#include "types.h"
+#include "memory.h"
+#include "queue.h"
+#include "timing.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace trading_engine {
+    // Sampled tick-to-trade tracing
+    //
+    // A sampled tick gets a nonzero trace ID, which is copied onto MarketTick
+    // and then onto any Order it triggers. Each pipeline stage stamps the TSC
+    // into the trace's slot in a fixed ring, so ticks and orders carry only the
+    // ID. The last stage copies the stamps out to a completion queue which
+    // report() drains off the hot path into per-stage histograms. Unsampled
+    // work pays one thread-local countdown per tick and a zero test per stamp.
+    //
+    // Slots are reused once the ring wraps, which silently ends traces that
+    // have not completed by then; a late stamp racing the reuse may land in the
+    // newer trace. Completions that find the queue full count as dropped.
+    class TickTracer {
+    public:
+        enum class Stage : std::uint8_t {
+            FeedReceived = 0, // Gateway decoded the message
+            BookUpdated = 1, // Shard applied it to the book, about to fan out
+            StrategySignal = 2, // Strategy picked up the tick
+            OrderSubmitted = 3, // Strategy submitted an order from it
+            RiskChecked = 4, // Risk verdict reached
+            Matched = 5, // Matching done and fills reported
+            Count
+        };
+
+        static constexpr size_t StageCount = static_cast<size_t>(Stage::Count);
+        static constexpr size_t RingSize = 4096;
+
+        // Raw stamps of one trace; 0 for stages it never reached
+        struct TraceRecord {
+            std::uint32_t trace_id;
+            Timestamp exchange_timestamp; // Exchange clock, from the feed
+            std::array<Timestamp, StageCount> stamps;
+        };
+
+        struct TraceReport {
+            std::uint64_t traces_started;
+            std::uint64_t traces_completed;
+            std::uint64_t traces_dropped;
+            // stage_latency[s]: time from the previous stamped stage up to s
+            std::array<LatencyProfiler::ProfileResults, StageCount> stage_latency;
+            LatencyProfiler::ProfileResults tick_to_trade; // FeedReceived to the last stamp
+            TraceRecord latest; // Most recently reported trace
+        };
+
+    private:
+        // Only used as a static, so atomics start zeroed without initializers
+        struct alignas(CacheLineSize) TraceSlot {
+            std::atomic<std::uint32_t> trace_id;
+            std::atomic<Timestamp> exchange_timestamp;
+            std::array<std::atomic<Timestamp>, StageCount> stamps;
+        };
+
+        inline static std::atomic<std::uint32_t> sample_rate{0}; // 1 in N ticks, 0 = off
+        inline static std::atomic<std::uint32_t> next_trace_id{1};
+        inline static thread_local std::uint32_t sample_countdown{0};
+
+        inline static std::array<TraceSlot, RingSize> slots;
+        inline static MPSCQueue<TraceRecord, 1024> completed;
+
+        // Reader side, under report_mutex
+        inline static std::mutex report_mutex;
+        inline static std::array<LatencyHistogram, StageCount> stage_histograms{};
+        inline static LatencyHistogram total_histogram{};
+        inline static std::uint64_t traces_completed{0};
+        inline static std::uint64_t started_before_reset{0};
+        inline static TraceRecord latest_trace;
+        inline static std::atomic<std::uint64_t> traces_dropped{0};
+
+    public:
+        static void set_sample_rate(const std::uint32_t one_in_n) noexcept {
+            sample_rate.store(one_in_n, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] static std::uint32_t get_sample_rate() noexcept {
+            return sample_rate.load(std::memory_order_relaxed);
+        }
+
+        // Returns a trace ID for a sampled tick and stamps FeedReceived, or 0
+        static FORCE_INLINE std::uint32_t begin(const Timestamp exchange_timestamp, const Timestamp received) noexcept {
+            const std::uint32_t rate = sample_rate.load(std::memory_order_relaxed);
+            if (LIKELY(rate == 0 || sample_countdown-- != 0)) {
+                return 0;
+            }
+            sample_countdown = rate - 1;
+            return start_trace(exchange_timestamp, received);
+        }
+
+        static FORCE_INLINE void stamp(const std::uint32_t trace_id, const Stage stage) noexcept {
+            if (LIKELY(trace_id == 0)) {
+                return;
+            }
+            record_stamp(trace_id, stage, TimestampManager::get_hardware_timestamp());
+        }
+
+        // Stamps the final stage and queues the trace for reporting
+        static FORCE_INLINE void complete(const std::uint32_t trace_id, const Stage stage) noexcept {
+            if (LIKELY(trace_id == 0)) {
+                return;
+            }
+            record_stamp(trace_id, stage, TimestampManager::get_hardware_timestamp());
+            finish_trace(trace_id);
+        }
+
+        // Folds completed traces into the stage histograms and summarizes them
+        static TraceReport report() {
+            std::lock_guard lock(report_mutex);
+            drain();
+
+            TraceReport result{
+                .traces_started = next_trace_id.load(std::memory_order_relaxed) - 1 - started_before_reset,
+                .traces_completed = traces_completed,
+                .traces_dropped = traces_dropped.load(std::memory_order_relaxed),
+                .stage_latency = {},
+                .tick_to_trade = LatencyProfiler::summarize(total_histogram),
+                .latest = latest_trace
+            };
+            for (size_t stage = 0; stage < StageCount; ++stage) {
+                result.stage_latency[stage] = LatencyProfiler::summarize(stage_histograms[stage]);
+            }
+            return result;
+        }
+
+        static void reset() {
+            std::lock_guard lock(report_mutex);
+            drain();
+            stage_histograms = {};
+            total_histogram = {};
+            traces_completed = 0;
+            started_before_reset = next_trace_id.load(std::memory_order_relaxed) - 1;
+            latest_trace = {};
+            traces_dropped.store(0, std::memory_order_relaxed);
+        }
+
+        static const char *stage_name(const Stage stage) noexcept {
+            switch (stage) {
+                case Stage::FeedReceived: return "Feed Received";
+                case Stage::BookUpdated: return "Book Updated";
+                case Stage::StrategySignal: return "Strategy Signal";
+                case Stage::OrderSubmitted: return "Order Submitted";
+                case Stage::RiskChecked: return "Risk Checked";
+                case Stage::Matched: return "Matched";
+                default: return "Unknown";
+            }
+        }
+
+    private:
+        static std::uint32_t start_trace(const Timestamp exchange_timestamp, const Timestamp received) noexcept {
+            std::uint32_t trace_id = next_trace_id.fetch_add(1, std::memory_order_relaxed);
+            if (UNLIKELY(trace_id == 0)) {
+                trace_id = next_trace_id.fetch_add(1, std::memory_order_relaxed); // Wrapped; 0 means untraced
+            }
+
+            // Most sampled ticks never lead to an order, so silently replacing
+            // an unfinished trace is the normal case
+            TraceSlot &slot = slots[trace_id % RingSize];
+            slot.trace_id.store(0, std::memory_order_relaxed);
+            for (auto &stage_stamp: slot.stamps) {
+                stage_stamp.store(0, std::memory_order_relaxed);
+            }
+            slot.exchange_timestamp.store(exchange_timestamp, std::memory_order_relaxed);
+            slot.stamps[static_cast<size_t>(Stage::FeedReceived)].store(received, std::memory_order_relaxed);
+            slot.trace_id.store(trace_id, std::memory_order_release);
+            return trace_id;
+        }
+
+        // First stamp per stage wins; a tick fanned out to several strategies
+        // or orders keeps the earliest
+        static void record_stamp(const std::uint32_t trace_id, const Stage stage, const Timestamp now) noexcept {
+            TraceSlot &slot = slots[trace_id % RingSize];
+            if (slot.trace_id.load(std::memory_order_acquire) != trace_id) {
+                return; // Slot already reused
+            }
+
+            auto &stage_stamp = slot.stamps[static_cast<size_t>(stage)];
+            if (stage_stamp.load(std::memory_order_relaxed) == 0) {
+                stage_stamp.store(now, std::memory_order_relaxed);
+            }
+        }
+
+        // Claims the slot so only the first completion of a fanned-out tick reports
+        static void finish_trace(const std::uint32_t trace_id) noexcept {
+            TraceSlot &slot = slots[trace_id % RingSize];
+
+            TraceRecord trace{
+                .trace_id = trace_id,
+                .exchange_timestamp = slot.exchange_timestamp.load(std::memory_order_relaxed),
+                .stamps = {}
+            };
+            for (size_t stage = 0; stage < StageCount; ++stage) {
+                trace.stamps[stage] = slot.stamps[stage].load(std::memory_order_relaxed);
+            }
+
+            std::uint32_t expected = trace_id;
+            if (!slot.trace_id.compare_exchange_strong(expected, 0, std::memory_order_acq_rel)) {
+                return; // Already reported, or the slot was reused
+            }
+
+            if (!completed.try_push(trace)) {
+                traces_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        static void drain() {
+            TraceRecord trace;
+            while (completed.try_pop(trace)) {
+                fold(trace);
+            }
+        }
+
+        static void fold(const TraceRecord &trace) noexcept {
+            const auto &stamps = trace.stamps;
+            const Timestamp first = stamps[static_cast<size_t>(Stage::FeedReceived)];
+            if (first == 0) {
+                return;
+            }
+
+            Timestamp previous = first;
+            for (size_t stage = 1; stage < StageCount; ++stage) {
+                if (stamps[stage] == 0 || stamps[stage] < previous) {
+                    continue; // Stage skipped, e.g. rejected before matching
+                }
+                stage_histograms[stage].record(stamps[stage] - previous);
+                previous = stamps[stage];
+            }
+
+            total_histogram.record(previous - first);
+            ++traces_completed;
+            latest_trace = trace;
+        }
+    };
+}
@@ -40,12 +40,22 @@ namespace trading_engine {
         Rejected = 4
     };
 
+    // What an Order on the order path asks for. Cancels only need orderID;
+    // amends carry orderID, symbolID, side and the new price and open quantity.
+    enum class OrderAction : uint8_t {
+        New = 0,
+        Cancel = 1,
+        Modify = 2
+    };
+
     enum class MessageType : uint8_t {
         MarketDataIncremental = 1,
         MarketDataSnapshot = 2,
         NewOrder = 3,
         CancelOrder = 4,
-        TradeReport = 5
+        TradeReport = 5,
+        AmendOrder = 6,
+        ExecutionReport = 7
     };
 
     enum class SignalType : uint8_t {
@@ -55,43 +65,64 @@ namespace trading_engine {
     };
 
     // Core data structures
+    using LinkID = std::uint32_t; // Groups the legs of one linked submission
+
+    // 64 bytes, one cache line: the three small enums share a byte so the
+    // header packs into the 16 bytes ahead of the prices
     struct alignas(64) Order {
         OrderID orderID{};
         SymbolID symbolID{};
-        Side side{};
-        OrderType orderType{};
-        TimeInForce TimeInForce{};
-        Price price{};
+        Side side : 1 {};
+        OrderType orderType : 2 {};
+        TimeInForce timeInForce : 2 {};
+        std::uint8_t legCount{0}; // Orders in the linkID group, this one included
+        OrderStatus status{OrderStatus::Incoming};
+        OrderAction action{OrderAction::New};
+        Price price{}; // Limit price; market orders only use it for risk checks
+        Price stopPrice{0}; // Stop and StopLimit: trigger price
         Quantity quantity{};
         Quantity filledQuantity{0};
-        OrderStatus status{OrderStatus::Incoming};
+        std::uint32_t traceID{0}; // Tick trace this order came from, 0 if untraced
+        LinkID linkID{0}; // Nonzero: legs passed or rejected by risk as one unit
         Timestamp timestamp{};
+    };
+
+    static_assert(sizeof(Order) == 64);
 
-        // For intrusive containers
-        Order *next{nullptr};
-        Order *prev{nullptr};
+    // Recovery ticks let the book's owning thread rebuild it from a snapshot
+    enum class TickType : uint8_t {
+        Incremental = 0,
+        BookReset = 1, // Clear the book; snapshot levels follow
+        SnapshotLevel = 2
     };
 
-    struct alignas(32) MarketTick {
+    // Widest fields first, so nothing pads between them
+    struct MarketTick {
         SymbolID symbol_id;
+        uint32_t trace_id{0}; // Nonzero when sampled by TickTracer
         Price price;
         Quantity quantity;
-        Side side;
         Timestamp timestamp;
         uint64_t sequence;
+        Side side;
+        TickType type{TickType::Incremental};
     };
 
-    struct alignas(32) Trade {
+    static_assert(sizeof(MarketTick) == 48);
+
+    struct Trade {
         TradeID trade_id;
         OrderID buy_order_id;
         OrderID sell_order_id;
-        SymbolID symbol_id;
         Price price;
         Quantity quantity;
         Timestamp timestamp;
+        SymbolID symbol_id;
         Side aggressor_side;
     };
 
+    static_assert(sizeof(Trade) == 56);
+
     // Message headers for network protocols
     struct alignas(8) MessageHeader {
         MessageType message_type;
@@ -114,7 +145,14 @@ namespace trading_engine {
         SymbolID symbol_id;
         uint32_t num_levels;
         Timestamp exchange_timestamp;
-        // Followed by array of price levels
+        // Followed by num_levels MDSnapshotLevel entries. header.sequence_number
+        // is the last incremental sequence on the symbol's channel it includes.
+    };
+
+    struct MDSnapshotLevel {
+        Price price;
+        Quantity quantity;
+        Side side;
     };
 
     // Constants
@@ -136,6 +174,26 @@ namespace trading_engine {
         return static_cast<Value>(price) * quantity / PriceScale;
     }
 
+    // Spreads symbols evenly over `shard_count` shards by hash
+    constexpr uint32_t symbol_shard(const SymbolID symbol_id, const uint32_t shard_count) noexcept {
+        const auto hash = static_cast<uint32_t>((static_cast<std::uint64_t>(symbol_id) * 0x9E3779B97F4A7C15ULL) >> 32);
+        return static_cast<uint32_t>((static_cast<std::uint64_t>(hash) * shard_count) >> 32);
+    }
+
+    // The top byte of an OrderID or TradeID names the matching shard that
+    // owns it, so a cancel that only carries the ID can still be routed.
+    // Callers pick IDs below 2^56; the engine fills in the shard.
+    constexpr int ShardIdShift = 56;
+    constexpr uint32_t MaxMatchingShards = 1U << (64 - ShardIdShift);
+
+    constexpr std::uint64_t with_shard(const std::uint64_t id, const uint32_t shard) noexcept {
+        return (id & ((1ULL << ShardIdShift) - 1)) | static_cast<std::uint64_t>(shard) << ShardIdShift;
+    }
+
+    constexpr uint32_t shard_of(const std::uint64_t id) noexcept {
+        return static_cast<uint32_t>(id >> ShardIdShift);
+    }
+
     // Hardware timestamp functions
     inline std::uint64_t rdtsc() noexcept {
 #ifdef _MSC_VER
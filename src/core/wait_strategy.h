@@ -0,0 +1,347 @@
+#pragma once
+
+#include "types.h"
+#include "memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace trading_engine {
+    // What a consumer loop does when a poll finds nothing
+    enum class WaitPolicy : uint8_t {
+        BusySpin, // Re-poll immediately; lowest latency, burns the core
+        SpinPause, // Re-poll with a pause hint between attempts
+        SpinThenYield, // Spin for a while, then give the core away on every empty poll
+        SpinThenPark, // Spin for a while, then sleep on a futex until a producer wakes it
+        Block // Sleep on the futex as soon as there is nothing to do
+    };
+
+    [[nodiscard]] constexpr bool parks(const WaitPolicy policy) noexcept {
+        return policy == WaitPolicy::SpinThenPark || policy == WaitPolicy::Block;
+    }
+
+    [[nodiscard]] constexpr const char *to_string(const WaitPolicy policy) noexcept {
+        switch (policy) {
+            case WaitPolicy::BusySpin: return "busy_spin";
+            case WaitPolicy::SpinPause: return "spin_pause";
+            case WaitPolicy::SpinThenYield: return "spin_then_yield";
+            case WaitPolicy::SpinThenPark: return "spin_then_park";
+            case WaitPolicy::Block: return "block";
+        }
+        return "unknown";
+    }
+
+    struct WaitConfig {
+        WaitPolicy policy{WaitPolicy::SpinThenYield};
+        uint32_t spin_iterations{64}; // Empty polls before yielding or parking
+        // Loops no producer can wake (a network poll) park by sleeping this long
+        std::chrono::microseconds park_timeout{100};
+    };
+
+    // Per-instance waits for a role: instance i uses overrides[i] when there
+    // is one, the role default otherwise
+    [[nodiscard]] inline const WaitConfig &wait_config_for(const WaitConfig &role_default,
+                                                           const std::vector<WaitConfig> &overrides,
+                                                           const uint32_t instance) noexcept {
+        return instance < overrides.size() ? overrides[instance] : role_default;
+    }
+
+    namespace wait_detail {
+        inline int64_t now_ns() noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // CPU time the calling thread has used
+        inline int64_t thread_cpu_ns() noexcept {
+#ifdef _WIN32
+            FILETIME creation, exit, kernel, user;
+            if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+                return 0;
+            }
+            const auto ticks = [](const FILETIME &time) {
+                return (static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+            };
+            return (ticks(kernel) + ticks(user)) * 100;
+#else
+            timespec time{};
+            if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+                return 0;
+            }
+            return static_cast<int64_t>(time.tv_sec) * 1000000000LL + time.tv_nsec;
+#endif
+        }
+    }
+
+    // Where a parked consumer sleeps
+    //
+    // Producers call notify() after publishing, which costs one relaxed load
+    // unless the consumer parks: only then is the push fenced against the
+    // consumer's sleeper count, and the futex is touched only when someone is
+    // actually asleep. A signal whose consumer never parks is never read.
+    class alignas(CacheLineSize) WakeSignal {
+        std::atomic<uint32_t> epoch{0};
+        std::atomic<uint32_t> sleepers{0};
+        std::atomic<int64_t> signalled_at{0}; // When a producer last woke a sleeper
+        bool parking;
+
+    public:
+        explicit WakeSignal(const WaitPolicy policy = WaitPolicy::SpinThenPark) noexcept
+            : parking(parks(policy)) {
+        }
+
+        WakeSignal(const WakeSignal &) = delete;
+
+        WakeSignal &operator=(const WakeSignal &) = delete;
+
+        // After a release push: orders it before the sleeper check
+        FORCE_INLINE void notify() noexcept {
+            if (!parking) {
+                return;
+            }
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            wake_if_parked();
+        }
+
+        // For producers whose publishing store was already seq_cst
+        FORCE_INLINE void wake_if_parked() noexcept {
+            if (UNLIKELY(sleepers.load(std::memory_order_relaxed) != 0)) {
+                signalled_at.store(wait_detail::now_ns(), std::memory_order_relaxed);
+                epoch.fetch_add(1, std::memory_order_release);
+                epoch.notify_one();
+            }
+        }
+
+        // Shutdown: every sleeper re-checks its loop condition
+        void wake_all() noexcept {
+            epoch.fetch_add(1, std::memory_order_release);
+            epoch.notify_all();
+        }
+
+        [[nodiscard]] bool parking_enabled() const noexcept {
+            return parking;
+        }
+
+        // Sleeps until notified unless ready() already holds once this
+        // consumer is counted as asleep, so a push cannot slip past. Returns
+        // the producer's wake time, or 0 if it did not sleep.
+        template<typename Ready>
+        int64_t park(Ready &&ready) {
+            const uint32_t seen = epoch.load(std::memory_order_acquire);
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            int64_t woken_at = 0;
+            if (!ready()) {
+                epoch.wait(seen, std::memory_order_acquire);
+                woken_at = signalled_at.load(std::memory_order_relaxed);
+            }
+
+            sleepers.fetch_sub(1, std::memory_order_seq_cst);
+            return woken_at;
+        }
+    };
+
+    // One loop's idle behaviour and what it cost
+    struct WaitStats {
+        const char *role;
+        uint32_t instance;
+        WaitPolicy policy;
+        uint64_t wakeups; // Idle stretches ended by work turning up
+        uint64_t yields;
+        uint64_t parks; // Futex sleeps, or timed sleeps for loops nobody wakes
+        // Idle to first message: from the last poll that found nothing, or the
+        // producer's wake for a futex sleep, to the poll that found work
+        double mean_wake_latency_ns;
+        uint64_t max_wake_latency_ns;
+        double cpu_seconds; // Sampled by the loop itself, at most a millisecond stale
+        double wall_seconds;
+        double cpu_utilisation; // cpu_seconds / wall_seconds
+    };
+
+    // A consumer loop's wait policy
+    //
+    // The loop calls idle() after a poll that found nothing and on_work()
+    // after one that found something. idle() takes a ready() predicate, which
+    // must also hold when the loop should exit, as parking re-checks it.
+    // Owned by the loop's thread; the counters are for get_statistics().
+    class WaitStrategy {
+        static constexpr int64_t CpuSampleIntervalNs = 1000000;
+        static constexpr uint32_t BusySampleInterval = 1024; // on_work() calls between clock reads
+
+        WaitConfig config;
+        WakeSignal *signal; // nullptr: nothing wakes this loop, so parks are timed sleeps
+        const char *role;
+        uint32_t instance;
+
+        // Loop thread only
+        uint32_t idle_polls{0};
+        uint32_t busy_polls{0};
+        bool idling{false};
+        int64_t empty_since{0}; // Latest time the loop knew it had nothing to do
+        int64_t started_at{0};
+        int64_t cpu_at_start{0};
+        int64_t sampled_at{0};
+
+        alignas(CacheLineSize) std::atomic<uint64_t> wakeups{0};
+        std::atomic<uint64_t> yields{0};
+        std::atomic<uint64_t> park_count{0};
+        std::atomic<uint64_t> wake_latency_total{0};
+        std::atomic<uint64_t> wake_latency_max{0};
+        std::atomic<int64_t> cpu_ns{0};
+        std::atomic<int64_t> wall_ns{0};
+
+    public:
+        WaitStrategy(const WaitConfig &wait_config, WakeSignal *wake_signal, const char *loop_role,
+                     const uint32_t loop_instance = 0) noexcept
+            : config(wait_config), signal(wake_signal), role(loop_role), instance(loop_instance) {
+        }
+
+        WaitStrategy(const WaitStrategy &) = delete;
+
+        WaitStrategy &operator=(const WaitStrategy &) = delete;
+
+        // On the loop's thread, before its first poll
+        void begin() noexcept {
+            started_at = wait_detail::now_ns();
+            sampled_at = started_at;
+            cpu_at_start = wait_detail::thread_cpu_ns();
+            idling = false;
+            idle_polls = 0;
+        }
+
+        // On the loop's thread, after its last poll
+        void end() noexcept {
+            sample_cpu(wait_detail::now_ns());
+        }
+
+        FORCE_INLINE void on_work() noexcept {
+            if (LIKELY(!idling)) {
+                if (UNLIKELY(++busy_polls == BusySampleInterval)) {
+                    busy_polls = 0;
+                    maybe_sample_cpu(wait_detail::now_ns());
+                }
+                return;
+            }
+            woke();
+        }
+
+        template<typename Ready>
+        void idle(Ready &&ready) {
+            const int64_t now = wait_detail::now_ns();
+            if (!idling) {
+                idling = true;
+                idle_polls = 0;
+            }
+            empty_since = now;
+            maybe_sample_cpu(now);
+
+            switch (config.policy) {
+                case WaitPolicy::BusySpin:
+                    return;
+
+                case WaitPolicy::SpinPause:
+                    cpu_relax();
+                    return;
+
+                case WaitPolicy::SpinThenYield:
+                    if (idle_polls < config.spin_iterations) {
+                        ++idle_polls;
+                        cpu_relax();
+                        return;
+                    }
+                    yields.fetch_add(1, std::memory_order_relaxed);
+                    std::this_thread::yield();
+                    return;
+
+                case WaitPolicy::SpinThenPark:
+                    if (++idle_polls < config.spin_iterations) {
+                        cpu_relax();
+                        return;
+                    }
+                    break;
+
+                case WaitPolicy::Block:
+                    break;
+            }
+
+            idle_polls = 0;
+            park(ready);
+        }
+
+        [[nodiscard]] const WaitConfig &wait_config() const noexcept {
+            return config;
+        }
+
+        [[nodiscard]] WaitStats get_statistics() const noexcept {
+            const uint64_t woke = wakeups.load(std::memory_order_relaxed);
+            const double cpu = static_cast<double>(cpu_ns.load(std::memory_order_relaxed)) / 1e9;
+            const double wall = static_cast<double>(wall_ns.load(std::memory_order_relaxed)) / 1e9;
+            return WaitStats{
+                .role = role,
+                .instance = instance,
+                .policy = config.policy,
+                .wakeups = woke,
+                .yields = yields.load(std::memory_order_relaxed),
+                .parks = park_count.load(std::memory_order_relaxed),
+                .mean_wake_latency_ns = woke > 0
+                                            ? static_cast<double>(wake_latency_total.load(std::memory_order_relaxed)) /
+                                              static_cast<double>(woke)
+                                            : 0.0,
+                .max_wake_latency_ns = wake_latency_max.load(std::memory_order_relaxed),
+                .cpu_seconds = cpu,
+                .wall_seconds = wall,
+                .cpu_utilisation = wall > 0.0 ? cpu / wall : 0.0
+            };
+        }
+
+    private:
+        template<typename Ready>
+        void park(Ready &&ready) {
+            park_count.fetch_add(1, std::memory_order_relaxed);
+            if (signal == nullptr || !signal->parking_enabled()) {
+                std::this_thread::sleep_for(config.park_timeout);
+                return;
+            }
+
+            const int64_t woken_at = signal->park(ready);
+            // The producer's wake is the earliest the work could have been seen
+            empty_since = std::max(empty_since, woken_at);
+        }
+
+        void woke() noexcept {
+            idling = false;
+            const int64_t now = wait_detail::now_ns();
+            const auto latency = static_cast<uint64_t>(std::max<int64_t>(now - empty_since, 0));
+
+            wakeups.fetch_add(1, std::memory_order_relaxed);
+            wake_latency_total.fetch_add(latency, std::memory_order_relaxed);
+            if (latency > wake_latency_max.load(std::memory_order_relaxed)) {
+                wake_latency_max.store(latency, std::memory_order_relaxed);
+            }
+            maybe_sample_cpu(now);
+        }
+
+        void maybe_sample_cpu(const int64_t now) noexcept {
+            if (now - sampled_at >= CpuSampleIntervalNs) {
+                sample_cpu(now);
+            }
+        }
+
+        void sample_cpu(const int64_t now) noexcept {
+            sampled_at = now;
+            cpu_ns.store(wait_detail::thread_cpu_ns() - cpu_at_start, std::memory_order_relaxed);
+            wall_ns.store(now - started_at, std::memory_order_relaxed);
+        }
+    };
+}
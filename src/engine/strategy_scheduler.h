@@ -0,0 +1,266 @@
+#pragma once
+
+#include "../core/types.h"
+#include "../core/memory.h"
+#include "../core/topology.h"
+#include "../core/wait_strategy.h"
+#include "../strategy/strategy_interface.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace trading_engine {
+    struct SchedulerConfig {
+        uint32_t worker_count{1};
+        ThreadPlacement workers{}; // Worker i runs on workers.core_for(i)
+        // What a worker does when no strategy is ready
+        WaitConfig wait{.policy = WaitPolicy::SpinThenPark, .spin_iterations = 4096};
+    };
+
+    // Event-driven strategy scheduler
+    //
+    // Producers call notify() after queueing data for a strategy, which sets the
+    // strategy's bit in a ready mask. Workers claim ready bits, preferring the
+    // strategies homed on them (index % worker_count) and stealing any other
+    // ready strategy when their own are idle. A busy flag keeps each strategy on
+    // one worker at a time, as its input queues are single-consumer.
+    class StrategyScheduler {
+    public:
+        static constexpr size_t MaxStrategies = 1024;
+
+    private:
+        static constexpr size_t WordCount = MaxStrategies / 64;
+
+        struct alignas(CacheLineSize) Entry {
+            std::atomic<IStrategy *> strategy{nullptr};
+            std::atomic<bool> busy{false};
+        };
+
+        struct alignas(CacheLineSize) WorkerCounters {
+            std::atomic<uint64_t> activations{0};
+            std::atomic<uint64_t> steals{0};
+        };
+
+        SchedulerConfig config;
+        std::unique_ptr<Entry[]> entries;
+        std::atomic<uint32_t> strategy_count{0};
+
+        alignas(CacheLineSize) std::array<std::atomic<std::uint64_t>, WordCount> ready{};
+
+        // Parking: workers sleep on the signal; producers only touch its
+        // futex when someone is asleep
+        WakeSignal wake;
+
+        std::vector<std::thread> workers;
+        std::unique_ptr<WorkerCounters[]> counters;
+        std::vector<std::unique_ptr<WaitStrategy> > waits; // Per worker
+        std::vector<std::array<std::uint64_t, WordCount> > home_masks; // Per worker, per ready word
+        std::atomic<bool> running{false};
+
+    public:
+        explicit StrategyScheduler(SchedulerConfig scheduler_config = {})
+            : config(std::move(scheduler_config)), entries(std::make_unique<Entry[]>(MaxStrategies)),
+              wake(config.wait.policy) {
+            config.worker_count = std::max<uint32_t>(config.worker_count, 1);
+            counters = std::make_unique<WorkerCounters[]>(config.worker_count);
+            waits.reserve(config.worker_count);
+            for (uint32_t i = 0; i < config.worker_count; ++i) {
+                waits.push_back(std::make_unique<WaitStrategy>(config.wait, &wake, "strategy_worker", i));
+            }
+
+            home_masks.resize(config.worker_count);
+            for (uint32_t index = 0; index < MaxStrategies; ++index) {
+                home_masks[index % config.worker_count][index / 64] |= 1ULL << (index % 64);
+            }
+        }
+
+        ~StrategyScheduler() {
+            stop();
+        }
+
+        StrategyScheduler(const StrategyScheduler &) = delete;
+
+        StrategyScheduler &operator=(const StrategyScheduler &) = delete;
+
+        // Returns the strategy's index for notify(), or MaxStrategies when full.
+        // Safe while running; registration itself is not thread-safe.
+        uint32_t add_strategy(IStrategy *strategy) {
+            const uint32_t index = strategy_count.load(std::memory_order_relaxed);
+            if (UNLIKELY(index >= MaxStrategies)) {
+                return MaxStrategies;
+            }
+
+            entries[index].strategy.store(strategy, std::memory_order_release);
+            strategy_count.store(index + 1, std::memory_order_release);
+            notify(index); // Pick up anything queued before registration
+            return index;
+        }
+
+        bool start() {
+            if (running.exchange(true, std::memory_order_acq_rel)) {
+                return false;
+            }
+
+            for (uint32_t i = 0; i < config.worker_count; ++i) {
+                workers.emplace_back(&StrategyScheduler::worker_loop, this, i);
+            }
+            return true;
+        }
+
+        void stop() {
+            if (!running.exchange(false, std::memory_order_acq_rel)) {
+                return;
+            }
+
+            wake.wake_all();
+            for (auto &worker: workers) {
+                if (worker.joinable()) {
+                    worker.join();
+                }
+            }
+            workers.clear();
+        }
+
+        FORCE_INLINE void notify(const uint32_t index) noexcept {
+            const std::uint64_t bit = 1ULL << (index % 64);
+            std::atomic<std::uint64_t> &word = ready[index / 64];
+
+            // Already flagged: a worker will see it, nothing to wake. The fence
+            // orders the caller's queue push before the check; without it a
+            // worker could clear the bit, miss the item and park.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (word.load(std::memory_order_relaxed) & bit) {
+                return;
+            }
+
+            word.fetch_or(bit, std::memory_order_seq_cst);
+            wake.wake_if_parked();
+        }
+
+        struct SchedulerStats {
+            uint64_t activations; // process_signals() calls
+            uint64_t steals; // ...of which ran on a non-home worker
+            uint64_t parks; // Times a worker went to sleep
+            uint32_t worker_count;
+            uint32_t strategy_count;
+        };
+
+        [[nodiscard]] SchedulerStats get_statistics() const noexcept {
+            SchedulerStats stats{
+                .activations = 0,
+                .steals = 0,
+                .parks = 0,
+                .worker_count = config.worker_count,
+                .strategy_count = strategy_count.load(std::memory_order_relaxed)
+            };
+
+            for (uint32_t i = 0; i < config.worker_count; ++i) {
+                stats.activations += counters[i].activations.load(std::memory_order_relaxed);
+                stats.steals += counters[i].steals.load(std::memory_order_relaxed);
+                stats.parks += waits[i]->get_statistics().parks;
+            }
+            return stats;
+        }
+
+        // Idle behaviour per worker
+        [[nodiscard]] std::vector<WaitStats> get_wait_statistics() const {
+            std::vector<WaitStats> stats;
+            stats.reserve(waits.size());
+            for (const auto &wait: waits) {
+                stats.push_back(wait->get_statistics());
+            }
+            return stats;
+        }
+
+    private:
+        void worker_loop(const uint32_t worker) {
+            if (!place_current_thread(config.workers, worker)) {
+                std::cerr << "Strategy worker " << worker << ": thread placement not applied" << std::endl;
+            }
+
+            WorkerCounters &stats = counters[worker];
+            WaitStrategy &wait = *waits[worker];
+            const auto has_work = [this] {
+                return any_ready() || !running.load(std::memory_order_acquire);
+            };
+
+            wait.begin();
+            try {
+                while (running.load(std::memory_order_acquire)) {
+                    bool stolen = false;
+                    const uint32_t index = claim(worker, stolen);
+
+                    if (index == MaxStrategies) {
+                        wait.idle(has_work);
+                        continue;
+                    }
+
+                    wait.on_work();
+                    Entry &entry = entries[index];
+
+                    // Another worker still has it; give the bit back for later
+                    if (entry.busy.exchange(true, std::memory_order_acquire)) {
+                        ready[index / 64].fetch_or(1ULL << (index % 64), std::memory_order_relaxed);
+                        cpu_relax();
+                        continue;
+                    }
+
+                    if (IStrategy *strategy = entry.strategy.load(std::memory_order_acquire);
+                        strategy && strategy->is_enabled()) {
+                        strategy->process_signals();
+                    }
+
+                    entry.busy.store(false, std::memory_order_release);
+                    stats.activations.fetch_add(1, std::memory_order_relaxed);
+                    if (stolen) {
+                        stats.steals.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            } catch (const std::exception &e) {
+                std::cerr << "Exception in strategy worker " << worker << ": " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Unknown exception in strategy worker " << worker << std::endl;
+            }
+            wait.end();
+        }
+
+        // Takes one ready strategy, home strategies first
+        uint32_t claim(const uint32_t worker, bool &stolen) noexcept {
+            const uint32_t used_words = (strategy_count.load(std::memory_order_acquire) + 63) / 64;
+            const auto &home = home_masks[worker];
+            const int passes = config.worker_count == 1 ? 1 : 2;
+
+            for (int pass = 0; pass < passes; ++pass) {
+                for (uint32_t w = 0; w < used_words; ++w) {
+                    const std::uint64_t mask = pass == 0 ? home[w] : ~home[w];
+                    std::uint64_t bits = ready[w].load(std::memory_order_relaxed) & mask;
+
+                    while (bits != 0) {
+                        const std::uint64_t bit = bits & -bits;
+                        if (ready[w].fetch_and(~bit, std::memory_order_acquire) & bit) {
+                            stolen = pass == 1;
+                            return w * 64 + static_cast<uint32_t>(std::countr_zero(bit));
+                        }
+                        bits &= ~bit; // Lost the race for it
+                    }
+                }
+            }
+
+            return MaxStrategies;
+        }
+
+        [[nodiscard]] bool any_ready() const noexcept {
+            for (const auto &word: ready) {
+                if (word.load(std::memory_order_seq_cst) != 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+}
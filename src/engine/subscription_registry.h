@@ -0,0 +1,72 @@
+#pragma once
+
+#include "../core/types.h"
+#include "../core/memory.h"
+#include "../core/symbol_directory.h"
+#include "../strategy/strategy_interface.h"
+
+#include <array>
+#include <atomic>
+#include <span>
+
+namespace trading_engine {
+    // Symbol -> subscribed strategies, for market data and trade fan-out
+    //
+    // Each symbol owns a contiguous, fixed-capacity subscriber array, so fan-out
+    // is one directory lookup and a linear walk over just the interested
+    // strategies. Readers are lock-free; subscribe() may run while data flows
+    // but must not be called concurrently with itself.
+    class SubscriptionRegistry {
+    public:
+        static constexpr size_t MaxSubscribersPerSymbol = 32;
+
+        struct Subscriber {
+            IStrategy *strategy;
+            uint32_t scheduler_index;
+        };
+
+    private:
+        struct alignas(CacheLineSize) SubscriberList {
+            std::atomic<uint32_t> count{0};
+            std::array<Subscriber, MaxSubscribersPerSymbol> subscribers{};
+        };
+
+        SymbolDirectory<SubscriberList> lists;
+
+    public:
+        // False if the symbol directory or the symbol's list is full
+        bool subscribe(const SymbolID symbol_id, IStrategy *strategy, const uint32_t scheduler_index) {
+            SubscriberList *list = lists.get_or_create(symbol_id);
+            if (list == nullptr) {
+                return false;
+            }
+
+            const uint32_t count = list->count.load(std::memory_order_relaxed);
+            for (uint32_t i = 0; i < count; ++i) {
+                if (list->subscribers[i].strategy == strategy) {
+                    return true; // Already subscribed
+                }
+            }
+
+            if (count >= MaxSubscribersPerSymbol) {
+                return false;
+            }
+
+            list->subscribers[count] = Subscriber{.strategy = strategy, .scheduler_index = scheduler_index};
+            list->count.store(count + 1, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] std::span<const Subscriber> subscribers(const SymbolID symbol_id) const noexcept {
+            const SubscriberList *list = lists.find(symbol_id);
+            if (list == nullptr) {
+                return {};
+            }
+            return {list->subscribers.data(), list->count.load(std::memory_order_acquire)};
+        }
+
+        [[nodiscard]] size_t symbol_count() const noexcept {
+            return lists.size();
+        }
+    };
+}
@@ -1,56 +1,251 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <iostream>
 #include <memory>
+#include <span>
 #include <thread>
 #include <vector>
 
 #include "../core/memory.h"
 #include "../core/queue.h"
 #include "../core/timing.h"
+#include "../core/tracing.h"
 #include "../core/types.h"
+#include "../core/wait_strategy.h"
 #include "../market_data/gateway.h"
 #include "../market_data/order_book.h"
 #include "../matching/matching_engine.h"
+#include "../order_entry/execution_listener.h"
+#include "../persistence/journal.h"
+#include "../risk/risk_batch.h"
 #include "../risk/risk_manager.h"
 #include "../strategy/strategy_base.h"
 #include "../strategy/strategy_interface.h"
+#include "strategy_scheduler.h"
+#include "subscription_registry.h"
 
 namespace trading_engine {
+    // Staged: incoming -> risk thread -> matching thread -> trade thread.
+    // Inline: the matching thread runs risk checks and applies positions itself,
+    // saving two thread hops per order at the cost of isolation.
+    enum class PipelineMode : uint8_t {
+        Staged,
+        Inline
+    };
+
+    struct EngineConfig {
+        PipelineMode pipeline{PipelineMode::Staged};
+        GatewayConfig gateway{};
+        SchedulerConfig scheduler{};
+        // Cores and scheduling policy per thread role; each role's queues,
+        // books and pools are allocated on its node. Roles set here override
+        // the gateway and scheduler placements.
+        ThreadTopology topology{};
+        // Matching threads, each owning the books of the symbols that hash to
+        // it. Staged pipeline only; the inline pipeline always runs one.
+        uint32_t matching_shards{1};
+        // Price grid of the matching ladders in scaled units; levels off the
+        // grid or outside the ladder window fall back to an ordered map.
+        // set_symbol_tick_size() overrides it per symbol.
+        Price price_tick_size{MatchingEngine::DefaultTickSize};
+        // Idle behaviour of the engine's consumer loops. The inline pipeline's
+        // one thread waits by matching_wait (or shard 0's override).
+        WaitConfig risk_wait{};
+        WaitConfig matching_wait{};
+        // Shard i waits by matching_shard_waits[i] when set, e.g. shards of
+        // latency-critical symbols spinning while the long tail parks
+        std::vector<WaitConfig> matching_shard_waits{};
+        WaitConfig trade_notification_wait{};
+        uint32_t trace_sample_rate{0}; // Trace 1 in N market data ticks end to end; 0 = off
+        // Write-ahead journal and snapshots of the matching state, for
+        // crash recovery; off while journal.directory is empty
+        JournalConfig journal{};
+    };
+
     // Main trading engine orchestrator
     class TradingEngine {
     private:
         // Core components
-        std::unique_ptr<OrderBookManager> order_book_manager;
+        NodeLocalPtr<OrderBookManager> order_book_manager;
         std::unique_ptr<MarketDataGateway> market_data_gateway;
-        std::unique_ptr<RiskManager> risk_manager;
-        std::unique_ptr<MatchingEngine> matching_engine;
+        NodeLocalPtr<RiskManager> risk_manager;
+
+        // One matching thread's engine, its inbound queue from the risk
+        // thread and its counters; lives on the thread's node
+        struct alignas(CacheLineSize) MatchingShard {
+            MatchingEngine engine;
+            SPSCQueue<Order, 1024> orders;
+            WakeSignal wake; // Rung by the risk thread after each push
+            alignas(CacheLineSize) std::atomic<uint64_t> orders_processed{0};
+            std::atomic<uint64_t> cancels_processed{0};
+            std::atomic<uint64_t> amends_processed{0};
+            // Last of the shard's trades positions have booked, all earlier
+            // ones included; staged pipeline, written by the trade
+            // notification thread
+            alignas(CacheLineSize) std::atomic<TradeID> trades_booked{0};
+            WaitStrategy wait;
+            JournalWriter::ShardLog *journal{nullptr}; // This shard's end of the journal, when there is one
+
+            MatchingShard(const uint32_t shard, const Price tick_size, const WaitConfig &wait_config)
+                : engine(shard, tick_size), wake(wait_config.policy),
+                  trades_booked(engine.get_next_trade_id() - 1), wait(wait_config, &wake, "matching", shard) {
+            }
+        };
 
-        // Strategy management
+        std::vector<NodeLocalPtr<MatchingShard> > matching_shards;
+        static constexpr size_t MatchingBatchSize = 32; // Orders a matching thread takes per queue read
+
+        // Staged matching output: fills are written straight into the
+        // notification ring, whose slots the notification thread recycles.
+        // Strategies hear about trades from that thread, so each strategy's
+        // trade queue keeps one producer. A full ring holds the matching
+        // thread back until the notification thread makes room; positions
+        // and strategies must see every fill.
+        struct NotificationSink {
+            MPSCQueue<Trade, 2048> &trades;
+            WakeSignal &wake;
+            IExecutionListener *listener;
+            JournalWriter::ShardLog *journal;
+            TradingEngine &engine;
+
+            void on_trade(const Trade &trade) const {
+                if (journal != nullptr) {
+                    journal->append_trade(trade);
+                }
+                if (UNLIKELY(listener != nullptr)) {
+                    listener->on_trade(trade); // From here, so a session's reports stay in book order
+                }
+                if (UNLIKELY(!trades.try_push(trade)) && !wait_to_push(trade)) {
+                    return;
+                }
+                wake.notify();
+            }
+
+            // Gives up only once the engine stops and nobody drains the ring
+            bool wait_to_push(const Trade &trade) const noexcept {
+                engine.trade_notification_stalls.fetch_add(1, std::memory_order_relaxed);
+                for (uint32_t attempt = 0; !trades.try_push(trade); ++attempt) {
+                    if (UNLIKELY(!engine.engine_running.load(std::memory_order_acquire))) {
+                        engine.trade_notifications_dropped.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    }
+                    wake.notify();
+                    if (attempt < 64) {
+                        cpu_relax();
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+                return true;
+            }
+
+            void on_order_update(const Order &order) const {
+                TradingEngine::on_order_update(listener, order);
+            }
+
+            void on_request_missed(const Order &request) const {
+                TradingEngine::on_request_missed(listener, request);
+            }
+        };
+
+        // Inline matching output: positions and strategies are updated on
+        // the matching thread as each fill happens
+        struct InlineSink {
+            TradingEngine &engine;
+            JournalWriter::ShardLog *journal;
+
+            void on_trade(const Trade &trade) const {
+                if (journal != nullptr) {
+                    journal->append_trade(trade);
+                }
+                if (UNLIKELY(engine.execution_listener != nullptr)) {
+                    engine.execution_listener->on_trade(trade);
+                }
+                engine.risk_manager->update_position(trade);
+                engine.risk_manager->update_reference_price(trade.symbol_id, trade.price);
+                engine.on_trade_executed(trade);
+                engine.trades_executed.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void on_order_update(const Order &order) const {
+                TradingEngine::on_order_update(engine.execution_listener, order);
+            }
+
+            void on_request_missed(const Order &request) const {
+                TradingEngine::on_request_missed(engine.execution_listener, request);
+            }
+        };
+
+        // Replay output: positions follow the fills, nobody else hears of them
+        struct RecoverySink {
+            RiskManager &risk;
+
+            void on_trade(const Trade &trade) const {
+                risk.update_position(trade);
+                risk.update_reference_price(trade.symbol_id, trade.price);
+            }
+
+            static void on_order_update(const Order &) noexcept {
+            }
+        };
+
+        EngineConfig config;
+
+        // Wake the consumers of incoming_orders and trade_notifications.
+        // Intake is the risk thread, or the matching thread when inline.
+        WakeSignal intake_wake;
+        WakeSignal trade_wake;
+        WaitStrategy intake_wait;
+        WaitStrategy trade_wait;
+
+        // Strategy management; strategies[i] is scheduler index i
         std::vector<std::unique_ptr<IStrategy> > strategies;
+        std::unique_ptr<StrategyScheduler> strategy_scheduler;
+        SubscriptionRegistry subscriptions;
 
         // Threading
         std::vector<std::thread> worker_threads;
         std::atomic<bool> engine_running{false};
         std::atomic<bool> stopped{false};
 
-        // Message queues for different components
-        SPSCQueue<Order, 4096> incoming_orders;
-        SPSCQueue<Order, 1024> risk_approved_orders;
-        MPSCQueue<Trade, 2048> trade_notifications;
+        // Message queues for different components, each on its consumer's
+        // node. Orders arrive from every strategy worker as well as external
+        // callers.
+        NodeLocalPtr<MPMCQueue<Order, 4096> > incoming_orders;
+        NodeLocalPtr<MPSCQueue<Trade, 2048> > trade_notifications; // Every shard's trades, merged
+
+        // Owned by whichever thread runs risk checks
+        NodeLocalPtr<RiskBatch> risk_batch;
 
         // Statistics and monitoring
         std::atomic<uint64_t> orders_received{0};
-        std::atomic<uint64_t> orders_processed{0};
         std::atomic<uint64_t> orders_rejected{0};
         std::atomic<uint64_t> trades_executed{0};
+        std::atomic<uint64_t> trade_notification_stalls{0}; // Fills that waited for notification ring space
+        std::atomic<uint64_t> trade_notifications_dropped{0}; // Fills still waiting when the engine stopped
 
         // Performance tracking
         std::chrono::steady_clock::time_point start_time;
 
+        IExecutionListener *execution_listener{nullptr}; // Order entry, when attached
+
+        std::unique_ptr<JournalWriter> journal; // When config.journal names a directory
+        bool recovered{false};
+
     public:
-        TradingEngine() {
+        explicit TradingEngine(EngineConfig engine_config = {})
+            : config(std::move(engine_config)),
+              intake_wake(intake_wait_config().policy),
+              trade_wake(config.trade_notification_wait.policy),
+              intake_wait(intake_wait_config(), &intake_wake,
+                          config.pipeline == PipelineMode::Inline ? "inline_matching" : "risk"),
+              trade_wait(config.trade_notification_wait, &trade_wake, "trade_notification") {
+            apply_topology();
+            strategies.reserve(StrategyScheduler::MaxStrategies);
+            TickTracer::set_sample_rate(config.trace_sample_rate);
             initialize_components();
         }
 
@@ -63,6 +258,17 @@ namespace trading_engine {
                 return false; // Already running
             }
 
+            // Nothing runs until the journal has been replayed and can take more
+            if (journal) {
+                if (!recovered && !recover().succeeded) {
+                    return false;
+                }
+                if (!journal->start()) {
+                    std::cerr << "Journal could not be opened in " << journal->directory() << std::endl;
+                    return false;
+                }
+            }
+
             start_time = std::chrono::steady_clock::now();
             engine_running.store(true, std::memory_order_release);
 
@@ -98,8 +304,12 @@ namespace trading_engine {
             // 2. Signal worker threads to stop their loops
             std::cout << "Signaling worker threads to stop..." << std::endl;
             engine_running.store(false, std::memory_order_release);
+            wake_consumers();
 
             // 3. Wait for all worker threads to complete and exit
+            std::cout << "Stopping strategy scheduler..." << std::endl;
+            strategy_scheduler->stop();
+
             std::cout << "Joining worker threads..." << std::endl;
             for (size_t i = 0; i < worker_threads.size(); ++i) {
                 if (worker_threads[i].joinable()) {
@@ -111,7 +321,18 @@ namespace trading_engine {
             worker_threads.clear();
             std::cout << "All worker threads joined." << std::endl;
 
-            // 4. Stop strategies
+            // 4. Commit what the matching threads journaled, then snapshot
+            // the final state so a restart has nothing to replay
+            if (journal) {
+                journal->stop();
+                if (journal->write_final_snapshot([this](const uint32_t shard, JournalWriter::ShardLog &log) {
+                    capture_checkpoint(*matching_shards[shard], log);
+                })) {
+                    std::cout << "Journal snapshot written." << std::endl;
+                }
+            }
+
+            // 5. Stop strategies
             for (auto &strategy: strategies) {
                 strategy->shutdown();
             }
@@ -119,78 +340,268 @@ namespace trading_engine {
             std::cout << "Trading engine stopped." << std::endl;
         }
 
-        // Order submission interface
-        bool submit_order(const Order &order) {
+        // Order submission interface, for new orders and amends. Returns the
+        // ID the engine knows the order by from now on (trades, updates,
+        // cancels, amends): the caller's ID with its matching shard in the top
+        // byte. An amend takes that ID and goes to the shard it names, so it
+        // reaches the order whatever symbol it carries. 0 if the queue is full.
+        OrderID submit_order(const Order &order) {
             orders_received.fetch_add(1, std::memory_order_relaxed);
 
-            if (!incoming_orders.try_push(order)) {
+            Order routed = order;
+            if (order.action == OrderAction::New) {
+                routed.orderID = with_shard(order.orderID, symbol_shard(order.symbolID, shard_count()));
+            }
+            if (!incoming_orders->try_push(routed)) {
                 // Queue full - this is a critical error in production
-                return false;
+                return 0;
+            }
+            intake_wake.notify();
+
+            return routed.orderID;
+        }
+
+        // Queues a burst of new orders, cancels and amends with one claim on
+        // the order queue, in order. New orders get their shard stamped into
+        // orderID in place, as submit_order would return it; cancels and
+        // amends already carry theirs. Returns how many leading requests
+        // were queued.
+        size_t submit_orders(const std::span<Order> orders) {
+            for (Order &order: orders) {
+                if (order.action == OrderAction::New) {
+                    order.orderID = with_shard(order.orderID, symbol_shard(order.symbolID, shard_count()));
+                }
+            }
+
+            const size_t queued = incoming_orders->try_push_bulk(std::span<const Order>(orders));
+            if (queued == 0) {
+                return 0;
             }
+            intake_wake.notify();
 
+            const auto cancels = std::count_if(orders.begin(), orders.begin() + queued, [](const Order &order) {
+                return order.action == OrderAction::Cancel;
+            });
+            orders_received.fetch_add(queued - static_cast<size_t>(cancels), std::memory_order_relaxed);
+            return queued;
+        }
+
+        // Every fill and order update also goes to `listener`, e.g. an
+        // OrderEntryGateway. Only while stopped; the listener must outlive
+        // the engine's threads. False once started.
+        bool set_execution_listener(IExecutionListener *listener) {
+            if (engine_running.load(std::memory_order_acquire)) {
+                return false;
+            }
+            execution_listener = listener;
             return true;
         }
 
         // Strategy management
-        void add_mean_reversion_strategy(SymbolID symbol_id) {
+        void add_mean_reversion_strategy(SymbolID symbol_id, ConflationMode conflation = ConflationMode::None) {
             auto strategy = std::make_unique<MeanReversionStrategy>(symbol_id);
+            strategy->set_conflation_mode(conflation);
+            connect_strategy(*strategy);
+            add_strategy(std::move(strategy));
+        }
 
-            // Set up callbacks
-            strategy->set_order_callback([this](const Order &order) {
-                submit_order(order);
-            });
+        // One strategy, one scheduler slot, for up to MaxBasketSymbols symbols
+        void add_basket_mean_reversion_strategy(const std::span<const SymbolID> basket,
+                                                const ConflationMode conflation = ConflationMode::None) {
+            auto strategy = std::make_unique<BasketMeanReversionStrategy>(basket);
+            strategy->set_conflation_mode(conflation);
+            connect_strategy(*strategy);
+            add_strategy(std::move(strategy));
+        }
 
-            strategy->set_cancel_callback([this](OrderID order_id) {
-                cancel_order(order_id);
-            });
+        // Trades the same instrument listed under two symbols
+        void add_arbitrage_strategy(SymbolID venue_a_symbol, SymbolID venue_b_symbol,
+                                    ConflationMode conflation = ConflationMode::None) {
+            auto strategy = std::make_unique<ArbitrageStrategy>(venue_a_symbol, venue_b_symbol);
+            strategy->set_conflation_mode(conflation);
+            connect_strategy(*strategy);
+            add_strategy(std::move(strategy));
+        }
 
+        // Takes ownership, schedules it and subscribes it (and the gateway) to
+        // each of its symbols; false once the scheduler is full
+        bool add_strategy(std::unique_ptr<IStrategy> strategy) {
+            if (strategies.size() >= StrategyScheduler::MaxStrategies) {
+                return false;
+            }
+
+            IStrategy *raw = strategy.get();
+            const auto index = static_cast<uint32_t>(strategies.size());
             strategies.push_back(std::move(strategy));
 
-            // Subscribe to market data for this symbol
-            market_data_gateway->subscribe_symbol(symbol_id);
+            for (const SymbolID symbol_id: raw->get_subscribed_symbols()) {
+                subscriptions.subscribe(symbol_id, raw, index);
+                subscribe_symbol(symbol_id);
+            }
+
+            strategy_scheduler->add_strategy(raw);
+            return true;
         }
 
-        bool cancel_order(const OrderID order_id) const {
-            return matching_engine->cancel_order(order_id);
+        // Queues a cancel behind the orders already submitted, so it reaches the
+        // matching thread in order; takes the ID submit_order returned. False
+        // if the order queue is full.
+        bool cancel_order(const OrderID order_id) {
+            if (!incoming_orders->try_push(Order{
+                .orderID = order_id,
+                .action = OrderAction::Cancel
+            })) {
+                return false;
+            }
+            intake_wake.notify();
+            return true;
+        }
+
+        // Queues an amend of a resting order to a new price and open quantity,
+        // in order behind what was already submitted. Risk checks the new
+        // terms; matching keeps the order's queue priority when only its size
+        // shrinks, and refuses an amend whose symbol or side is not the
+        // order's. Takes the ID submit_order returned; false if the queue is full.
+        bool modify_order(const OrderID order_id, const SymbolID symbol_id, const Side side,
+                          const Price price, const Quantity quantity) {
+            return submit_order(Order{
+                .orderID = order_id,
+                .symbolID = symbol_id,
+                .side = side,
+                .orderType = OrderType::Limit,
+                .action = OrderAction::Modify,
+                .price = price,
+                .quantity = quantity
+            }) != 0;
+        }
+
+        // Risk limits for every symbol without its own; takes effect on the next check
+        void set_risk_limits(const RiskLimits &limits) const {
+            risk_manager->set_global_limits(limits);
+        }
+
+        void set_symbol_risk_limits(SymbolID symbol_id, const RiskLimits &limits) const {
+            risk_manager->set_symbol_limits(symbol_id, limits);
+        }
+
+        // Ladder tick size for a symbol off the common grid; creates its book.
+        // Call before start(), while the book is empty.
+        bool set_symbol_tick_size(const SymbolID symbol_id, const Price tick_size) const {
+            return matching_shards[symbol_shard(symbol_id, shard_count())]->engine.configure_symbol_ladder(
+                symbol_id, tick_size);
+        }
+
+        // Pre-register symbols at startup so books and risk state are never
+        // created on the tick or order path
+        void register_symbols(std::span<const SymbolID> symbol_ids) const {
+            for (const SymbolID symbol_id: symbol_ids) {
+                register_symbol(symbol_id);
+            }
         }
 
-        // Market data subscription
-        void subscribe_symbol(SymbolID symbol_id) const {
-            market_data_gateway->subscribe_symbol(symbol_id);
+        // Market data subscription; false if the gateway could not take the
+        // symbol on (see MarketDataGateway::subscribe_symbol)
+        bool subscribe_symbol(SymbolID symbol_id) const {
+            register_symbol(symbol_id);
+            return market_data_gateway->subscribe_symbol(symbol_id);
         }
 
         void unsubscribe_symbol(SymbolID symbol_id) const {
             market_data_gateway->unsubscribe_symbol(symbol_id);
         }
 
+        // Replaces the synthetic feed; call before start()
+        void set_market_data_transport(std::unique_ptr<IFeedTransport> transport) const {
+            market_data_gateway->set_transport(std::move(transport));
+        }
+
+        // Capture mode, e.g. a CaptureWriter; call before start()
+        void set_market_data_recorder(std::unique_ptr<IFeedRecorder> recorder) const {
+            market_data_gateway->set_recorder(std::move(recorder));
+        }
+
         // Statistics and monitoring
         struct EngineStats {
             std::uint64_t orders_received;
             std::uint64_t orders_processed;
             std::uint64_t orders_rejected;
             std::uint64_t trades_executed;
+            std::uint64_t cancels_processed; // Cancel requests that reached matching
+            std::uint64_t amends_processed; // Amend requests that reached matching
+            std::uint64_t trade_notification_stalls; // Matching waited on a full notification ring
+            std::uint64_t trade_notifications_dropped; // Only while stopping
             double order_processing_rate;
             double uptime_seconds;
             MarketDataGateway::GatewayStats market_data_stats;
-            MatchingEngine::MatchingStats matching_stats;
+            MatchingEngine::MatchingStats matching_stats; // Summed over all shards
+            std::vector<MatchingEngine::MatchingStats> matching_shard_stats;
+            StrategyScheduler::SchedulerStats scheduler_stats;
+            StrategyFeedStats strategy_feed_stats; // Summed over all strategies
+            TickTracer::TraceReport trace_report; // Empty unless trace_sample_rate is set
+            JournalWriter::JournalStats journal_stats; // enabled false without a journal
+            // Every consumer loop with its wait policy: intake, matching shards
+            // and trade notifications, then the gateway's, the scheduler's and the journal's
+            std::vector<WaitStats> wait_stats;
         };
 
         [[nodiscard]] EngineStats get_statistics() const {
             auto now = std::chrono::steady_clock::now();
             auto uptime = std::chrono::duration_cast<std::chrono::seconds>(now - start_time);
 
-            uint64_t processed = orders_processed.load(std::memory_order_relaxed);
+            uint64_t processed = 0;
+            uint64_t cancels = 0;
+            uint64_t amends = 0;
+            MatchingEngine::MatchingStats matching_stats{};
+            std::vector<MatchingEngine::MatchingStats> shard_stats;
+            shard_stats.reserve(matching_shards.size());
+            for (const auto &shard: matching_shards) {
+                processed += shard->orders_processed.load(std::memory_order_relaxed);
+                cancels += shard->cancels_processed.load(std::memory_order_relaxed);
+                amends += shard->amends_processed.load(std::memory_order_relaxed);
+                shard_stats.push_back(shard->engine.get_statistics());
+                matching_stats += shard_stats.back();
+            }
             double processing_rate = uptime.count() > 0 ? static_cast<double>(processed) / uptime.count() : 0.0;
 
+            StrategyFeedStats feed_stats{};
+            for (const auto &strategy: strategies) {
+                feed_stats += strategy->get_feed_stats();
+            }
+
+            std::vector<WaitStats> wait_stats{intake_wait.get_statistics()};
+            if (config.pipeline == PipelineMode::Staged) {
+                for (const auto &shard: matching_shards) {
+                    wait_stats.push_back(shard->wait.get_statistics());
+                }
+                wait_stats.push_back(trade_wait.get_statistics());
+            }
+            for (const auto &loops: {market_data_gateway->get_wait_statistics(),
+                                     strategy_scheduler->get_wait_statistics()}) {
+                wait_stats.insert(wait_stats.end(), loops.begin(), loops.end());
+            }
+            if (journal) {
+                wait_stats.push_back(journal->get_wait_statistics());
+            }
+
             return EngineStats{
                 .orders_received = orders_received.load(std::memory_order_relaxed),
                 .orders_processed = processed,
                 .orders_rejected = orders_rejected.load(std::memory_order_relaxed),
                 .trades_executed = trades_executed.load(std::memory_order_relaxed),
+                .cancels_processed = cancels,
+                .amends_processed = amends,
+                .trade_notification_stalls = trade_notification_stalls.load(std::memory_order_relaxed),
+                .trade_notifications_dropped = trade_notifications_dropped.load(std::memory_order_relaxed),
                 .order_processing_rate = processing_rate,
                 .uptime_seconds = static_cast<double>(uptime.count()),
                 .market_data_stats = market_data_gateway->get_statistics(),
-                .matching_stats = matching_engine->get_statistics()
+                .matching_stats = matching_stats,
+                .matching_shard_stats = std::move(shard_stats),
+                .scheduler_stats = strategy_scheduler->get_statistics(),
+                .strategy_feed_stats = feed_stats,
+                .trace_report = TickTracer::report(),
+                .journal_stats = journal ? journal->get_statistics() : JournalWriter::JournalStats{},
+                .wait_stats = std::move(wait_stats)
             };
         }
 
@@ -202,13 +613,229 @@ namespace trading_engine {
             return risk_manager->get_position_info(symbol_id);
         }
 
+        struct RecoveryStats {
+            bool succeeded;
+            bool snapshot_loaded;
+            uint64_t snapshot_round;
+            uint64_t orders_restored; // Resting orders and stops loaded from the snapshot
+            uint64_t requests_replayed;
+            uint64_t trades_reapplied; // Snapshot positions brought up to their book
+            uint64_t records_scanned;
+            uint64_t segments_scanned;
+            uint64_t torn_segments; // Ended mid-record: the crash point
+            uint64_t sequence_gaps; // Shards whose replay stopped at a missing record
+            double elapsed_ms;
+        };
+
+        // Rebuilds books and positions from the journal: the newest snapshot,
+        // then every request each shard journaled after it. Call after the
+        // symbols are registered and before start(), which runs it otherwise.
+        RecoveryStats recover() {
+            const auto began = std::chrono::steady_clock::now();
+            RecoveryStats stats{};
+            if (!journal || recovered || engine_running.load(std::memory_order_acquire)) {
+                stats.succeeded = recovered;
+                return stats;
+            }
+
+#ifndef _WIN32
+            const JournalReader reader(config.journal.directory);
+            if (const uint32_t written_with = reader.shard_count(); written_with != 0 && written_with != shard_count()) {
+                // Orders were routed by the old shard count; replay would put them on the wrong books
+                std::cerr << "Journal was written with " << written_with << " matching shards, engine has "
+                        << shard_count() << std::endl;
+                return stats;
+            }
+
+            std::vector<uint64_t> applied(shard_count(), 0);
+            std::vector<uint64_t> snapshot_sequence(shard_count(), 0);
+            if (const auto snapshot = reader.load_snapshot(shard_count())) {
+                for (uint32_t shard = 0; shard < shard_count(); ++shard) {
+                    const ShardCheckpoint &checkpoint = snapshot->shards[shard];
+                    if (!matching_shards[shard]->engine.restore(checkpoint.books, checkpoint.orders,
+                                                                checkpoint.next_trade_id)) {
+                        std::cerr << "Journal snapshot does not fit matching shard " << shard << std::endl;
+                        return stats;
+                    }
+                    for (const RiskManager::PositionCheckpoint &position: checkpoint.positions) {
+                        risk_manager->restore_position(position);
+                    }
+                    applied[shard] = snapshot_sequence[shard] = checkpoint.sequence;
+                    stats.orders_restored += checkpoint.orders.size();
+                }
+                stats.snapshot_loaded = true;
+                stats.snapshot_round = snapshot->round;
+            }
+
+            RecoverySink sink{*risk_manager};
+            std::vector<bool> broken(shard_count(), false);
+            // Every segment kept holds requests after the snapshot or trades
+            // its positions had not booked, so replay reads them all
+            const JournalReader::ScanStats scanned = reader.scan(0, [&](const JournalRecord &record) {
+                const uint32_t shard = record.shard;
+                if (shard >= shard_count() || broken[shard]) {
+                    return;
+                }
+                if (record.sequence <= snapshot_sequence[shard]) {
+                    // Already in the books; a staged position may still be missing it
+                    if (record.type == JournalRecordType::Trade) {
+                        const Trade trade = record.trade();
+                        if (risk_manager->checkpoint_position(trade.symbol_id).last_trade_id < trade.trade_id) {
+                            sink.on_trade(trade);
+                            ++stats.trades_reapplied;
+                        }
+                    }
+                    return;
+                }
+                if (record.sequence <= applied[shard]) {
+                    return;
+                }
+                if (record.sequence != applied[shard] + 1) {
+                    broken[shard] = true;
+                    ++stats.sequence_gaps;
+                    return;
+                }
+
+                // Journaled trades after the snapshot come back from the replay itself
+                applied[shard] = record.sequence;
+                if (record.type == JournalRecordType::Request) {
+                    replay_request(matching_shards[shard]->engine, record.order(), sink);
+                    ++stats.requests_replayed;
+                }
+            });
+
+            for (uint32_t shard = 0; shard < shard_count(); ++shard) {
+                journal->log(shard).resume(applied[shard]);
+                // Recovery booked every trade it saw
+                MatchingShard &recovered_shard = *matching_shards[shard];
+                recovered_shard.trades_booked.store(recovered_shard.engine.get_next_trade_id() - 1,
+                                                    std::memory_order_relaxed);
+            }
+            stats.records_scanned = scanned.records;
+            stats.segments_scanned = scanned.segments;
+            stats.torn_segments = scanned.torn_segments;
+            stats.succeeded = true;
+            recovered = true;
+#endif
+
+            stats.elapsed_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - began).count();
+            if (stats.succeeded) {
+                std::cout << "Journal recovered: " << stats.orders_restored << " orders from snapshot, "
+                        << stats.requests_replayed << " requests replayed in " << stats.elapsed_ms << " ms"
+                        << std::endl;
+            }
+            return stats;
+        }
+
     private:
+        template<typename Strategy>
+        void connect_strategy(Strategy &strategy) {
+            strategy.set_order_callback([this](const Order &order) {
+                return submit_order(order);
+            });
+
+            strategy.set_cancel_callback([this](OrderID order_id) {
+                cancel_order(order_id);
+            });
+        }
+
+        void register_symbol(SymbolID symbol_id) const {
+            order_book_manager->register_symbol(symbol_id);
+            risk_manager->register_symbol(symbol_id);
+            matching_shards[symbol_shard(symbol_id, shard_count())]->engine.register_symbol(symbol_id);
+        }
+
+        [[nodiscard]] uint32_t shard_count() const noexcept {
+            return static_cast<uint32_t>(matching_shards.size());
+        }
+
+        // Shard an order or cancel belongs to, from the ID submit_order stamped
+        [[nodiscard]] MatchingShard &shard_for(const Order &order) const noexcept {
+            const uint32_t shard = shard_of(order.orderID);
+            return *matching_shards[shard < matching_shards.size() ? shard : 0];
+        }
+
+        // Topology roles take over the matching gateway and scheduler placements
+        void apply_topology() {
+            config.matching_shards = config.pipeline == PipelineMode::Inline
+                                         ? 1
+                                         : std::clamp<uint32_t>(config.matching_shards, 1, MaxMatchingShards);
+
+            const ThreadTopology &topology = config.topology;
+            if (topology.receiver.configured()) {
+                config.gateway.receiver = topology.receiver;
+            }
+            if (topology.gateway_shards.configured()) {
+                config.gateway.shards = topology.gateway_shards;
+            }
+            if (topology.strategies.configured()) {
+                config.scheduler.workers = topology.strategies;
+            }
+            if (topology.journal.configured()) {
+                config.journal.placement = topology.journal;
+            }
+        }
+
+        [[nodiscard]] const WaitConfig &intake_wait_config() const noexcept {
+            return config.pipeline == PipelineMode::Inline
+                       ? wait_config_for(config.matching_wait, config.matching_shard_waits, 0)
+                       : config.risk_wait;
+        }
+
+        // Shutdown: parked loops re-check engine_running
+        void wake_consumers() noexcept {
+            intake_wake.wake_all();
+            trade_wake.wake_all();
+            for (const auto &shard: matching_shards) {
+                shard->wake.wake_all();
+            }
+        }
+
+        // Thread that runs risk checks: its own in the staged pipeline, the
+        // matching thread when inline
+        [[nodiscard]] const ThreadPlacement &risk_placement() const noexcept {
+            return config.pipeline == PipelineMode::Inline ? config.topology.matching : config.topology.risk;
+        }
+
         void initialize_components() {
-            // Create core components
-            order_book_manager = std::make_unique<OrderBookManager>();
-            market_data_gateway = std::make_unique<MarketDataGateway>(order_book_manager.get());
-            risk_manager = std::make_unique<RiskManager>();
-            matching_engine = std::make_unique<MatchingEngine>();
+            // Create core components, each on the node of the thread that works it
+            const int book_node = config.gateway.shards.numa_node();
+            const int risk_node = risk_placement().numa_node();
+
+            order_book_manager = make_node_local<OrderBookManager>(book_node);
+            order_book_manager->place_on_node(book_node);
+            market_data_gateway = std::make_unique<MarketDataGateway>(order_book_manager.get(), config.gateway);
+            risk_manager = make_node_local<RiskManager>(risk_node);
+            risk_batch = make_node_local<RiskBatch>(risk_node);
+
+            const ThreadPlacement &matching = config.topology.matching;
+            std::vector<int> shard_nodes;
+            matching_shards.reserve(config.matching_shards);
+            for (uint32_t shard = 0; shard < config.matching_shards; ++shard) {
+                const int node = matching.pinned() ? numa_node_of_cpu(matching.core_for(shard)) : -1;
+                shard_nodes.push_back(node);
+                matching_shards.push_back(make_node_local<MatchingShard>(
+                    node, shard, config.price_tick_size,
+                    wait_config_for(config.matching_wait, config.matching_shard_waits, shard)));
+            }
+
+            // Each shard's journal ring sits with its matching thread; a
+            // checkpoint request rings whatever that thread parks on
+            if (!config.journal.directory.empty()) {
+                journal = std::make_unique<JournalWriter>(config.journal, shard_nodes);
+                for (uint32_t shard = 0; shard < shard_count(); ++shard) {
+                    JournalWriter::ShardLog &log = journal->log(shard);
+                    log.set_wake(config.pipeline == PipelineMode::Inline ? &intake_wake : &matching_shards[shard]->wake);
+                    matching_shards[shard]->journal = &log;
+                }
+            }
+
+            incoming_orders = make_node_local<MPMCQueue<Order, 4096> >(risk_node);
+            trade_notifications = make_node_local<MPSCQueue<Trade, 2048> >(
+                config.topology.trade_notifications.numa_node());
+
+            strategy_scheduler = std::make_unique<StrategyScheduler>(config.scheduler);
 
             // Set up callbacks
             setup_callbacks();
@@ -226,29 +853,30 @@ namespace trading_engine {
                 }
             );
 
-            // Matching engine callbacks
-            matching_engine->set_trade_callback([this](const Trade &trade) {
-                on_trade_executed(trade);
-            });
-
-            matching_engine->set_order_update_callback([this](const Order &order) {
-                on_order_update(order);
-            });
         }
 
         void start_worker_threads() {
             try {
-                // Order processing thread
-                worker_threads.emplace_back(&TradingEngine::order_processing_loop, this);
+                if (config.pipeline == PipelineMode::Inline) {
+                    // One thread: risk check, match and position update
+                    worker_threads.emplace_back(&TradingEngine::inline_order_loop, this);
+                } else {
+                    // Order processing threads, one per matching shard
+                    for (uint32_t shard = 0; shard < shard_count(); ++shard) {
+                        worker_threads.emplace_back(&TradingEngine::order_processing_loop, this, shard);
+                    }
 
-                // Risk management thread
-                worker_threads.emplace_back(&TradingEngine::risk_processing_loop, this);
+                    // Risk management thread
+                    worker_threads.emplace_back(&TradingEngine::risk_processing_loop, this);
+                }
 
-                // Strategy processing thread
-                worker_threads.emplace_back(&TradingEngine::strategy_processing_loop, this);
+                // Strategy workers wake on incoming data instead of polling
+                strategy_scheduler->start();
 
                 // Trade notification thread
-                worker_threads.emplace_back(&TradingEngine::trade_notification_loop, this);
+                if (config.pipeline == PipelineMode::Staged) {
+                    worker_threads.emplace_back(&TradingEngine::trade_notification_loop, this);
+                }
             } catch (const std::exception &e) {
                 std::cerr << "Exception creating worker threads: " << e.what() << std::endl;
                 engine_running.store(false, std::memory_order_release);
@@ -258,106 +886,299 @@ namespace trading_engine {
             }
         }
 
-        void order_processing_loop() {
+        static void place_worker_thread(const ThreadPlacement &placement, const char *role,
+                                        const uint32_t instance = 0) {
+            if (!place_current_thread(placement, instance)) {
+                std::cerr << role << " thread " << instance << ": placement not applied" << std::endl;
+            }
+        }
+
+        void order_processing_loop(const uint32_t shard_index) {
+            place_worker_thread(config.topology.matching, "Matching", shard_index);
+            MatchingShard &shard = *matching_shards[shard_index];
+            MatchingEngine &matching = shard.engine;
+            const auto ready = [this, &shard] {
+                return !shard.orders.empty() || checkpoint_due(shard) ||
+                       !engine_running.load(std::memory_order_acquire);
+            };
+
+            shard.wait.begin();
             try {
-                Order order;
+                std::array<Order, MatchingBatchSize> orders;
+                NotificationSink sink{*trade_notifications, trade_wake, execution_listener, shard.journal, *this};
 
                 while (engine_running.load(std::memory_order_acquire)) {
-                    if (risk_approved_orders.try_pop(order)) {
+                    // Between bursts, so the checkpoint sits on a request boundary
+                    if (UNLIKELY(checkpoint_due(shard))) {
+                        capture_checkpoint(shard, *shard.journal);
+                    }
+
+                    // Drain a burst per index update rather than one order at a time
+                    const size_t count = shard.orders.try_pop_bulk(orders);
+                    if (count == 0) {
+                        matching.maintain_pools();
+                        shard.wait.idle(ready);
+                        continue;
+                    }
+                    shard.wait.on_work();
+
+                    uint64_t processed = 0;
+                    for (size_t i = 0; i < count; ++i) {
+                        Order &order = orders[i];
+                        journal_request(shard, order);
+                        if (UNLIKELY(order.action != OrderAction::New)) {
+                            process_cancel_or_amend(shard, order, sink);
+                            continue;
+                        }
+
                         MEASURE_LATENCY_BLOCK(
                             LatencyProfiler::Order_processing, {
-                            // Process the order through matching engine
-                            auto result = matching_engine->process_order(order);
-                            orders_processed.fetch_add(1, std::memory_order_relaxed);
-
-                            // Notify about trades
-                            for (const Trade* trade : result.trades) {
-                                if (!trade_notifications.try_push(*trade)) {
-                                    std::cerr << "Trade notification queue overflow!" << std::endl;
-                                }
-                            }
+                            // Fills go straight into the notification ring
+                            process_new_order(matching, order, sink);
+                            TickTracer::complete(order.traceID, TickTracer::Stage::Matched);
                             }
                         );
-                    } else {
-                        std::this_thread::yield();
+                        ++processed;
                     }
+                    shard.orders_processed.fetch_add(processed, std::memory_order_relaxed);
                 }
             } catch (const std::exception &e) {
                 std::cerr << "Exception in order_processing_loop: " << e.what() << std::endl;
             } catch (...) {
                 std::cerr << "Unknown exception in order_processing_loop" << std::endl;
             }
+            shard.wait.end();
         }
 
-        void risk_processing_loop() {
-            try {
-                Order order;
+        void inline_order_loop() {
+            place_worker_thread(config.topology.matching, "Matching");
+            MatchingShard &shard = *matching_shards.front();
+            MatchingEngine &matching = shard.engine;
+            InlineSink sink{*this, shard.journal};
+            const auto ready = [this, &shard] { return intake_ready() || checkpoint_due(shard); };
 
+            intake_wait.begin();
+            try {
                 while (engine_running.load(std::memory_order_acquire)) {
-                    if (incoming_orders.try_pop(order)) {
-                        // Check risk limits
-                        auto risk_result = risk_manager->check_order(order);
-
-                        if (risk_result == RiskManager::RiskResult::approved) {
-                            if (!risk_approved_orders.try_push(order)) {
-                                // Risk approved queue full - critical error
-                                orders_rejected.fetch_add(1, std::memory_order_relaxed);
-                            }
-                        } else {
-                            // Order rejected by risk management
-                            orders_rejected.fetch_add(1, std::memory_order_relaxed);
+                    if (UNLIKELY(checkpoint_due(shard))) {
+                        capture_checkpoint(shard, *shard.journal);
+                    }
 
-                            // Update order status and notify
-                            Order rejected_order = order;
-                            rejected_order.status = OrderStatus::Rejected;
-                            on_order_update(rejected_order);
+                    if (!collect_risk_batch()) {
+                        matching.maintain_pools();
+                        intake_wait.idle(ready);
+                        continue;
+                    }
+                    intake_wait.on_work();
+
+                    const auto orders = risk_batch->orders();
+                    const auto results = risk_batch->results();
+                    for (size_t i = 0; i < orders.size(); ++i) {
+                        if (results[i] != RiskManager::RiskResult::approved) {
+                            reject_order(orders[i]);
+                            continue;
                         }
-                    } else {
-                        std::this_thread::yield();
+                        Order order = orders[i];
+                        journal_request(shard, order);
+                        if (UNLIKELY(order.action != OrderAction::New)) {
+                            process_cancel_or_amend(shard, order, sink);
+                            continue;
+                        }
+                        TickTracer::stamp(order.traceID, TickTracer::Stage::RiskChecked);
+
+                        MEASURE_LATENCY_BLOCK(
+                            LatencyProfiler::Order_processing, {
+                            // Fills are applied in place; no trade notification hop
+                            process_new_order(matching, order, sink);
+                            shard.orders_processed.fetch_add(1, std::memory_order_relaxed);
+                            TickTracer::complete(order.traceID, TickTracer::Stage::Matched);
+                            }
+                        );
                     }
+                    risk_batch->clear();
                 }
             } catch (const std::exception &e) {
-                std::cerr << "Exception in risk_processing_loop: " << e.what() << std::endl;
+                std::cerr << "Exception in inline_order_loop: " << e.what() << std::endl;
             } catch (...) {
-                std::cerr << "Unknown exception in risk_processing_loop" << std::endl;
+                std::cerr << "Unknown exception in inline_order_loop" << std::endl;
             }
+            intake_wait.end();
         }
 
-        void strategy_processing_loop() const {
+        void risk_processing_loop() {
+            place_worker_thread(config.topology.risk, "Risk");
+            const auto ready = [this] { return intake_ready(); };
+
+            intake_wait.begin();
             try {
                 while (engine_running.load(std::memory_order_acquire)) {
-                    // Process all strategies
-                    for (auto &strategy: strategies) {
-                        if (strategy->is_enabled()) {
-                            strategy->process_signals();
-                        }
+                    if (!collect_risk_batch()) {
+                        intake_wait.idle(ready);
+                        continue;
                     }
+                    intake_wait.on_work();
 
-                    // Small sleep to prevent excessive CPU usage
-                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    const auto orders = risk_batch->orders();
+                    const auto results = risk_batch->results();
+                    for (size_t i = 0; i < orders.size(); ++i) {
+                        if (results[i] != RiskManager::RiskResult::approved) {
+                            // Order rejected by risk management
+                            reject_order(orders[i]);
+                            continue;
+                        }
+
+                        // An approved linked group's legs are adjacent and
+                        // share a shard; they are queued together or not at all
+                        const size_t legs = orders[i].linkID != 0 ? std::max<size_t>(orders[i].legCount, 1) : 1;
+                        const auto group = orders.subspan(i, std::min(legs, orders.size() - i));
+                        for (const Order &leg: group) {
+                            TickTracer::stamp(leg.traceID, TickTracer::Stage::RiskChecked);
+                        }
+                        MatchingShard &shard = shard_for(orders[i]);
+                        if (group.size() <= shard.orders.capacity() - shard.orders.size() &&
+                            shard.orders.try_push_bulk(group) == group.size()) {
+                            shard.wake.notify();
+                        } else {
+                            // Shard queue full: reject every leg, so the
+                            // submitter hears the order is gone
+                            for (const Order &leg: group) {
+                                reject_order(leg);
+                            }
+                        }
+                        i += group.size() - 1;
+                    }
+                    risk_batch->clear();
                 }
             } catch (const std::exception &e) {
-                std::cerr << "Exception in strategy_processing_loop: " << e.what() << std::endl;
+                std::cerr << "Exception in risk_processing_loop: " << e.what() << std::endl;
             } catch (...) {
-                std::cerr << "Unknown exception in strategy_processing_loop" << std::endl;
+                std::cerr << "Unknown exception in risk_processing_loop" << std::endl;
+            }
+            intake_wait.end();
+        }
+
+        // More orders to check, staged legs to time out, or time to stop
+        [[nodiscard]] bool intake_ready() const noexcept {
+            return !incoming_orders->empty() || risk_batch->staged_legs() > 0 ||
+                   !engine_running.load(std::memory_order_acquire);
+        }
+
+        // Drains a burst of incoming orders and risk-checks it in one call
+        bool collect_risk_batch() {
+            if (risk_batch->fill_from(*incoming_orders) == 0) {
+                return false;
+            }
+            risk_batch->check(*risk_manager);
+            return true;
+        }
+
+        // The shard's matching thread only; a new order reusing an open
+        // order's ID is refused, and the listener hears so
+        template<typename Sink>
+        static FORCE_INLINE void process_new_order(MatchingEngine &matching, const Order &order, Sink &sink) {
+            if (UNLIKELY(matching.process_order(order, sink).duplicate)) {
+                sink.on_request_missed(order);
+            }
+        }
+
+        // The shard's matching thread only; a miss means the order already
+        // filled or never rested, or the amend named another symbol or side.
+        // The listener hears the request failed.
+        template<typename Sink>
+        static void process_cancel_or_amend(MatchingShard &shard, const Order &request, Sink &sink) {
+            bool found;
+            if (request.action == OrderAction::Cancel) {
+                found = shard.engine.cancel_order(request.orderID, sink);
+                shard.cancels_processed.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                found = shard.engine.amend_order(request, sink);
+                shard.amends_processed.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (UNLIKELY(!found)) {
+                sink.on_request_missed(request);
             }
         }
 
+        [[nodiscard]] static FORCE_INLINE bool checkpoint_due(const MatchingShard &shard) noexcept {
+            return shard.journal != nullptr && shard.journal->checkpoint_due();
+        }
+
+        // Logs a request as matching is about to apply it. An amend is timed
+        // here, so a replay re-queues it at the same time.
+        static FORCE_INLINE void journal_request(const MatchingShard &shard, Order &request) noexcept {
+            if (request.action == OrderAction::Modify) {
+                request.timestamp = TimestampManager::get_hardware_timestamp();
+            }
+            if (shard.journal != nullptr) {
+                shard.journal->append_request(request);
+            }
+        }
+
+        // The shard's matching thread, or any thread once matching has
+        // stopped. Positions are read under their seqlock; in the staged
+        // pipeline they may trail the book by the trades still in flight.
+        void capture_checkpoint(MatchingShard &shard, JournalWriter::ShardLog &log) const {
+            MatchingEngine &matching = shard.engine;
+            ShardCheckpoint &checkpoint = log.begin_checkpoint();
+            matching.checkpoint(checkpoint.books, checkpoint.orders);
+            checkpoint.next_trade_id = matching.get_next_trade_id();
+            // Read before the positions, so they hold at least this much;
+            // inline, they hold every trade the book printed
+            checkpoint.trades_booked = config.pipeline == PipelineMode::Inline
+                                           ? checkpoint.next_trade_id - 1
+                                           : shard.trades_booked.load(std::memory_order_acquire);
+            for (const MatchingEngine::BookCheckpoint &book: checkpoint.books) {
+                checkpoint.positions.push_back(risk_manager->checkpoint_position(book.symbol_id));
+            }
+            log.publish_checkpoint();
+        }
+
+        template<typename Sink>
+        static void replay_request(MatchingEngine &matching, const Order &request, Sink &sink) {
+            if (request.action == OrderAction::New) {
+                (void) matching.process_order(request, sink);
+            } else if (request.action == OrderAction::Cancel) {
+                (void) matching.cancel_order(request.orderID, sink);
+            } else {
+                (void) matching.amend_order(request, sink);
+            }
+        }
+
+        void reject_order(const Order &order) {
+            orders_rejected.fetch_add(1, std::memory_order_relaxed);
+            TickTracer::complete(order.traceID, TickTracer::Stage::RiskChecked);
+
+            // Update order status and notify
+            Order rejected_order = order;
+            rejected_order.status = OrderStatus::Rejected;
+            on_order_update(execution_listener, rejected_order);
+        }
+
         void trade_notification_loop() {
+            place_worker_thread(config.topology.trade_notifications, "Trade notification");
+            const auto ready = [this] {
+                return !trade_notifications->empty() || !engine_running.load(std::memory_order_acquire);
+            };
+
+            trade_wait.begin();
             try {
                 Trade trade{};
 
                 while (engine_running.load(std::memory_order_acquire)) {
-                    if (trade_notifications.try_pop(trade)) {
+                    if (trade_notifications->try_pop(trade)) {
+                        trade_wait.on_work();
+
                         // Update risk manager with trade information
                         risk_manager->update_position(trade);
+                        note_trade_booked(trade);
 
                         // Update reference prices for risk checks
                         risk_manager->update_reference_price(trade.symbol_id, trade.price);
 
+                        on_trade_executed(trade);
                         trades_executed.fetch_add(1, std::memory_order_relaxed);
                     } else {
-                        std::this_thread::yield();
+                        trade_wait.idle(ready);
                     }
                 }
             } catch (const std::exception &e) {
@@ -365,38 +1186,51 @@ namespace trading_engine {
             } catch (...) {
                 std::cerr << "Unknown exception in trade_notification_loop" << std::endl;
             }
+            trade_wait.end();
         }
 
         void on_market_tick(const MarketTick &tick) const {
-            // Forward to strategies
-            for (auto &strategy: strategies) {
-                if (strategy->get_symbol_id() == tick.symbol_id) {
-                    strategy->on_market_data(tick);
-                }
+            // Forward to subscribed strategies and wake their workers
+            for (const auto &[strategy, index]: subscriptions.subscribers(tick.symbol_id)) {
+                strategy->on_market_data(tick);
+                strategy_scheduler->notify(index);
             }
         }
 
         void on_book_snapshot(SymbolID symbol_id, const OrderBook<1000>::BookSnapshot &snapshot) const {
             // Forward to strategies
-            for (auto &strategy: strategies) {
-                if (strategy->get_symbol_id() == symbol_id) {
-                    strategy->on_book_snapshot(snapshot);
-                }
+            for (const auto &[strategy, index]: subscriptions.subscribers(symbol_id)) {
+                strategy->on_book_snapshot(symbol_id, snapshot);
+                strategy_scheduler->notify(index);
             }
         }
 
         void on_trade_executed(const Trade &trade) const {
             // Forward to strategies
-            for (auto &strategy: strategies) {
-                if (strategy->get_symbol_id() == trade.symbol_id) {
-                    strategy->on_trade(trade);
-                }
+            for (const auto &[strategy, index]: subscriptions.subscribers(trade.symbol_id)) {
+                strategy->on_trade(trade);
+                strategy_scheduler->notify(index);
+            }
+        }
+
+        // Trade notification thread; a shard's trades arrive in the order it printed them
+        void note_trade_booked(const Trade &trade) const noexcept {
+            if (const uint32_t shard = shard_of(trade.trade_id); shard < matching_shards.size()) {
+                matching_shards[shard]->trades_booked.store(trade.trade_id, std::memory_order_release);
             }
         }
 
-        static void on_order_update([[maybe_unused]] const Order &order) {
-            // Log order updates, send to external systems, etc.
-            // This could be extended to notify external order management systems
+        static void on_order_update(IExecutionListener *listener, const Order &order) {
+            // External order management hears about it through the listener
+            if (UNLIKELY(listener != nullptr)) {
+                listener->on_order_update(order);
+            }
+        }
+
+        static void on_request_missed(IExecutionListener *listener, const Order &request) {
+            if (UNLIKELY(listener != nullptr)) {
+                listener->on_request_missed(request);
+            }
         }
     };
 }
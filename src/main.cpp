@@ -2,7 +2,10 @@
 #include <csignal>
 #include <iostream>
 #include <thread>
+
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 #include "engine/trading_engine.h"
 
@@ -12,6 +15,17 @@ using namespace trading_engine;
 std::unique_ptr<TradingEngine> g_engine;
 std::atomic<bool> g_shutdown_requested{false};
 
+void print_latency(const char *name, const LatencyProfiler::ProfileResults &latency) {
+    std::cout << name << " - Avg: " << latency.avg_latency_us
+            << "μs, p50: " << latency.p50_latency_us
+            << "μs, p90: " << latency.p90_latency_us
+            << "μs, p99: " << latency.p99_latency_us
+            << "μs, p99.9: " << latency.p999_latency_us
+            << "μs, p99.99: " << latency.p9999_latency_us
+            << "μs, Max: " << latency.max_latency_us << "μs, Samples: "
+            << latency.sample_count << "\n";
+}
+
 void print_statistics(const TradingEngine &engine) {
     const auto stats = engine.get_statistics();
 
@@ -27,9 +41,21 @@ void print_statistics(const TradingEngine &engine) {
     std::cout << "Messages Received: " << stats.market_data_stats.total_messages_received << "\n";
     std::cout << "Messages Processed: " << stats.market_data_stats.total_messages_processed << "\n";
     std::cout << "Parsing Errors: " << stats.market_data_stats.total_parsing_errors << "\n";
+    std::cout << "Packets Truncated: " << stats.market_data_stats.packets_truncated << "\n";
     std::cout << "Active Symbols: " << stats.market_data_stats.active_symbols << "\n";
     std::cout << "Processing Rate: " << stats.market_data_stats.processing_rate_per_second << " msg/sec\n";
 
+    std::cout << "\n--- Strategy Feed Stats ---\n";
+    std::cout << "Ticks Received: " << stats.strategy_feed_stats.ticks_received
+            << ", Dropped: " << stats.strategy_feed_stats.ticks_dropped
+            << ", Conflated: " << stats.strategy_feed_stats.ticks_conflated << "\n";
+    std::cout << "Snapshots Received: " << stats.strategy_feed_stats.snapshots_received
+            << ", Dropped: " << stats.strategy_feed_stats.snapshots_dropped
+            << ", Conflated: " << stats.strategy_feed_stats.snapshots_conflated << "\n";
+    std::cout << "Trades Dropped: " << stats.strategy_feed_stats.trades_dropped << "\n";
+    std::cout << "Strategy Activations: " << stats.scheduler_stats.activations
+            << " (stolen: " << stats.scheduler_stats.steals << ", parks: " << stats.scheduler_stats.parks << ")\n";
+
     std::cout << "\n--- Matching Engine Stats ---\n";
     std::cout << "Total Orders: " << stats.matching_stats.total_orders << "\n";
     std::cout << "Total Trades: " << stats.matching_stats.total_trades << "\n";
@@ -37,6 +63,14 @@ void print_statistics(const TradingEngine &engine) {
     std::cout << "Match Rate: " << (stats.matching_stats.match_rate * 100.0) << "%\n";
     std::cout << "Average Fill Size: " << stats.matching_stats.average_fill_size << "\n";
 
+    std::cout << "\n--- Idle Loops ---\n";
+    for (const WaitStats &wait: stats.wait_stats) {
+        std::cout << wait.role << " " << wait.instance << " (" << to_string(wait.policy) << "): "
+                << wait.wakeups << " wakeups, " << wait.parks << " parks, wake "
+                << wait.mean_wake_latency_ns << "ns avg / " << wait.max_wake_latency_ns << "ns max, CPU "
+                << (wait.cpu_utilisation * 100.0) << "%\n";
+    }
+
     // Show latency profiles
     std::cout << "\n--- Latency Profiles ---\n";
     const auto order_latency = LatencyProfiler::get_stats(LatencyProfiler::Order_processing);
@@ -45,25 +79,22 @@ void print_statistics(const TradingEngine &engine) {
     const auto risk_latency = LatencyProfiler::get_stats(LatencyProfiler::Risk_check);
     const auto strategy_latency = LatencyProfiler::get_stats(LatencyProfiler::Strategy_signal);
 
-    std::cout << "Order Processing - Avg: " << order_latency.avg_latency_us
-            << "μs, Max: " << order_latency.max_latency_us << "μs, Samples: "
-            << order_latency.sample_count << "\n";
-
-    std::cout << "Market Data - Avg: " << md_latency.avg_latency_us
-            << "μs, Max: " << md_latency.max_latency_us << "μs, Samples: "
-            << md_latency.sample_count << "\n";
-
-    std::cout << "Order Matching - Avg: " << matching_latency.avg_latency_us
-            << "μs, Max: " << matching_latency.max_latency_us << "μs, Samples: "
-            << matching_latency.sample_count << "\n";
-
-    std::cout << "Risk Checks - Avg: " << risk_latency.avg_latency_us
-            << "μs, Max: " << risk_latency.max_latency_us << "μs, Samples: "
-            << risk_latency.sample_count << "\n";
-
-    std::cout << "Strategy Signals - Avg: " << strategy_latency.avg_latency_us
-            << "μs, Max: " << strategy_latency.max_latency_us << "μs, Samples: "
-            << strategy_latency.sample_count << "\n";
+    print_latency("Order Processing", order_latency);
+    print_latency("Market Data", md_latency);
+    print_latency("Order Matching", matching_latency);
+    print_latency("Risk Checks", risk_latency);
+    print_latency("Strategy Signals", strategy_latency);
+
+    if (const auto &trace = stats.trace_report; trace.traces_started > 0) {
+        std::cout << "\n--- Tick-to-Trade Traces ---\n";
+        std::cout << "Traces Started: " << trace.traces_started
+                << ", Completed: " << trace.traces_completed
+                << ", Dropped: " << trace.traces_dropped << "\n";
+        for (size_t stage = 1; stage < TickTracer::StageCount; ++stage) {
+            print_latency(TickTracer::stage_name(static_cast<TickTracer::Stage>(stage)), trace.stage_latency[stage]);
+        }
+        print_latency("Tick to Trade", trace.tick_to_trade);
+    }
 
     std::cout << "================================\n\n";
 }
@@ -74,15 +105,18 @@ void signal_handler(int signal) {
 }
 
 int main() {
+#ifdef _WIN32
     // Set console output to UTF-8 for better character support
     SetConsoleOutputCP(CP_UTF8);
+#endif
 
     // Set up signal handling for graceful shutdown
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
     try {
-        g_engine = std::make_unique<TradingEngine>();
+        // Trace one tick in a thousand through the whole pipeline
+        g_engine = std::make_unique<TradingEngine>(EngineConfig{.trace_sample_rate = 1000});
         std::cout << "Trading engine created successfully." << std::endl;
 
         // Start the full trading engine
@@ -0,0 +1,796 @@
+#pragma once
+
+#include "../core/types.h"
+#include "../core/memory.h"
+#include "transport.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <ctime>
+#endif
+
+namespace trading_engine {
+    // Receives everything the gateway takes in, on the receiver thread
+    class IFeedRecorder {
+    public:
+        virtual ~IFeedRecorder() = default;
+
+        virtual void record_packet(const PacketView &packet) = 0;
+
+        virtual void record_tick(const MarketTick &tick) = 0;
+
+        // Makes recorded data visible to readers; called when the gateway stops
+        virtual void flush() = 0;
+    };
+
+    // Capture journal layout: a file header, then records, each a
+    // CaptureRecordHeader and its payload (raw packet bytes or a MarketTick),
+    // then a sparse index written on close. A journal that was never closed has
+    // no index; readers then scan up to the first zeroed record header.
+    //
+    // Records start on CaptureAlignment boundaries and the header is that size,
+    // so payloads are as aligned as the receive buffers and messages can be
+    // parsed in place from the mapping.
+    constexpr size_t CaptureAlignment = 32;
+
+    constexpr size_t capture_align(const size_t bytes) noexcept {
+        return (bytes + CaptureAlignment - 1) & ~(CaptureAlignment - 1);
+    }
+
+    enum class CaptureRecordType : uint8_t {
+        End = 0, // Unwritten space
+        Packet = 1,
+        Tick = 2
+    };
+
+    struct CaptureFileHeader {
+        static constexpr uint64_t Magic = 0x31504143444D4554ULL; // "TEMDCAP1"
+        static constexpr uint32_t CurrentVersion = 2; // 2: 48-byte MarketTick records
+
+        uint64_t magic;
+        uint32_t version;
+        uint32_t header_size;
+        uint64_t data_end; // Offset past the last record; 0 if not yet flushed
+        uint64_t record_count;
+        uint64_t index_offset;
+        uint64_t index_count;
+        uint64_t first_timestamp_ns;
+        uint64_t last_timestamp_ns;
+    };
+
+    struct CaptureRecordHeader {
+        uint32_t length; // Payload bytes
+        CaptureRecordType type;
+        uint8_t feed;
+        uint16_t channel;
+        uint64_t timestamp_ns; // CLOCK_REALTIME receive time (NIC stamp when available)
+        uint64_t sequence; // First message's sequence for packets, MarketTick::sequence for ticks
+        uint64_t reserved;
+    };
+
+    static_assert(sizeof(CaptureRecordHeader) == CaptureAlignment);
+
+    // One entry per IndexInterval records
+    struct CaptureIndexEntry {
+        uint64_t timestamp_ns;
+        uint64_t sequence;
+        uint64_t record_number;
+        uint64_t offset;
+    };
+
+    struct CaptureRecord {
+        const CaptureRecordHeader *header;
+        const uint8_t *payload;
+    };
+
+#ifndef _WIN32
+    // Append-only, memory-mapped capture writer. Single-threaded: the gateway
+    // calls it from its receiver thread. The file sits in one address range
+    // reserved on open and grows by fixed extents, which a helper thread
+    // extends and pre-faults while the writer is still half an extent short
+    // of the end. A record is one memcpy into mapped memory, and growth never
+    // unmaps or faults in anything on the receive path.
+    class CaptureWriter final : public IFeedRecorder {
+    public:
+        static constexpr size_t IndexInterval = 4096;
+        static constexpr size_t DefaultReserveBytes = 64ULL << 20; // Per extent
+        static constexpr size_t DefaultMaxBytes = 1ULL << 40; // Address space only; pages come with the extents
+
+    private:
+        int fd{-1};
+        uint8_t *base{nullptr};
+        size_t reserved_bytes{0};
+        size_t extent_bytes{0};
+        std::atomic<size_t> mapped_bytes{0}; // Grown by the extender, read by the writer
+        size_t write_offset{0};
+        uint64_t records{0};
+        uint64_t first_timestamp{0};
+        uint64_t last_timestamp{0};
+        std::vector<CaptureIndexEntry> index;
+        bool failed{false};
+
+        // Extends the mapping ahead of the writer
+        std::thread extender;
+        std::mutex extend_mutex; // Serialises extensions
+        std::condition_variable extend_wake;
+        std::atomic<bool> extend_pending{false};
+        bool extender_stopping{false};
+        std::atomic<uint64_t> writer_extensions{0}; // The writer caught up and had to extend itself
+
+    public:
+        CaptureWriter() = default;
+
+        ~CaptureWriter() override {
+            close();
+        }
+
+        CaptureWriter(const CaptureWriter &) = delete;
+
+        CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+        // Truncates any existing file. The file grows reserve_bytes at a time
+        // up to max_bytes.
+        bool open(const std::string &path, const size_t reserve_bytes = DefaultReserveBytes,
+                  const size_t max_bytes = DefaultMaxBytes) {
+            close();
+
+            fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) {
+                return false;
+            }
+
+            write_offset = capture_align(sizeof(CaptureFileHeader));
+            records = 0;
+            first_timestamp = 0;
+            last_timestamp = 0;
+            index.clear();
+            failed = false;
+            writer_extensions.store(0, std::memory_order_relaxed);
+
+            const auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            extent_bytes = (std::max(reserve_bytes, write_offset + 4096) + page - 1) / page * page;
+            reserved_bytes = (std::max(max_bytes, extent_bytes) + page - 1) / page * page;
+
+            // PROT_NONE and unbacked: address space, not memory
+            void *range = ::mmap(nullptr, reserved_bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                                 -1, 0);
+            if (range == MAP_FAILED) {
+                close();
+                return false;
+            }
+            base = static_cast<uint8_t *>(range);
+
+            if (!extend_to(extent_bytes)) {
+                close();
+                return false;
+            }
+
+            *header() = CaptureFileHeader{
+                .magic = CaptureFileHeader::Magic,
+                .version = CaptureFileHeader::CurrentVersion,
+                .header_size = sizeof(CaptureFileHeader),
+                .data_end = 0,
+                .record_count = 0,
+                .index_offset = 0,
+                .index_count = 0,
+                .first_timestamp_ns = 0,
+                .last_timestamp_ns = 0
+            };
+
+            extender_stopping = false;
+            extender = std::thread(&CaptureWriter::extend_loop, this);
+            return true;
+        }
+
+        // Writes the index, trims the file and unmaps it
+        void close() {
+            if (extender.joinable()) {
+                {
+                    std::lock_guard lock(extend_mutex);
+                    extender_stopping = true;
+                }
+                extend_wake.notify_one();
+                extender.join();
+            }
+
+            if (fd < 0) {
+                return;
+            }
+
+            if (base != nullptr) {
+                if (mapped_bytes.load(std::memory_order_relaxed) > 0) {
+                    const size_t index_bytes = index.size() * sizeof(CaptureIndexEntry);
+                    if (!failed && reserve(index_bytes)) {
+                        std::memcpy(base + write_offset, index.data(), index_bytes);
+                        publish_header(write_offset, index.size());
+                        write_offset += index_bytes;
+                    } else {
+                        publish_header(0, 0);
+                    }
+                }
+                ::munmap(base, reserved_bytes);
+                base = nullptr;
+            }
+
+            if (::ftruncate(fd, static_cast<off_t>(write_offset)) != 0) {
+                failed = true;
+            }
+            ::close(fd);
+            fd = -1;
+            mapped_bytes.store(0, std::memory_order_relaxed);
+            reserved_bytes = 0;
+        }
+
+        void record_packet(const PacketView &packet) override {
+            const uint64_t sequence = packet.length >= sizeof(MessageHeader)
+                                          ? reinterpret_cast<const MessageHeader *>(packet.data)->sequence_number
+                                          : 0;
+            append(CaptureRecordType::Packet, packet.data, packet.length, packet.channel, packet.feed,
+                   packet.rx_timestamp_ns != 0 ? packet.rx_timestamp_ns : realtime_ns(), sequence);
+        }
+
+        void record_tick(const MarketTick &tick) override {
+            append(CaptureRecordType::Tick, reinterpret_cast<const uint8_t *>(&tick), sizeof(MarketTick), 0, 0,
+                   realtime_ns(), tick.sequence);
+        }
+
+        // Publishes the data written so far; the index only appears on close()
+        void flush() override {
+            if (base != nullptr) {
+                publish_header(0, 0);
+                ::msync(base, write_offset, MS_ASYNC);
+            }
+        }
+
+        [[nodiscard]] uint64_t record_count() const noexcept { return records; }
+        [[nodiscard]] size_t bytes_written() const noexcept { return write_offset; }
+        [[nodiscard]] bool has_failed() const noexcept { return failed; } // Out of space; later records dropped
+
+        // Times the receive path found the extender behind and grew the file itself
+        [[nodiscard]] uint64_t writer_extension_count() const noexcept {
+            return writer_extensions.load(std::memory_order_relaxed);
+        }
+
+        static uint64_t realtime_ns() noexcept {
+            timespec now{};
+            ::clock_gettime(CLOCK_REALTIME, &now);
+            return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+        }
+
+    private:
+        CaptureFileHeader *header() const noexcept {
+            return reinterpret_cast<CaptureFileHeader *>(base);
+        }
+
+        void append(const CaptureRecordType type, const uint8_t *payload, const uint32_t length,
+                    const uint16_t channel, const uint8_t feed, const uint64_t timestamp_ns,
+                    const uint64_t sequence) {
+            const size_t record_bytes = capture_align(sizeof(CaptureRecordHeader) + length);
+            if (UNLIKELY(failed || !reserve(record_bytes))) {
+                failed = true;
+                return;
+            }
+
+            if (records % IndexInterval == 0) {
+                index.push_back(CaptureIndexEntry{
+                    .timestamp_ns = timestamp_ns,
+                    .sequence = sequence,
+                    .record_number = records,
+                    .offset = write_offset
+                });
+            }
+
+            uint8_t *out = base + write_offset;
+            const CaptureRecordHeader record{
+                .length = length,
+                .type = type,
+                .feed = feed,
+                .channel = channel,
+                .timestamp_ns = timestamp_ns,
+                .sequence = sequence,
+                .reserved = 0
+            };
+            std::memcpy(out + sizeof(CaptureRecordHeader), payload, length);
+            std::memcpy(out, &record, sizeof(record));
+
+            write_offset += record_bytes;
+            if (records == 0) {
+                first_timestamp = timestamp_ns;
+            }
+            last_timestamp = timestamp_ns;
+            ++records;
+        }
+
+        // Keeps room for `bytes` more plus a zeroed end marker, and asks for
+        // the next extent once the writer is within half an extent of the end
+        bool reserve(const size_t bytes) {
+            const size_t needed = write_offset + bytes + sizeof(CaptureRecordHeader);
+            const size_t mapped = mapped_bytes.load(std::memory_order_acquire);
+            if (UNLIKELY(needed + extent_bytes / 2 > mapped) && extender.joinable() &&
+                !extend_pending.exchange(true, std::memory_order_acq_rel)) {
+                // Once per extent; the extender is idle, so the lock is free
+                {
+                    std::lock_guard lock(extend_mutex);
+                }
+                extend_wake.notify_one();
+            }
+            if (LIKELY(needed <= mapped)) {
+                return true;
+            }
+
+            // A burst outran the extender: grow here rather than drop
+            if (extender.joinable()) {
+                writer_extensions.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::lock_guard lock(extend_mutex);
+            return extend_to(std::max(needed, mapped + extent_bytes));
+        }
+
+        void extend_loop() {
+            std::unique_lock lock(extend_mutex);
+            while (true) {
+                extend_wake.wait(lock, [this] {
+                    return extender_stopping || extend_pending.load(std::memory_order_acquire);
+                });
+                if (extender_stopping) {
+                    return;
+                }
+                (void) extend_to(mapped_bytes.load(std::memory_order_relaxed) + extent_bytes);
+                extend_pending.store(false, std::memory_order_release);
+            }
+        }
+
+        // Grows the file and maps the new part into the reserved range,
+        // pre-faulted; the written part stays mapped where it is. Callers
+        // hold extend_mutex, except open() before the extender starts.
+        bool extend_to(size_t bytes) {
+            const size_t mapped = mapped_bytes.load(std::memory_order_relaxed);
+            bytes = (bytes + extent_bytes - 1) / extent_bytes * extent_bytes;
+            if (bytes <= mapped) {
+                return true;
+            }
+            if (bytes > reserved_bytes || ::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+                return false;
+            }
+
+            int flags = MAP_SHARED | MAP_FIXED;
+#ifdef MAP_POPULATE
+            flags |= MAP_POPULATE; // Fault the extent in ahead of the writer
+#endif
+            if (::mmap(base + mapped, bytes - mapped, PROT_READ | PROT_WRITE, flags, fd,
+                       static_cast<off_t>(mapped)) == MAP_FAILED) {
+                return false;
+            }
+            mapped_bytes.store(bytes, std::memory_order_release);
+            return true;
+        }
+
+        void publish_header(const uint64_t index_offset, const uint64_t index_count) noexcept {
+            CaptureFileHeader *file_header = header();
+            file_header->record_count = records;
+            file_header->index_offset = index_offset;
+            file_header->index_count = index_count;
+            file_header->first_timestamp_ns = first_timestamp;
+            file_header->last_timestamp_ns = last_timestamp;
+            file_header->data_end = write_offset;
+        }
+    };
+
+    // Read-only view of a capture journal. Records are handed out in place.
+    class CaptureReader {
+        int fd{-1};
+        const uint8_t *base{nullptr};
+        size_t file_bytes{0};
+        size_t data_end{0};
+        std::span<const CaptureIndexEntry> index;
+        CaptureFileHeader file_header{};
+
+    public:
+        CaptureReader() = default;
+
+        ~CaptureReader() {
+            close();
+        }
+
+        CaptureReader(const CaptureReader &) = delete;
+
+        CaptureReader &operator=(const CaptureReader &) = delete;
+
+        bool open(const std::string &path) {
+            close();
+
+            fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return false;
+            }
+
+            struct stat info{};
+            if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(CaptureFileHeader)) {
+                close();
+                return false;
+            }
+
+            file_bytes = static_cast<size_t>(info.st_size);
+            void *mapping = ::mmap(nullptr, file_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                close();
+                return false;
+            }
+            base = static_cast<const uint8_t *>(mapping);
+#ifdef MADV_SEQUENTIAL
+            ::madvise(mapping, file_bytes, MADV_SEQUENTIAL);
+#endif
+
+            std::memcpy(&file_header, base, sizeof(file_header));
+            if (file_header.magic != CaptureFileHeader::Magic ||
+                file_header.version != CaptureFileHeader::CurrentVersion ||
+                file_header.header_size > file_bytes) {
+                close();
+                return false;
+            }
+
+            data_end = file_header.data_end != 0 ? std::min<size_t>(file_header.data_end, file_bytes) : file_bytes;
+
+            const uint64_t index_bytes = file_header.index_count * sizeof(CaptureIndexEntry);
+            if (file_header.index_count != 0 && file_header.index_offset + index_bytes <= file_bytes) {
+                index = {
+                    reinterpret_cast<const CaptureIndexEntry *>(base + file_header.index_offset),
+                    static_cast<size_t>(file_header.index_count)
+                };
+                data_end = std::min<size_t>(data_end, file_header.index_offset);
+            }
+            return true;
+        }
+
+        void close() {
+            if (base != nullptr) {
+                ::munmap(const_cast<uint8_t *>(base), file_bytes);
+                base = nullptr;
+            }
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+            index = {};
+            file_bytes = 0;
+            data_end = 0;
+        }
+
+        [[nodiscard]] bool is_open() const noexcept { return base != nullptr; }
+        [[nodiscard]] const CaptureFileHeader &get_header() const noexcept { return file_header; }
+        [[nodiscard]] std::span<const CaptureIndexEntry> get_index() const noexcept { return index; }
+
+        [[nodiscard]] size_t first_offset() const noexcept {
+            return capture_align(sizeof(CaptureFileHeader));
+        }
+
+        // Reads the record at offset and advances it; false at the end or on a corrupt record
+        bool next(size_t &offset, CaptureRecord &record) const noexcept {
+            if (offset + sizeof(CaptureRecordHeader) > data_end) {
+                return false;
+            }
+
+            const auto *header = reinterpret_cast<const CaptureRecordHeader *>(base + offset);
+            const size_t record_bytes = capture_align(sizeof(CaptureRecordHeader) + header->length);
+            if (header->type == CaptureRecordType::End || offset + record_bytes > data_end) {
+                return false;
+            }
+
+            record = CaptureRecord{.header = header, .payload = base + offset + sizeof(CaptureRecordHeader)};
+            offset += record_bytes;
+            return true;
+        }
+
+        // Offset of the first record at or after timestamp_ns
+        [[nodiscard]] size_t seek_time(const uint64_t timestamp_ns) const noexcept {
+            const auto it = std::upper_bound(index.begin(), index.end(), timestamp_ns,
+                                             [](const uint64_t value, const CaptureIndexEntry &entry) {
+                                                 return value < entry.timestamp_ns;
+                                             });
+            return scan_from(it == index.begin() ? first_offset() : std::prev(it)->offset,
+                             [timestamp_ns](const CaptureRecordHeader &header) {
+                                 return header.timestamp_ns >= timestamp_ns;
+                             });
+        }
+
+        // Offset of the first packet on channel whose sequence is at or after
+        // sequence. The index narrows the scan when the capture holds one channel.
+        [[nodiscard]] size_t seek_sequence(const uint16_t channel, const uint64_t sequence) const noexcept {
+            const auto it = std::upper_bound(index.begin(), index.end(), sequence,
+                                             [](const uint64_t value, const CaptureIndexEntry &entry) {
+                                                 return value < entry.sequence;
+                                             });
+            size_t start = first_offset();
+            if (it != index.begin() && single_channel()) {
+                start = std::prev(it)->offset;
+            }
+            return scan_from(start, [channel, sequence](const CaptureRecordHeader &header) {
+                return header.type == CaptureRecordType::Packet && header.channel == channel &&
+                       header.sequence >= sequence;
+            });
+        }
+
+    private:
+        template<typename Predicate>
+        size_t scan_from(size_t offset, Predicate &&matches) const noexcept {
+            CaptureRecord record{};
+            size_t at = offset;
+            while (next(offset, record)) {
+                if (matches(*record.header)) {
+                    return at;
+                }
+                at = offset;
+            }
+            return data_end;
+        }
+
+        [[nodiscard]] bool single_channel() const noexcept {
+            size_t offset = first_offset();
+            CaptureRecord record{};
+            int64_t channel = -1;
+            for (int checked = 0; checked < 64 && next(offset, record); ++checked) {
+                if (record.header->type != CaptureRecordType::Packet) {
+                    continue;
+                }
+                if (channel >= 0 && channel != record.header->channel) {
+                    return false;
+                }
+                channel = record.header->channel;
+            }
+            return true;
+        }
+    };
+
+    enum class ReplayPace : uint8_t {
+        AsFastAsPossible,
+        Recorded // Reproduce the captured inter-record gaps, scaled by speed
+    };
+
+    struct ReplayOptions {
+        ReplayPace pace{ReplayPace::AsFastAsPossible};
+        double speed{1.0}; // Recorded pace only: 2.0 replays twice as fast
+        uint64_t start_time_ns{0}; // Skip records captured before this
+        uint64_t end_time_ns{UINT64_MAX}; // Stop at the first record after this
+    };
+
+    struct ReplayStats {
+        bool opened;
+        uint64_t packets;
+        uint64_t ticks;
+        uint64_t bytes;
+        uint64_t elapsed_ns;
+    };
+
+    // Walks a capture in order, pacing records if asked. Runs on the caller's thread.
+    class CaptureReplayer {
+        const CaptureReader &reader;
+        ReplayOptions options;
+        size_t offset;
+        uint64_t first_capture_ns{0};
+        std::chrono::steady_clock::time_point replay_start{};
+        ReplayStats stats{.opened = true, .packets = 0, .ticks = 0, .bytes = 0, .elapsed_ns = 0};
+        bool done{false};
+
+    public:
+        CaptureReplayer(const CaptureReader &capture, ReplayOptions replay_options = {})
+            : reader(capture), options(replay_options),
+              offset(replay_options.start_time_ns != 0
+                         ? capture.seek_time(replay_options.start_time_ns)
+                         : capture.first_offset()) {
+        }
+
+        // Next record, once its recorded time has come when pacing. With
+        // wait = false it returns false instead of waiting for a record that is
+        // not due yet; finished() tells that apart from the end of the capture.
+        bool next(CaptureRecord &record, const bool wait = true) {
+            size_t peek = offset;
+            if (done || !reader.next(peek, record) || record.header->timestamp_ns > options.end_time_ns) {
+                finish();
+                return false;
+            }
+
+            if (stats.packets + stats.ticks == 0) {
+                first_capture_ns = record.header->timestamp_ns;
+                replay_start = std::chrono::steady_clock::now();
+            } else if (options.pace == ReplayPace::Recorded) {
+                if (wait) {
+                    wait_until(record.header->timestamp_ns);
+                } else if (std::chrono::steady_clock::now() < due_time(record.header->timestamp_ns)) {
+                    return false;
+                }
+            }
+            offset = peek;
+
+            if (record.header->type == CaptureRecordType::Packet) {
+                ++stats.packets;
+            } else if (record.header->type == CaptureRecordType::Tick) {
+                ++stats.ticks;
+            }
+            stats.bytes += record.header->length;
+            return true;
+        }
+
+        // Replays everything: on_packet(const PacketView &), on_tick(const MarketTick &)
+        template<typename OnPacket, typename OnTick>
+        ReplayStats run(OnPacket &&on_packet, OnTick &&on_tick) {
+            CaptureRecord record{};
+            while (next(record)) {
+                if (record.header->type == CaptureRecordType::Packet) {
+                    on_packet(to_packet(record));
+                } else if (record.header->type == CaptureRecordType::Tick &&
+                           record.header->length == sizeof(MarketTick)) {
+                    MarketTick tick;
+                    std::memcpy(&tick, record.payload, sizeof(tick));
+                    on_tick(tick);
+                }
+            }
+            return stats;
+        }
+
+        static PacketView to_packet(const CaptureRecord &record) noexcept {
+            return PacketView{
+                .data = record.payload,
+                .length = record.header->length,
+                .channel = record.header->channel,
+                .feed = record.header->feed,
+                .hardware_timestamp = false,
+                .rx_timestamp_ns = record.header->timestamp_ns
+            };
+        }
+
+        [[nodiscard]] bool finished() const noexcept { return done; }
+        [[nodiscard]] const ReplayStats &get_statistics() const noexcept { return stats; }
+
+    private:
+        [[nodiscard]] std::chrono::steady_clock::time_point due_time(const uint64_t capture_ns) const {
+            const auto offset_ns = static_cast<int64_t>(
+                static_cast<double>(capture_ns - std::min(capture_ns, first_capture_ns)) / options.speed);
+            return replay_start + std::chrono::nanoseconds(offset_ns);
+        }
+
+        void wait_until(const uint64_t capture_ns) const {
+            const auto due = due_time(capture_ns);
+
+            // Sleep through long gaps, spin the last stretch for accuracy
+            while (true) {
+                const auto now = std::chrono::steady_clock::now();
+                if (now >= due) {
+                    return;
+                }
+                if (due - now > std::chrono::microseconds(200)) {
+                    std::this_thread::sleep_for(due - now - std::chrono::microseconds(100));
+                } else {
+                    cpu_relax();
+                }
+            }
+        }
+
+        void finish() {
+            if (!done) {
+                done = true;
+                if (stats.packets + stats.ticks != 0) {
+                    stats.elapsed_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - replay_start).count());
+                }
+            }
+        }
+    };
+
+    // Feeds a capture's packets through the gateway's normal receive path, so a
+    // replay exercises arbitration, recovery, sharding and strategies exactly as
+    // live traffic would. Tick records are skipped; the gateway regenerates them.
+    class ReplayTransport final : public IFeedTransport {
+        std::string path;
+        ReplayOptions options;
+        CaptureReader reader;
+        std::unique_ptr<CaptureReplayer> replayer;
+        std::atomic<bool> done{false};
+
+    public:
+        explicit ReplayTransport(std::string capture_path, ReplayOptions replay_options = {})
+            : path(std::move(capture_path)), options(replay_options) {
+        }
+
+        bool open() override {
+            if (!reader.open(path)) {
+                return false;
+            }
+            replayer = std::make_unique<CaptureReplayer>(reader, options);
+            done.store(false, std::memory_order_release);
+            return true;
+        }
+
+        void close() override {
+            replayer.reset();
+            reader.close();
+        }
+
+        size_t receive_batch(std::span<PacketView> packets) override {
+            if (!replayer) {
+                return 0;
+            }
+
+            size_t count = 0;
+            CaptureRecord record{};
+            // Never blocks, so the gateway can still stop during long recorded gaps
+            while (count < packets.size() && replayer->next(record, false)) {
+                if (record.header->type == CaptureRecordType::Packet) {
+                    packets[count++] = CaptureReplayer::to_packet(record);
+                }
+            }
+
+            if (replayer->finished()) {
+                done.store(true, std::memory_order_release);
+            }
+            return count;
+        }
+
+        // True once every record has been handed to the gateway
+        [[nodiscard]] bool finished() const noexcept {
+            return done.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] ReplayStats get_statistics() const noexcept {
+            return replayer ? replayer->get_statistics() : ReplayStats{};
+        }
+    };
+
+    // Replays many captures at once, one file per thread at a time.
+    // on_packet(file_index, const PacketView &) and on_tick(file_index, const
+    // MarketTick &) run on the worker threads; calls for one file are ordered.
+    template<typename OnPacket, typename OnTick>
+    std::vector<ReplayStats> replay_in_parallel(std::span<const std::string> paths, const ReplayOptions &options,
+                                                OnPacket &&on_packet, OnTick &&on_tick,
+                                                size_t max_threads = 0) {
+        std::vector<ReplayStats> results(paths.size(), ReplayStats{});
+        if (paths.empty()) {
+            return results;
+        }
+
+        if (max_threads == 0) {
+            max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        std::atomic<size_t> next_file{0};
+        const auto worker = [&] {
+            for (size_t file = next_file.fetch_add(1); file < paths.size(); file = next_file.fetch_add(1)) {
+                CaptureReader reader;
+                if (!reader.open(paths[file])) {
+                    continue; // results[file].opened stays false
+                }
+
+                CaptureReplayer replayer(reader, options);
+                results[file] = replayer.run(
+                    [&](const PacketView &packet) { on_packet(file, packet); },
+                    [&](const MarketTick &tick) { on_tick(file, tick); });
+            }
+        };
+
+        std::vector<std::thread> threads;
+        const size_t thread_count = std::min(max_threads, paths.size());
+        for (size_t i = 1; i < thread_count; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker(); // The calling thread takes a share too
+
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        return results;
+    }
+#endif
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "../core/types.h"
+#include "../core/memory.h"
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace trading_engine {
+    // Line arbitration for redundant A/B feeds
+    //
+    // Both lines carry the same per-channel sequence numbers. The first copy of
+    // a sequence is delivered and any later copy is dropped. A message that
+    // arrives ahead of a hole waits in a small reorder window so the other line
+    // can fill the hole; once the hole outlives the gap timeout, or the window
+    // runs out, it is declared lost and on_gap() fires before anything after it
+    // is delivered. Single-threaded: call it from the feed receiver only.
+    template<typename Message, size_t WindowSize = 1024>
+    class FeedArbitrator {
+        static_assert(std::has_single_bit(WindowSize), "WindowSize must be a power of 2");
+        static constexpr uint32_t WindowMask = WindowSize - 1;
+
+        using Clock = std::chrono::steady_clock;
+
+        struct Pending {
+            Message message;
+            uint32_t sequence;
+            bool valid;
+        };
+
+        struct Channel {
+            uint32_t next_sequence{0};
+            uint32_t pending_count{0};
+            bool initialised{false};
+            Clock::time_point hole_since{};
+            std::unique_ptr<Pending[]> window; // Allocated on the first reorder
+        };
+
+        std::vector<Channel> channels;
+        std::chrono::nanoseconds gap_timeout;
+
+        // Written by the receiver only; atomics so stats can be read elsewhere
+        std::atomic<uint64_t> duplicates{0};
+        std::atomic<uint64_t> reordered{0};
+        std::atomic<uint64_t> gaps{0};
+        std::atomic<uint64_t> messages_lost{0};
+
+    public:
+        explicit FeedArbitrator(const std::chrono::nanoseconds timeout = std::chrono::microseconds(500))
+            : gap_timeout(timeout) {
+        }
+
+        // deliver(channel, const Message &) runs for each message in sequence order;
+        // on_gap(channel, first_lost_sequence, lost_count) runs for each lost hole
+        template<typename Deliver, typename OnGap>
+        void on_message(const uint16_t channel_id, const uint32_t sequence, const Message &message,
+                        Deliver &&deliver, OnGap &&on_gap) {
+            Channel &channel = get_channel(channel_id);
+
+            if (UNLIKELY(!channel.initialised)) {
+                // Join mid-stream at whatever arrives first
+                channel.next_sequence = sequence;
+                channel.initialised = true;
+            }
+
+            auto distance = static_cast<int32_t>(sequence - channel.next_sequence);
+
+            if (LIKELY(distance == 0)) {
+                deliver(channel_id, message);
+                ++channel.next_sequence;
+                if (UNLIKELY(channel.pending_count > 0)) {
+                    drain(channel_id, channel, deliver);
+                }
+                return;
+            }
+
+            if (distance < 0) {
+                bump(duplicates); // The other line got there first
+                return;
+            }
+
+            // Too far ahead to hold: give up on holes until it fits
+            while (static_cast<uint32_t>(distance) >= WindowSize) {
+                if (channel.pending_count == 0) {
+                    report_gap(channel_id, channel.next_sequence, static_cast<uint32_t>(distance), on_gap);
+                    channel.next_sequence = sequence;
+                    deliver(channel_id, message);
+                    ++channel.next_sequence;
+                    return;
+                }
+                skip_hole(channel_id, channel, deliver, on_gap);
+                distance = static_cast<int32_t>(sequence - channel.next_sequence);
+                if (distance <= 0) {
+                    // Already covered by a drained message, or next in line
+                    on_message(channel_id, sequence, message, deliver, on_gap);
+                    return;
+                }
+            }
+
+            if (!channel.window) {
+                channel.window = std::make_unique<Pending[]>(WindowSize);
+            }
+
+            Pending &slot = channel.window[sequence & WindowMask];
+            if (slot.valid) {
+                bump(duplicates);
+                return;
+            }
+
+            slot.message = message;
+            slot.sequence = sequence;
+            slot.valid = true;
+            bump(reordered);
+
+            if (channel.pending_count++ == 0) {
+                channel.hole_since = Clock::now();
+            } else if (Clock::now() - channel.hole_since > gap_timeout) {
+                skip_hole(channel_id, channel, deliver, on_gap);
+            }
+        }
+
+        // Gives up on holes older than the timeout; call when the feed is idle
+        template<typename Deliver, typename OnGap>
+        void poll(Deliver &&deliver, OnGap &&on_gap) {
+            Clock::time_point now{};
+
+            for (size_t i = 0; i < channels.size(); ++i) {
+                Channel &channel = channels[i];
+                if (channel.pending_count == 0) {
+                    continue;
+                }
+
+                if (now == Clock::time_point{}) {
+                    now = Clock::now();
+                }
+
+                if (now - channel.hole_since > gap_timeout) {
+                    skip_hole(static_cast<uint16_t>(i), channel, deliver, on_gap);
+                }
+            }
+        }
+
+        struct ArbitrationStats {
+            uint64_t duplicates_dropped;
+            uint64_t messages_reordered;
+            uint64_t sequence_gaps;
+            uint64_t messages_lost;
+        };
+
+        ArbitrationStats get_statistics() const noexcept {
+            return ArbitrationStats{
+                .duplicates_dropped = duplicates.load(std::memory_order_relaxed),
+                .messages_reordered = reordered.load(std::memory_order_relaxed),
+                .sequence_gaps = gaps.load(std::memory_order_relaxed),
+                .messages_lost = messages_lost.load(std::memory_order_relaxed)
+            };
+        }
+
+    private:
+        Channel &get_channel(const uint16_t channel_id) {
+            if (UNLIKELY(channel_id >= channels.size())) {
+                channels.resize(static_cast<size_t>(channel_id) + 1);
+            }
+            return channels[channel_id];
+        }
+
+        // Declares the hole at next_sequence lost and resumes at the oldest pending message
+        template<typename Deliver, typename OnGap>
+        void skip_hole(const uint16_t channel_id, Channel &channel, Deliver &deliver, OnGap &on_gap) {
+            uint32_t first_pending = channel.next_sequence + 1;
+            while (!is_pending(channel, first_pending)) {
+                ++first_pending;
+            }
+
+            report_gap(channel_id, channel.next_sequence, first_pending - channel.next_sequence, on_gap);
+            channel.next_sequence = first_pending;
+            drain(channel_id, channel, deliver);
+        }
+
+        template<typename Deliver>
+        void drain(const uint16_t channel_id, Channel &channel, Deliver &deliver) {
+            while (channel.pending_count > 0 && is_pending(channel, channel.next_sequence)) {
+                Pending &slot = channel.window[channel.next_sequence & WindowMask];
+                slot.valid = false;
+                --channel.pending_count;
+                ++channel.next_sequence;
+                deliver(channel_id, static_cast<const Message &>(slot.message));
+            }
+
+            if (channel.pending_count > 0) {
+                channel.hole_since = Clock::now(); // A later hole starts its own clock
+            }
+        }
+
+        [[nodiscard]] static bool is_pending(const Channel &channel, const uint32_t sequence) noexcept {
+            const Pending &slot = channel.window[sequence & WindowMask];
+            return slot.valid && slot.sequence == sequence;
+        }
+
+        template<typename OnGap>
+        void report_gap(const uint16_t channel_id, const uint32_t first, const uint32_t count, OnGap &on_gap) {
+            bump(gaps);
+            messages_lost.store(messages_lost.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+            on_gap(channel_id, first, count);
+        }
+
+        static void bump(std::atomic<uint64_t> &counter) noexcept {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    };
+}
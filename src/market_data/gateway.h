@@ -4,29 +4,115 @@
 #include "../core/memory.h"
 #include "../core/queue.h"
 #include "../core/timing.h"
+#include "../core/tracing.h"
+#include "../core/symbol_directory.h"
+#include "../core/topology.h"
+#include "../core/wait_strategy.h"
+#include "../market_data/capture.h"
+#include "../market_data/feed_arbitrator.h"
 #include "../market_data/order_book.h"
+#include "../market_data/transport.h"
 
-#include <thread>
+#include <algorithm>
+#include <array>
 #include <functional>
-#include <unordered_map>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace trading_engine {
+    struct GatewayConfig {
+        uint32_t shard_count{1};
+        ThreadPlacement receiver{};
+        ThreadPlacement shards{}; // Shard i runs on shards.core_for(i); books and tick queues go on its node
+        // Wait for room instead of dropping when a tick queue is full. Meant for
+        // replaying captures as fast as possible, where nothing is lost upstream
+        bool block_when_full{false};
+        // The receiver polls its transport, which cannot wake it, so its
+        // parks are timed sleeps
+        WaitConfig receiver_wait{.policy = WaitPolicy::SpinPause};
+        WaitConfig shard_wait{};
+        std::vector<WaitConfig> shard_waits{}; // Shard i waits by shard_waits[i] when set
+    };
+
     // Market data feed handler
+    //
+    // Symbols are spread over a fixed pool of shard threads by symbol hash. A
+    // shard is the only consumer of its symbols' tick queues and the only writer
+    // of their order books; symbols move between shards through the shards'
+    // command queues, so the feed never has to stop for a rebalance.
     class MarketDataGateway {
+        static constexpr uint32_t NoShard = std::numeric_limits<uint32_t>::max();
+        static constexpr size_t ShardBatchSize = 64; // Ticks per symbol before moving on
+        static constexpr uint16_t NoChannel = std::numeric_limits<uint16_t>::max();
+        static constexpr size_t MaxRecoveryBuffer = 4096; // Incrementals held per stale symbol
+
         struct alignas(CacheLineSize) SymbolProcessor {
             SPSCQueue<MarketTick, 4096> tick_queue;
             std::atomic<uint64_t> sequence_number{0};
             std::atomic<uint64_t> messages_processed{0};
             std::atomic<uint64_t> messages_dropped{0};
-            std::thread processor_thread;
+            OrderBook<> *book{nullptr};
+            SymbolID symbol_id{0};
+            uint32_t assigned_shard{NoShard}; // Guarded by control_mutex
+            std::atomic<bool> migrating{false};
             std::atomic<bool> running{false};
+
+            // Gap recovery, receiver thread only. While stale, incrementals are
+            // held back until a snapshot arrives to rebuild the book from.
+            uint16_t channel{NoChannel};
+            bool stale{false};
+            bool has_recovery_floor{false};
+            uint32_t recovery_floor{0}; // Oldest snapshot sequence that can still be replayed onto
+            std::vector<MDIncrementalMessage> recovery_buffer;
         };
 
-        std::unordered_map<SymbolID, std::unique_ptr<SymbolProcessor> > processors;
+        struct ShardCommand {
+            enum class Type : uint8_t { Attach, Detach };
+
+            Type type;
+            SymbolProcessor *processor;
+            uint32_t forward_to; // Detach only: shard that attaches it next
+        };
+
+        struct alignas(CacheLineSize) GatewayShard {
+            MPSCQueue<ShardCommand, 256> commands;
+            std::vector<SymbolProcessor *> symbols; // Owned by the shard thread
+            std::vector<ShardCommand> handoffs; // Detached, waiting for room in the target's queue
+            std::thread thread;
+            std::atomic<uint64_t> messages_processed{0};
+            std::atomic<uint32_t> symbol_count{0};
+            WakeSignal wake; // Rung by the receiver after each batch and by command senders
+            WaitStrategy wait;
+
+            GatewayShard(const uint32_t index, const WaitConfig &wait_config)
+                : wake(wait_config.policy), wait(wait_config, &wake, "gateway_shard", index) {
+            }
+        };
+
+        // Processors stay in the directory after unsubscribe and are reused
+        // on resubscribe, so the receiver can look them up without a lock
+        SymbolDirectory<SymbolProcessor, MaxSymbolCount, 1> processors;
         OrderBookManager *order_book_manager;
 
-        // Network receiver (placeholder for actual implementation)
+        GatewayConfig config;
+        std::vector<NodeLocalPtr<GatewayShard> > shards;
+        std::mutex control_mutex; // Serialises subscribe/unsubscribe/rebalance
+
+        static constexpr size_t ReceiveBatchSize = 64;
+
+        // Network receiver; generates synthetic data when no transport is set
+        std::unique_ptr<IFeedTransport> transport;
+        std::array<PacketView, ReceiveBatchSize> packet_batch{};
+        std::unique_ptr<IFeedRecorder> recorder; // Capture mode; receiver thread only
+        FeedArbitrator<MDIncrementalMessage> arbitrator;
+        std::vector<std::vector<SymbolProcessor *> > channel_symbols; // Learned from the feed
         std::thread receiver_thread;
+        WaitStrategy receive_wait;
+        bool shards_park{false}; // Whether the receiver needs to ring shard signals at all
         std::atomic<bool> gateway_running{false};
 
         // Callbacks for processed data
@@ -34,13 +120,29 @@ namespace trading_engine {
         std::function<void(SymbolID, const OrderBook<1000>::BookSnapshot &)> snapshot_callback;
 
         // Statistics
+        std::atomic<uint64_t> total_packets_received{0};
         std::atomic<uint64_t> total_messages_received{0};
         std::atomic<uint64_t> total_messages_processed{0};
         std::atomic<uint64_t> total_parsing_errors{0};
+        std::atomic<uint64_t> symbols_recovered{0};
+        std::atomic<uint64_t> recovery_failures{0};
+        std::atomic<uint64_t> commands_refused{0}; // Attaches and detaches a full shard queue turned away
+        std::atomic<uint64_t> handoffs_deferred{0};
 
     public:
-        explicit MarketDataGateway(OrderBookManager *book_manager)
-            : order_book_manager(book_manager) {
+        explicit MarketDataGateway(OrderBookManager *book_manager, GatewayConfig gateway_config = {})
+            : order_book_manager(book_manager), config(std::move(gateway_config)),
+              receive_wait(config.receiver_wait, nullptr, "receiver") {
+            config.shard_count = std::max<uint32_t>(config.shard_count, 1);
+            shards.reserve(config.shard_count);
+            for (uint32_t i = 0; i < config.shard_count; ++i) {
+                const int node = config.shards.pinned() ? numa_node_of_cpu(config.shards.core_for(i)) : -1;
+                const WaitConfig &wait = wait_config_for(config.shard_wait, config.shard_waits, i);
+                shards.push_back(make_node_local<GatewayShard>(node, i, wait));
+                shards_park = shards_park || parks(wait.policy);
+            }
+            // Processors migrate between shards, so they follow the shards' first core
+            processors.place_on_node(config.shards.numa_node());
         }
 
         ~MarketDataGateway() {
@@ -55,13 +157,36 @@ namespace trading_engine {
             snapshot_callback = std::move(callback);
         }
 
+        // Must be called while the gateway is stopped
+        void set_transport(std::unique_ptr<IFeedTransport> feed_transport) {
+            if (!gateway_running.load(std::memory_order_acquire)) {
+                transport = std::move(feed_transport);
+            }
+        }
+
+        // Records every received packet and generated tick, e.g. into a
+        // CaptureWriter. Must be called while the gateway is stopped.
+        void set_recorder(std::unique_ptr<IFeedRecorder> feed_recorder) {
+            if (!gateway_running.load(std::memory_order_acquire)) {
+                recorder = std::move(feed_recorder);
+            }
+        }
+
         bool start() {
             if (gateway_running.load(std::memory_order_acquire)) {
                 return false; // Already running
             }
 
+            if (transport && !transport->open()) {
+                return false;
+            }
+
             gateway_running.store(true, std::memory_order_release);
 
+            for (uint32_t i = 0; i < shards.size(); ++i) {
+                shards[i]->thread = std::thread(&MarketDataGateway::shard_loop, this, i);
+            }
+
             // Start receiver thread
             receiver_thread = std::thread(&MarketDataGateway::receiver_loop, this);
 
@@ -70,63 +195,195 @@ namespace trading_engine {
 
         void stop() {
             gateway_running.store(false, std::memory_order_release);
-
-            // Stop all symbol processors
-            for (auto &[symbol_id, processor]: processors) {
-                processor->running.store(false, std::memory_order_release);
-                if (processor->processor_thread.joinable()) {
-                    processor->processor_thread.join();
-                }
+            for (const auto &shard: shards) {
+                shard->wake.wake_all();
             }
 
             if (receiver_thread.joinable()) {
                 receiver_thread.join();
             }
+
+            if (transport) {
+                transport->close();
+            }
+
+            if (recorder) {
+                recorder->flush();
+            }
+
+            for (const auto &shard: shards) {
+                if (shard->thread.joinable()) {
+                    shard->thread.join();
+                }
+            }
         }
 
-        void subscribe_symbol(SymbolID symbol_id) {
-            auto processor = std::make_unique<SymbolProcessor>();
-            processor->running.store(true, std::memory_order_release);
+        // False if the symbol directory is full, or the symbol's shard had
+        // no room for the attach; the symbol is then not subscribed
+        bool subscribe_symbol(SymbolID symbol_id) {
+            // Directory entries have a stable address for the shards to use
+            SymbolProcessor *processor = processors.get_or_create(symbol_id, [symbol_id](SymbolProcessor &entry) {
+                entry.symbol_id = symbol_id;
+            });
+            if (processor == nullptr) {
+                return false; // Directory full
+            }
+
+            std::lock_guard lock(control_mutex);
+
+            if (processor->running.load(std::memory_order_relaxed)) {
+                return true; // Already subscribed
+            }
+
+            if (order_book_manager && processor->book == nullptr) {
+                processor->book = order_book_manager->get_or_create_order_book(symbol_id);
+            }
 
-            // Store the processor in the map first to ensure stable memory location
-            SymbolProcessor *processor_ptr = processor.get();
-            processors[symbol_id] = std::move(processor);
+            // A processor stays attached to its shard across unsubscribe, so it
+            // only needs a home the first time round
+            if (processor->assigned_shard == NoShard) {
+                const uint32_t shard = shard_for_symbol(symbol_id);
+                if (!shards[shard]->commands.try_push({ShardCommand::Type::Attach, processor, NoShard})) {
+                    commands_refused.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                shards[shard]->wake.notify();
+                processor->assigned_shard = shard;
+            }
 
-            // Start processing thread for this symbol using the stable pointer
-            processor_ptr->processor_thread = std::thread(&MarketDataGateway::symbol_processor_loop, this, symbol_id,
-                                                          processor_ptr);
+            processor->running.store(true, std::memory_order_release);
+            return true;
         }
 
         void unsubscribe_symbol(SymbolID symbol_id) {
-            if (auto it = processors.find(symbol_id); it != processors.end()) {
-                it->second->running.store(false, std::memory_order_release);
-                if (it->second->processor_thread.joinable()) {
-                    it->second->processor_thread.join();
-                }
-                processors.erase(it);
+            // The receiver stops routing; the shard drains what is already queued
+            if (SymbolProcessor *processor = processors.find(symbol_id)) {
+                processor->running.store(false, std::memory_order_release);
+            }
+        }
+
+        // Moves a symbol to another shard without pausing the feed. The old shard
+        // drops it at its next command poll and hands it on; ticks keep queueing
+        // meanwhile. Returns false if the symbol is unknown or already moving.
+        bool rebalance_symbol(SymbolID symbol_id, uint32_t target_shard) {
+            if (target_shard >= shards.size()) {
+                return false;
             }
+
+            SymbolProcessor *processor = processors.find(symbol_id);
+            if (processor == nullptr) {
+                return false;
+            }
+
+            std::lock_guard lock(control_mutex);
+
+            const uint32_t current_shard = processor->assigned_shard;
+            if (current_shard == NoShard || current_shard == target_shard ||
+                processor->migrating.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            processor->migrating.store(true, std::memory_order_release);
+            if (!shards[current_shard]->commands.try_push({ShardCommand::Type::Detach, processor, target_shard})) {
+                processor->migrating.store(false, std::memory_order_release);
+                commands_refused.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            shards[current_shard]->wake.notify();
+
+            processor->assigned_shard = target_shard;
+            return true;
+        }
+
+        [[nodiscard]] uint32_t get_shard_count() const noexcept {
+            return static_cast<uint32_t>(shards.size());
         }
 
         // Statistics
         struct GatewayStats {
+            uint64_t total_packets_received;
             uint64_t total_messages_received;
             uint64_t total_messages_processed;
             uint64_t total_parsing_errors;
             uint64_t active_symbols;
             double processing_rate_per_second;
+            FeedArbitrator<MDIncrementalMessage>::ArbitrationStats arbitration;
+            uint64_t symbols_recovered;
+            uint64_t recovery_failures;
+            uint64_t commands_refused; // subscribe or rebalance found the shard's command queue full
+            uint64_t handoffs_deferred; // Rebalances held back a poll or more by a full target queue
+            uint64_t packets_truncated; // Dropped by the transport for not fitting its buffers
+        };
+
+        struct ShardStats {
+            uint32_t symbol_count;
+            uint64_t messages_processed;
         };
 
         GatewayStats get_statistics() const {
             return GatewayStats{
+                .total_packets_received = total_packets_received.load(std::memory_order_relaxed),
                 .total_messages_received = total_messages_received.load(std::memory_order_relaxed),
                 .total_messages_processed = total_messages_processed.load(std::memory_order_relaxed),
                 .total_parsing_errors = total_parsing_errors.load(std::memory_order_relaxed),
-                .active_symbols = processors.size(),
-                .processing_rate_per_second = calculate_processing_rate()
+                .active_symbols = count_active_symbols(),
+                .processing_rate_per_second = calculate_processing_rate(),
+                .arbitration = arbitrator.get_statistics(),
+                .symbols_recovered = symbols_recovered.load(std::memory_order_relaxed),
+                .recovery_failures = recovery_failures.load(std::memory_order_relaxed),
+                .commands_refused = commands_refused.load(std::memory_order_relaxed),
+                .handoffs_deferred = handoffs_deferred.load(std::memory_order_relaxed),
+                .packets_truncated = transport ? transport->packets_truncated() : 0
             };
         }
 
-        void process_raw_message(const uint8_t *data, size_t length) {
+        // Idle behaviour of the receiver, then each shard
+        std::vector<WaitStats> get_wait_statistics() const {
+            std::vector<WaitStats> stats;
+            stats.reserve(shards.size() + 1);
+            stats.push_back(receive_wait.get_statistics());
+            for (const auto &shard: shards) {
+                stats.push_back(shard->wait.get_statistics());
+            }
+            return stats;
+        }
+
+        std::vector<ShardStats> get_shard_statistics() const {
+            std::vector<ShardStats> stats;
+            stats.reserve(shards.size());
+
+            for (const auto &shard: shards) {
+                stats.push_back(ShardStats{
+                    .symbol_count = shard->symbol_count.load(std::memory_order_relaxed),
+                    .messages_processed = shard->messages_processed.load(std::memory_order_relaxed)
+                });
+            }
+
+            return stats;
+        }
+
+        // A datagram may carry several messages back to back, each sized by its header
+        void process_packet(const PacketView &packet) {
+            total_packets_received.fetch_add(1, std::memory_order_relaxed);
+
+            const uint8_t *data = packet.data;
+            size_t remaining = packet.length;
+
+            while (remaining >= sizeof(MessageHeader)) {
+                const uint16_t length = reinterpret_cast<const MessageHeader *>(data)->length;
+                if (UNLIKELY(length < sizeof(MessageHeader) || length > remaining)) {
+                    total_parsing_errors.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                process_raw_message(data, length, packet.channel);
+                data += length;
+                remaining -= length;
+            }
+        }
+
+        // Incrementals are arbitrated per channel; A and B copies share a channel id
+        void process_raw_message(const uint8_t *data, size_t length, uint16_t channel = 0) {
             MEASURE_LATENCY(LatencyProfiler::Market_data_processing);
 
             total_messages_received.fetch_add(1, std::memory_order_relaxed);
@@ -141,8 +398,7 @@ namespace trading_engine {
             switch (header->message_type) {
                 case MessageType::MarketDataIncremental:
                     if (length >= sizeof(MDIncrementalMessage)) {
-                        process_incremental_update(
-                            reinterpret_cast<const MDIncrementalMessage *>(data));
+                        arbitrate_incremental(channel, *reinterpret_cast<const MDIncrementalMessage *>(data));
                     } else {
                         total_parsing_errors.fetch_add(1, std::memory_order_relaxed);
                     }
@@ -151,7 +407,7 @@ namespace trading_engine {
                 case MessageType::MarketDataSnapshot:
                     if (length >= sizeof(MDSnapshotMessage)) {
                         process_snapshot_update(
-                            reinterpret_cast<const MDSnapshotMessage *>(data));
+                            reinterpret_cast<const MDSnapshotMessage *>(data), length);
                     } else {
                         total_parsing_errors.fetch_add(1, std::memory_order_relaxed);
                     }
@@ -165,65 +421,302 @@ namespace trading_engine {
 
     private:
         void receiver_loop() {
+            if (!place_current_thread(config.receiver)) {
+                std::cerr << "Gateway receiver: thread placement not applied" << std::endl;
+            }
+
+            if (!transport) {
+                while (gateway_running.load(std::memory_order_acquire)) {
+                    // Simulate receiving market data
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+
+                    // Generate synthetic market data for testing
+                    generate_synthetic_data();
+                    wake_shards();
+                }
+                return;
+            }
+
+            const auto stopping = [this] {
+                return !gateway_running.load(std::memory_order_acquire);
+            };
+
+            receive_wait.begin();
             while (gateway_running.load(std::memory_order_acquire)) {
-                // Simulate receiving market data
-                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                const size_t count = transport->receive_batch(packet_batch);
+                if (count == 0) {
+                    poll_arbitrator();
+                    receive_wait.idle(stopping);
+                    continue;
+                }
+                receive_wait.on_work();
 
-                // Generate synthetic market data for testing
-                generate_synthetic_data();
+                // Parsed in place; the views are only valid until the next batch
+                for (size_t i = 0; i < count; ++i) {
+                    if (UNLIKELY(recorder != nullptr)) {
+                        recorder->record_packet(packet_batch[i]);
+                    }
+                    process_packet(packet_batch[i]);
+                }
+                wake_shards();
             }
+            receive_wait.end();
         }
 
-        void symbol_processor_loop(SymbolID /*symbol_id*/, SymbolProcessor *processor) {
-            MarketTick tick{};
+        // One fence covers every tick the batch queued; only shards that are
+        // asleep get a futex wake
+        void wake_shards() noexcept {
+            if (!shards_park) {
+                return;
+            }
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            for (const auto &shard: shards) {
+                shard->wake.wake_if_parked();
+            }
+        }
 
-            while (processor->running.load(std::memory_order_acquire)) {
-                if (processor->tick_queue.try_pop(tick)) {
-                    // Process the tick
-                    process_tick(tick);
-                    processor->messages_processed.fetch_add(1, std::memory_order_relaxed);
-                    total_messages_processed.fetch_add(1, std::memory_order_relaxed);
+        void shard_loop(const uint32_t shard_index) {
+            GatewayShard &shard = *shards[shard_index];
+
+            if (!place_current_thread(config.shards, shard_index)) {
+                std::cerr << "Gateway shard " << shard_index << ": thread placement not applied" << std::endl;
+            }
+
+            std::array<MarketTick, ShardBatchSize> ticks;
+            const auto ready = [this, &shard] {
+                return !gateway_running.load(std::memory_order_acquire) || !shard.commands.empty() ||
+                       !shard.handoffs.empty() ||
+                       std::ranges::any_of(shard.symbols, [](const SymbolProcessor *processor) {
+                           return !processor->tick_queue.empty();
+                       });
+            };
+
+            shard.wait.begin();
+            while (gateway_running.load(std::memory_order_acquire)) {
+                apply_shard_commands(shard);
+
+                uint64_t processed = 0;
+                for (SymbolProcessor *processor: shard.symbols) {
+                    // One index update per batch rather than per tick
+                    const size_t batch = processor->tick_queue.try_pop_bulk(ticks);
+                    for (size_t i = 0; i < batch; ++i) {
+                        process_tick(*processor, ticks[i]);
+                    }
+
+                    if (batch > 0) {
+                        processor->messages_processed.fetch_add(batch, std::memory_order_relaxed);
+                        processed += batch;
+                    }
+                }
+
+                if (processed > 0) {
+                    shard.wait.on_work();
+                    shard.messages_processed.fetch_add(processed, std::memory_order_relaxed);
+                    total_messages_processed.fetch_add(processed, std::memory_order_relaxed);
                 } else {
-                    // No data available, yield
-                    std::this_thread::yield();
+                    shard.wait.idle(ready);
                 }
             }
+            shard.wait.end();
+
+            // Hand on any symbol still being detached; one the target has no
+            // room for stays in handoffs, so it is not lost on restart
+            apply_shard_commands(shard);
         }
 
-        void process_incremental_update(const MDIncrementalMessage *msg) {
-            const SymbolID symbol_id = msg->symbol_id;
+        void apply_shard_commands(GatewayShard &shard) {
+            // A symbol has one move in flight at most, so these go in any order
+            std::erase_if(shard.handoffs, [this](const ShardCommand &handoff) { return forward(handoff); });
+
+            ShardCommand command{};
+            while (shard.commands.try_pop(command)) {
+                SymbolProcessor *processor = command.processor;
+
+                if (command.type == ShardCommand::Type::Attach) {
+                    shard.symbols.push_back(processor);
+                    processor->migrating.store(false, std::memory_order_release);
+                } else {
+                    std::erase(shard.symbols, processor);
+
+                    // A full target is only briefly behind; retry on the next poll
+                    // rather than spin here while this shard's symbols wait
+                    if (!forward(command)) {
+                        shard.handoffs.push_back(command);
+                        handoffs_deferred.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+
+                shard.symbol_count.store(static_cast<uint32_t>(shard.symbols.size()), std::memory_order_relaxed);
+            }
+        }
 
-            auto it = processors.find(symbol_id);
-            if (it == processors.end()) {
-                // Symbol not subscribed
+        // Attaches a detached symbol to its target shard; false if the
+        // target's command queue is full
+        bool forward(const ShardCommand &detach) {
+            GatewayShard &target = *shards[detach.forward_to];
+            if (!target.commands.try_push({ShardCommand::Type::Attach, detach.processor, NoShard})) {
+                return false;
+            }
+            target.wake.notify();
+            return true;
+        }
+
+        [[nodiscard]] uint32_t shard_for_symbol(const SymbolID symbol_id) const noexcept {
+            return symbol_shard(symbol_id, static_cast<uint32_t>(shards.size()));
+        }
+
+        void arbitrate_incremental(const uint16_t channel, const MDIncrementalMessage &msg) {
+            arbitrator.on_message(channel, msg.header.sequence_number, msg,
+                                  [this](const uint16_t in_channel, const MDIncrementalMessage &in_order) {
+                                      route_incremental(in_channel, in_order);
+                                  },
+                                  [this](const uint16_t gap_channel, uint32_t, uint32_t) {
+                                      mark_channel_stale(gap_channel);
+                                  });
+        }
+
+        void poll_arbitrator() {
+            arbitrator.poll([this](const uint16_t in_channel, const MDIncrementalMessage &in_order) {
+                                route_incremental(in_channel, in_order);
+                            },
+                            [this](const uint16_t gap_channel, uint32_t, uint32_t) {
+                                mark_channel_stale(gap_channel);
+                            });
+        }
+
+        [[nodiscard]] SymbolProcessor *find_subscribed(const SymbolID symbol_id) const noexcept {
+            SymbolProcessor *processor = processors.find(symbol_id);
+            if (processor == nullptr || !processor->running.load(std::memory_order_relaxed)) {
+                return nullptr; // Symbol not subscribed
+            }
+            return processor;
+        }
+
+        void route_incremental(const uint16_t channel, const MDIncrementalMessage &msg) {
+            SymbolProcessor *processor = find_subscribed(msg.symbol_id);
+            if (processor == nullptr) {
+                return;
+            }
+
+            if (UNLIKELY(processor->channel == NoChannel)) {
+                // First sighting: remember which channel's gaps affect this symbol
+                processor->channel = channel;
+                if (channel >= channel_symbols.size()) {
+                    channel_symbols.resize(static_cast<size_t>(channel) + 1);
+                }
+                channel_symbols[channel].push_back(processor);
+            }
+
+            if (UNLIKELY(processor->stale)) {
+                hold_for_recovery(*processor, msg);
                 return;
             }
 
-            SymbolProcessor *processor = it->second.get();
+            enqueue_incremental(*processor, msg);
+        }
+
+        // Unsequenced entry point used by the synthetic feed
+        void process_incremental_update(const MDIncrementalMessage *msg) {
+            if (SymbolProcessor *processor = find_subscribed(msg->symbol_id)) {
+                enqueue_incremental(*processor, *msg);
+            }
+        }
+
+        bool enqueue_incremental(SymbolProcessor &processor, const MDIncrementalMessage &msg) {
+            const Timestamp received = TimestampManager::get_hardware_timestamp();
+            return enqueue_tick(processor, msg.price, msg.quantity, msg.side, TickType::Incremental, received,
+                                TickTracer::begin(msg.exchange_timestamp, received));
+        }
 
+        bool enqueue_tick(SymbolProcessor &processor, const Price price, const Quantity quantity, const Side side,
+                          const TickType type) {
+            return enqueue_tick(processor, price, quantity, side, type, TimestampManager::get_hardware_timestamp(), 0);
+        }
+
+        bool enqueue_tick(SymbolProcessor &processor, const Price price, const Quantity quantity, const Side side,
+                          const TickType type, const Timestamp received, const uint32_t trace_id) {
             MarketTick tick{
-                .symbol_id = symbol_id,
-                .price = msg->price,
-                .quantity = msg->quantity,
-                .side = msg->side,
-                .timestamp = TimestampManager::get_hardware_timestamp(),
-                .sequence = processor->sequence_number.fetch_add(1, std::memory_order_relaxed)
+                .symbol_id = processor.symbol_id,
+                .trace_id = trace_id,
+                .price = price,
+                .quantity = quantity,
+                .timestamp = received,
+                .sequence = processor.sequence_number.fetch_add(1, std::memory_order_relaxed),
+                .side = side,
+                .type = type
             };
 
-            if (!processor->tick_queue.try_push(tick)) {
+            if (UNLIKELY(recorder != nullptr)) {
+                recorder->record_tick(tick);
+            }
+
+            if (UNLIKELY(config.block_when_full)) {
+                while (!processor.tick_queue.try_push(tick)) {
+                    if (!gateway_running.load(std::memory_order_acquire) ||
+                        !processor.running.load(std::memory_order_relaxed)) {
+                        return false;
+                    }
+                    wake_shards(); // Its shard may be asleep with this batch still unsent
+                    cpu_relax();
+                }
+                return true;
+            }
+
+            if (!processor.tick_queue.try_push(tick)) {
                 // Queue overflow
-                processor->messages_dropped.fetch_add(1, std::memory_order_relaxed);
-                handle_queue_overflow(symbol_id);
+                processor.messages_dropped.fetch_add(1, std::memory_order_relaxed);
+                handle_queue_overflow(processor.symbol_id);
+                return false;
+            }
+            return true;
+        }
+
+        // A lost message could have touched any symbol on the channel
+        void mark_channel_stale(const uint16_t channel) {
+            if (channel >= channel_symbols.size()) {
+                return;
+            }
+
+            for (SymbolProcessor *processor: channel_symbols[channel]) {
+                if (!processor->stale) {
+                    processor->stale = true;
+                    processor->has_recovery_floor = false;
+                    processor->recovery_buffer.clear();
+                }
+            }
+        }
+
+        static void hold_for_recovery(SymbolProcessor &processor, const MDIncrementalMessage &msg) {
+            if (processor.recovery_buffer.size() >= MaxRecoveryBuffer) {
+                // Out of room: only a snapshot that already includes msg can be used now
+                processor.recovery_buffer.clear();
+                processor.recovery_floor = msg.header.sequence_number;
+                processor.has_recovery_floor = true;
+                return;
             }
+
+            processor.recovery_buffer.push_back(msg);
         }
 
-        void process_snapshot_update(const MDSnapshotMessage *msg) const {
-            // Snapshot processing would rebuild the entire order book
-            // This is a simplified version
+        void process_snapshot_update(const MDSnapshotMessage *msg, const size_t length) {
             const SymbolID symbol_id = msg->symbol_id;
 
+            if (UNLIKELY(length < sizeof(MDSnapshotMessage) + msg->num_levels * sizeof(MDSnapshotLevel))) {
+                total_parsing_errors.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            if (SymbolProcessor *processor = find_subscribed(symbol_id); processor && processor->stale) {
+                const auto levels = std::span(
+                    reinterpret_cast<const MDSnapshotLevel *>(reinterpret_cast<const uint8_t *>(msg) +
+                                                              sizeof(MDSnapshotMessage)), msg->num_levels);
+                recover_symbol(*processor, msg->header.sequence_number, levels);
+                return;
+            }
+
+            // Book is current; just publish its top
             if (order_book_manager) {
-                if (const OrderBook<> *book = order_book_manager->get_or_create_order_book(symbol_id);
+                if (const OrderBook<> *book = order_book_manager->get_order_book(symbol_id);
                     book && snapshot_callback) {
                     const auto snapshot = book->get_snapshot();
                     snapshot_callback(symbol_id, snapshot);
@@ -231,12 +724,52 @@ namespace trading_engine {
             }
         }
 
-        void process_tick(const MarketTick &tick) const {
-            // Update order book
-            if (order_book_manager) {
-                order_book_manager->process_market_data(tick);
+        // The rebuild goes through the tick queue so the shard stays the book's only
+        // writer: reset, snapshot levels, then the held incrementals newer than it
+        void recover_symbol(SymbolProcessor &processor, const uint32_t snapshot_sequence,
+                            const std::span<const MDSnapshotLevel> levels) {
+            if (processor.has_recovery_floor &&
+                static_cast<int32_t>(snapshot_sequence - processor.recovery_floor) < 0) {
+                return; // Too old to replay onto; wait for the next one
+            }
+
+            bool complete = enqueue_tick(processor, 0, 0, Side::Buy, TickType::BookReset);
+
+            for (size_t i = 0; complete && i < levels.size(); ++i) {
+                complete = enqueue_tick(processor, levels[i].price, levels[i].quantity, levels[i].side,
+                                        TickType::SnapshotLevel);
+            }
+
+            for (size_t i = 0; complete && i < processor.recovery_buffer.size(); ++i) {
+                const MDIncrementalMessage &held = processor.recovery_buffer[i];
+                if (static_cast<int32_t>(held.header.sequence_number - snapshot_sequence) > 0) {
+                    complete = enqueue_incremental(processor, held);
+                }
             }
 
+            if (!complete) {
+                // Partial rebuild; stay stale so the next snapshot resets it again
+                recovery_failures.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            processor.stale = false;
+            processor.has_recovery_floor = false;
+            processor.recovery_buffer.clear();
+            symbols_recovered.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void process_tick(const SymbolProcessor &processor, const MarketTick &tick) const {
+            // Update order book; the shard is its only writer
+            if (processor.book) {
+                if (UNLIKELY(tick.type == TickType::BookReset)) {
+                    processor.book->clear();
+                    return;
+                }
+                processor.book->update_level(tick.side, tick.price, tick.quantity);
+            }
+            TickTracer::stamp(tick.trace_id, TickTracer::Stage::BookUpdated);
+
             // Notify callback
             if (tick_callback) {
                 tick_callback(tick);
@@ -258,8 +791,7 @@ namespace trading_engine {
             }
 
             SymbolID symbol_id = 1; // Test symbol
-            auto it = processors.find(symbol_id);
-            if (it == processors.end()) {
+            if (processors.find(symbol_id) == nullptr) {
                 return;
             }
 
@@ -279,9 +811,28 @@ namespace trading_engine {
                 .exchange_timestamp = TimestampManager::get_hardware_timestamp()
             };
 
+            if (UNLIKELY(recorder != nullptr)) {
+                recorder->record_packet(PacketView{
+                    .data = reinterpret_cast<const uint8_t *>(&synthetic_msg),
+                    .length = sizeof(synthetic_msg),
+                    .channel = 0,
+                    .feed = 0,
+                    .hardware_timestamp = false,
+                    .rx_timestamp_ns = 0
+                });
+            }
+
             process_incremental_update(&synthetic_msg);
         }
 
+        uint64_t count_active_symbols() const {
+            uint64_t active = 0;
+            processors.for_each([&active](SymbolID, const SymbolProcessor &processor) {
+                active += processor.running.load(std::memory_order_relaxed) ? 1 : 0;
+            });
+            return active;
+        }
+
         double calculate_processing_rate() const {
             // Simple rate calculation - in production this would be more sophisticated
             static auto last_time = std::chrono::steady_clock::now();
@@ -3,36 +3,55 @@
 #include "../core/types.h"
 #include "../core/memory.h"
 #include "../core/timing.h"
+#include "../core/seqlock.h"
+#include "../core/symbol_directory.h"
 
-#include <unordered_map>
 #include <vector>
 #include <algorithm>
-#include <shared_mutex>
-#include <mutex>
+#include <bit>
+#include <cstring>
+#include <span>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
 
 namespace trading_engine {
     // High-performance order book implementation
+    //
+    // Single writer: only the gateway thread that owns the symbol calls
+    // update_level. Readers (strategies, risk, stats) never take a lock; they
+    // copy what they need under the version seqlock and retry on a concurrent
+    // update.
     template<size_t MaxLevels = 1000>
     class OrderBook {
+    public:
         struct Level {
             Price price;
             Quantity quantity;
             uint32_t order_count;
         };
 
+    private:
+        // The search kernel loads whole 8-price blocks from any starting
+        // level, so the column runs one block past MaxLevels and a block
+        // starting at the last level stays in bounds. Lanes past the range
+        // searched are masked off.
+        static constexpr size_t SearchBlock = 8;
+        static constexpr size_t PaddedLevels = MaxLevels + SearchBlock;
+
+        // Structure-of-arrays: the search only touches the price column
         struct alignas(CacheLineSize) BookSide {
-            std::array<Level, MaxLevels> levels;
-            std::atomic<uint32_t> level_count{0};
-
-            // Price-to-index mapping for O(1) lookup
-            std::unordered_map<Price, uint16_t> price_to_index;
-            mutable std::shared_mutex index_mutex;
+            alignas(CacheLineSize) std::array<Price, PaddedLevels> prices{};
+            alignas(CacheLineSize) std::array<Quantity, MaxLevels> quantities{};
+            alignas(CacheLineSize) std::array<uint32_t, MaxLevels> order_counts{};
+            uint32_t level_count{0};
         };
 
         BookSide bids; // Sorted descending (highest first)
         BookSide asks; // Sorted ascending (lowest first)
 
-        alignas(CacheLineSize) std::atomic<std::uint64_t> version{0};
+        alignas(CacheLineSize) SeqLock version;
         alignas(CacheLineSize) std::atomic<Price> best_bid{0};
         alignas(CacheLineSize) std::atomic<Price> best_ask{UINT64_MAX};
         alignas(CacheLineSize) std::atomic<Quantity> best_bid_qty{0};
@@ -40,27 +59,37 @@ namespace trading_engine {
 
     public:
         void update_level(Side side, Price price, Quantity quantity) noexcept {
-            MEASURE_LATENCY(LatencyProfiler::Order_processing); {
-                BookSide &book_side = (side == Side::Buy) ? bids : asks;
-                std::unique_lock lock(book_side.index_mutex);
-
-                auto it = book_side.price_to_index.find(price);
-                if (it != book_side.price_to_index.end()) {
-                    // Update existing level
-                    uint16_t index = it->second;
-                    if (quantity == 0) {
-                        remove_level(book_side, index, price);
-                    } else {
-                        book_side.levels[index].quantity = quantity;
-                    }
-                } else if (quantity > 0) {
-                    // Add new level
-                    add_level(book_side, price, quantity);
+            MEASURE_LATENCY(LatencyProfiler::Order_processing);
+
+            const bool is_bid_side = side == Side::Buy;
+            BookSide &book_side = is_bid_side ? bids : asks;
+
+            version.write_begin();
+
+            const uint32_t index = find_level_index(book_side, price, is_bid_side);
+            if (index < book_side.level_count && book_side.prices[index] == price) {
+                // Update existing level
+                if (quantity == 0) {
+                    remove_level(book_side, index);
+                } else {
+                    book_side.quantities[index] = quantity;
                 }
+            } else if (quantity > 0) {
+                // Add new level
+                add_level(book_side, index, price, quantity);
             }
 
             update_best_prices();
-            version.fetch_add(1, std::memory_order_release);
+            version.write_end();
+        }
+
+        // Drops every level, e.g. before rebuilding from a snapshot
+        void clear() noexcept {
+            version.write_begin();
+            bids.level_count = 0;
+            asks.level_count = 0;
+            update_best_prices();
+            version.write_end();
         }
 
         struct BookSnapshot {
@@ -72,15 +101,53 @@ namespace trading_engine {
             Timestamp timestamp;
         };
 
+        // Top levels of both sides taken under a single version
+        template<size_t Depth>
+        struct DepthSnapshot {
+            std::array<Level, Depth> bids;
+            std::array<Level, Depth> asks;
+            uint32_t bid_count;
+            uint32_t ask_count;
+            std::uint64_t version;
+        };
+
         BookSnapshot get_snapshot() const noexcept {
-            return BookSnapshot{
-                .best_bid_price = best_bid.load(std::memory_order_acquire),
-                .best_ask_price = best_ask.load(std::memory_order_acquire),
-                .best_bid_qty = best_bid_qty.load(std::memory_order_acquire),
-                .best_ask_qty = best_ask_qty.load(std::memory_order_acquire),
-                .version = version.load(std::memory_order_acquire),
-                .timestamp = TimestampManager::get_hardware_timestamp()
-            };
+            BookSnapshot snapshot{};
+
+            while (true) {
+                const std::uint64_t seq = version.read_begin();
+                snapshot.best_bid_price = best_bid.load(std::memory_order_relaxed);
+                snapshot.best_ask_price = best_ask.load(std::memory_order_relaxed);
+                snapshot.best_bid_qty = best_bid_qty.load(std::memory_order_relaxed);
+                snapshot.best_ask_qty = best_ask_qty.load(std::memory_order_relaxed);
+                if (!version.read_retry(seq)) {
+                    snapshot.version = seq;
+                    break;
+                }
+            }
+
+            snapshot.timestamp = TimestampManager::get_hardware_timestamp();
+            return snapshot;
+        }
+
+        template<size_t Depth = 10>
+        DepthSnapshot<Depth> get_depth_snapshot() const noexcept {
+            DepthSnapshot<Depth> snapshot{};
+
+            while (true) {
+                const std::uint64_t seq = version.read_begin();
+                snapshot.bid_count = copy_side(bids, snapshot.bids.data(), Depth);
+                snapshot.ask_count = copy_side(asks, snapshot.asks.data(), Depth);
+                if (!version.read_retry(seq)) {
+                    snapshot.version = seq;
+                    return snapshot;
+                }
+            }
+        }
+
+        // Even value of the book seqlock; advances by two per update
+        std::uint64_t get_version() const noexcept {
+            return version.current();
         }
 
         Price get_best_bid() const noexcept {
@@ -93,52 +160,20 @@ namespace trading_engine {
         }
 
         Quantity get_bid_quantity(Price price) const noexcept {
-            std::shared_lock lock(bids.index_mutex);
-            auto it = bids.price_to_index.find(price);
-            if (it != bids.price_to_index.end()) {
-                return bids.levels[it->second].quantity;
-            }
-            return 0;
+            return version.read([&] { return level_quantity(bids, price, true); });
         }
 
         Quantity get_ask_quantity(Price price) const noexcept {
-            std::shared_lock lock(asks.index_mutex);
-            auto it = asks.price_to_index.find(price);
-            if (it != asks.price_to_index.end()) {
-                return asks.levels[it->second].quantity;
-            }
-            return 0;
+            return version.read([&] { return level_quantity(asks, price, false); });
         }
 
         // Get top N levels
         std::vector<Level> get_bid_levels(size_t depth = 10) const {
-            std::shared_lock lock(bids.index_mutex);
-            std::vector<Level> result;
-
-            uint32_t count = std::min(static_cast<uint32_t>(depth),
-                                      bids.level_count.load(std::memory_order_acquire));
-            result.reserve(count);
-
-            for (uint32_t i = 0; i < count; ++i) {
-                result.push_back(bids.levels[i]);
-            }
-
-            return result;
+            return copy_levels(bids, depth);
         }
 
         std::vector<Level> get_ask_levels(size_t depth = 10) const {
-            std::shared_lock lock(asks.index_mutex);
-            std::vector<Level> result;
-
-            uint32_t count = std::min(static_cast<uint32_t>(depth),
-                                      asks.level_count.load(std::memory_order_acquire));
-            result.reserve(count);
-
-            for (uint32_t i = 0; i < count; ++i) {
-                result.push_back(asks.levels[i]);
-            }
-
-            return result;
+            return copy_levels(asks, depth);
         }
 
         bool is_crossed() const noexcept {
@@ -169,91 +204,180 @@ namespace trading_engine {
         }
 
     private:
-        void add_level(BookSide &book_side, Price price, Quantity quantity) {
-            uint32_t current_count = book_side.level_count.load(std::memory_order_acquire);
+        // Ranges at most this long are scanned by the SIMD kernel; longer
+        // ones are first narrowed by binary search
+        static constexpr uint32_t SearchWindow = 32;
 
-            if (UNLIKELY(current_count >= MaxLevels)) {
-                return; // Book is full
+        static bool is_better(const Price level_price, const Price price, const bool is_bid_side) noexcept {
+            return is_bid_side ? level_price > price : level_price < price;
+        }
+
+        // First index whose price is not better than price. Updates cluster at
+        // the top of the book, so the first block is tried before narrowing.
+        static uint32_t find_level_index(const BookSide &book_side, const Price price,
+                                         const bool is_bid_side) noexcept {
+            const uint32_t count = std::min<uint32_t>(book_side.level_count, MaxLevels);
+            const Price *prices = book_side.prices.data();
+
+            const uint32_t head = std::min<uint32_t>(count, SearchBlock);
+            const uint32_t in_head = count_better(prices, head, price, is_bid_side);
+            if (in_head < head || head == count) {
+                return in_head;
             }
 
-            // Find insertion point to maintain sorted order
-            uint32_t insert_index = 0;
-            bool is_bid_side = (&book_side == &bids);
-
-            for (uint32_t i = 0; i < current_count; ++i) {
-                if (is_bid_side) {
-                    // Bids: descending order (highest first)
-                    if (price > book_side.levels[i].price) {
-                        insert_index = i;
-                        break;
-                    }
-                    insert_index = i + 1;
+            uint32_t low = head;
+            uint32_t high = count;
+            while (high - low > SearchWindow) {
+                const uint32_t mid = low + (high - low) / 2;
+                if (is_better(prices[mid], price, is_bid_side)) {
+                    low = mid + 1;
                 } else {
-                    // Asks: ascending order (lowest first)
-                    if (price < book_side.levels[i].price) {
-                        insert_index = i;
-                        break;
-                    }
-                    insert_index = i + 1;
+                    high = mid;
                 }
             }
 
-            // Shift elements to make room
-            for (uint32_t i = current_count; i > insert_index; --i) {
-                book_side.levels[i] = book_side.levels[i - 1];
+            return low + count_better(prices + low, high - low, price, is_bid_side);
+        }
+
+        // Number of leading prices in [prices, prices + n) better than price.
+        // Levels are sorted, so better prices always form a prefix. Reads up
+        // to SearchBlock - 1 prices past n, which PaddedLevels leaves room for.
+        static uint32_t count_better(const Price *prices, const uint32_t n, const Price price,
+                                     const bool is_bid_side) noexcept {
+            uint32_t count = 0;
+
+#if defined(__AVX512F__)
+            const __m512i target = _mm512_set1_epi64(static_cast<long long>(price));
+            for (uint32_t i = 0; i < n; i += 8) {
+                const __m512i block = _mm512_loadu_si512(prices + i);
+                __mmask8 mask = is_bid_side
+                                    ? _mm512_cmpgt_epu64_mask(block, target)
+                                    : _mm512_cmplt_epu64_mask(block, target);
+                if (n - i < 8) {
+                    mask &= static_cast<__mmask8>((1U << (n - i)) - 1);
+                }
+                count += std::popcount(static_cast<unsigned>(mask));
+                if (mask != 0xFF) {
+                    break;
+                }
+            }
+#elif defined(__AVX2__)
+            // AVX2 only has a signed 64-bit compare, so bias both operands
+            const __m256i bias = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ULL));
+            const __m256i target = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(price)), bias);
+            for (uint32_t i = 0; i < n; i += 4) {
+                const __m256i block = _mm256_xor_si256(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(prices + i)), bias);
+                const __m256i better = is_bid_side
+                                           ? _mm256_cmpgt_epi64(block, target)
+                                           : _mm256_cmpgt_epi64(target, block);
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(better)));
+                if (n - i < 4) {
+                    mask &= (1U << (n - i)) - 1;
+                }
+                count += std::popcount(mask);
+                if (mask != 0xF) {
+                    break;
+                }
+            }
+#else
+            while (count < n && is_better(prices[count], price, is_bid_side)) {
+                ++count;
+            }
+#endif
+
+            return count;
+        }
 
-                // Update index mapping
-                Price shifted_price = book_side.levels[i].price;
-                book_side.price_to_index[shifted_price] = i;
+        static Quantity level_quantity(const BookSide &book_side, const Price price, const bool is_bid_side) noexcept {
+            const uint32_t index = find_level_index(book_side, price, is_bid_side);
+            if (index < std::min<uint32_t>(book_side.level_count, MaxLevels) &&
+                book_side.prices[index] == price) {
+                return book_side.quantities[index];
             }
+            return 0;
+        }
+
+        // Reader-side copy; only valid if the surrounding read does not retry
+        static uint32_t copy_side(const BookSide &book_side, Level *out, const size_t depth) noexcept {
+            const uint32_t count = std::min({
+                static_cast<uint32_t>(depth), book_side.level_count, static_cast<uint32_t>(MaxLevels)
+            });
+            for (uint32_t i = 0; i < count; ++i) {
+                out[i] = Level{
+                    .price = book_side.prices[i],
+                    .quantity = book_side.quantities[i],
+                    .order_count = book_side.order_counts[i]
+                };
+            }
+            return count;
+        }
+
+        std::vector<Level> copy_levels(const BookSide &book_side, const size_t depth) const {
+            std::vector<Level> result(std::min(depth, MaxLevels));
+
+            const uint32_t count = version.read([&] {
+                return copy_side(book_side, result.data(), result.size());
+            });
+
+            result.resize(count);
+            return result;
+        }
+
+        // Move levels [from, count) to start at to, one bulk move per column
+        static void move_levels(BookSide &book_side, const uint32_t from, const uint32_t to,
+                                const uint32_t count) noexcept {
+            const size_t moved = count - from;
+            std::memmove(&book_side.prices[to], &book_side.prices[from], moved * sizeof(Price));
+            std::memmove(&book_side.quantities[to], &book_side.quantities[from], moved * sizeof(Quantity));
+            std::memmove(&book_side.order_counts[to], &book_side.order_counts[from], moved * sizeof(uint32_t));
+        }
+
+        void add_level(BookSide &book_side, uint32_t insert_index, Price price, Quantity quantity) noexcept {
+            const uint32_t current_count = book_side.level_count;
+
+            if (UNLIKELY(current_count >= MaxLevels)) {
+                return; // Book is full
+            }
+
+            // Shift elements to make room
+            move_levels(book_side, insert_index, insert_index + 1, current_count);
 
             // Insert new level
-            book_side.levels[insert_index] = Level{
-                .price = price,
-                .quantity = quantity,
-                .order_count = 1
-            };
+            book_side.prices[insert_index] = price;
+            book_side.quantities[insert_index] = quantity;
+            book_side.order_counts[insert_index] = 1;
 
-            book_side.price_to_index[price] = insert_index;
-            book_side.level_count.store(current_count + 1, std::memory_order_release);
+            book_side.level_count = current_count + 1;
         }
 
-        void remove_level(BookSide &book_side, uint16_t index, Price price) {
-            uint32_t current_count = book_side.level_count.load(std::memory_order_acquire);
+        void remove_level(BookSide &book_side, uint32_t index) noexcept {
+            const uint32_t current_count = book_side.level_count;
 
             if (index >= current_count) {
                 return;
             }
 
             // Shift elements to fill the gap
-            for (uint32_t i = index; i < current_count - 1; ++i) {
-                book_side.levels[i] = book_side.levels[i + 1];
-
-                // Update index mapping
-                Price shifted_price = book_side.levels[i].price;
-                book_side.price_to_index[shifted_price] = i;
-            }
+            move_levels(book_side, index + 1, index, current_count);
 
-            book_side.price_to_index.erase(price);
-            book_side.level_count.store(current_count - 1, std::memory_order_release);
+            book_side.level_count = current_count - 1;
         }
 
         void update_best_prices() noexcept {
             // Update best bid
-            uint32_t bid_count = bids.level_count.load(std::memory_order_acquire);
-            if (bid_count > 0) {
-                best_bid.store(bids.levels[0].price, std::memory_order_release);
-                best_bid_qty.store(bids.levels[0].quantity, std::memory_order_release);
+            if (bids.level_count > 0) {
+                best_bid.store(bids.prices[0], std::memory_order_release);
+                best_bid_qty.store(bids.quantities[0], std::memory_order_release);
             } else {
                 best_bid.store(0, std::memory_order_release);
                 best_bid_qty.store(0, std::memory_order_release);
             }
 
             // Update best ask
-            uint32_t ask_count = asks.level_count.load(std::memory_order_acquire);
-            if (ask_count > 0) {
-                best_ask.store(asks.levels[0].price, std::memory_order_release);
-                best_ask_qty.store(asks.levels[0].quantity, std::memory_order_release);
+            if (asks.level_count > 0) {
+                best_ask.store(asks.prices[0], std::memory_order_release);
+                best_ask_qty.store(asks.quantities[0], std::memory_order_release);
             } else {
                 best_ask.store(UINT64_MAX, std::memory_order_release);
                 best_ask_qty.store(0, std::memory_order_release);
@@ -262,46 +386,39 @@ namespace trading_engine {
     };
 
     // Order book manager for multiple symbols
+    //
+    // Books are looked up through a lock-free symbol directory. Register every
+    // traded symbol at startup so no book is ever created on the tick path.
     class OrderBookManager {
-        std::unordered_map<SymbolID, std::unique_ptr<OrderBook<> > > order_books;
-        mutable std::shared_mutex books_mutex;
+        SymbolDirectory<OrderBook<>, MaxSymbolCount, 1> order_books;
 
     public:
-        OrderBook<> *get_order_book(SymbolID symbol_id) {
-            std::shared_lock lock(books_mutex);
-
-            auto it = order_books.find(symbol_id);
-            if (it != order_books.end()) {
-                return it->second.get();
-            }
+        // Books registered from now on go on the node of the threads that update them
+        void place_on_node(const int node) {
+            order_books.place_on_node(node);
+        }
 
-            return nullptr;
+        bool register_symbol(SymbolID symbol_id) {
+            return order_books.get_or_create(symbol_id) != nullptr;
         }
 
-        OrderBook<> *get_or_create_order_book(SymbolID symbol_id) {
-            // Try shared lock first
-            {
-                std::shared_lock lock(books_mutex);
-                auto it = order_books.find(symbol_id);
-                if (it != order_books.end()) {
-                    return it->second.get();
-                }
+        void register_symbols(std::span<const SymbolID> symbol_ids) {
+            for (const SymbolID symbol_id: symbol_ids) {
+                register_symbol(symbol_id);
             }
+        }
 
-            // Need to create new order book
-            std::unique_lock lock(books_mutex);
+        OrderBook<> *get_order_book(SymbolID symbol_id) const noexcept {
+            return order_books.find(symbol_id);
+        }
 
-            // Double-check in case another thread created it
-            auto it = order_books.find(symbol_id);
-            if (it != order_books.end()) {
-                return it->second.get();
+        OrderBook<> *get_or_create_order_book(SymbolID symbol_id) {
+            if (OrderBook<> *book = order_books.find(symbol_id); LIKELY(book != nullptr)) {
+                return book;
             }
 
-            auto book = std::make_unique<OrderBook<> >();
-            OrderBook<> *book_ptr = book.get();
-            order_books[symbol_id] = std::move(book);
-
-            return book_ptr;
+            // Symbol was not pre-registered: cold path, takes the directory mutex
+            return order_books.get_or_create(symbol_id);
         }
 
         void process_market_data(const MarketTick &tick) {
@@ -311,19 +428,17 @@ namespace trading_engine {
         }
 
         std::vector<SymbolID> get_active_symbols() const {
-            std::shared_lock lock(books_mutex);
             std::vector<SymbolID> symbols;
             symbols.reserve(order_books.size());
 
-            for (const auto &[symbol_id, book]: order_books) {
+            order_books.for_each([&symbols](const SymbolID symbol_id, const OrderBook<> &) {
                 symbols.push_back(symbol_id);
-            }
+            });
 
             return symbols;
         }
 
         size_t get_book_count() const {
-            std::shared_lock lock(books_mutex);
             return order_books.size();
         }
     };
@@ -0,0 +1,298 @@
+#pragma once
+
+#include "../core/types.h"
+#include "../core/memory.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <ctime>
+#endif
+
+namespace trading_engine {
+    // One received datagram, viewed in place in the transport's buffers.
+    // Views stay valid until the next receive_batch() call on the same transport.
+    struct PacketView {
+        const uint8_t *data;
+        uint32_t length;
+        uint16_t channel; // Logical feed channel (e.g. one multicast group per channel)
+        uint8_t feed; // Redundant line: 0 = A, 1 = B
+        bool hardware_timestamp; // rx_timestamp_ns came from the NIC
+        uint64_t rx_timestamp_ns; // CLOCK_REALTIME receive time, 0 if unavailable
+    };
+
+    // Packet source for the market data gateway. The socket implementation
+    // below is the default; kernel-bypass stacks (ef_vi, DPDK, AF_XDP) plug in
+    // by implementing the same three calls and handing out views of their own
+    // receive rings, so the parser never changes.
+    class IFeedTransport {
+    public:
+        virtual ~IFeedTransport() = default;
+
+        virtual bool open() = 0;
+
+        virtual void close() = 0;
+
+        // Non-blocking; fills up to packets.size() views and returns the count
+        virtual size_t receive_batch(std::span<PacketView> packets) = 0;
+
+        // Packets dropped for not fitting the transport's buffers; any thread
+        [[nodiscard]] virtual uint64_t packets_truncated() const noexcept {
+            return 0;
+        }
+    };
+
+#ifdef __linux__
+    struct MulticastEndpoint {
+        std::string group; // e.g. "239.1.1.1"
+        uint16_t port;
+        std::string interface_address{"0.0.0.0"}; // Local interface to join on
+        // NIC to switch receive stamping on for, e.g. "eth0". Empty leaves the
+        // NIC as configured outside the engine (hwstamp_ctl, ethtool).
+        std::string device{};
+        uint16_t channel{0};
+        uint8_t feed{0};
+    };
+
+    struct UdpTransportConfig {
+        std::vector<MulticastEndpoint> endpoints;
+        int receive_buffer_bytes{8 * 1024 * 1024};
+        bool hardware_timestamps{true}; // Falls back to software stamps if the NIC can't
+    };
+
+    // UDP multicast receiver that batch-reads datagrams with recvmmsg(2) into a
+    // pre-allocated ring of cache-aligned buffers, so messages can be parsed in place.
+    // Datagrams longer than MaxDatagramSize are dropped and counted rather than
+    // handed out cut short.
+    class UdpMulticastTransport final : public IFeedTransport {
+    public:
+        static constexpr size_t MaxDatagramSize = 2048;
+        static constexpr size_t RingSize = 64; // Datagrams per receive_batch()
+
+    private:
+        static constexpr size_t ControlSize = 256;
+
+        struct alignas(CacheLineSize) PacketBuffer {
+            std::array<uint8_t, MaxDatagramSize> bytes;
+        };
+
+        struct Socket {
+            int fd{-1};
+            uint16_t channel{0};
+            uint8_t feed{0};
+        };
+
+        UdpTransportConfig config;
+        std::vector<Socket> sockets;
+        size_t next_socket{0}; // Round-robin start so one busy group can't starve the rest
+        std::atomic<uint64_t> truncated{0}; // Written by the receiving thread only
+        size_t devices_stamping{0};
+
+        std::vector<PacketBuffer> buffers;
+        std::vector<std::array<uint8_t, ControlSize> > control;
+        std::array<mmsghdr, RingSize> headers{};
+        std::array<iovec, RingSize> iovecs{};
+
+    public:
+        explicit UdpMulticastTransport(UdpTransportConfig transport_config)
+            : config(std::move(transport_config)), buffers(RingSize), control(RingSize) {
+            for (size_t i = 0; i < RingSize; ++i) {
+                iovecs[i] = iovec{.iov_base = buffers[i].bytes.data(), .iov_len = MaxDatagramSize};
+            }
+        }
+
+        ~UdpMulticastTransport() override {
+            close();
+        }
+
+        bool open() override {
+            close();
+
+            for (const MulticastEndpoint &endpoint: config.endpoints) {
+                const int fd = open_socket(endpoint);
+                if (fd < 0) {
+                    close();
+                    return false;
+                }
+                sockets.push_back(Socket{.fd = fd, .channel = endpoint.channel, .feed = endpoint.feed});
+            }
+
+            return !sockets.empty();
+        }
+
+        void close() override {
+            for (const Socket &socket: sockets) {
+                ::close(socket.fd);
+            }
+            sockets.clear();
+            devices_stamping = 0;
+        }
+
+        // Datagrams dropped for not fitting MaxDatagramSize
+        [[nodiscard]] uint64_t packets_truncated() const noexcept override {
+            return truncated.load(std::memory_order_relaxed);
+        }
+
+        // Endpoints whose device accepted hardware receive stamping in open()
+        [[nodiscard]] size_t hardware_stamping_devices() const noexcept {
+            return devices_stamping;
+        }
+
+        size_t receive_batch(std::span<PacketView> packets) override {
+            const size_t capacity = std::min(packets.size(), RingSize);
+            size_t received = 0;
+            size_t used = 0; // Buffers filled; runs ahead of received by the dropped datagrams
+
+            for (size_t n = 0; n < sockets.size() && used < capacity; ++n) {
+                const Socket &socket = sockets[(next_socket + n) % sockets.size()];
+                const size_t slots = capacity - used;
+
+                for (size_t i = 0; i < slots; ++i) {
+                    const size_t slot = used + i;
+                    headers[slot].msg_hdr = msghdr{
+                        .msg_name = nullptr,
+                        .msg_namelen = 0,
+                        .msg_iov = &iovecs[slot],
+                        .msg_iovlen = 1,
+                        .msg_control = control[slot].data(),
+                        .msg_controllen = ControlSize,
+                        .msg_flags = 0
+                    };
+                }
+
+                const int count = ::recvmmsg(socket.fd, &headers[used], static_cast<unsigned>(slots),
+                                             MSG_DONTWAIT, nullptr);
+                if (count <= 0) {
+                    continue; // EAGAIN or a transient error; try the next socket
+                }
+
+                for (int i = 0; i < count; ++i) {
+                    const size_t slot = used + static_cast<size_t>(i);
+                    if (UNLIKELY(headers[slot].msg_hdr.msg_flags & MSG_TRUNC)) {
+                        // The tail is gone; parsing the rest would misread the feed
+                        truncated.store(truncated.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                        continue;
+                    }
+
+                    PacketView &packet = packets[received++];
+                    packet.data = buffers[slot].bytes.data();
+                    packet.length = headers[slot].msg_len;
+                    packet.channel = socket.channel;
+                    packet.feed = socket.feed;
+                    read_timestamp(headers[slot].msg_hdr, packet);
+                }
+
+                used += static_cast<size_t>(count);
+            }
+
+            if (!sockets.empty()) {
+                next_socket = (next_socket + 1) % sockets.size();
+            }
+
+            return received;
+        }
+
+    private:
+        int open_socket(const MulticastEndpoint &endpoint) {
+            const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+            if (fd < 0) {
+                return -1;
+            }
+
+            // Several processes (or the A and B lines) may bind the same port
+            constexpr int enable = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &config.receive_buffer_bytes,
+                         sizeof(config.receive_buffer_bytes));
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(endpoint.port);
+            if (::inet_pton(AF_INET, endpoint.group.c_str(), &address.sin_addr) != 1 ||
+                ::bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+                ::close(fd);
+                return -1;
+            }
+
+            ip_mreq membership{};
+            membership.imr_multiaddr = address.sin_addr;
+            if (::inet_pton(AF_INET, endpoint.interface_address.c_str(), &membership.imr_interface) != 1 ||
+                ::setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) {
+                ::close(fd);
+                return -1;
+            }
+
+            // Not fatal: without support the kernel simply attaches no stamp
+            int timestamping = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+            if (config.hardware_timestamps) {
+                timestamping |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+                devices_stamping += !endpoint.device.empty() && enable_device_stamping(fd, endpoint.device);
+            }
+            ::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &timestamping, sizeof(timestamping));
+
+            return fd;
+        }
+
+        // SO_TIMESTAMPING only asks for stamps; the NIC must also be told to
+        // take them. Needs CAP_NET_ADMIN, and changes the device for every
+        // socket on it; without it, stamping stays as set up outside the engine.
+        static bool enable_device_stamping(const int fd, const std::string &device) noexcept {
+            if (device.size() >= IFNAMSIZ) {
+                return false;
+            }
+
+            hwtstamp_config stamping{};
+            stamping.tx_type = HWTSTAMP_TX_OFF;
+            stamping.rx_filter = HWTSTAMP_FILTER_ALL;
+
+            ifreq request{};
+            std::memcpy(request.ifr_name, device.c_str(), device.size());
+            request.ifr_data = reinterpret_cast<char *>(&stamping);
+            return ::ioctl(fd, SIOCSHWTSTAMP, &request) == 0 && stamping.rx_filter != HWTSTAMP_FILTER_NONE;
+        }
+
+        static void read_timestamp(const msghdr &header, PacketView &packet) noexcept {
+            packet.hardware_timestamp = false;
+            packet.rx_timestamp_ns = 0;
+
+            for (cmsghdr *cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr;
+                 cmsg = CMSG_NXTHDR(const_cast<msghdr *>(&header), cmsg)) {
+                if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_TIMESTAMPING) {
+                    continue;
+                }
+
+                scm_timestamping stamps{};
+                std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+
+                // ts[2] is the raw hardware stamp, ts[0] the software one
+                if (stamps.ts[2].tv_sec != 0 || stamps.ts[2].tv_nsec != 0) {
+                    packet.rx_timestamp_ns = to_nanoseconds(stamps.ts[2]);
+                    packet.hardware_timestamp = true;
+                } else {
+                    packet.rx_timestamp_ns = to_nanoseconds(stamps.ts[0]);
+                }
+                return;
+            }
+        }
+
+        static uint64_t to_nanoseconds(const timespec &ts) noexcept {
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+        }
+    };
+#endif
+}
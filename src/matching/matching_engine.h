@@ -2,17 +2,42 @@
 
 #include "../core/types.h"
 #include "../core/memory.h"
+#include "../core/symbol_directory.h"
 #include "../core/timing.h"
 #include "../risk/risk_manager.h"
+#include "price_ladder.h"
 
 #include <unordered_map>
 #include <vector>
 #include <algorithm>
-#include <map>
-#include <functional>
+#include <limits>
+#include <span>
 
 namespace trading_engine {
+    // Receives a matching engine's output as it happens. process_order and
+    // cancel_order take any type with these two members, so output goes
+    // straight to where it is needed (a trade ring, position updates) with
+    // no allocation or indirect call per fill.
+    struct NullMatchSink {
+        static void on_trade(const Trade &) noexcept {
+        }
+
+        // A resting order filled, partly filled or was cancelled, or an
+        // incoming order's unfilled part was cancelled instead of resting
+        static void on_order_update(const Order &) noexcept {
+        }
+    };
+
     // Order matching engine
+    //
+    // Keeps one book per symbol. Not thread-safe: one thread (a matching
+    // shard) drives each engine, and an engine only sees its shard's symbols.
+    //
+    // Limit orders rest what they cannot fill unless they are IOC or FOK;
+    // market orders never rest. FOK orders are killed up front when the
+    // book cannot fill them. Stop and StopLimit orders wait in the symbol's
+    // trigger book until a trade prints at or through the stop price, then
+    // enter as market and limit orders.
     class MatchingEngine {
         struct OrderEntry {
             Order order;
@@ -26,12 +51,14 @@ namespace trading_engine {
 
         // Price level containing orders at the same price
         struct PriceLevel {
-            Price price;
+            Price price{0};
             Quantity total_quantity{0};
             uint32_t order_count{0};
             OrderEntry *first_order{nullptr};
             OrderEntry *last_order{nullptr};
 
+            PriceLevel() = default;
+
             explicit PriceLevel(const Price p) : price(p) {
             }
 
@@ -72,83 +99,284 @@ namespace trading_engine {
             }
         };
 
-        // Order book sides
-        using price_level_map = std::map<Price, std::unique_ptr<PriceLevel> >;
+        // Order book sides: tick-indexed ladders with an ordered fallback.
+        // Stops are rare, so their ladders keep a narrower window.
+        using price_ladder = PriceLadder<PriceLevel>;
+        using stop_ladder = PriceLadder<PriceLevel, 256>;
+
+        struct SymbolBook {
+            price_ladder bid_levels; // Best is highest
+            price_ladder ask_levels; // Best is lowest
+            Quantity bid_depth{0}; // Resting quantity per side, for FOK checks
+            Quantity ask_depth{0};
+
+            // Parked stops by stop price. Buy stops trigger once the last
+            // trade is at or above their price, sell stops at or below.
+            stop_ladder buy_stops;
+            stop_ladder sell_stops;
+            Price last_trade_price{0}; // 0 until the first trade
+        };
 
-        price_level_map bid_levels; // Descending order (highest first)
-        price_level_map ask_levels; // Ascending order (lowest first)
+        SymbolDirectory<SymbolBook, MaxSymbolCount, 1> books;
+        Price ladder_tick_size; // For books created from now on
+
+        // Order tracking. The pool grows by a chunk at a time, to 1M resting
+        // orders; the matching thread goes through its cache so acquires and
+        // releases stay off the shared free list.
+        using OrderPool = LockFreeMemoryPool<OrderEntry, 16384>;
 
-        // Order tracking
         std::unordered_map<OrderID, OrderEntry *> order_lookup;
-        LockFreeMemoryPool<OrderEntry, 10000> order_pool;
-        LockFreeMemoryPool<Trade, 1000> trade_pool;
+        OrderPool order_pool{MemoryPoolConfig{.max_chunks = 64, .numa_node = -1}};
+        OrderPool::LocalCache order_cache{order_pool};
+
+        // Fills collected for callers that pass no sink; reused every call
+        static constexpr size_t TradeBufferReserve = 256;
+        std::vector<Trade> trade_buffer;
+
+        // Trade IDs carry the shard so they stay unique across shards
+        uint32_t shard_index;
+        TradeID next_trade_id;
 
         // Statistics
         std::atomic<std::uint64_t> total_orders_processed{0};
         std::atomic<std::uint64_t> total_trades_generated{0};
         std::atomic<std::uint64_t> total_volume_matched{0};
 
-        // Callbacks
-        std::function<void(const Trade &)> trade_callback;
-        std::function<void(const Order &)> order_update_callback;
-
     public:
+        // A cent: prices are scaled by PriceScale, so a one-unit tick would
+        // leave every level but the first outside the ladder window
+        static constexpr Price DefaultTickSize = PriceScale / 100;
+
+        explicit MatchingEngine(const uint32_t shard = 0, const Price tick_size = DefaultTickSize)
+            : ladder_tick_size(tick_size), shard_index(shard), next_trade_id(with_shard(1, shard)) {
+            // Books follow the engine onto its node when it is built node-local
+            books.place_on_node(NodeScope::current());
+            trade_buffer.reserve(TradeBufferReserve);
+        }
+
+        // What happened to an order; its trades went to the sink. Trades of
+        // stops it triggered went there too but are not counted here.
+        struct MatchSummary {
+            uint32_t trade_count{0};
+            Quantity filled_quantity{0};
+            bool fully_matched{false};
+            bool rested{false}; // The remainder joined the book
+            bool cancelled{false}; // The remainder was cancelled: IOC, market, FOK that could not fill, or no room
+            bool parked{false}; // A stop waiting in the trigger book
+            bool duplicate{false}; // Refused untouched: an order under its orderID is still open
+        };
+
         struct MatchResult {
-            std::vector<Trade *> trades;
+            std::span<const Trade> trades; // Valid until the next process_order
             bool fully_matched{false};
-            OrderEntry *remaining_order{nullptr};
         };
 
-        void set_trade_callback(std::function<void(const Trade &)> callback) {
-            trade_callback = std::move(callback);
-        }
+        // Matches an order and rests what is left, handing each fill and
+        // resting-order update to `sink` as it happens. An order reusing the
+        // ID of one still open is refused with `duplicate` set, before it
+        // touches the book; the caller reports it.
+        template<typename Sink>
+        MatchSummary process_order(const Order &incoming_order, Sink &sink) {
+            MEASURE_LATENCY(LatencyProfiler::Order_matching);
+
+            total_orders_processed.fetch_add(1, std::memory_order_relaxed);
 
-        void set_order_update_callback(std::function<void(const Order &)> callback) {
-            order_update_callback = std::move(callback);
+            if (UNLIKELY(order_lookup.contains(incoming_order.orderID))) {
+                MatchSummary refused;
+                refused.duplicate = true;
+                return refused;
+            }
+
+            SymbolBook *book = book_for(incoming_order.symbolID);
+            if (UNLIKELY(book == nullptr)) {
+                // Symbol directory full: the order cannot trade or rest
+                MatchSummary refused;
+                refused.cancelled = true;
+                cancel_remainder(incoming_order, refused, sink);
+                return refused;
+            }
+
+            const Price last_price = book->last_trade_price;
+            const MatchSummary summary = is_stop(incoming_order)
+                                             ? park_stop(*book, incoming_order, sink)
+                                             : execute(*book, incoming_order, sink);
+            check_stops(*book, last_price, sink);
+            return summary;
         }
 
+        // Collects the trades into a buffer the engine reuses; it only
+        // allocates when one order fills more times than any before it
         MatchResult process_order(const Order &incoming_order) {
-            MEASURE_LATENCY(LatencyProfiler::Order_matching);
+            trade_buffer.clear();
+            TradeCollector collector{trade_buffer};
+            const MatchSummary summary = process_order(incoming_order, collector);
+            return MatchResult{.trades = trade_buffer, .fully_matched = summary.fully_matched};
+        }
 
-            total_orders_processed.fetch_add(1, std::memory_order_relaxed);
+        // Grows the pool ahead of need; matching thread only, between orders
+        void maintain_pools() noexcept {
+            (void) order_pool.maintain();
+        }
 
-            MatchResult result;
+        [[nodiscard]] uint32_t shard() const noexcept {
+            return shard_index;
+        }
 
-            if (incoming_order.side == Side::Buy) {
-                result = match_buy_order(incoming_order);
-            } else {
-                result = match_sell_order(incoming_order);
+        // Creates the symbol's book ahead of its first order, off the hot path
+        bool register_symbol(const SymbolID symbol_id) {
+            return book_for(symbol_id) != nullptr;
+        }
+
+        // Tick size of the ladder window for every book; 0 keeps every level
+        // in the ordered fallback map. Only allowed while all books are empty.
+        bool configure_price_ladder(const Price tick_size) noexcept {
+            bool all_empty = true;
+            books.for_each([&all_empty](SymbolID, const SymbolBook &book) {
+                all_empty = all_empty && book_empty(book);
+            });
+            if (!all_empty) {
+                return false;
             }
 
-            // Add remaining quantity to book if not fully matched
-            if (!result.fully_matched && result.remaining_order != nullptr) {
-                add_order_to_book(result.remaining_order);
+            ladder_tick_size = tick_size;
+            bool configured = true;
+            books.for_each([&configured, tick_size](SymbolID, SymbolBook &book) {
+                configured = configure_book(book, tick_size) && configured;
+            });
+            return configured;
+        }
+
+        // Tick size of one symbol's ladders, for instruments off the common
+        // grid; creates the book, and is only allowed while it is empty
+        bool configure_symbol_ladder(const SymbolID symbol_id, const Price tick_size) {
+            SymbolBook *book = book_for(symbol_id);
+            return book != nullptr && book_empty(*book) && configure_book(*book, tick_size);
+        }
+
+        template<typename Sink>
+        bool cancel_order(const OrderID order_id, Sink &sink) {
+            const auto it = order_lookup.find(order_id);
+            if (it == order_lookup.end()) {
+                return false; // Order not found
             }
 
-            return result;
+            cancel_entry(it, sink);
+            return true;
         }
 
         bool cancel_order(const OrderID order_id) {
+            NullMatchSink sink;
+            return cancel_order(order_id, sink);
+        }
+
+        // Amends a resting order or parked stop to a new price and open
+        // quantity without a pool or order map round trip. Shrinking at the
+        // same price keeps queue priority; growing goes to the back of the
+        // level. A new price moves the entry straight to its new level, or
+        // matches it first when the price now crosses. Zero quantity cancels.
+        // A new position in the queue is timed at `timestamp`, so a replay
+        // can requeue the order exactly. False if the order is not resting.
+        template<typename Sink>
+        bool modify_order(const OrderID order_id, const Price new_price, const Quantity new_quantity, Sink &sink,
+                          const Timestamp timestamp = TimestampManager::get_hardware_timestamp()) {
             const auto it = order_lookup.find(order_id);
             if (it == order_lookup.end()) {
                 return false; // Order not found
             }
+            return modify_entry(it, new_price, new_quantity, sink, timestamp);
+        }
 
-            OrderEntry *entry = it->second;
-            remove_order_from_book(entry);
+        bool modify_order(const OrderID order_id, const Price new_price, const Quantity new_quantity) {
+            NullMatchSink sink;
+            return modify_order(order_id, new_price, new_quantity, sink);
+        }
 
-            // Update order status
-            entry->order.status = OrderStatus::Cancelled;
-            if (order_update_callback) {
-                order_update_callback(entry->order);
+        // modify_order for an amend off the order path, which names the
+        // order's symbol and side as well as its new terms. Risk checked it
+        // under those, so one naming another symbol or side than the order
+        // rests under is refused like a miss.
+        template<typename Sink>
+        bool amend_order(const Order &request, Sink &sink) {
+            const auto it = order_lookup.find(request.orderID);
+            if (it == order_lookup.end() || it->second->order.symbolID != request.symbolID ||
+                it->second->order.side != request.side) {
+                return false;
             }
+            return modify_entry(it, request.price, request.quantity, sink, request.timestamp);
+        }
 
-            order_pool.release(entry);
-            order_lookup.erase(it);
+        // What a book keeps besides its orders
+        struct BookCheckpoint {
+            SymbolID symbol_id;
+            uint32_t reserved;
+            Price last_trade_price;
+        };
 
+        // Appends every book and every resting order and parked stop, level
+        // by level from the best price and in queue order within a level, so
+        // restore() rebuilds the same queues. Matching thread only.
+        void checkpoint(std::vector<BookCheckpoint> &book_states, std::vector<Order> &orders) {
+            books.for_each([&](const SymbolID symbol_id, SymbolBook &book) {
+                book_states.push_back(BookCheckpoint{
+                    .symbol_id = symbol_id,
+                    .reserved = 0,
+                    .last_trade_price = book.last_trade_price
+                });
+                for (PriceLevel *level = book.bid_levels.highest(); level != nullptr;
+                     level = book.bid_levels.next_lower(level->price)) {
+                    append_queue(*level, orders);
+                }
+                for (PriceLevel *level = book.ask_levels.lowest(); level != nullptr;
+                     level = book.ask_levels.next_higher(level->price)) {
+                    append_queue(*level, orders);
+                }
+                for (PriceLevel *level = book.buy_stops.lowest(); level != nullptr;
+                     level = book.buy_stops.next_higher(level->price)) {
+                    append_queue(*level, orders);
+                }
+                for (PriceLevel *level = book.sell_stops.highest(); level != nullptr;
+                     level = book.sell_stops.next_lower(level->price)) {
+                    append_queue(*level, orders);
+                }
+            });
+        }
+
+        // Loads what checkpoint() captured into an engine that has no
+        // orders yet. False if the pool runs out.
+        bool restore(std::span<const BookCheckpoint> book_states, std::span<const Order> orders,
+                     const TradeID trade_id) {
+            for (const BookCheckpoint &state: book_states) {
+                if (SymbolBook *book = book_for(state.symbol_id)) {
+                    book->last_trade_price = state.last_trade_price;
+                }
+            }
+
+            for (const Order &order: orders) {
+                SymbolBook *book = book_for(order.symbolID);
+                OrderEntry *entry = order_cache.acquire();
+                if (book == nullptr || entry == nullptr) {
+                    return false;
+                }
+
+                entry->order = order;
+                if (is_stop(order)) {
+                    stop_ladder &stops = order.side == Side::Buy ? book->buy_stops : book->sell_stops;
+                    stops.find_or_insert(order.stopPrice)->add_order(entry);
+                    order_lookup[order.orderID] = entry;
+                } else {
+                    add_order_to_book(*book, entry);
+                }
+            }
+
+            next_trade_id = trade_id;
             return true;
         }
 
+        // The ID the next trade gets
+        [[nodiscard]] TradeID get_next_trade_id() const noexcept {
+            return next_trade_id;
+        }
+
         struct BookState {
             Price best_bid{0};
             Price best_ask{0};
@@ -158,23 +386,26 @@ namespace trading_engine {
             uint32_t ask_levels_count{0};
         };
 
-        BookState get_book_state() const {
+        BookState get_book_state(const SymbolID symbol_id) const {
             BookState state;
 
-            if (!bid_levels.empty()) {
-                const auto it = bid_levels.rbegin(); // Highest bid (reverse iterator)
-                state.best_bid = it->first;
-                state.best_bid_qty = it->second->total_quantity;
+            const SymbolBook *book = books.find(symbol_id);
+            if (book == nullptr) {
+                return state;
             }
 
-            if (!ask_levels.empty()) {
-                auto it = ask_levels.begin(); // Lowest ask
-                state.best_ask = it->first;
-                state.best_ask_qty = it->second->total_quantity;
+            if (const PriceLevel *level = book->bid_levels.highest()) {
+                state.best_bid = level->price;
+                state.best_bid_qty = level->total_quantity;
             }
 
-            state.bid_levels_count = static_cast<uint32_t>(bid_levels.size());
-            state.ask_levels_count = static_cast<uint32_t>(ask_levels.size());
+            if (const PriceLevel *level = book->ask_levels.lowest()) {
+                state.best_ask = level->price;
+                state.best_ask_qty = level->total_quantity;
+            }
+
+            state.bid_levels_count = static_cast<uint32_t>(book->bid_levels.size());
+            state.ask_levels_count = static_cast<uint32_t>(book->ask_levels.size());
 
             return state;
         }
@@ -185,6 +416,18 @@ namespace trading_engine {
             std::uint64_t total_volume;
             double match_rate;
             double average_fill_size;
+            MemoryPoolStats order_pool; // Resting orders
+
+            // Folds in another shard's figures
+            MatchingStats &operator+=(const MatchingStats &other) noexcept {
+                total_orders += other.total_orders;
+                total_trades += other.total_trades;
+                total_volume += other.total_volume;
+                match_rate = total_orders > 0 ? static_cast<double>(total_trades) / total_orders : 0.0;
+                average_fill_size = total_trades > 0 ? static_cast<double>(total_volume) / total_trades : 0.0;
+                order_pool += other.order_pool;
+                return *this;
+            }
         };
 
         MatchingStats get_statistics() const {
@@ -197,100 +440,369 @@ namespace trading_engine {
                 .total_trades = trades,
                 .total_volume = volume,
                 .match_rate = orders > 0 ? static_cast<double>(trades) / orders : 0.0,
-                .average_fill_size = trades > 0 ? static_cast<double>(volume) / trades : 0.0
+                .average_fill_size = trades > 0 ? static_cast<double>(volume) / trades : 0.0,
+                .order_pool = order_pool.get_statistics()
             };
         }
 
     private:
-        MatchResult match_buy_order(const Order &buy_order) {
-            MatchResult result;
-            result.fully_matched = false;
+        SymbolBook *book_for(const SymbolID symbol_id) {
+            if (SymbolBook *book = books.find(symbol_id); LIKELY(book != nullptr)) {
+                return book;
+            }
+
+            // Symbol was not registered: cold path, takes the directory mutex
+            return books.get_or_create(symbol_id, [this](SymbolBook &book) {
+                (void) configure_book(book, ladder_tick_size);
+            });
+        }
+
+        static bool book_empty(const SymbolBook &book) noexcept {
+            return book.bid_levels.empty() && book.ask_levels.empty() &&
+                   book.buy_stops.empty() && book.sell_stops.empty();
+        }
+
+        static bool configure_book(SymbolBook &book, const Price tick_size) noexcept {
+            return book.bid_levels.configure(tick_size) && book.ask_levels.configure(tick_size) &&
+                   book.buy_stops.configure(tick_size) && book.sell_stops.configure(tick_size);
+        }
+
+        // Sink for the collecting process_order overload
+        struct TradeCollector {
+            std::vector<Trade> &trades;
+
+            void on_trade(const Trade &trade) const {
+                trades.push_back(trade);
+            }
+
+            static void on_order_update(const Order &) noexcept {
+            }
+        };
+
+        static void append_queue(const PriceLevel &level, std::vector<Order> &orders) {
+            for (const OrderEntry *entry = level.first_order; entry != nullptr; entry = entry->next) {
+                orders.push_back(entry->order);
+            }
+        }
+
+        template<typename Sink>
+        bool modify_entry(const std::unordered_map<OrderID, OrderEntry *>::iterator it, const Price new_price,
+                          const Quantity new_quantity, Sink &sink, const Timestamp timestamp) {
+            if (new_quantity == 0) {
+                cancel_entry(it, sink);
+                return true;
+            }
+
+            OrderEntry *entry = it->second;
+            Order &order = entry->order;
+            SymbolBook &book = *books.find(order.symbolID);
+            const bool buy = order.side == Side::Buy;
+
+            if (is_stop(order)) {
+                // Stops are keyed by stop price, so limit and size change in place
+                PriceLevel *level = (buy ? book.buy_stops : book.sell_stops).find(order.stopPrice);
+                level->total_quantity = level->total_quantity - order.quantity + new_quantity;
+                order.price = new_price;
+                order.quantity = new_quantity;
+                sink.on_order_update(order);
+                return true;
+            }
+
+            price_ladder &ladder = buy ? book.bid_levels : book.ask_levels;
+            Quantity &depth = buy ? book.bid_depth : book.ask_depth;
+            PriceLevel *level = ladder.find(order.price);
+
+            if (new_price == order.price) {
+                if (new_quantity <= order.quantity) {
+                    const Quantity reduction = order.quantity - new_quantity;
+                    order.quantity = new_quantity;
+                    level->total_quantity -= reduction;
+                    depth -= reduction;
+                } else {
+                    depth += new_quantity - order.quantity;
+                    level->remove_order(entry);
+                    order.quantity = new_quantity;
+                    order.timestamp = timestamp;
+                    level->add_order(entry);
+                }
+                sink.on_order_update(order);
+                return true;
+            }
+
+            level->remove_order(entry);
+            if (level->empty()) {
+                ladder.erase(order.price);
+            }
+            depth -= order.quantity;
+            order.price = new_price;
+            order.quantity = new_quantity;
+            order.timestamp = timestamp;
+
+            if (crosses(book, order)) {
+                // Matches as an incoming order; the remainder rests again
+                const Order amended = order;
+                order_lookup.erase(it);
+                order_cache.release(entry);
+
+                const Price last_price = book.last_trade_price;
+                (void) execute(book, amended, sink);
+                check_stops(book, last_price, sink);
+                return true;
+            }
+
+            ladder.find_or_insert(new_price)->add_order(entry);
+            depth += new_quantity;
+            sink.on_order_update(order);
+            return true;
+        }
+
+        template<typename Sink>
+        void cancel_entry(const std::unordered_map<OrderID, OrderEntry *>::iterator it, Sink &sink) {
+            OrderEntry *entry = it->second;
+            remove_order_from_book(entry);
+
+            // Update order status
+            entry->order.status = OrderStatus::Cancelled;
+            sink.on_order_update(entry->order);
+
+            order_cache.release(entry);
+            order_lookup.erase(it);
+        }
+
+        // Only a new last price can trigger stops
+        template<typename Sink>
+        void check_stops(SymbolBook &book, const Price last_price, Sink &sink) {
+            if (UNLIKELY(book.last_trade_price != last_price) && (!book.buy_stops.empty() || !book.sell_stops.empty())) {
+                trigger_stops(book, sink);
+            }
+        }
+
+        // Whether a limit order at its price would trade against the other side
+        [[nodiscard]] static bool crosses(const SymbolBook &book, const Order &order) noexcept {
+            if (order.side == Side::Buy) {
+                const PriceLevel *best_ask = book.ask_levels.lowest();
+                return best_ask != nullptr && best_ask->price <= order.price;
+            }
+            const PriceLevel *best_bid = book.bid_levels.highest();
+            return best_bid != nullptr && best_bid->price >= order.price;
+        }
+
+        [[nodiscard]] static bool is_stop(const Order &order) noexcept {
+            return order.orderType == OrderType::Stop || order.orderType == OrderType::StopLimit;
+        }
+
+        // Only limit orders without IOC or FOK keep what they cannot fill
+        [[nodiscard]] static bool rests(const Order &order) noexcept {
+            return order.orderType == OrderType::Limit &&
+                   (order.timeInForce == TimeInForce::Day || order.timeInForce == TimeInForce::Gtc);
+        }
+
+        // Worst price the order may trade at; market orders take any price
+        [[nodiscard]] static Price price_limit(const Order &order) noexcept {
+            if (order.orderType != OrderType::Market) {
+                return order.price;
+            }
+            return order.side == Side::Buy ? std::numeric_limits<Price>::max() : 0;
+        }
+
+        // Matches a market or limit order and applies its time in force
+        template<typename Sink>
+        MatchSummary execute(SymbolBook &book, const Order &order, Sink &sink) {
+            const Price limit = price_limit(order);
+
+            if (UNLIKELY(order.timeInForce == TimeInForce::Fok) && !can_fill(book, order, limit)) {
+                MatchSummary killed;
+                killed.cancelled = true;
+                cancel_remainder(order, killed, sink);
+                return killed;
+            }
 
+            MatchSummary summary;
+            if (order.side == Side::Buy) {
+                summary = match_buy_order(book, order, limit, sink);
+                book.ask_depth -= summary.filled_quantity;
+            } else {
+                summary = match_sell_order(book, order, limit, sink);
+                book.bid_depth -= summary.filled_quantity;
+            }
+
+            if (!summary.fully_matched) {
+                if (rests(order)) {
+                    summary.rested = rest_order(book, order, order.quantity - summary.filled_quantity);
+                }
+                if (!summary.rested) {
+                    // IOC or market, or the order pool is exhausted
+                    summary.cancelled = true;
+                    cancel_remainder(order, summary, sink);
+                }
+            }
+            return summary;
+        }
+
+        // FOK pre-check, made before any fill is touched. The side's depth
+        // total rejects most misses in O(1) and decides market orders
+        // outright; otherwise only the level totals the order would consume
+        // are summed, never their orders.
+        [[nodiscard]] static bool can_fill(SymbolBook &book, const Order &order, const Price limit) noexcept {
+            const bool buy = order.side == Side::Buy;
+            if ((buy ? book.ask_depth : book.bid_depth) < order.quantity) {
+                return false;
+            }
+            if (order.orderType == OrderType::Market) {
+                return true;
+            }
+
+            Quantity available = 0;
+            if (buy) {
+                for (const PriceLevel *level = book.ask_levels.lowest();
+                     level != nullptr && level->price <= limit; level = book.ask_levels.next_higher(level->price)) {
+                    if ((available += level->total_quantity) >= order.quantity) {
+                        return true;
+                    }
+                }
+            } else {
+                for (const PriceLevel *level = book.bid_levels.highest();
+                     level != nullptr && level->price >= limit; level = book.bid_levels.next_lower(level->price)) {
+                    if ((available += level->total_quantity) >= order.quantity) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        template<typename Sink>
+        static void cancel_remainder(const Order &order, const MatchSummary &summary, Sink &sink) {
+            Order cancelled = order;
+            cancelled.quantity = order.quantity - summary.filled_quantity;
+            cancelled.filledQuantity = summary.filled_quantity;
+            cancelled.status = OrderStatus::Cancelled;
+            sink.on_order_update(cancelled);
+        }
+
+        [[nodiscard]] static bool stop_triggered(const SymbolBook &book, const Order &stop) noexcept {
+            const Price last = book.last_trade_price;
+            return last != 0 && (stop.side == Side::Buy ? last >= stop.stopPrice : last <= stop.stopPrice);
+        }
+
+        // What a stop becomes once triggered
+        [[nodiscard]] static Order triggered(const Order &stop) noexcept {
+            Order order = stop;
+            order.orderType = stop.orderType == OrderType::Stop ? OrderType::Market : OrderType::Limit;
+            return order;
+        }
+
+        // Runs a stop whose trigger already traded; parks the rest
+        template<typename Sink>
+        MatchSummary park_stop(SymbolBook &book, const Order &stop, Sink &sink) {
+            if (stop_triggered(book, stop)) {
+                return execute(book, triggered(stop), sink);
+            }
+
+            MatchSummary summary;
+            OrderEntry *entry = order_cache.acquire();
+            if (UNLIKELY(entry == nullptr)) {
+                summary.cancelled = true;
+                cancel_remainder(stop, summary, sink);
+                return summary;
+            }
+
+            entry->order = stop;
+            entry->order.status = OrderStatus::Incoming;
+            stop_ladder &stops = stop.side == Side::Buy ? book.buy_stops : book.sell_stops;
+            stops.find_or_insert(stop.stopPrice)->add_order(entry);
+            order_lookup[stop.orderID] = entry;
+            summary.parked = true;
+            return summary;
+        }
+
+        // Each triggered stop may trade and move the price again, so keep
+        // going until no parked stop is due; they run in trigger-price order
+        template<typename Sink>
+        void trigger_stops(SymbolBook &book, Sink &sink) {
+            while (OrderEntry *entry = next_triggered_stop(book)) {
+                const Order stop = entry->order;
+                remove_order_from_book(entry);
+                order_lookup.erase(stop.orderID);
+                order_cache.release(entry);
+                (void) execute(book, triggered(stop), sink);
+            }
+        }
+
+        static OrderEntry *next_triggered_stop(SymbolBook &book) noexcept {
+            const Price last = book.last_trade_price;
+            if (const PriceLevel *level = book.buy_stops.lowest(); level != nullptr && level->price <= last) {
+                return level->first_order;
+            }
+            if (const PriceLevel *level = book.sell_stops.highest(); level != nullptr && level->price >= last) {
+                return level->first_order;
+            }
+            return nullptr;
+        }
+
+        template<typename Sink>
+        MatchSummary match_buy_order(SymbolBook &book, const Order &buy_order, const Price limit, Sink &sink) {
+            price_ladder &ask_levels = book.ask_levels;
+            MatchSummary summary;
             Quantity remaining_qty = buy_order.quantity;
-            Order working_order = buy_order;
 
             // Match against ask levels (lowest price first)
-            auto ask_it = ask_levels.begin();
-            while (ask_it != ask_levels.end() && ask_it->first <= buy_order.price && remaining_qty > 0) {
-                PriceLevel *level = ask_it->second.get();
-                const Price level_price = ask_it->first;
+            PriceLevel *level = ask_levels.lowest();
+            while (level != nullptr && level->price <= limit && remaining_qty > 0) {
+                const Price level_price = level->price;
 
                 // Match against orders at this price level (FIFO)
                 OrderEntry *sell_order = level->first_order;
                 while (sell_order != nullptr && remaining_qty > 0) {
                     OrderEntry *next_order = sell_order->next; // Save before potential removal
 
-                    Quantity trade_qty = std::min(remaining_qty, sell_order->order.quantity);
-
-                    // Create trade
-                    if (Trade *trade = create_trade(working_order, sell_order->order, level_price, trade_qty)) {
-                        result.trades.push_back(trade);
-
-                        // Update quantities
-                        remaining_qty -= trade_qty;
-                        sell_order->order.quantity -= trade_qty;
-                        sell_order->order.filledQuantity += trade_qty;
-                        level->total_quantity -= trade_qty;
-
-                        total_volume_matched.fetch_add(trade_qty, std::memory_order_relaxed);
-
-                        // Update order status
-                        if (sell_order->order.quantity == 0) {
-                            sell_order->order.status = OrderStatus::Filled;
-                            level->remove_order(sell_order);
-                            order_lookup.erase(sell_order->order.orderID);
-                            order_pool.release(sell_order);
-                        } else {
-                            sell_order->order.status = OrderStatus::PartiallyFilled;
-                        }
-
-                        // Notify callbacks
-                        if (trade_callback) {
-                            trade_callback(*trade);
-                        }
-                        if (order_update_callback) {
-                            order_update_callback(sell_order->order);
-                        }
+                    const Quantity trade_qty = std::min(remaining_qty, sell_order->order.quantity);
+                    sink.on_trade(make_trade(buy_order, sell_order->order, level_price, trade_qty));
+                    ++summary.trade_count;
+
+                    // Update quantities
+                    remaining_qty -= trade_qty;
+                    sell_order->order.quantity -= trade_qty;
+                    sell_order->order.filledQuantity += trade_qty;
+                    level->total_quantity -= trade_qty;
+
+                    // Update order status
+                    if (sell_order->order.quantity == 0) {
+                        sell_order->order.status = OrderStatus::Filled;
+                        sink.on_order_update(sell_order->order);
+                        level->remove_order(sell_order);
+                        order_lookup.erase(sell_order->order.orderID);
+                        order_cache.release(sell_order);
+                    } else {
+                        sell_order->order.status = OrderStatus::PartiallyFilled;
+                        sink.on_order_update(sell_order->order);
                     }
 
                     sell_order = next_order;
                 }
 
+                book.last_trade_price = level_price;
+
                 // Remove empty price levels
                 if (level->empty()) {
-                    ask_it = ask_levels.erase(ask_it);
-                } else {
-                    ++ask_it;
+                    ask_levels.erase(level_price);
                 }
+                level = remaining_qty > 0 ? ask_levels.next_higher(level_price) : nullptr;
             }
 
-            result.fully_matched = (remaining_qty == 0);
-
-            // Create remaining order entry if not fully matched
-            if (!result.fully_matched) {
-                if (OrderEntry *entry = order_pool.acquire()) {
-                    working_order.quantity = remaining_qty;
-                    working_order.status = OrderStatus::Incoming;
-                    entry->order = working_order;
-                    result.remaining_order = entry;
-                }
-            }
-
-            return result;
+            return finish_match(summary, buy_order.quantity, remaining_qty);
         }
 
-        MatchResult match_sell_order(const Order &sell_order) {
-            MatchResult result;
-            result.fully_matched = false;
-
+        template<typename Sink>
+        MatchSummary match_sell_order(SymbolBook &book, const Order &sell_order, const Price limit, Sink &sink) {
+            price_ladder &bid_levels = book.bid_levels;
+            MatchSummary summary;
             Quantity remaining_qty = sell_order.quantity;
-            Order working_order = sell_order;
 
             // Match against bid levels (highest price first)
-            auto bid_it = bid_levels.rbegin();
-            while (bid_it != bid_levels.rend() && bid_it->first >= sell_order.price && remaining_qty > 0) {
-                PriceLevel *level = bid_it->second.get();
-                const Price level_price = bid_it->first;
+            PriceLevel *level = bid_levels.highest();
+            while (level != nullptr && level->price >= limit && remaining_qty > 0) {
+                const Price level_price = level->price;
 
                 // Match against orders at this price level (FIFO)
                 OrderEntry *buy_order = level->first_order;
@@ -298,136 +810,117 @@ namespace trading_engine {
                     OrderEntry *next_order = buy_order->next;
 
                     const Quantity trade_qty = std::min(remaining_qty, buy_order->order.quantity);
-
-                    // Create trade
-                    if (Trade *trade = create_trade(buy_order->order, working_order, level_price, trade_qty)) {
-                        result.trades.push_back(trade);
-
-                        // Update quantities
-                        remaining_qty -= trade_qty;
-                        buy_order->order.quantity -= trade_qty;
-                        buy_order->order.filledQuantity += trade_qty;
-                        level->total_quantity -= trade_qty;
-
-                        total_volume_matched.fetch_add(trade_qty, std::memory_order_relaxed);
-
-                        // Update order status
-                        if (buy_order->order.quantity == 0) {
-                            buy_order->order.status = OrderStatus::Filled;
-                            level->remove_order(buy_order);
-                            order_lookup.erase(buy_order->order.orderID);
-                            order_pool.release(buy_order);
-                        } else {
-                            buy_order->order.status = OrderStatus::PartiallyFilled;
-                        }
-
-                        // Notify callbacks
-                        if (trade_callback) {
-                            trade_callback(*trade);
-                        }
-                        if (order_update_callback) {
-                            order_update_callback(buy_order->order);
-                        }
+                    sink.on_trade(make_trade(buy_order->order, sell_order, level_price, trade_qty));
+                    ++summary.trade_count;
+
+                    // Update quantities
+                    remaining_qty -= trade_qty;
+                    buy_order->order.quantity -= trade_qty;
+                    buy_order->order.filledQuantity += trade_qty;
+                    level->total_quantity -= trade_qty;
+
+                    // Update order status
+                    if (buy_order->order.quantity == 0) {
+                        buy_order->order.status = OrderStatus::Filled;
+                        sink.on_order_update(buy_order->order);
+                        level->remove_order(buy_order);
+                        order_lookup.erase(buy_order->order.orderID);
+                        order_cache.release(buy_order);
+                    } else {
+                        buy_order->order.status = OrderStatus::PartiallyFilled;
+                        sink.on_order_update(buy_order->order);
                     }
 
                     buy_order = next_order;
                 }
 
+                book.last_trade_price = level_price;
+
                 // Remove empty price levels
                 if (level->empty()) {
-                    // Convert reverse iterator to forward iterator for erase
-                    const auto forward_it = std::next(bid_it).base();
-                    bid_levels.erase(forward_it);
-                    bid_it = bid_levels.rbegin(); // Restart from beginning
-                } else {
-                    ++bid_it;
+                    bid_levels.erase(level_price);
                 }
+                level = remaining_qty > 0 ? bid_levels.next_lower(level_price) : nullptr;
             }
 
-            result.fully_matched = (remaining_qty == 0);
+            return finish_match(summary, sell_order.quantity, remaining_qty);
+        }
+
+        MatchSummary finish_match(MatchSummary summary, const Quantity quantity, const Quantity remaining_qty) noexcept {
+            summary.filled_quantity = quantity - remaining_qty;
+            summary.fully_matched = remaining_qty == 0;
+            total_trades_generated.fetch_add(summary.trade_count, std::memory_order_relaxed);
+            total_volume_matched.fetch_add(summary.filled_quantity, std::memory_order_relaxed);
+            return summary;
+        }
 
-            // Create remaining order entry if not fully matched
-            if (!result.fully_matched) {
-                if (OrderEntry *entry = order_pool.acquire()) {
-                    working_order.quantity = remaining_qty;
-                    working_order.status = OrderStatus::Incoming;
-                    entry->order = working_order;
-                    result.remaining_order = entry;
-                }
+        // Rests the unfilled part of an order; false if the pool is exhausted
+        bool rest_order(SymbolBook &book, const Order &order, const Quantity remaining_qty) {
+            OrderEntry *entry = order_cache.acquire();
+            if (UNLIKELY(entry == nullptr)) {
+                return false;
             }
 
-            return result;
+            entry->order = order;
+            entry->order.quantity = remaining_qty;
+            entry->order.status = OrderStatus::Incoming;
+            add_order_to_book(book, entry);
+            return true;
         }
 
-        void add_order_to_book(OrderEntry *entry) {
-            Price price = entry->order.price;
-
-            if (entry->order.side == Side::Buy) {
-                auto it = bid_levels.find(price);
-                if (it == bid_levels.end()) {
-                    auto level = std::make_unique<PriceLevel>(price);
-                    level->add_order(entry);
-                    bid_levels[price] = std::move(level);
-                } else {
-                    it->second->add_order(entry);
-                }
-            } else {
-                if (const auto it = ask_levels.find(price); it == ask_levels.end()) {
-                    auto level = std::make_unique<PriceLevel>(price);
-                    level->add_order(entry);
-                    ask_levels[price] = std::move(level);
-                } else {
-                    it->second->add_order(entry);
-                }
-            }
+        void add_order_to_book(SymbolBook &book, OrderEntry *entry) {
+            const bool buy = entry->order.side == Side::Buy;
+            price_ladder &ladder = buy ? book.bid_levels : book.ask_levels;
+            ladder.find_or_insert(entry->order.price)->add_order(entry);
+            (buy ? book.bid_depth : book.ask_depth) += entry->order.quantity;
 
             order_lookup[entry->order.orderID] = entry;
         }
 
+        // Takes a resting order or a parked stop out of its ladder
         void remove_order_from_book(const OrderEntry *entry) {
-            Price price = entry->order.price;
+            SymbolBook *book = books.find(entry->order.symbolID);
+            if (book == nullptr) {
+                return;
+            }
 
-            if (entry->order.side == Side::Buy) {
-                if (const auto it = bid_levels.find(price); it != bid_levels.end()) {
-                    it->second->remove_order(entry);
-                    if (it->second->empty()) {
-                        bid_levels.erase(it);
-                    }
-                }
-            } else {
-                auto it = ask_levels.find(price);
-                if (it != ask_levels.end()) {
-                    it->second->remove_order(entry);
-                    if (it->second->empty()) {
-                        ask_levels.erase(it);
-                    }
-                }
+            const bool buy = entry->order.side == Side::Buy;
+            if (is_stop(entry->order)) {
+                remove_from_ladder(buy ? book->buy_stops : book->sell_stops, entry->order.stopPrice, entry);
+                return;
+            }
+
+            if (remove_from_ladder(buy ? book->bid_levels : book->ask_levels, entry->order.price, entry)) {
+                (buy ? book->bid_depth : book->ask_depth) -= entry->order.quantity;
             }
         }
 
-        Trade *create_trade(const Order &buy_order, const Order &sell_order,
-                            Price trade_price, Quantity trade_qty) {
-            Trade *trade = trade_pool.acquire();
-            if (!trade) {
-                return nullptr;
+        template<typename Ladder>
+        static bool remove_from_ladder(Ladder &ladder, const Price price, const OrderEntry *entry) noexcept {
+            PriceLevel *level = ladder.find(price);
+            if (level == nullptr) {
+                return false;
             }
 
-            static std::atomic<TradeID> trade_id_generator{1};
+            level->remove_order(entry);
+            if (level->empty()) {
+                ladder.erase(price);
+            }
+            return true;
+        }
 
-            *trade = Trade{
-                .trade_id = trade_id_generator.fetch_add(1, std::memory_order_relaxed),
+        Trade make_trade(const Order &buy_order, const Order &sell_order,
+                         const Price trade_price, const Quantity trade_qty) noexcept {
+            return Trade{
+                .trade_id = next_trade_id++,
                 .buy_order_id = buy_order.orderID,
                 .sell_order_id = sell_order.orderID,
-                .symbol_id = buy_order.symbolID,
                 .price = trade_price,
                 .quantity = trade_qty,
                 .timestamp = TimestampManager::get_hardware_timestamp(),
+                .symbol_id = buy_order.symbolID,
                 .aggressor_side = determine_aggressor_side(buy_order, sell_order)
             };
-
-            total_trades_generated.fetch_add(1, std::memory_order_relaxed);
-
-            return trade;
         }
 
         static Side determine_aggressor_side(const Order &buy_order, const Order &sell_order) {
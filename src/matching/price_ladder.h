@@ -0,0 +1,257 @@
+#pragma once
+
+#include "../core/types.h"
+#include "../core/memory.h"
+
+#include <array>
+#include <bit>
+#include <map>
+#include <memory>
+
+namespace trading_engine {
+    // Tick-indexed price ladder for one side of a book
+    //
+    // Levels whose price falls on the tick grid inside a window of WindowTicks
+    // ticks live in a contiguous array and are found through an occupancy
+    // bitmap. Everything else (outside the window or off the grid) falls back
+    // to an ordered map, and queries merge both. The window is anchored on the
+    // first price seen and re-centred whenever it holds no levels.
+    template<typename Level, size_t WindowTicks = 4096>
+    class PriceLadder {
+        static_assert(WindowTicks > 0 && WindowTicks % 64 == 0, "WindowTicks must be a multiple of 64");
+        static constexpr size_t word_count = WindowTicks / 64;
+
+        alignas(CacheLineSize) std::array<std::uint64_t, word_count> occupancy{};
+        Price tick_size{1}; // 0 disables the window (map-only mode)
+        Price base_price{0}; // Price of slot 0
+        bool anchored{false};
+        size_t window_levels{0};
+
+        // Fallback for prices outside the window
+        std::map<Price, std::unique_ptr<Level> > overflow;
+
+        alignas(CacheLineSize) std::array<Level, WindowTicks> slots;
+
+    public:
+        // Changing the tick size is only allowed while the ladder is empty
+        bool configure(const Price new_tick_size) noexcept {
+            if (!empty()) {
+                return false;
+            }
+
+            tick_size = new_tick_size;
+            anchored = false;
+            return true;
+        }
+
+        [[nodiscard]] Price get_tick_size() const noexcept { return tick_size; }
+
+        [[nodiscard]] size_t size() const noexcept { return window_levels + overflow.size(); }
+
+        [[nodiscard]] bool empty() const noexcept { return window_levels == 0 && overflow.empty(); }
+
+        [[nodiscard]] size_t overflow_size() const noexcept { return overflow.size(); }
+
+        Level *find(const Price price) noexcept {
+            if (size_t index; window_index(price, index)) {
+                return test(index) ? &slots[index] : nullptr;
+            }
+
+            if (overflow.empty()) {
+                return nullptr;
+            }
+
+            const auto it = overflow.find(price);
+            return it != overflow.end() ? it->second.get() : nullptr;
+        }
+
+        Level *find_or_insert(const Price price) {
+            if (UNLIKELY(tick_size != 0 && window_levels == 0 && !covers(price))) {
+                recentre(price);
+            }
+
+            if (size_t index; window_index(price, index)) {
+                if (!test(index)) {
+                    slots[index] = Level(price);
+                    set(index);
+                    ++window_levels;
+                }
+                return &slots[index];
+            }
+
+            auto &level = overflow[price];
+            if (!level) {
+                level = std::make_unique<Level>(price);
+            }
+            return level.get();
+        }
+
+        // Drops the level at this price; the caller guarantees it is empty
+        void erase(const Price price) noexcept {
+            if (size_t index; window_index(price, index)) {
+                if (test(index)) {
+                    clear(index);
+                    --window_levels;
+                }
+                return;
+            }
+
+            overflow.erase(price);
+        }
+
+        Level *lowest() noexcept {
+            Level *window_level = window_levels > 0 ? find_next_from(0) : nullptr;
+            return pick_lower(window_level, overflow.empty() ? nullptr : overflow.begin()->second.get());
+        }
+
+        Level *highest() noexcept {
+            Level *window_level = window_levels > 0 ? find_prev_from(WindowTicks - 1) : nullptr;
+            return pick_higher(window_level, overflow.empty() ? nullptr : overflow.rbegin()->second.get());
+        }
+
+        const Level *lowest() const noexcept { return const_cast<PriceLadder *>(this)->lowest(); }
+
+        const Level *highest() const noexcept { return const_cast<PriceLadder *>(this)->highest(); }
+
+        // Next populated level strictly above price
+        Level *next_higher(const Price price) noexcept {
+            Level *window_level = nullptr;
+            if (window_levels > 0) {
+                if (price < base_price) {
+                    window_level = find_next_from(0);
+                } else if (const Price ticks = (price - base_price) / tick_size; ticks + 1 < WindowTicks) {
+                    window_level = find_next_from(static_cast<size_t>(ticks + 1));
+                }
+            }
+
+            Level *overflow_level = nullptr;
+            if (!overflow.empty()) {
+                if (const auto it = overflow.upper_bound(price); it != overflow.end()) {
+                    overflow_level = it->second.get();
+                }
+            }
+
+            return pick_lower(window_level, overflow_level);
+        }
+
+        // Next populated level strictly below price
+        Level *next_lower(const Price price) noexcept {
+            Level *window_level = nullptr;
+            if (window_levels > 0 && price > base_price) {
+                const Price offset = price - base_price;
+                Price ticks = offset / tick_size;
+                if (offset % tick_size == 0) {
+                    --ticks; // Exclude the level at price itself
+                }
+                window_level = find_prev_from(static_cast<size_t>(std::min<Price>(ticks, WindowTicks - 1)));
+            }
+
+            Level *overflow_level = nullptr;
+            if (!overflow.empty()) {
+                if (auto it = overflow.lower_bound(price); it != overflow.begin()) {
+                    overflow_level = std::prev(it)->second.get();
+                }
+            }
+
+            return pick_higher(window_level, overflow_level);
+        }
+
+    private:
+        [[nodiscard]] bool covers(const Price price) const noexcept {
+            return anchored && price >= base_price && (price - base_price) / tick_size < WindowTicks;
+        }
+
+        [[nodiscard]] bool window_index(const Price price, size_t &index) const noexcept {
+            if (tick_size == 0 || !anchored || price < base_price) {
+                return false;
+            }
+
+            const Price offset = price - base_price;
+            const Price ticks = offset / tick_size;
+            if (ticks >= WindowTicks || ticks * tick_size != offset) {
+                return false;
+            }
+
+            index = static_cast<size_t>(ticks);
+            return true;
+        }
+
+        // Centre the window on price and pull in any fallback levels it now covers.
+        // Only called while the window holds no levels, so no slot is live.
+        void recentre(const Price price) {
+            constexpr Price half_window = WindowTicks / 2;
+
+            const Price ticks_below = std::min<Price>(half_window, price / tick_size);
+            base_price = price - ticks_below * tick_size; // Stays on price's tick grid
+            anchored = true;
+
+            for (auto it = overflow.begin(); it != overflow.end();) {
+                if (size_t index; window_index(it->first, index)) {
+                    slots[index] = *it->second;
+                    set(index);
+                    ++window_levels;
+                    it = overflow.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        [[nodiscard]] bool test(const size_t index) const noexcept {
+            return (occupancy[index / 64] >> (index % 64)) & 1ULL;
+        }
+
+        void set(const size_t index) noexcept {
+            occupancy[index / 64] |= 1ULL << (index % 64);
+        }
+
+        void clear(const size_t index) noexcept {
+            occupancy[index / 64] &= ~(1ULL << (index % 64));
+        }
+
+        // First populated slot at or after index
+        Level *find_next_from(const size_t index) noexcept {
+            size_t word = index / 64;
+            std::uint64_t bits = occupancy[word] & (~0ULL << (index % 64));
+
+            while (true) {
+                if (bits != 0) {
+                    return &slots[word * 64 + std::countr_zero(bits)];
+                }
+                if (++word == word_count) {
+                    return nullptr;
+                }
+                bits = occupancy[word];
+            }
+        }
+
+        // Last populated slot at or before index
+        Level *find_prev_from(const size_t index) noexcept {
+            size_t word = index / 64;
+            const unsigned shift = 63 - static_cast<unsigned>(index % 64);
+            std::uint64_t bits = occupancy[word] & (~0ULL >> shift);
+
+            while (true) {
+                if (bits != 0) {
+                    return &slots[word * 64 + 63 - std::countl_zero(bits)];
+                }
+                if (word-- == 0) {
+                    return nullptr;
+                }
+                bits = occupancy[word];
+            }
+        }
+
+        static Level *pick_lower(Level *a, Level *b) noexcept {
+            if (a == nullptr) return b;
+            if (b == nullptr) return a;
+            return a->price <= b->price ? a : b;
+        }
+
+        static Level *pick_higher(Level *a, Level *b) noexcept {
+            if (a == nullptr) return b;
+            if (b == nullptr) return a;
+            return a->price >= b->price ? a : b;
+        }
+    };
+}
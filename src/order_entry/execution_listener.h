@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../core/types.h"
+
+namespace trading_engine {
+    // Hears every fill and order update the engine produces, on the thread
+    // that produced it: the matching threads, and the risk thread for risk
+    // rejections. Calls come from several threads at once and sit on the
+    // matching path, so implementations hand the event off and return.
+    class IExecutionListener {
+    public:
+        virtual ~IExecutionListener() = default;
+
+        virtual void on_trade(const Trade &trade) = 0;
+
+        // A resting order filled, was amended or cancelled, an incoming
+        // order's remainder was cancelled, or risk rejected an order
+        virtual void on_order_update(const Order &order) = 0;
+
+        // A cancel or amend found no open order under its orderID, the amend
+        // named another symbol or side, or a new order reused the orderID of
+        // one still open; from the matching thread that looked
+        virtual void on_request_missed(const Order &request) = 0;
+    };
+}
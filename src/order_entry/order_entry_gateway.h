@@ -0,0 +1,895 @@
+#pragma once
+
+#include "../core/types.h"
+#include "../core/memory.h"
+#include "../core/queue.h"
+#include "../core/timing.h"
+#include "../core/topology.h"
+#include "../core/wait_strategy.h"
+#include "../engine/trading_engine.h"
+#include "execution_listener.h"
+#include "protocol.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace trading_engine {
+    struct OrderEntryConfig {
+        std::string bind_address{"0.0.0.0"};
+        uint16_t port{0}; // 0 picks a free port; see listening_port()
+        uint32_t max_sessions{256};
+        int listen_backlog{128};
+        int busy_poll_us{0}; // SO_BUSY_POLL on each session socket; 0 keeps the system default
+        // Unsent report bytes a session may build up before it is dropped as too slow
+        size_t max_backlog_bytes{1 << 20};
+        ThreadPlacement placement{};
+        // epoll cannot be woken through a WakeSignal, so parks are timed sleeps
+        WaitConfig wait{.policy = WaitPolicy::SpinPause};
+    };
+
+#ifdef __linux__
+    // TCP order entry for external clients
+    //
+    // One thread multiplexes every session over a non-blocking epoll poll.
+    // Requests are decoded in place from each session's receive buffer into
+    // a staging burst that reaches the engine's order queue with one
+    // submit_orders() claim, and acked from the same burst. The engine's
+    // matching and risk threads encode execution reports straight from
+    // their callbacks into one report ring; the session thread routes them
+    // by the session number in each order ID and flushes every session that
+    // has output with a single writev per loop. A full report ring holds
+    // the engine thread back until the session thread makes room: a client
+    // that missed a fill would trade on the wrong position.
+    //
+    // Attach before the engine starts, and stop the engine before
+    // destroying the gateway: the engine calls into it from its threads.
+    class OrderEntryGateway final : public IExecutionListener {
+    public:
+        static constexpr size_t ReportQueueSize = 8192;
+
+    private:
+        static constexpr uint32_t ListenerToken = std::numeric_limits<uint32_t>::max();
+        static constexpr uint32_t NoSlot = std::numeric_limits<uint32_t>::max();
+        static constexpr size_t SessionNumbers = size_t{1} << 16;
+        static constexpr size_t MaxEvents = 64;
+        static constexpr size_t ReceiveBufferSize = 64 * 1024;
+        static constexpr size_t SubmitBatchSize = 64; // Requests per submit_orders() call
+        static constexpr size_t ReportBatchSize = 64;
+        static constexpr size_t MaxReportBatches = 16; // Per loop, so reads are not starved
+        static constexpr size_t PendingRequestSlots = 4096; // Power of two
+
+        // When an outgoing report's request was read, for the latency profiles
+        struct SendStamp {
+            Timestamp received; // 0: not sampled
+            LatencyProfiler::ProfileID profile;
+        };
+
+        struct Session {
+            int fd{-1};
+            uint16_t number{0}; // 0: slot free
+            bool dirty{false}; // Listed in dirty_sessions
+            bool write_armed{false}; // EPOLLOUT registered
+            bool write_blocked{false}; // Socket buffer full; wait for EPOLLOUT before writing
+            uint32_t next_sequence{1};
+
+            std::vector<uint8_t> inbox;
+            size_t inbox_used{0};
+
+            // Reports queued this loop, then whatever the socket did not take
+            std::vector<ExecutionReportMessage> outbox;
+            std::vector<SendStamp> stamps; // One per outbox entry
+            std::vector<uint8_t> backlog;
+            size_t backlog_sent{0};
+        };
+
+        // Request read times by order ID, direct-mapped; the first report
+        // that answers a request measures it, a collision just loses a sample
+        struct PendingRequest {
+            OrderID order_id{0};
+            Timestamp received{0};
+        };
+
+        TradingEngine &engine;
+        OrderEntryConfig config;
+
+        int listen_fd{-1};
+        int epoll_fd{-1};
+        uint16_t bound_port{0};
+
+        // Session thread only
+        std::vector<Session> sessions;
+        std::vector<uint32_t> free_slots;
+        std::vector<uint32_t> slot_of; // By session number
+        uint16_t next_session_number{1};
+        std::vector<uint32_t> dirty_sessions;
+        std::vector<PendingRequest> pending_requests;
+        std::array<Order, SubmitBatchSize> staged{};
+        size_t staged_count{0};
+        std::array<ExecutionReportMessage, ReportBatchSize> report_batch{};
+
+        // Written by the engine's threads, drained by the session thread
+        NodeLocalPtr<MPMCQueue<ExecutionReportMessage, ReportQueueSize> > reports;
+
+        std::thread session_thread;
+        std::atomic<bool> running{false};
+        WaitStrategy wait;
+
+        // Statistics
+        std::atomic<uint64_t> sessions_accepted{0};
+        std::atomic<uint64_t> sessions_refused{0};
+        std::atomic<uint64_t> sessions_closed{0};
+        std::atomic<uint64_t> slow_sessions_dropped{0};
+        std::atomic<uint32_t> active_sessions{0};
+        std::atomic<uint64_t> messages_received{0};
+        std::atomic<uint64_t> orders_submitted{0};
+        std::atomic<uint64_t> cancels_submitted{0};
+        std::atomic<uint64_t> amends_submitted{0};
+        std::atomic<uint64_t> requests_rejected{0};
+        std::atomic<uint64_t> parse_errors{0};
+        alignas(CacheLineSize) std::atomic<uint64_t> reports_queued{0}; // Bumped by engine threads
+        std::atomic<uint64_t> report_stalls{0};
+        std::atomic<uint64_t> reports_dropped{0};
+        alignas(CacheLineSize) std::atomic<uint64_t> reports_sent{0};
+        std::atomic<uint64_t> reports_orphaned{0}; // Their session had gone
+        std::atomic<uint64_t> writev_calls{0};
+        std::atomic<uint64_t> bytes_received{0};
+        std::atomic<uint64_t> bytes_sent{0};
+
+    public:
+        OrderEntryGateway(TradingEngine &trading_engine, OrderEntryConfig gateway_config = {})
+            : engine(trading_engine), config(std::move(gateway_config)),
+              sessions(std::clamp<uint32_t>(config.max_sessions, 1, SessionNumbers - 1)),
+              slot_of(SessionNumbers, NoSlot), pending_requests(PendingRequestSlots),
+              reports(make_node_local<MPMCQueue<ExecutionReportMessage, ReportQueueSize> >(
+                  config.placement.numa_node())),
+              wait(config.wait, nullptr, "order_entry") {
+            free_slots.reserve(sessions.size());
+            for (uint32_t slot = static_cast<uint32_t>(sessions.size()); slot > 0; --slot) {
+                free_slots.push_back(slot - 1);
+            }
+            dirty_sessions.reserve(sessions.size());
+            (void) engine.set_execution_listener(this);
+        }
+
+        ~OrderEntryGateway() override {
+            stop();
+        }
+
+        OrderEntryGateway(const OrderEntryGateway &) = delete;
+
+        OrderEntryGateway &operator=(const OrderEntryGateway &) = delete;
+
+        bool start() {
+            if (running.load(std::memory_order_acquire)) {
+                return false; // Already running
+            }
+            if (!open_listener()) {
+                close_listener();
+                return false;
+            }
+
+            running.store(true, std::memory_order_release);
+            session_thread = std::thread(&OrderEntryGateway::session_loop, this);
+            return true;
+        }
+
+        void stop() {
+            running.store(false, std::memory_order_release);
+            if (session_thread.joinable()) {
+                session_thread.join();
+            }
+
+            for (uint32_t slot = 0; slot < sessions.size(); ++slot) {
+                if (sessions[slot].fd >= 0) {
+                    close_session(slot);
+                }
+            }
+            close_listener();
+        }
+
+        // The bound port, once started
+        [[nodiscard]] uint16_t listening_port() const noexcept {
+            return bound_port;
+        }
+
+        // Engine threads: encode and hand off, nothing else
+        void on_trade(const Trade &trade) override {
+            if (session_of(trade.buy_order_id) != 0) {
+                queue_report(trade_report(trade, Side::Buy));
+            }
+            if (session_of(trade.sell_order_id) != 0) {
+                queue_report(trade_report(trade, Side::Sell));
+            }
+        }
+
+        void on_order_update(const Order &order) override {
+            if (session_of(order.orderID) == 0) {
+                return; // The engine's own strategies
+            }
+
+            switch (order.status) {
+                case OrderStatus::Cancelled:
+                    queue_report(execution_report(ExecutionType::Cancelled, order));
+                    break;
+                case OrderStatus::Rejected:
+                    queue_report(execution_report(order.action == OrderAction::Modify
+                                                      ? ExecutionType::AmendReject
+                                                      : ExecutionType::Rejected, order, RejectReason::RiskCheck));
+                    break;
+                default:
+                    queue_report(execution_report(ExecutionType::Updated, order));
+                    break;
+            }
+        }
+
+        void on_request_missed(const Order &request) override {
+            if (session_of(request.orderID) == 0) {
+                return;
+            }
+
+            Order order = request;
+            order.status = OrderStatus::Rejected;
+            if (request.action == OrderAction::New) {
+                queue_report(execution_report(ExecutionType::Rejected, order, RejectReason::DuplicateOrder));
+                return;
+            }
+            queue_report(execution_report(request.action == OrderAction::Cancel
+                                              ? ExecutionType::CancelReject
+                                              : ExecutionType::AmendReject, order, RejectReason::UnknownOrder));
+        }
+
+        struct OrderEntryStats {
+            uint64_t sessions_accepted;
+            uint64_t sessions_refused; // No free session slot
+            uint64_t sessions_closed;
+            uint64_t slow_sessions_dropped;
+            uint32_t active_sessions;
+            uint64_t messages_received;
+            uint64_t orders_submitted;
+            uint64_t cancels_submitted;
+            uint64_t amends_submitted;
+            uint64_t requests_rejected; // By the gateway: malformed, not owned, engine busy
+            uint64_t parse_errors; // Framing lost; the session was closed
+            uint64_t reports_queued;
+            uint64_t report_stalls; // An engine thread waited on a full report ring
+            uint64_t reports_dropped; // Only once the gateway stopped
+            uint64_t reports_sent; // Written, or queued behind bytes the socket has not taken
+            uint64_t reports_orphaned;
+            uint64_t writev_calls;
+            uint64_t bytes_received;
+            uint64_t bytes_sent;
+            // Request read to the writev carrying its ack, and to the one
+            // carrying the engine's first answer (fill, cancel, amend, reject)
+            LatencyProfiler::ProfileResults ack_latency;
+            LatencyProfiler::ProfileResults response_latency;
+        };
+
+        [[nodiscard]] OrderEntryStats get_statistics() const {
+            return OrderEntryStats{
+                .sessions_accepted = sessions_accepted.load(std::memory_order_relaxed),
+                .sessions_refused = sessions_refused.load(std::memory_order_relaxed),
+                .sessions_closed = sessions_closed.load(std::memory_order_relaxed),
+                .slow_sessions_dropped = slow_sessions_dropped.load(std::memory_order_relaxed),
+                .active_sessions = active_sessions.load(std::memory_order_relaxed),
+                .messages_received = messages_received.load(std::memory_order_relaxed),
+                .orders_submitted = orders_submitted.load(std::memory_order_relaxed),
+                .cancels_submitted = cancels_submitted.load(std::memory_order_relaxed),
+                .amends_submitted = amends_submitted.load(std::memory_order_relaxed),
+                .requests_rejected = requests_rejected.load(std::memory_order_relaxed),
+                .parse_errors = parse_errors.load(std::memory_order_relaxed),
+                .reports_queued = reports_queued.load(std::memory_order_relaxed),
+                .report_stalls = report_stalls.load(std::memory_order_relaxed),
+                .reports_dropped = reports_dropped.load(std::memory_order_relaxed),
+                .reports_sent = reports_sent.load(std::memory_order_relaxed),
+                .reports_orphaned = reports_orphaned.load(std::memory_order_relaxed),
+                .writev_calls = writev_calls.load(std::memory_order_relaxed),
+                .bytes_received = bytes_received.load(std::memory_order_relaxed),
+                .bytes_sent = bytes_sent.load(std::memory_order_relaxed),
+                .ack_latency = LatencyProfiler::get_stats(LatencyProfiler::Order_entry_ack),
+                .response_latency = LatencyProfiler::get_stats(LatencyProfiler::Order_entry_response)
+            };
+        }
+
+        [[nodiscard]] WaitStats get_wait_statistics() const noexcept {
+            return wait.get_statistics();
+        }
+
+    private:
+        void queue_report(const ExecutionReportMessage &report) noexcept {
+            if (UNLIKELY(!reports->try_push(report)) && !wait_to_queue(report)) {
+                return;
+            }
+            reports_queued.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Gives up only once the gateway stops and nobody drains the ring
+        bool wait_to_queue(const ExecutionReportMessage &report) noexcept {
+            report_stalls.fetch_add(1, std::memory_order_relaxed);
+            for (uint32_t attempt = 0; !reports->try_push(report); ++attempt) {
+                if (UNLIKELY(!running.load(std::memory_order_acquire))) {
+                    reports_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                if (attempt < 64) {
+                    cpu_relax();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            return true;
+        }
+
+        bool open_listener() {
+            listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, IPPROTO_TCP);
+            if (listen_fd < 0) {
+                return false;
+            }
+
+            constexpr int enable = 1;
+            ::setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(config.port);
+            if (::inet_pton(AF_INET, config.bind_address.c_str(), &address.sin_addr) != 1 ||
+                ::bind(listen_fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+                ::listen(listen_fd, config.listen_backlog) != 0) {
+                return false;
+            }
+
+            socklen_t length = sizeof(address);
+            if (::getsockname(listen_fd, reinterpret_cast<sockaddr *>(&address), &length) != 0) {
+                return false;
+            }
+            bound_port = ntohs(address.sin_port);
+
+            epoll_fd = ::epoll_create1(0);
+            if (epoll_fd < 0) {
+                return false;
+            }
+            epoll_event event{.events = EPOLLIN, .data = {.u32 = ListenerToken}};
+            return ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) == 0;
+        }
+
+        void close_listener() noexcept {
+            if (epoll_fd >= 0) {
+                ::close(epoll_fd);
+                epoll_fd = -1;
+            }
+            if (listen_fd >= 0) {
+                ::close(listen_fd);
+                listen_fd = -1;
+            }
+        }
+
+        void session_loop() {
+            if (!place_current_thread(config.placement)) {
+                std::cerr << "Order entry: thread placement not applied" << std::endl;
+            }
+            // Sockets cannot end a park early; reports can at least be seen
+            const auto ready = [this] {
+                return !reports->empty() || !running.load(std::memory_order_acquire);
+            };
+
+            wait.begin();
+            try {
+                std::array<epoll_event, MaxEvents> events{};
+
+                while (running.load(std::memory_order_acquire)) {
+                    // Busy poll: the session thread never sleeps in the kernel
+                    const int count = ::epoll_wait(epoll_fd, events.data(), static_cast<int>(MaxEvents), 0);
+                    for (int i = 0; i < count; ++i) {
+                        handle_event(events[i]);
+                    }
+
+                    const bool reported = drain_reports();
+                    flush_sessions();
+
+                    if (count > 0 || reported) {
+                        wait.on_work();
+                    } else {
+                        wait.idle(ready);
+                    }
+                }
+            } catch (const std::exception &e) {
+                std::cerr << "Exception in order entry session_loop: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Unknown exception in order entry session_loop" << std::endl;
+            }
+            wait.end();
+        }
+
+        void handle_event(const epoll_event &event) {
+            const uint32_t slot = event.data.u32;
+            if (slot == ListenerToken) {
+                accept_sessions();
+                return;
+            }
+
+            Session &session = sessions[slot];
+            if (session.fd < 0) {
+                return; // Closed earlier in this batch of events
+            }
+            if (event.events & EPOLLOUT) {
+                session.write_blocked = false;
+                mark_dirty(slot);
+            }
+            if (event.events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                read_session(slot);
+            }
+        }
+
+        void accept_sessions() {
+            for (;;) {
+                const int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK);
+                if (fd < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return; // Nothing pending, or out of descriptors until a session closes
+                }
+
+                const uint16_t number = free_slots.empty() ? 0 : allocate_session_number();
+                if (number == 0) {
+                    ::close(fd);
+                    sessions_refused.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+
+                constexpr int enable = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+                if (config.busy_poll_us > 0) {
+                    // Needs CAP_NET_ADMIN above net.core.busy_read; without it the default stays
+                    ::setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &config.busy_poll_us, sizeof(config.busy_poll_us));
+                }
+
+                const uint32_t slot = free_slots.back();
+                epoll_event event{.events = EPOLLIN, .data = {.u32 = slot}};
+                if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+                    ::close(fd);
+                    sessions_refused.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                free_slots.pop_back();
+
+                Session &session = sessions[slot];
+                session.fd = fd;
+                session.number = number;
+                session.next_sequence = 1;
+                session.inbox.resize(ReceiveBufferSize); // Kept across reuse of the slot
+                session.inbox_used = 0;
+                slot_of[number] = slot;
+
+                sessions_accepted.fetch_add(1, std::memory_order_relaxed);
+                active_sessions.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // Numbers go round before any is reused, so a late report for a
+        // closed session rarely finds a new one under its number
+        uint16_t allocate_session_number() noexcept {
+            for (size_t tries = 0; tries < SessionNumbers; ++tries) {
+                const uint16_t number = next_session_number++;
+                if (number != 0 && slot_of[number] == NoSlot) {
+                    return number;
+                }
+            }
+            return 0;
+        }
+
+        // Orders the session left resting stay in the book
+        void close_session(const uint32_t slot) noexcept {
+            Session &session = sessions[slot];
+            ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, session.fd, nullptr);
+            ::close(session.fd);
+
+            slot_of[session.number] = NoSlot;
+            session.fd = -1;
+            session.number = 0;
+            session.write_armed = false;
+            session.write_blocked = false;
+            session.inbox_used = 0;
+            session.outbox.clear();
+            session.stamps.clear();
+            session.backlog.clear();
+            session.backlog_sent = 0;
+            free_slots.push_back(slot);
+
+            active_sessions.fetch_sub(1, std::memory_order_relaxed);
+            sessions_closed.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void read_session(const uint32_t slot) {
+            Session &session = sessions[slot];
+            for (;;) {
+                const size_t space = session.inbox.size() - session.inbox_used;
+                const ssize_t received = ::recv(session.fd, session.inbox.data() + session.inbox_used, space,
+                                                MSG_DONTWAIT);
+                if (received > 0) {
+                    const Timestamp now = TimestampManager::get_hardware_timestamp();
+                    bytes_received.fetch_add(static_cast<uint64_t>(received), std::memory_order_relaxed);
+                    session.inbox_used += static_cast<size_t>(received);
+                    if (!parse_inbox(slot, now) || static_cast<size_t>(received) < space) {
+                        return; // Closed, or the socket is drained
+                    }
+                    continue;
+                }
+                if (received < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                    close_session(slot); // Peer closed, or the connection failed
+                }
+                return;
+            }
+        }
+
+        // Decodes every complete message in place and submits them as one
+        // burst; keeps a trailing partial message for the next read. False
+        // if framing was lost and the session closed.
+        bool parse_inbox(const uint32_t slot, const Timestamp received) {
+            Session &session = sessions[slot];
+            const uint8_t *data = session.inbox.data();
+            size_t offset = 0;
+
+            while (session.inbox_used - offset >= sizeof(MessageHeader)) {
+                const uint16_t length = reinterpret_cast<const MessageHeader *>(data + offset)->length;
+                if (UNLIKELY(length < sizeof(MessageHeader))) {
+                    parse_errors.fetch_add(1, std::memory_order_relaxed);
+                    submit_staged(slot, received);
+                    close_session(slot);
+                    return false;
+                }
+                if (session.inbox_used - offset < length) {
+                    break;
+                }
+
+                handle_message(slot, data + offset, length, received);
+                offset += length;
+            }
+            submit_staged(slot, received);
+
+            std::memmove(session.inbox.data(), data + offset, session.inbox_used - offset);
+            session.inbox_used -= offset;
+            return true;
+        }
+
+        void handle_message(const uint32_t slot, const uint8_t *data, const uint16_t length,
+                            const Timestamp received) {
+            messages_received.fetch_add(1, std::memory_order_relaxed);
+            const Session &session = sessions[slot];
+            const auto header = reinterpret_cast<const MessageHeader *>(data);
+
+            if (UNLIKELY(header->version != OrderEntryProtocolVersion)) {
+                reject(slot, malformed(session, data, length), RejectReason::Malformed, received);
+                return;
+            }
+
+            switch (header->message_type) {
+                case MessageType::NewOrder: {
+                    if (UNLIKELY(length != sizeof(NewOrderMessage))) {
+                        break;
+                    }
+                    const auto &message = *reinterpret_cast<const NewOrderMessage *>(data);
+                    Order order{
+                        .orderID = with_session(message.client_order_id, session.number),
+                        .symbolID = message.symbol_id,
+                        .side = message.side,
+                        .orderType = message.order_type,
+                        .timeInForce = message.time_in_force,
+                        .price = message.price,
+                        .stopPrice = message.stop_price,
+                        .quantity = message.quantity,
+                        .timestamp = received
+                    };
+                    if (UNLIKELY(!valid(message))) {
+                        reject(slot, order, RejectReason::Malformed, received);
+                        return;
+                    }
+                    stage(slot, order, received);
+                    return;
+                }
+
+                case MessageType::CancelOrder: {
+                    if (UNLIKELY(length != sizeof(CancelOrderMessage))) {
+                        break;
+                    }
+                    const auto &message = *reinterpret_cast<const CancelOrderMessage *>(data);
+                    const Order order{.orderID = message.order_id, .action = OrderAction::Cancel, .timestamp = received};
+                    if (UNLIKELY(session_of(message.order_id) != session.number)) {
+                        reject(slot, order, RejectReason::NotOwner, received);
+                        return;
+                    }
+                    stage(slot, order, received);
+                    return;
+                }
+
+                case MessageType::AmendOrder: {
+                    if (UNLIKELY(length != sizeof(AmendOrderMessage))) {
+                        break;
+                    }
+                    const auto &message = *reinterpret_cast<const AmendOrderMessage *>(data);
+                    const Order order{
+                        .orderID = message.order_id,
+                        .symbolID = message.symbol_id,
+                        .side = message.side,
+                        .orderType = OrderType::Limit,
+                        .action = OrderAction::Modify,
+                        .price = message.price,
+                        .quantity = message.quantity,
+                        .timestamp = received
+                    };
+                    if (UNLIKELY(static_cast<uint8_t>(message.side) > static_cast<uint8_t>(Side::Sell))) {
+                        reject(slot, order, RejectReason::Malformed, received);
+                        return;
+                    }
+                    if (UNLIKELY(session_of(message.order_id) != session.number)) {
+                        reject(slot, order, RejectReason::NotOwner, received);
+                        return;
+                    }
+                    stage(slot, order, received);
+                    return;
+                }
+
+                default:
+                    break;
+            }
+
+            // Unknown type or wrong length for its type; the header still frames it
+            reject(slot, malformed(session, data, length), RejectReason::Malformed, received);
+        }
+
+        // What a reject for an unreadable message echoes: the order ID in the
+        // client's layout, when the message is long enough to hold one.
+        // NewOrder names the client's ID, cancels and amends the engine's.
+        [[nodiscard]] static Order malformed(const Session &session, const uint8_t *data, const uint16_t length) noexcept {
+            const auto header = reinterpret_cast<const MessageHeader *>(data);
+            Order order{};
+            if (length < sizeof(MessageHeader) + sizeof(uint64_t)) {
+                return order;
+            }
+
+            uint64_t order_id;
+            std::memcpy(&order_id, data + sizeof(MessageHeader), sizeof(order_id));
+            if (header->message_type == MessageType::NewOrder) {
+                order.orderID = with_session(order_id, session.number);
+            } else if (header->message_type == MessageType::CancelOrder ||
+                       header->message_type == MessageType::AmendOrder) {
+                order.orderID = order_id;
+                order.action = header->message_type == MessageType::CancelOrder
+                                   ? OrderAction::Cancel
+                                   : OrderAction::Modify;
+            }
+            return order;
+        }
+
+        // Enum bytes are checked before they reach the Order's bitfields
+        [[nodiscard]] static bool valid(const NewOrderMessage &message) noexcept {
+            return message.client_order_id != 0 && message.client_order_id <= MaxClientOrderId &&
+                   message.quantity > 0 &&
+                   static_cast<uint8_t>(message.side) <= static_cast<uint8_t>(Side::Sell) &&
+                   static_cast<uint8_t>(message.order_type) <= static_cast<uint8_t>(OrderType::StopLimit) &&
+                   static_cast<uint8_t>(message.time_in_force) <= static_cast<uint8_t>(TimeInForce::Gtc);
+        }
+
+        void stage(const uint32_t slot, const Order &order, const Timestamp received) {
+            staged[staged_count++] = order;
+            if (staged_count == SubmitBatchSize) {
+                submit_staged(slot, received);
+            }
+        }
+
+        // One queue claim for the burst; each request is acked in order,
+        // and what did not fit is rejected rather than retried
+        void submit_staged(const uint32_t slot, const Timestamp received) {
+            if (staged_count == 0) {
+                return;
+            }
+
+            const auto burst = std::span<Order>(staged.data(), staged_count);
+            const size_t queued = engine.submit_orders(burst);
+            Session &session = sessions[slot];
+
+            for (size_t i = 0; i < burst.size(); ++i) {
+                const Order &order = burst[i];
+                if (i >= queued) {
+                    append_reject(slot, order, RejectReason::EngineBusy, received);
+                    continue;
+                }
+
+                remember_request(order.orderID, received);
+                ExecutionType type = ExecutionType::Accepted;
+                if (order.action == OrderAction::Cancel) {
+                    type = ExecutionType::PendingCancel;
+                    cancels_submitted.fetch_add(1, std::memory_order_relaxed);
+                } else if (order.action == OrderAction::Modify) {
+                    type = ExecutionType::PendingAmend;
+                    amends_submitted.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    orders_submitted.fetch_add(1, std::memory_order_relaxed);
+                }
+                append(slot, session, execution_report(type, order),
+                       SendStamp{received, LatencyProfiler::Order_entry_ack});
+            }
+            staged_count = 0;
+        }
+
+        // Acks the requests staged ahead of this one first, so the session
+        // hears back in the order it asked
+        void reject(const uint32_t slot, const Order &order, const RejectReason reason, const Timestamp received) {
+            submit_staged(slot, received);
+            append_reject(slot, order, reason, received);
+        }
+
+        void append_reject(const uint32_t slot, Order order, const RejectReason reason, const Timestamp received) {
+            requests_rejected.fetch_add(1, std::memory_order_relaxed);
+            order.status = OrderStatus::Rejected;
+            append(slot, sessions[slot], execution_report(ExecutionType::Rejected, order, reason),
+                   SendStamp{received, LatencyProfiler::Order_entry_ack});
+        }
+
+        [[nodiscard]] PendingRequest &pending_for(const OrderID order_id) noexcept {
+            return pending_requests[(order_id ^ order_id >> SessionIdShift) & (PendingRequestSlots - 1)];
+        }
+
+        void remember_request(const OrderID order_id, const Timestamp received) noexcept {
+            pending_for(order_id) = PendingRequest{.order_id = order_id, .received = received};
+        }
+
+        void append(const uint32_t slot, Session &session, ExecutionReportMessage report, const SendStamp stamp) {
+            report.header.sequence_number = session.next_sequence++;
+            session.outbox.push_back(report);
+            session.stamps.push_back(stamp);
+            mark_dirty(slot);
+        }
+
+        void mark_dirty(const uint32_t slot) {
+            if (!sessions[slot].dirty) {
+                sessions[slot].dirty = true;
+                dirty_sessions.push_back(slot);
+            }
+        }
+
+        // Routes engine reports to their sessions' outboxes. A request's
+        // first answer is measured; a resting order's fills are not answers,
+        // so they only retire the entry.
+        bool drain_reports() {
+            size_t drained = 0;
+            for (size_t batch = 0; batch < MaxReportBatches; ++batch) {
+                const size_t count = reports->try_pop_bulk(report_batch);
+                if (count == 0) {
+                    break;
+                }
+                drained += count;
+
+                for (size_t i = 0; i < count; ++i) {
+                    const ExecutionReportMessage &report = report_batch[i];
+                    const uint32_t slot = slot_of[session_of(report.order_id)];
+                    if (UNLIKELY(slot == NoSlot)) {
+                        reports_orphaned.fetch_add(1, std::memory_order_relaxed);
+                        continue;
+                    }
+
+                    SendStamp stamp{0, LatencyProfiler::Order_entry_response};
+                    if (PendingRequest &pending = pending_for(report.order_id); pending.order_id == report.order_id) {
+                        if (report.exec_type != ExecutionType::Trade || report.liquidity == Liquidity::Removed) {
+                            stamp.received = pending.received;
+                        }
+                        pending.order_id = 0;
+                    }
+                    append(slot, sessions[slot], report, stamp);
+                }
+            }
+            return drained > 0;
+        }
+
+        void flush_sessions() {
+            for (const uint32_t slot: dirty_sessions) {
+                sessions[slot].dirty = false;
+                if (sessions[slot].fd >= 0) {
+                    flush(slot);
+                }
+            }
+            dirty_sessions.clear();
+        }
+
+        // Whatever is still backlogged, then this loop's reports, in one
+        // writev; the socket's leftovers wait for EPOLLOUT
+        void flush(const uint32_t slot) {
+            Session &session = sessions[slot];
+            const size_t backlogged = session.backlog.size() - session.backlog_sent;
+            const size_t outbox_bytes = session.outbox.size() * sizeof(ExecutionReportMessage);
+            if (backlogged == 0 && outbox_bytes == 0) {
+                return;
+            }
+
+            size_t written = 0;
+            if (!session.write_blocked) {
+                std::array<iovec, 2> parts{};
+                int part_count = 0;
+                if (backlogged > 0) {
+                    parts[part_count++] = iovec{.iov_base = session.backlog.data() + session.backlog_sent,
+                                                .iov_len = backlogged};
+                }
+                if (outbox_bytes > 0) {
+                    parts[part_count++] = iovec{.iov_base = session.outbox.data(), .iov_len = outbox_bytes};
+                }
+
+                const ssize_t result = ::writev(session.fd, parts.data(), part_count);
+                writev_calls.fetch_add(1, std::memory_order_relaxed);
+                if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    close_session(slot);
+                    return;
+                }
+                written = result > 0 ? static_cast<size_t>(result) : 0;
+                bytes_sent.fetch_add(written, std::memory_order_relaxed);
+            }
+
+            const size_t from_backlog = std::min(written, backlogged);
+            session.backlog_sent += from_backlog;
+            written -= from_backlog;
+            if (written < outbox_bytes) {
+                const auto bytes = reinterpret_cast<const uint8_t *>(session.outbox.data());
+                session.backlog.insert(session.backlog.end(), bytes + written, bytes + outbox_bytes);
+            }
+            if (session.backlog_sent == session.backlog.size()) {
+                session.backlog.clear();
+                session.backlog_sent = 0;
+            } else if (session.backlog_sent > session.backlog.size() / 2) {
+                session.backlog.erase(session.backlog.begin(),
+                                      session.backlog.begin() + static_cast<std::ptrdiff_t>(session.backlog_sent));
+                session.backlog_sent = 0;
+            }
+
+            // Handed to the kernel, or queued behind what it has not taken yet
+            const Timestamp now = TimestampManager::get_hardware_timestamp();
+            for (const SendStamp &stamp: session.stamps) {
+                if (stamp.received != 0) {
+                    LatencyProfiler::record(stamp.profile, now - stamp.received);
+                }
+            }
+            reports_sent.fetch_add(session.outbox.size(), std::memory_order_relaxed);
+            session.outbox.clear();
+            session.stamps.clear();
+
+            if (UNLIKELY(session.backlog.size() - session.backlog_sent > config.max_backlog_bytes)) {
+                slow_sessions_dropped.fetch_add(1, std::memory_order_relaxed);
+                close_session(slot);
+                return;
+            }
+            set_write_interest(slot, !session.backlog.empty());
+        }
+
+        void set_write_interest(const uint32_t slot, const bool blocked) noexcept {
+            Session &session = sessions[slot];
+            session.write_blocked = blocked;
+            if (session.write_armed == blocked) {
+                return;
+            }
+            epoll_event event{.events = EPOLLIN | (blocked ? EPOLLOUT : 0U), .data = {.u32 = slot}};
+            if (::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, session.fd, &event) == 0) {
+                session.write_armed = blocked;
+            }
+        }
+    };
+#endif
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "../core/types.h"
+
+#include <cstdint>
+
+namespace trading_engine {
+    // Order entry wire format
+    //
+    // Fixed-layout little-endian messages, each led by a MessageHeader whose
+    // length is the whole message. Clients send NewOrder, CancelOrder and
+    // AmendOrder; the gateway answers with ExecutionReports, numbered per
+    // session in header.sequence_number.
+    constexpr uint8_t OrderEntryProtocolVersion = 1;
+
+    // An engine OrderID for a session's order: the client's ID in the low
+    // 40 bits, the session number above it, the matching shard in the top
+    // byte. Reports can be routed back from the ID alone, and IDs of orders
+    // from inside the engine (session 0) are never mistaken for a client's.
+    constexpr int SessionIdShift = 40;
+    constexpr uint64_t MaxClientOrderId = (1ULL << SessionIdShift) - 1;
+
+    constexpr OrderID with_session(const uint64_t client_order_id, const uint16_t session) noexcept {
+        return (client_order_id & MaxClientOrderId) | static_cast<OrderID>(session) << SessionIdShift;
+    }
+
+    constexpr uint16_t session_of(const OrderID order_id) noexcept {
+        return static_cast<uint16_t>(order_id >> SessionIdShift);
+    }
+
+    constexpr uint64_t client_order_id_of(const OrderID order_id) noexcept {
+        return order_id & MaxClientOrderId;
+    }
+
+    struct NewOrderMessage {
+        MessageHeader header;
+        uint64_t client_order_id; // Nonzero, unique within the session, at most MaxClientOrderId
+        Price price;
+        Price stop_price;
+        Quantity quantity;
+        SymbolID symbol_id;
+        Side side;
+        OrderType order_type;
+        TimeInForce time_in_force;
+        uint8_t reserved;
+    };
+
+    // Cancels and amends name the order_id the Accepted report carried
+    struct CancelOrderMessage {
+        MessageHeader header;
+        OrderID order_id;
+    };
+
+    struct AmendOrderMessage {
+        MessageHeader header;
+        OrderID order_id;
+        Price price;
+        Quantity quantity; // New open quantity; 0 cancels
+        SymbolID symbol_id;
+        Side side;
+        uint8_t reserved[3];
+    };
+
+    enum class ExecutionType : uint8_t {
+        Accepted = 0, // The new order is in the engine under order_id
+        PendingCancel = 1, // Cancel queued behind the session's earlier requests
+        PendingAmend = 2,
+        Rejected = 3, // See reason
+        Trade = 4, // One fill: price and quantity are the fill's
+        Cancelled = 5, // quantity is what was left open
+        Updated = 6, // Amended, or a resting order filled: status and quantities are current
+        CancelReject = 7, // The cancel changed nothing; see reason
+        AmendReject = 8
+    };
+
+    enum class RejectReason : uint8_t {
+        None = 0,
+        Malformed = 1, // Bad length, version, enum value or ID
+        NotOwner = 2, // The order belongs to another session
+        EngineBusy = 3, // The engine's order queue was full
+        RiskCheck = 4,
+        UnknownOrder = 5, // Nothing open under order_id for that symbol and side: filled, cancelled, never rested
+        DuplicateOrder = 6 // A new order reused the order_id of one still open
+    };
+
+    // Which side of a fill the order was on
+    enum class Liquidity : uint8_t {
+        None = 0,
+        Added = 1, // Resting
+        Removed = 2 // Aggressor
+    };
+
+    struct ExecutionReportMessage {
+        MessageHeader header;
+        OrderID order_id; // client_order_id_of() gives back the client's ID
+        TradeID trade_id; // Trade reports only
+        Price price;
+        Quantity quantity;
+        Quantity filled_quantity; // Cumulative; order updates only
+        SymbolID symbol_id;
+        ExecutionType exec_type;
+        OrderStatus status;
+        Side side;
+        Liquidity liquidity;
+        RejectReason reason;
+        uint8_t reserved[7];
+    };
+
+    static_assert(sizeof(MessageHeader) == 8);
+    static_assert(sizeof(NewOrderMessage) == 48);
+    static_assert(sizeof(CancelOrderMessage) == 16);
+    static_assert(sizeof(AmendOrderMessage) == 40);
+    static_assert(sizeof(ExecutionReportMessage) == 64);
+
+    [[nodiscard]] constexpr MessageHeader order_entry_header(const MessageType type, const uint16_t length,
+                                                             const uint32_t sequence = 0) noexcept {
+        return MessageHeader{
+            .message_type = type,
+            .version = OrderEntryProtocolVersion,
+            .length = length,
+            .sequence_number = sequence
+        };
+    }
+
+    // Encoders for the engine's callbacks; sequence numbers are filled in
+    // by the gateway when the report is queued on its session
+    [[nodiscard]] constexpr ExecutionReportMessage execution_report(const ExecutionType type,
+                                                                    const Order &order,
+                                                                    const RejectReason reason =
+                                                                            RejectReason::None) noexcept {
+        return ExecutionReportMessage{
+            .header = order_entry_header(MessageType::ExecutionReport, sizeof(ExecutionReportMessage)),
+            .order_id = order.orderID,
+            .trade_id = 0,
+            .price = order.price,
+            .quantity = order.quantity,
+            .filled_quantity = order.filledQuantity,
+            .symbol_id = order.symbolID,
+            .exec_type = type,
+            .status = order.status,
+            .side = order.side,
+            .liquidity = Liquidity::None,
+            .reason = reason,
+            .reserved = {}
+        };
+    }
+
+    [[nodiscard]] constexpr ExecutionReportMessage trade_report(const Trade &trade, const Side side) noexcept {
+        return ExecutionReportMessage{
+            .header = order_entry_header(MessageType::ExecutionReport, sizeof(ExecutionReportMessage)),
+            .order_id = side == Side::Buy ? trade.buy_order_id : trade.sell_order_id,
+            .trade_id = trade.trade_id,
+            .price = trade.price,
+            .quantity = trade.quantity,
+            .filled_quantity = 0,
+            .symbol_id = trade.symbol_id,
+            .exec_type = ExecutionType::Trade,
+            .status = OrderStatus::Incoming,
+            .side = side,
+            .liquidity = side == trade.aggressor_side ? Liquidity::Removed : Liquidity::Added,
+            .reason = RejectReason::None,
+            .reserved = {}
+        };
+    }
+}
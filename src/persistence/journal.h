@@ -0,0 +1,1159 @@
+#pragma once
+
+#include "../core/types.h"
+#include "../core/memory.h"
+#include "../core/queue.h"
+#include "../core/timing.h"
+#include "../core/topology.h"
+#include "../core/wait_strategy.h"
+#include "../matching/matching_engine.h"
+#include "../risk/risk_manager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace trading_engine {
+    struct JournalConfig {
+        std::string directory{}; // Empty: no journal
+        bool direct_io{true}; // O_DIRECT where the filesystem takes it, the page cache otherwise
+        bool sync{true}; // fdatasync every group commit; false leaves flushing to the OS
+        size_t segment_bytes{256ULL << 20}; // Preallocated; a full segment rolls over to the next
+        // How often the matching shards snapshot their state; 0: only on a clean stop
+        std::chrono::milliseconds snapshot_interval{30000};
+        ThreadPlacement placement{};
+        // Producers do not ring the writer, so parks are timed sleeps; a
+        // short one lets a group commit gather what arrives meanwhile
+        WaitConfig wait{.policy = WaitPolicy::SpinThenPark, .spin_iterations = 64,
+                        .park_timeout = std::chrono::microseconds(50)};
+    };
+
+    // Journal layout: a directory of segments, journal-<n>.log, and
+    // snapshots, snapshot-<round>.snap. A segment is a header block then
+    // fixed-size records, each tagged with its matching shard and that
+    // shard's sequence number. Requests are what the shard applied, in the
+    // order it applied them; trades are what it printed. A snapshot holds
+    // every shard's books, resting orders, trade ID counter and positions
+    // as of one of its sequence numbers, so recovery loads the newest one
+    // and replays each shard's requests after it.
+    //
+    // Unwritten space is zeros; a record whose checksum fails ends its
+    // segment, which is what a torn last write looks like.
+    constexpr size_t JournalBlockSize = 4096; // O_DIRECT alignment for offsets, lengths and buffers
+
+    enum class JournalRecordType : uint8_t {
+        End = 0,
+        Request = 1, // An Order: new, cancel or amend, as risk passed it
+        Trade = 2
+    };
+
+    struct JournalRecord {
+        uint32_t checksum; // Of the whole record with this field zero; set by the writer thread
+        JournalRecordType type;
+        uint8_t shard;
+        uint16_t reserved;
+        uint64_t sequence; // Per shard, from 1
+        uint8_t payload[64];
+
+        [[nodiscard]] Order order() const noexcept {
+            Order order;
+            std::memcpy(&order, payload, sizeof(order));
+            return order;
+        }
+
+        [[nodiscard]] Trade trade() const noexcept {
+            Trade trade;
+            std::memcpy(&trade, payload, sizeof(trade));
+            return trade;
+        }
+    };
+
+    static_assert(sizeof(JournalRecord) == 80);
+    static_assert(sizeof(Order) <= sizeof(JournalRecord::payload) && sizeof(Trade) <= sizeof(JournalRecord::payload));
+    static_assert(MaxMatchingShards <= 256, "JournalRecord::shard is one byte");
+
+    struct JournalSegmentHeader {
+        static constexpr uint64_t Magic = 0x314C4E524A4554ULL; // "TEJRNL1"
+        static constexpr uint32_t CurrentVersion = 1;
+
+        uint64_t magic;
+        uint32_t version;
+        uint32_t record_size;
+        uint64_t segment;
+        uint32_t shard_count;
+        uint32_t reserved;
+        uint64_t created_ns;
+    };
+
+    struct SnapshotFileHeader {
+        static constexpr uint64_t Magic = 0x3150414E534554ULL; // "TESNAP1"
+        static constexpr uint32_t CurrentVersion = 1;
+
+        uint64_t magic;
+        uint32_t version;
+        uint32_t shard_count;
+        uint64_t round;
+        uint64_t first_segment; // Opened when the round began; requests after the snapshot start here
+        uint64_t created_ns;
+        uint64_t payload_bytes;
+        uint64_t checksum; // Of the payload
+    };
+
+    // Followed by its books, orders and positions
+    struct SnapshotShardHeader {
+        uint32_t shard;
+        uint32_t book_count;
+        uint64_t sequence;
+        TradeID next_trade_id;
+        uint64_t order_count;
+        uint64_t position_count;
+    };
+
+    // Not a CRC: a word-at-a-time mix that catches torn and zeroed writes
+    [[nodiscard]] inline uint64_t journal_hash(const void *data, const size_t bytes) noexcept {
+        const auto *bytes_in = static_cast<const uint8_t *>(data);
+        uint64_t hash = 0x9E3779B97F4A7C15ULL ^ bytes;
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, bytes_in + i, sizeof(word));
+            hash = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+            hash ^= hash >> 31;
+        }
+        for (; i < bytes; ++i) {
+            hash = (hash ^ bytes_in[i]) * 0x94D049BB133111EBULL;
+        }
+        return hash ^ (hash >> 29);
+    }
+
+    [[nodiscard]] inline uint32_t record_checksum(const JournalRecord &record) noexcept {
+        JournalRecord unsealed = record;
+        unsealed.checksum = 0;
+        const uint64_t hash = journal_hash(&unsealed, sizeof(unsealed));
+        return static_cast<uint32_t>(hash ^ (hash >> 32)) | 1; // Never 0, so zeroed space never passes
+    }
+
+    [[nodiscard]] inline bool record_valid(const JournalRecord &record) noexcept {
+        return record.type != JournalRecordType::End && record.checksum == record_checksum(record);
+    }
+
+    // One shard's state as of its journal sequence `sequence`, captured on
+    // its matching thread between bursts
+    struct ShardCheckpoint {
+        uint64_t round{0};
+        uint64_t sequence{0};
+        TradeID next_trade_id{0};
+        // Positions hold every one of the shard's trades up to this one;
+        // later ones may be missing. Decides which segments are kept, and
+        // is not itself written to the snapshot.
+        TradeID trades_booked{0};
+        std::vector<MatchingEngine::BookCheckpoint> books;
+        std::vector<Order> orders; // Queue order within each level, best level first
+        std::vector<RiskManager::PositionCheckpoint> positions;
+
+        // Keeps the capacity, so steady-state captures do not allocate
+        void clear() noexcept {
+            books.clear();
+            orders.clear();
+            positions.clear();
+        }
+    };
+
+    struct JournalSnapshot {
+        uint64_t round{0};
+        uint64_t first_segment{0};
+        std::vector<ShardCheckpoint> shards; // Indexed by shard
+    };
+
+    namespace journal_detail {
+        inline std::filesystem::path segment_path(const std::string &directory, const uint64_t segment) {
+            return std::filesystem::path(directory) / ("journal-" + std::to_string(segment) + ".log");
+        }
+
+        inline std::filesystem::path snapshot_path(const std::string &directory, const uint64_t round) {
+            return std::filesystem::path(directory) / ("snapshot-" + std::to_string(round) + ".snap");
+        }
+
+        // The number in journal-<n>.log or snapshot-<n>.snap, if the name is one of ours
+        inline std::optional<uint64_t> parse_number(const std::filesystem::path &path, const std::string &prefix,
+                                                    const std::string &suffix) {
+            const std::string name = path.filename().string();
+            if (name.size() <= prefix.size() + suffix.size() || !name.starts_with(prefix) ||
+                !name.ends_with(suffix)) {
+                return std::nullopt;
+            }
+            const std::string digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+            if (!std::all_of(digits.begin(), digits.end(), [](const char c) { return c >= '0' && c <= '9'; })) {
+                return std::nullopt;
+            }
+            return std::stoull(digits);
+        }
+
+        // Segment or snapshot numbers present in the directory, ascending
+        inline std::vector<uint64_t> list(const std::string &directory, const std::string &prefix,
+                                          const std::string &suffix) {
+            std::vector<uint64_t> numbers;
+            std::error_code error;
+            for (const auto &entry: std::filesystem::directory_iterator(directory, error)) {
+                if (const auto number = parse_number(entry.path(), prefix, suffix)) {
+                    numbers.push_back(*number);
+                }
+            }
+            std::sort(numbers.begin(), numbers.end());
+            return numbers;
+        }
+
+        inline std::vector<uint64_t> list_segments(const std::string &directory) {
+            return list(directory, "journal-", ".log");
+        }
+
+        inline std::vector<uint64_t> list_snapshots(const std::string &directory) {
+            return list(directory, "snapshot-", ".snap");
+        }
+
+        inline uint64_t realtime_ns() noexcept {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        }
+
+        template<typename T>
+        void append_bytes(std::vector<uint8_t> &out, const T *items, const size_t count) {
+            const auto *bytes = reinterpret_cast<const uint8_t *>(items);
+            out.insert(out.end(), bytes, bytes + count * sizeof(T));
+        }
+
+        template<typename T>
+        bool read_items(const uint8_t *&in, const uint8_t *end, std::vector<T> &items, const uint64_t count) {
+            if (count > static_cast<uint64_t>(end - in) / sizeof(T)) {
+                return false;
+            }
+            items.resize(count);
+            std::memcpy(items.data(), in, count * sizeof(T));
+            in += count * sizeof(T);
+            return true;
+        }
+
+#ifndef _WIN32
+        inline bool write_all(const int fd, const uint8_t *data, size_t bytes, off_t offset) noexcept {
+            while (bytes > 0) {
+                const ssize_t written = ::pwrite(fd, data, bytes, offset);
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (written <= 0) {
+                    return false;
+                }
+                data += written;
+                bytes -= static_cast<size_t>(written);
+                offset += written;
+            }
+            return true;
+        }
+
+        // New directory entries only survive a crash once the directory is synced
+        inline void sync_directory(const std::string &directory) noexcept {
+            const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+            if (fd >= 0) {
+                (void) ::fsync(fd);
+                ::close(fd);
+            }
+        }
+
+        // Whole file into memory; empty if it cannot be read
+        inline std::vector<uint8_t> read_file(const std::filesystem::path &path) {
+            std::vector<uint8_t> contents;
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return contents;
+            }
+            struct stat info{};
+            if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+                contents.resize(static_cast<size_t>(info.st_size));
+                size_t done = 0;
+                while (done < contents.size()) {
+                    const ssize_t count = ::pread(fd, contents.data() + done, contents.size() - done,
+                                                  static_cast<off_t>(done));
+                    if (count < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (count <= 0) {
+                        break;
+                    }
+                    done += static_cast<size_t>(count);
+                }
+                contents.resize(done);
+            }
+            ::close(fd);
+            return contents;
+        }
+
+        // Read-only mapping of a segment. Segments are preallocated, so only
+        // the pages a scan reaches are ever read in.
+        class MappedSegment {
+            const uint8_t *base{nullptr};
+            size_t bytes{0};
+
+        public:
+            explicit MappedSegment(const std::filesystem::path &path) {
+                const int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    return;
+                }
+                struct stat info{};
+                if (::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= JournalBlockSize) {
+                    void *mapping = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE,
+                                           fd, 0);
+                    if (mapping != MAP_FAILED) {
+                        base = static_cast<const uint8_t *>(mapping);
+                        bytes = static_cast<size_t>(info.st_size);
+#ifdef MADV_SEQUENTIAL
+                        ::madvise(mapping, bytes, MADV_SEQUENTIAL);
+#endif
+                    }
+                }
+                ::close(fd);
+            }
+
+            ~MappedSegment() {
+                if (base != nullptr) {
+                    ::munmap(const_cast<uint8_t *>(base), bytes);
+                }
+            }
+
+            MappedSegment(const MappedSegment &) = delete;
+
+            MappedSegment &operator=(const MappedSegment &) = delete;
+
+            // The header when the segment is one of ours in this format
+            [[nodiscard]] std::optional<JournalSegmentHeader> header() const noexcept {
+                if (base == nullptr) {
+                    return std::nullopt;
+                }
+                JournalSegmentHeader segment_header{};
+                std::memcpy(&segment_header, base, sizeof(segment_header));
+                if (segment_header.magic != JournalSegmentHeader::Magic ||
+                    segment_header.version != JournalSegmentHeader::CurrentVersion ||
+                    segment_header.record_size != sizeof(JournalRecord)) {
+                    return std::nullopt;
+                }
+                return segment_header;
+            }
+
+            [[nodiscard]] const uint8_t *data() const noexcept { return base; }
+            [[nodiscard]] size_t size() const noexcept { return bytes; }
+        };
+#endif
+    }
+
+    // Asynchronous write-ahead journal for the matching shards
+    //
+    // Each matching thread appends its requests and trades to its own
+    // ShardLog ring; that is the whole hot-path cost. One writer thread
+    // drains every ring into a block-aligned buffer and group-commits it: a
+    // single pwrite of whole blocks (rewriting the partial last block) and
+    // one fdatasync, however many records arrived since the last commit.
+    //
+    // Every snapshot_interval the writer starts a snapshot round: it rolls
+    // over to a new segment and asks each shard for a checkpoint, which the
+    // shard captures between bursts. Once every shard has answered and the
+    // journal is durable up to each checkpoint, the writer writes the
+    // snapshot file and drops the segments replay no longer needs: those
+    // before the round's, unless they hold a trade a captured position had
+    // not booked yet.
+    class JournalWriter {
+    public:
+        static constexpr size_t RingSize = 16384; // Records per shard between commits
+        static constexpr size_t CommitBytes = 1 << 20; // Largest group commit
+
+        // A matching shard's end of the journal. Appends and checkpoints come
+        // from that shard's matching thread only.
+        class alignas(CacheLineSize) ShardLog {
+            friend class JournalWriter;
+
+            SPSCQueue<JournalRecord, RingSize> ring;
+            const std::atomic<uint64_t> &requested_round;
+            WakeSignal *wake{nullptr}; // Rung when a checkpoint is wanted
+            uint8_t shard;
+            uint64_t next_sequence{1}; // Matching thread
+
+            alignas(CacheLineSize) std::atomic<uint64_t> captured_round{0};
+            ShardCheckpoint checkpoint;
+
+            alignas(CacheLineSize) std::atomic<uint64_t> durable_sequence{0}; // Writer thread
+            std::atomic<uint64_t> stalls{0}; // Appends that waited for ring space
+
+        public:
+            ShardLog(const uint32_t shard_index, const std::atomic<uint64_t> &round)
+                : requested_round(round), shard(static_cast<uint8_t>(shard_index)) {
+            }
+
+            FORCE_INLINE void append_request(const Order &order) noexcept {
+                append(JournalRecordType::Request, &order, sizeof(order));
+            }
+
+            FORCE_INLINE void append_trade(const Trade &trade) noexcept {
+                append(JournalRecordType::Trade, &trade, sizeof(trade));
+            }
+
+            [[nodiscard]] FORCE_INLINE bool checkpoint_due() const noexcept {
+                return requested_round.load(std::memory_order_relaxed) !=
+                       captured_round.load(std::memory_order_relaxed);
+            }
+
+            // Fill the returned checkpoint, then publish it. Sequence and
+            // round are already set.
+            ShardCheckpoint &begin_checkpoint() noexcept {
+                checkpoint.clear();
+                checkpoint.round = requested_round.load(std::memory_order_acquire);
+                checkpoint.sequence = next_sequence - 1;
+                return checkpoint;
+            }
+
+            void publish_checkpoint() noexcept {
+                captured_round.store(checkpoint.round, std::memory_order_release);
+            }
+
+            // Last sequence number on disk (or handed to the OS when sync is off)
+            [[nodiscard]] uint64_t durable() const noexcept {
+                return durable_sequence.load(std::memory_order_acquire);
+            }
+
+            [[nodiscard]] uint64_t last_sequence() const noexcept {
+                return next_sequence - 1;
+            }
+
+            // Before start: recovery says where the shard's journal left off
+            void resume(const uint64_t sequence) noexcept {
+                next_sequence = sequence + 1;
+                durable_sequence.store(sequence, std::memory_order_relaxed);
+            }
+
+            void set_wake(WakeSignal *signal) noexcept {
+                wake = signal;
+            }
+
+        private:
+            FORCE_INLINE void append(const JournalRecordType type, const void *payload, const size_t bytes) noexcept {
+                JournalRecord record{
+                    .checksum = 0,
+                    .type = type,
+                    .shard = shard,
+                    .reserved = 0,
+                    .sequence = next_sequence++,
+                    .payload = {}
+                };
+                std::memcpy(record.payload, payload, bytes);
+                if (UNLIKELY(!ring.try_push(record))) {
+                    wait_to_push(record);
+                }
+            }
+
+            // Back-pressure rather than loss: a record that never reaches the
+            // writer is state recovery cannot rebuild
+            void wait_to_push(const JournalRecord &record) noexcept {
+                stalls.fetch_add(1, std::memory_order_relaxed);
+                for (uint32_t attempt = 0; !ring.try_push(record); ++attempt) {
+                    if (attempt < 64) {
+                        cpu_relax();
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        };
+
+        struct JournalStats {
+            bool enabled;
+            bool direct_io; // Writing with O_DIRECT
+            bool failed; // A write or sync failed; later records were dropped
+            uint64_t records_written;
+            uint64_t bytes_written; // Including rewritten partial blocks
+            uint64_t records_dropped; // After a failure
+            uint64_t commits;
+            double records_per_commit;
+            uint64_t producer_stalls; // Appends that found their shard's ring full
+            uint64_t segments_opened;
+            uint64_t snapshots_written;
+            uint64_t last_snapshot_bytes;
+            uint64_t last_snapshot_round;
+            LatencyProfiler::ProfileResults commit_latency; // Write plus sync per group commit
+        };
+
+    private:
+        JournalConfig config;
+        std::vector<NodeLocalPtr<ShardLog> > logs;
+        alignas(CacheLineSize) std::atomic<uint64_t> requested_round{0};
+
+        // Writer thread once started
+        int segment_fd{-1};
+        uint64_t segment_number{0};
+        uint64_t segment_end{0}; // Offset past the last record
+        bool direct{false};
+        uint8_t *buffer{nullptr}; // CommitBytes plus a block, block-aligned
+        size_t tail_bytes{0}; // The partial last block, already written once, kept at the front
+        size_t buffered_bytes{0}; // tail_bytes plus records not yet written
+        std::vector<uint64_t> buffered_sequence; // Per shard, last sequence in the buffer
+        std::vector<uint64_t> committed_sequence;
+        uint32_t first_shard{0};
+        uint64_t round_first_segment{0};
+        bool round_open{false};
+
+        // Per shard, the last trade ID collected, and for each segment opened
+        // since start, what it was when the segment opened; so the segments
+        // holding a shard's trades after a given ID can be found
+        struct SegmentStart {
+            uint64_t segment;
+            std::vector<TradeID> trades_before;
+        };
+        std::vector<TradeID> last_trade_collected;
+        std::vector<SegmentStart> segment_starts;
+        std::chrono::steady_clock::time_point next_round_at{};
+
+        std::thread writer_thread;
+        std::atomic<bool> running{false};
+        std::atomic<bool> failed{false};
+        WaitStrategy wait;
+
+        // Statistics
+        std::atomic<uint64_t> records_written{0};
+        std::atomic<uint64_t> bytes_written{0};
+        std::atomic<uint64_t> records_dropped{0};
+        std::atomic<uint64_t> commits{0};
+        std::atomic<uint64_t> segments_opened{0};
+        std::atomic<uint64_t> snapshots_written{0};
+        std::atomic<uint64_t> last_snapshot_bytes{0};
+        std::atomic<uint64_t> last_snapshot_round{0};
+
+    public:
+        // shard_nodes[i]: NUMA node of shard i's matching thread, -1 if unpinned
+        JournalWriter(JournalConfig journal_config, const std::vector<int> &shard_nodes)
+            : config(std::move(journal_config)), buffered_sequence(shard_nodes.size(), 0),
+              committed_sequence(shard_nodes.size(), 0), last_trade_collected(shard_nodes.size(), 0),
+              wait(config.wait, nullptr, "journal") {
+            logs.reserve(shard_nodes.size());
+            for (uint32_t shard = 0; shard < shard_nodes.size(); ++shard) {
+                logs.push_back(make_node_local<ShardLog>(shard_nodes[shard], shard, requested_round));
+            }
+        }
+
+        ~JournalWriter() {
+            stop();
+            release_buffer();
+        }
+
+        JournalWriter(const JournalWriter &) = delete;
+
+        JournalWriter &operator=(const JournalWriter &) = delete;
+
+        [[nodiscard]] ShardLog &log(const uint32_t shard) noexcept {
+            return *logs[shard];
+        }
+
+        [[nodiscard]] uint32_t shard_count() const noexcept {
+            return static_cast<uint32_t>(logs.size());
+        }
+
+        [[nodiscard]] const std::string &directory() const noexcept {
+            return config.directory;
+        }
+
+        // Opens a fresh segment after anything already in the directory and
+        // starts the writer thread. Shards must have been resumed first.
+        bool start() {
+            if (running.load(std::memory_order_acquire)) {
+                return false;
+            }
+            std::error_code error;
+            std::filesystem::create_directories(config.directory, error);
+            if (!allocate_buffer()) {
+                return false;
+            }
+
+            const auto segments = journal_detail::list_segments(config.directory);
+            const auto snapshots = journal_detail::list_snapshots(config.directory);
+            const uint64_t last_round = snapshots.empty() ? 0 : snapshots.back();
+            requested_round.store(last_round, std::memory_order_relaxed);
+            for (const auto &log: logs) {
+                log->captured_round.store(last_round, std::memory_order_relaxed);
+            }
+            for (uint32_t shard = 0; shard < logs.size(); ++shard) {
+                committed_sequence[shard] = buffered_sequence[shard] = logs[shard]->last_sequence();
+            }
+            std::ranges::fill(last_trade_collected, 0);
+            segment_starts.clear();
+
+            if (!open_segment(segments.empty() ? 1 : segments.back() + 1)) {
+                return false;
+            }
+
+            next_round_at = std::chrono::steady_clock::now() + config.snapshot_interval;
+            running.store(true, std::memory_order_release);
+            writer_thread = std::thread(&JournalWriter::writer_loop, this);
+            return true;
+        }
+
+        // After the matching threads have stopped: drains and commits
+        // everything they appended
+        void stop() {
+            running.store(false, std::memory_order_release);
+            if (writer_thread.joinable()) {
+                writer_thread.join();
+            }
+            if (segment_fd >= 0) {
+                while (collect() > 0) {
+                    (void) commit();
+                }
+                close_segment();
+            }
+        }
+
+        // After stop(), with the matching threads gone: one more snapshot,
+        // captured on this thread by capture(shard, ShardLog &) for each
+        // shard, so the next start has nothing to replay
+        template<typename Capture>
+        bool write_final_snapshot(Capture &&capture) {
+            if (buffer == nullptr || failed.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            if (!open_segment(segment_number + 1)) {
+                return false;
+            }
+            round_first_segment = segment_number;
+            requested_round.fetch_add(1, std::memory_order_acq_rel);
+            for (uint32_t shard = 0; shard < logs.size(); ++shard) {
+                capture(shard, *logs[shard]);
+            }
+            const bool written = write_snapshot();
+            close_segment();
+            return written;
+        }
+
+        [[nodiscard]] JournalStats get_statistics() const {
+            const uint64_t records = records_written.load(std::memory_order_relaxed);
+            const uint64_t commit_count = commits.load(std::memory_order_relaxed);
+            uint64_t stalls = 0;
+            for (const auto &log: logs) {
+                stalls += log->stalls.load(std::memory_order_relaxed);
+            }
+
+            return JournalStats{
+                .enabled = true,
+                .direct_io = direct,
+                .failed = failed.load(std::memory_order_relaxed),
+                .records_written = records,
+                .bytes_written = bytes_written.load(std::memory_order_relaxed),
+                .records_dropped = records_dropped.load(std::memory_order_relaxed),
+                .commits = commit_count,
+                .records_per_commit = commit_count > 0 ? static_cast<double>(records) / commit_count : 0.0,
+                .producer_stalls = stalls,
+                .segments_opened = segments_opened.load(std::memory_order_relaxed),
+                .snapshots_written = snapshots_written.load(std::memory_order_relaxed),
+                .last_snapshot_bytes = last_snapshot_bytes.load(std::memory_order_relaxed),
+                .last_snapshot_round = last_snapshot_round.load(std::memory_order_relaxed),
+                .commit_latency = LatencyProfiler::get_stats(LatencyProfiler::Journal_commit)
+            };
+        }
+
+        [[nodiscard]] WaitStats get_wait_statistics() const noexcept {
+            return wait.get_statistics();
+        }
+
+    private:
+        void writer_loop() {
+            if (!place_current_thread(config.placement)) {
+                std::cerr << "Journal: thread placement not applied" << std::endl;
+            }
+            const auto ready = [this] {
+                return !running.load(std::memory_order_acquire) ||
+                       std::any_of(logs.begin(), logs.end(), [](const auto &log) { return !log->ring.empty(); });
+            };
+
+            wait.begin();
+            try {
+                while (running.load(std::memory_order_acquire)) {
+                    const size_t collected = collect();
+                    if (collected > 0) {
+                        (void) commit();
+                        wait.on_work();
+                    }
+                    advance_snapshot_round();
+                    if (collected == 0) {
+                        wait.idle(ready);
+                    }
+                }
+            } catch (const std::exception &e) {
+                std::cerr << "Exception in journal writer_loop: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Unknown exception in journal writer_loop" << std::endl;
+            }
+            wait.end();
+        }
+
+        // Moves what the rings hold into the buffer, straight into place,
+        // and seals each record. Returns the records taken.
+        size_t collect() noexcept {
+            if (UNLIKELY(failed.load(std::memory_order_relaxed))) {
+                return discard();
+            }
+            if (buffered_bytes == tail_bytes && segment_end + sizeof(JournalRecord) > config.segment_bytes &&
+                !open_segment(segment_number + 1)) {
+                return discard(); // Full, and no next segment
+            }
+
+            size_t taken = 0;
+            for (uint32_t i = 0; i < logs.size(); ++i) {
+                // Rotate who goes first, so a busy shard cannot fill every commit
+                const uint32_t shard = (first_shard + i) % static_cast<uint32_t>(logs.size());
+                const size_t pending = buffered_bytes - tail_bytes;
+                const size_t segment_room = config.segment_bytes -
+                                            std::min<size_t>(config.segment_bytes, segment_end + pending);
+                const size_t room = std::min(CommitBytes - pending, segment_room) / sizeof(JournalRecord);
+                if (room == 0) {
+                    break; // Commit first; a full segment rolls over on the next pass
+                }
+
+                auto *records = reinterpret_cast<JournalRecord *>(buffer + buffered_bytes);
+                const size_t count = logs[shard]->ring.try_pop_bulk(std::span(records, room));
+                for (size_t r = 0; r < count; ++r) {
+                    records[r].checksum = record_checksum(records[r]);
+                    if (records[r].type == JournalRecordType::Trade) {
+                        last_trade_collected[shard] = records[r].trade().trade_id;
+                    }
+                }
+                if (count > 0) {
+                    buffered_sequence[shard] = records[count - 1].sequence;
+                    buffered_bytes += count * sizeof(JournalRecord);
+                    taken += count;
+                }
+            }
+            first_shard = (first_shard + 1) % static_cast<uint32_t>(logs.size());
+            return taken;
+        }
+
+        // After a failure: keep the rings moving so the matching threads
+        // never stall on a journal that can no longer be written
+        size_t discard() noexcept {
+            size_t dropped = 0;
+            auto *records = reinterpret_cast<JournalRecord *>(buffer);
+            for (const auto &log: logs) {
+                dropped += log->ring.try_pop_bulk(std::span(records, CommitBytes / sizeof(JournalRecord)));
+            }
+            records_dropped.fetch_add(dropped, std::memory_order_relaxed);
+            return 0;
+        }
+
+        // One write of whole blocks from the partial block on, one sync,
+        // then the new partial block moves to the front of the buffer
+        bool commit() {
+            const size_t new_bytes = buffered_bytes - tail_bytes;
+            if (new_bytes == 0 || failed.load(std::memory_order_relaxed)) {
+                return !failed.load(std::memory_order_relaxed);
+            }
+
+            const uint64_t started = TimestampManager::get_hardware_timestamp();
+            const uint64_t block_start = segment_end - tail_bytes;
+            const size_t write_bytes = (buffered_bytes + JournalBlockSize - 1) & ~(JournalBlockSize - 1);
+            std::memset(buffer + buffered_bytes, 0, write_bytes - buffered_bytes);
+
+            if (!write_blocks(block_start, write_bytes)) {
+                std::cerr << "Journal: write to segment " << segment_number << " failed; journaling stopped"
+                        << std::endl;
+                failed.store(true, std::memory_order_relaxed);
+            }
+
+            const uint64_t records = new_bytes / sizeof(JournalRecord);
+            segment_end += new_bytes;
+            const size_t kept = buffered_bytes % JournalBlockSize;
+            std::memmove(buffer, buffer + buffered_bytes - kept, kept);
+            tail_bytes = buffered_bytes = kept;
+
+            if (!failed.load(std::memory_order_relaxed)) {
+                for (uint32_t shard = 0; shard < logs.size(); ++shard) {
+                    if (committed_sequence[shard] != buffered_sequence[shard]) {
+                        committed_sequence[shard] = buffered_sequence[shard];
+                        logs[shard]->durable_sequence.store(committed_sequence[shard], std::memory_order_release);
+                    }
+                }
+                records_written.fetch_add(records, std::memory_order_relaxed);
+                bytes_written.fetch_add(write_bytes, std::memory_order_relaxed);
+                commits.fetch_add(1, std::memory_order_relaxed);
+                LatencyProfiler::record(LatencyProfiler::Journal_commit,
+                                        TimestampManager::get_hardware_timestamp() - started);
+            }
+            return !failed.load(std::memory_order_relaxed);
+        }
+
+        // Starts a round on schedule; writes its snapshot once every shard
+        // has captured it and the journal is durable up to each capture
+        void advance_snapshot_round() {
+            if (config.snapshot_interval.count() == 0 || failed.load(std::memory_order_relaxed)) {
+                return;
+            }
+
+            const uint64_t round = requested_round.load(std::memory_order_relaxed);
+            if (!round_open) {
+                if (std::chrono::steady_clock::now() < next_round_at) {
+                    return;
+                }
+                // Everything before the round's first segment predates every capture
+                if (!commit() || !open_segment(segment_number + 1)) {
+                    return;
+                }
+                round_first_segment = segment_number;
+                round_open = true;
+                requested_round.store(round + 1, std::memory_order_release);
+                for (const auto &log: logs) {
+                    if (log->wake != nullptr) {
+                        log->wake->wake_all();
+                    }
+                }
+                return;
+            }
+
+            for (uint32_t shard = 0; shard < logs.size(); ++shard) {
+                const ShardLog &log = *logs[shard];
+                if (log.captured_round.load(std::memory_order_acquire) != round ||
+                    committed_sequence[shard] < log.checkpoint.sequence) {
+                    return;
+                }
+            }
+            (void) write_snapshot();
+            round_open = false;
+            next_round_at = std::chrono::steady_clock::now() + config.snapshot_interval;
+        }
+
+        // Snapshot for the current round: written aside, synced, renamed into
+        // place, then older snapshots and segments replay can skip are removed
+        bool write_snapshot() {
+            const uint64_t round = requested_round.load(std::memory_order_relaxed);
+            std::vector<uint8_t> payload;
+            for (uint32_t shard = 0; shard < logs.size(); ++shard) {
+                const ShardCheckpoint &checkpoint = logs[shard]->checkpoint;
+                const SnapshotShardHeader header{
+                    .shard = shard,
+                    .book_count = static_cast<uint32_t>(checkpoint.books.size()),
+                    .sequence = checkpoint.sequence,
+                    .next_trade_id = checkpoint.next_trade_id,
+                    .order_count = checkpoint.orders.size(),
+                    .position_count = checkpoint.positions.size()
+                };
+                journal_detail::append_bytes(payload, &header, 1);
+                journal_detail::append_bytes(payload, checkpoint.books.data(), checkpoint.books.size());
+                journal_detail::append_bytes(payload, checkpoint.orders.data(), checkpoint.orders.size());
+                journal_detail::append_bytes(payload, checkpoint.positions.data(), checkpoint.positions.size());
+            }
+
+            const SnapshotFileHeader header{
+                .magic = SnapshotFileHeader::Magic,
+                .version = SnapshotFileHeader::CurrentVersion,
+                .shard_count = shard_count(),
+                .round = round,
+                .first_segment = round_first_segment,
+                .created_ns = journal_detail::realtime_ns(),
+                .payload_bytes = payload.size(),
+                .checksum = journal_hash(payload.data(), payload.size())
+            };
+
+            if (!write_file(journal_detail::snapshot_path(config.directory, round), header, payload)) {
+                std::cerr << "Journal: snapshot " << round << " could not be written" << std::endl;
+                return false;
+            }
+            snapshots_written.fetch_add(1, std::memory_order_relaxed);
+            last_snapshot_bytes.store(sizeof(header) + payload.size(), std::memory_order_relaxed);
+            last_snapshot_round.store(round, std::memory_order_relaxed);
+
+            std::error_code error;
+            for (const uint64_t old_round: journal_detail::list_snapshots(config.directory)) {
+                if (old_round < round) {
+                    std::filesystem::remove(journal_detail::snapshot_path(config.directory, old_round), error);
+                }
+            }
+            const uint64_t keep_from = first_needed_segment();
+            for (const uint64_t segment: journal_detail::list_segments(config.directory)) {
+                if (segment < keep_from) {
+                    std::filesystem::remove(journal_detail::segment_path(config.directory, segment), error);
+                }
+            }
+            std::erase_if(segment_starts, [keep_from](const SegmentStart &start) { return start.segment < keep_from; });
+            return true;
+        }
+
+        // Oldest segment replay of the checkpoints just written needs: the
+        // round's first, for the requests after them, or an older one
+        // holding a trade some shard's positions had not booked. Segments
+        // from before start hold none; recovery booked all of theirs.
+        [[nodiscard]] uint64_t first_needed_segment() const noexcept {
+            for (size_t i = 0; i + 1 < segment_starts.size() && segment_starts[i].segment < round_first_segment;
+                 ++i) {
+                // Everything up to the next segment's start is booked: this one can go
+                const std::vector<TradeID> &through = segment_starts[i + 1].trades_before;
+                for (uint32_t shard = 0; shard < logs.size(); ++shard) {
+                    if (through[shard] > logs[shard]->checkpoint.trades_booked) {
+                        return segment_starts[i].segment;
+                    }
+                }
+            }
+            return round_first_segment;
+        }
+
+#ifndef _WIN32
+        bool allocate_buffer() {
+            if (buffer == nullptr) {
+                void *memory = nullptr;
+                if (::posix_memalign(&memory, JournalBlockSize, CommitBytes + JournalBlockSize) != 0) {
+                    return false;
+                }
+                buffer = static_cast<uint8_t *>(memory);
+            }
+            tail_bytes = buffered_bytes = 0;
+            return true;
+        }
+
+        void release_buffer() noexcept {
+            std::free(buffer);
+            buffer = nullptr;
+        }
+
+        // Preallocated, so commits append without growing the file and a
+        // data sync does not also have to write out the inode
+        bool open_segment(const uint64_t number) {
+            if (!commit()) {
+                return false;
+            }
+            close_segment();
+
+            const std::string path = journal_detail::segment_path(config.directory, number).string();
+            int flags = O_RDWR | O_CREAT | O_TRUNC;
+            direct = false;
+#ifdef O_DIRECT
+            if (config.direct_io) {
+                segment_fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+                direct = segment_fd >= 0;
+            }
+#endif
+            if (segment_fd < 0) {
+                segment_fd = ::open(path.c_str(), flags, 0644); // tmpfs and friends refuse O_DIRECT
+            }
+            if (segment_fd < 0) {
+                failed.store(true, std::memory_order_relaxed);
+                return false;
+            }
+
+#ifdef __linux__
+            if (::posix_fallocate(segment_fd, 0, static_cast<off_t>(config.segment_bytes)) != 0)
+#endif
+            {
+                (void) ::ftruncate(segment_fd, static_cast<off_t>(config.segment_bytes));
+            }
+
+            // The header takes the first block; records follow it
+            std::memset(buffer, 0, JournalBlockSize);
+            const JournalSegmentHeader header{
+                .magic = JournalSegmentHeader::Magic,
+                .version = JournalSegmentHeader::CurrentVersion,
+                .record_size = sizeof(JournalRecord),
+                .segment = number,
+                .shard_count = shard_count(),
+                .reserved = 0,
+                .created_ns = journal_detail::realtime_ns()
+            };
+            std::memcpy(buffer, &header, sizeof(header));
+            segment_number = number;
+            if (!write_blocks(0, JournalBlockSize)) {
+                failed.store(true, std::memory_order_relaxed);
+                return false;
+            }
+            journal_detail::sync_directory(config.directory);
+
+            segment_end = JournalBlockSize;
+            tail_bytes = buffered_bytes = 0;
+            segment_starts.push_back(SegmentStart{.segment = number, .trades_before = last_trade_collected});
+            segments_opened.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        void close_segment() noexcept {
+            if (segment_fd >= 0) {
+                ::close(segment_fd);
+                segment_fd = -1;
+            }
+        }
+
+        bool write_blocks(const uint64_t offset, const size_t bytes) noexcept {
+            if (!journal_detail::write_all(segment_fd, buffer, bytes, static_cast<off_t>(offset))) {
+                return false;
+            }
+            return !config.sync || ::fdatasync(segment_fd) == 0;
+        }
+
+        bool write_file(const std::filesystem::path &path, const SnapshotFileHeader &header,
+                        const std::vector<uint8_t> &payload) const {
+            const std::string staging = path.string() + ".tmp";
+            const int fd = ::open(staging.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) {
+                return false;
+            }
+            const bool written =
+                    journal_detail::write_all(fd, reinterpret_cast<const uint8_t *>(&header), sizeof(header), 0) &&
+                    journal_detail::write_all(fd, payload.data(), payload.size(), sizeof(header)) &&
+                    ::fsync(fd) == 0;
+            ::close(fd);
+            if (!written || ::rename(staging.c_str(), path.c_str()) != 0) {
+                std::error_code error;
+                std::filesystem::remove(staging, error);
+                return false;
+            }
+            journal_detail::sync_directory(config.directory);
+            return true;
+        }
+#else
+        // No Windows backend: start() fails and the engine runs unjournaled
+        bool allocate_buffer() { return false; }
+        void release_buffer() noexcept {}
+        bool open_segment(uint64_t) { return false; }
+        void close_segment() noexcept {}
+        bool write_blocks(uint64_t, size_t) noexcept { return false; }
+
+        bool write_file(const std::filesystem::path &, const SnapshotFileHeader &,
+                        const std::vector<uint8_t> &) const {
+            return false;
+        }
+#endif
+    };
+
+#ifndef _WIN32
+    // Reads back what a JournalWriter left in its directory
+    class JournalReader {
+        std::string directory;
+
+    public:
+        explicit JournalReader(std::string journal_directory) : directory(std::move(journal_directory)) {
+        }
+
+        // The newest snapshot that reads back whole and matches shard_count
+        [[nodiscard]] std::optional<JournalSnapshot> load_snapshot(const uint32_t shard_count) const {
+            const auto rounds = journal_detail::list_snapshots(directory);
+            for (auto round = rounds.rbegin(); round != rounds.rend(); ++round) {
+                if (auto snapshot = read_snapshot(journal_detail::snapshot_path(directory, *round), shard_count)) {
+                    return snapshot;
+                }
+            }
+            return std::nullopt;
+        }
+
+        // Shard count the journal was written with, from its newest segment; 0 if there is none
+        [[nodiscard]] uint32_t shard_count() const {
+            const auto numbers = segments();
+            for (auto segment = numbers.rbegin(); segment != numbers.rend(); ++segment) {
+                const journal_detail::MappedSegment mapped(journal_detail::segment_path(directory, *segment));
+                if (const auto header = mapped.header()) {
+                    return header->shard_count;
+                }
+            }
+            return 0;
+        }
+
+        [[nodiscard]] std::vector<uint64_t> segments() const {
+            return journal_detail::list_segments(directory);
+        }
+
+        struct ScanStats {
+            uint64_t segments;
+            uint64_t records;
+            uint64_t torn_segments; // Ended on a record that failed its checksum
+        };
+
+        // Every valid record of segments from first_segment on, in write order
+        template<typename Visitor>
+        ScanStats scan(const uint64_t first_segment, Visitor &&visitor) const {
+            ScanStats stats{.segments = 0, .records = 0, .torn_segments = 0};
+            for (const uint64_t segment: segments()) {
+                if (segment < first_segment) {
+                    continue;
+                }
+                const journal_detail::MappedSegment mapped(journal_detail::segment_path(directory, segment));
+                if (!mapped.header()) {
+                    continue;
+                }
+
+                ++stats.segments;
+                JournalRecord record{};
+                size_t offset = JournalBlockSize;
+                for (; offset + sizeof(record) <= mapped.size(); offset += sizeof(record)) {
+                    std::memcpy(&record, mapped.data() + offset, sizeof(record));
+                    if (!record_valid(record)) {
+                        break;
+                    }
+                    visitor(record);
+                    ++stats.records;
+                }
+                if (offset + sizeof(record) <= mapped.size() && record.type != JournalRecordType::End) {
+                    ++stats.torn_segments;
+                }
+            }
+            return stats;
+        }
+
+    private:
+        static std::optional<JournalSnapshot> read_snapshot(const std::filesystem::path &path,
+                                                            const uint32_t shard_count) {
+            const auto contents = journal_detail::read_file(path);
+            SnapshotFileHeader header{};
+            if (contents.size() < sizeof(header)) {
+                return std::nullopt;
+            }
+            std::memcpy(&header, contents.data(), sizeof(header));
+            const uint8_t *in = contents.data() + sizeof(header);
+            const uint8_t *end = contents.data() + contents.size();
+            if (header.magic != SnapshotFileHeader::Magic || header.version != SnapshotFileHeader::CurrentVersion ||
+                header.shard_count != shard_count || header.payload_bytes != static_cast<uint64_t>(end - in) ||
+                header.checksum != journal_hash(in, header.payload_bytes)) {
+                return std::nullopt;
+            }
+
+            JournalSnapshot snapshot{.round = header.round, .first_segment = header.first_segment, .shards = {}};
+            snapshot.shards.resize(shard_count);
+            for (uint32_t i = 0; i < shard_count; ++i) {
+                SnapshotShardHeader shard{};
+                if (static_cast<size_t>(end - in) < sizeof(shard)) {
+                    return std::nullopt;
+                }
+                std::memcpy(&shard, in, sizeof(shard));
+                in += sizeof(shard);
+                if (shard.shard >= shard_count) {
+                    return std::nullopt;
+                }
+
+                ShardCheckpoint &checkpoint = snapshot.shards[shard.shard];
+                checkpoint.round = header.round;
+                checkpoint.sequence = shard.sequence;
+                checkpoint.next_trade_id = shard.next_trade_id;
+                if (!journal_detail::read_items(in, end, checkpoint.books, shard.book_count) ||
+                    !journal_detail::read_items(in, end, checkpoint.orders, shard.order_count) ||
+                    !journal_detail::read_items(in, end, checkpoint.positions, shard.position_count)) {
+                    return std::nullopt;
+                }
+            }
+            return snapshot;
+        }
+    };
+#endif
+}
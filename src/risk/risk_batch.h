@@ -0,0 +1,191 @@
+#pragma once
+
+#include "../core/types.h"
+#include "../core/timing.h"
+#include "risk_manager.h"
+
+#include <algorithm>
+#include <array>
+#include <span>
+
+namespace trading_engine {
+    // Gathers orders for RiskManager::check_orders on the risk-checking thread
+    //
+    // Unlinked orders go straight into the batch. Linked legs are held back
+    // until their whole group has arrived, so check_orders always sees complete
+    // groups, and a released group's legs sit next to each other in the batch.
+    // A group that does not complete within the staging limit, or is the
+    // oldest when staging fills up, is refused: its legs, and any that arrive
+    // for it later, come out rejected_incomplete_link without being checked.
+    // So are the legs of groups larger than MaxStagedLegs.
+    // Not thread-safe.
+    class RiskBatch {
+    public:
+        static constexpr size_t Capacity = RiskManager::MaxBatchSize;
+        static constexpr size_t MaxStagedLegs = 8;
+        static constexpr uint64_t DefaultMaxStageNs = 1000000; // 1ms; siblings are submitted back to back
+
+    private:
+        // Room for a refused group plus the group that completes in the same add()
+        static constexpr size_t Reserve = 2 * MaxStagedLegs;
+        static constexpr size_t RefusedLinkMemory = 16; // Late legs of this many refused groups are caught
+
+        std::array<Order, Capacity> batch{};
+        std::array<RiskManager::RiskResult, Capacity> verdicts{};
+        size_t count{0};
+
+        // Refused legs; check() appends them to the batch, already rejected
+        std::array<Order, Capacity> refused{};
+        size_t refused_count{0};
+
+        std::array<Order, MaxStagedLegs> staged{}; // In arrival order
+        std::array<uint64_t, MaxStagedLegs> staged_at{};
+        size_t staged_count{0};
+        uint64_t max_stage_ns;
+
+        std::array<LinkID, RefusedLinkMemory> refused_links{};
+        size_t next_refused_link{0};
+        uint64_t groups_refused{0};
+
+        std::array<Order, Capacity> inbound{}; // Landing area for fill_from
+
+    public:
+        explicit RiskBatch(const uint64_t max_stage_time_ns = DefaultMaxStageNs) noexcept
+            : max_stage_ns(max_stage_time_ns) {
+        }
+
+        // Pulls orders with pop(Order &) -> bool until it fails or the batch is full
+        template<typename Pop>
+        size_t fill(Pop &&pop) {
+            refuse_stale();
+            Order order;
+            while (count + refused_count + Reserve <= Capacity && pop(order)) {
+                add(order);
+            }
+            return count + refused_count;
+        }
+
+        // Same, but takes a burst from the queue's try_pop_bulk in one go.
+        // Every order added ends up in the batch, refused or staged, so
+        // asking for no more than the free room keeps a completing group in
+        // bounds.
+        template<typename Queue>
+        size_t fill_from(Queue &queue) {
+            refuse_stale();
+            const size_t room = Capacity - count - refused_count - staged_count;
+            const size_t popped = queue.try_pop_bulk(std::span(inbound.data(), room));
+            for (size_t i = 0; i < popped; ++i) {
+                add(inbound[i]);
+            }
+            return count + refused_count;
+        }
+
+        void check(RiskManager &risk_manager) noexcept {
+            risk_manager.check_orders({batch.data(), count}, {verdicts.data(), count});
+            for (size_t i = 0; i < refused_count; ++i) {
+                batch[count] = refused[i];
+                verdicts[count++] = RiskManager::RiskResult::rejected_incomplete_link;
+            }
+            refused_count = 0;
+        }
+
+        [[nodiscard]] std::span<const Order> orders() const noexcept {
+            return {batch.data(), count};
+        }
+
+        [[nodiscard]] std::span<RiskManager::RiskResult> results() noexcept {
+            return {verdicts.data(), count};
+        }
+
+        [[nodiscard]] size_t size() const noexcept {
+            return count;
+        }
+
+        [[nodiscard]] size_t staged_legs() const noexcept {
+            return staged_count;
+        }
+
+        // Linked groups refused for arriving incomplete
+        [[nodiscard]] uint64_t refused_groups() const noexcept {
+            return groups_refused;
+        }
+
+        void clear() noexcept {
+            count = 0;
+        }
+
+    private:
+        void add(const Order &order) noexcept {
+            if (order.linkID == 0 || order.legCount <= 1) {
+                batch[count++] = order;
+                return;
+            }
+
+            // Oversized groups could never be staged whole; late legs of a
+            // refused group would go out without their siblings
+            if (UNLIKELY(order.legCount > MaxStagedLegs ||
+                         std::ranges::find(refused_links, order.linkID) != refused_links.end())) {
+                refused[refused_count++] = order;
+                return;
+            }
+
+            if (staged_count == MaxStagedLegs) {
+                refuse_group(staged[0].linkID);
+            }
+
+            staged_at[staged_count] = TimestampManager::get_hardware_timestamp();
+            staged[staged_count++] = order;
+
+            size_t legs = 0;
+            for (size_t i = 0; i < staged_count; ++i) {
+                legs += staged[i].linkID == order.linkID;
+            }
+            if (legs == order.legCount) {
+                release_group(order.linkID, batch, count);
+            }
+        }
+
+        // Refuses the oldest groups once they have waited past the limit
+        void refuse_stale() noexcept {
+            if (LIKELY(staged_count == 0)) {
+                return;
+            }
+
+            const uint64_t now = TimestampManager::get_hardware_timestamp();
+            const uint64_t limit = stage_limit();
+            while (staged_count > 0 && now - staged_at[0] >= limit) {
+                refuse_group(staged[0].linkID);
+            }
+        }
+
+        void refuse_group(const LinkID link) noexcept {
+            release_group(link, refused, refused_count);
+            refused_links[next_refused_link] = link;
+            next_refused_link = (next_refused_link + 1) % RefusedLinkMemory;
+            ++groups_refused;
+        }
+
+        // Moves every staged leg of the group to `out`, keeping arrival order
+        void release_group(const LinkID link, std::array<Order, Capacity> &out, size_t &out_count) noexcept {
+            size_t kept = 0;
+            for (size_t i = 0; i < staged_count; ++i) {
+                if (staged[i].linkID == link) {
+                    out[out_count++] = staged[i];
+                } else {
+                    staged_at[kept] = staged_at[i];
+                    staged[kept++] = staged[i];
+                }
+            }
+            staged_count = kept;
+        }
+
+        // The staging limit in get_hardware_timestamp() units: TSC ticks once
+        // calibrated, nanoseconds before
+        [[nodiscard]] uint64_t stage_limit() const noexcept {
+            const uint64_t frequency = TimestampManager::get_frequency();
+            return TimestampManager::is_reliable() && frequency > 0
+                       ? max_stage_ns * frequency / 1000000000ULL
+                       : max_stage_ns;
+        }
+    };
+}
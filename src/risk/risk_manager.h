@@ -3,17 +3,43 @@
 #include "../core/types.h"
 #include "../core/memory.h"
 #include "../core/timing.h"
+#include "../core/seqlock.h"
+#include "../core/symbol_directory.h"
 
 #include <atomic>
-#include <unordered_map>
 #include <chrono>
-#include <shared_mutex>
+#include <memory>
 #include <mutex>
+#include <vector>
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
-#include <tuple>
+#include <span>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
 
 namespace trading_engine {
+    // Limits are immutable once published; updates swap in a new copy
+    struct RiskLimits {
+        Quantity max_position{1000000};
+        Value max_notional{10000000 * PriceScale};
+        std::uint32_t max_orders_per_second{1000};
+        Value max_loss_per_day{100000 * PriceScale};
+        Quantity max_order_size{100000};
+        Price max_price_deviation{to_scaled_price(10.0)}; // 10$ from reference
+    };
+
+    // Pre-trade risk checks over flat, pre-allocated per-symbol state
+    //
+    // Every field has a single writer: check_order() owns the token buckets and
+    // order counts, update_position() and update_reference_price() own the
+    // position fields. The two sides may run on different threads (staged
+    // pipeline) or the same one (inline), so the hot path takes no lock and
+    // does no read-modify-write; fields are atomics only so that the other side
+    // and monitoring can read them. Limits are published RCU-style.
     class RiskManager {
     public:
         enum class RiskResult {
@@ -23,229 +49,292 @@ namespace trading_engine {
             rejected_rate_limit,
             rejected_loss_limit,
             rejected_order_size,
-            rejected_price_limit
-        };
-
-    private:
-        struct alignas(CacheLineSize) RiskLimits {
-            std::atomic<Quantity> max_position{1000000};
-            std::atomic<Value> max_notional{10000000 * PriceScale};
-            std::atomic<std::uint32_t> max_orders_per_second{1000};
-            std::atomic<Value> max_loss_per_day{100000 * PriceScale};
-            std::atomic<Quantity> max_order_size{100000};
-            std::atomic<Price> max_price_deviation{to_scaled_price(10.0)}; // 10$ from reference
-
-            // Custom assignment to copy atomic values
-            void copy_from(const RiskLimits &other) {
-                max_position.store(other.max_position.load());
-                max_notional.store(other.max_notional.load());
-                max_orders_per_second.store(other.max_orders_per_second.load());
-                max_loss_per_day.store(other.max_loss_per_day.load());
-                max_order_size.store(other.max_order_size.load());
-                max_price_deviation.store(other.max_price_deviation.load());
-            }
-        };
-
-        struct alignas(CacheLineSize) PositionTracker {
-            std::atomic<std::int64_t> current_position{0}; // Signed for long/short
-            std::atomic<Value> current_notional{0};
-            std::atomic<std::int64_t> realized_pnl{0}; // Signed PnL
-            std::atomic<std::uint32_t> order_count_today{0};
-            std::atomic<Price> vwap{0}; // Volume weighted average price
-            std::atomic<Quantity> total_volume{0};
+            rejected_price_limit,
+            rejected_incomplete_link, // Not every leg of a linked group was in the batch
+            rejected_split_link // A linked group's legs belong to different matching shards
         };
 
-        RiskLimits global_limits;
-        std::unordered_map<SymbolID, PositionTracker> positions;
-        std::unordered_map<SymbolID, RiskLimits> symbol_limits;
-        mutable std::shared_mutex positions_mutex;
-
-        // Rate limiting using token bucket
-        struct RateLimiter {
-            std::atomic<std::uint32_t> tokens{1000};
-            std::atomic<std::uint64_t> last_refill_time{};
-            std::uint32_t refill_rate; // tokens per second
-            std::uint32_t bucket_size;
+        static constexpr std::uint32_t DefaultSymbolOrdersPerSecond = 100;
+        static constexpr size_t MaxBatchSize = 64;
 
-            RateLimiter() : refill_rate(1000), bucket_size(1000) {
-                last_refill_time.store(TimestampManager::get_hardware_timestamp());
+    private:
+        // Single-writer token bucket. Refill cost is a subtraction and a compare
+        // unless at least one whole token has accrued.
+        struct TokenBucket {
+            std::uint64_t last_refill{0};
+            std::uint64_t ticks_per_token{0}; // 0 until first use, when the clock is known
+            std::uint32_t tokens{0};
+            std::uint32_t bucket_size{0};
+            std::uint32_t rate{0};
+
+            void configure(const std::uint32_t orders_per_second) noexcept {
+                rate = std::max<std::uint32_t>(orders_per_second, 1);
+                bucket_size = rate;
+                tokens = rate;
+                ticks_per_token = 0;
             }
 
-            RateLimiter(std::uint32_t rate, std::uint32_t size);
+            // Repeat calls with the same timestamp are a single compare
+            void refill(const std::uint64_t now) noexcept {
+                if (UNLIKELY(ticks_per_token == 0)) {
+                    ticks_per_token = std::max<std::uint64_t>(clock_ticks_per_second() / rate, 1);
+                    last_refill = now;
+                }
 
-            // Make it movable and copyable
-            RateLimiter(const RateLimiter &other)
-                : tokens(other.tokens.load()),
-                  last_refill_time(other.last_refill_time.load()),
-                  refill_rate(other.refill_rate),
-                  bucket_size(other.bucket_size) {
+                if (const std::uint64_t elapsed = now - last_refill; elapsed >= ticks_per_token && now > last_refill) {
+                    const std::uint64_t accrued = elapsed / ticks_per_token;
+                    tokens = static_cast<std::uint32_t>(std::min<std::uint64_t>(tokens + accrued, bucket_size));
+                    last_refill += accrued * ticks_per_token; // Keep the fractional token
+                }
             }
 
-            RateLimiter &operator=(const RateLimiter &other) {
-                if (this != &other) {
-                    tokens.store(other.tokens.load());
-                    last_refill_time.store(other.last_refill_time.load());
-                    refill_rate = other.refill_rate;
-                    bucket_size = other.bucket_size;
+            bool try_take() noexcept {
+                if (tokens == 0) {
+                    return false;
                 }
-                return *this;
+                --tokens;
+                return true;
             }
 
-            RateLimiter(RateLimiter &&other) noexcept
-                : tokens(other.tokens.load()),
-                  last_refill_time(other.last_refill_time.load()),
-                  refill_rate(other.refill_rate),
-                  bucket_size(other.bucket_size) {
+            void give_back() noexcept {
+                tokens = std::min(tokens + 1, bucket_size);
             }
 
-            RateLimiter &operator=(RateLimiter &&other) noexcept {
-                if (this != &other) {
-                    tokens.store(other.tokens.load());
-                    last_refill_time.store(other.last_refill_time.load());
-                    refill_rate = other.refill_rate;
-                    bucket_size = other.bucket_size;
-                }
-                return *this;
+            bool try_consume(const std::uint64_t now) noexcept {
+                refill(now);
+                return try_take();
             }
         };
 
-        RateLimiter global_rate_limiter;
-        std::unordered_map<SymbolID, RateLimiter> symbol_rate_limiters;
+        struct alignas(CacheLineSize) SymbolRiskState {
+            // Position side
+            std::atomic<std::int64_t> position{0}; // Signed for long/short
+            std::atomic<Value> notional{0};
+            std::atomic<std::int64_t> realized_pnl{0}; // Signed PnL
+            std::atomic<Price> vwap{0}; // Volume weighted average price
+            std::atomic<Quantity> total_volume{0};
+            std::atomic<Price> reference_price{0};
+            std::atomic<TradeID> last_trade_id{0}; // Last trade update_position() applied
+            SeqLock position_lock; // Lets a checkpoint copy the position side whole
+            std::atomic<const RiskLimits *> limits{nullptr}; // nullptr: global limits apply
+
+            // Check side
+            alignas(CacheLineSize) TokenBucket bucket;
+            const RiskLimits *bucket_limits{nullptr}; // Limits the bucket was sized for
+            std::atomic<std::uint32_t> order_count{0};
+        };
+
+        SymbolDirectory<SymbolRiskState> symbols;
+
+        std::atomic<const RiskLimits *> global_limits;
+        TokenBucket global_bucket;
+        const RiskLimits *global_bucket_limits{nullptr};
 
-        // Reference prices for price deviation checks
-        std::unordered_map<SymbolID, std::atomic<Price> > reference_prices;
+        // Every published limits object stays alive until the manager goes away,
+        // so a reader holding an old pointer never sees freed memory
+        std::vector<std::unique_ptr<const RiskLimits> > retired_limits;
+        std::mutex limits_mutex;
+
+        // Reported for symbols that have no state yet
+        const SymbolRiskState flat_state{};
 
     public:
-        RiskManager() = default;
+        RiskManager() {
+            global_limits.store(retain(RiskLimits{}), std::memory_order_release);
+        }
 
         void initialize() {
             // Initialize with default limits
-            global_limits.max_position.store(1000000, std::memory_order_relaxed);
-            global_limits.max_notional.store(10000000 * PriceScale, std::memory_order_relaxed);
-            global_limits.max_orders_per_second.store(1000, std::memory_order_relaxed);
-            global_limits.max_loss_per_day.store(100000 * PriceScale, std::memory_order_relaxed);
-            global_limits.max_order_size.store(100000, std::memory_order_relaxed);
+            set_global_limits(RiskLimits{});
         }
 
+        // Pre-allocate per-symbol state so check_order never creates it
+        void register_symbol(SymbolID symbol_id) {
+            get_or_create_state(symbol_id);
+        }
+
+        // Cancels only reduce exposure, so they pass without touching any limit.
+        // Amends are checked on what they change: the new price and size go
+        // through the size, deviation and exposure limits and the message
+        // takes a rate token, but it is not counted as another order.
         RiskResult check_order(const Order &order) noexcept {
             MEASURE_LATENCY(LatencyProfiler::Risk_check);
 
+            if (UNLIKELY(order.action == OrderAction::Cancel)) {
+                return RiskResult::approved;
+            }
+
+            SymbolRiskState *state = find_state(order.symbolID);
+            if (UNLIKELY(state == nullptr)) {
+                return RiskResult::rejected_rate_limit; // Symbol directory full
+            }
+
+            const RiskLimits &global = *global_limits.load(std::memory_order_acquire);
+            const RiskLimits *symbol_override = state->limits.load(std::memory_order_acquire);
+            const RiskLimits &limits = symbol_override != nullptr ? *symbol_override : global;
+
+            const std::uint64_t now = TimestampManager::get_hardware_timestamp();
+
             // Global rate limiting check
-            if (!check_rate_limit(global_rate_limiter)) {
+            sync_global_bucket(global);
+            if (!global_bucket.try_consume(now)) {
                 return RiskResult::rejected_rate_limit;
             }
 
             // Symbol-specific rate limiting
-            if (auto &symbol_limiter = get_or_create_symbol_limiter(order.symbolID);
-                !check_rate_limit(symbol_limiter)) {
+            sync_symbol_bucket(*state, symbol_override);
+            if (!state->bucket.try_consume(now)) {
                 return RiskResult::rejected_rate_limit;
             }
 
             // Order size check
-            if (order.quantity > global_limits.max_order_size.load(std::memory_order_relaxed)) {
+            if (order.quantity > limits.max_order_size) {
                 return RiskResult::rejected_order_size;
             }
 
             // Price deviation check
-            if (!check_price_deviation(order)) {
+            if (!check_price_deviation(*state, order.price, limits)) {
                 return RiskResult::rejected_price_limit;
             }
 
-            // Position and notional checks
-            std::shared_lock lock(positions_mutex);
-            const PositionTracker &position = positions[order.symbolID];
-
-            // Calculate new position
-            const std::int64_t position_change = order.side == Side::Buy
-                                                     ? static_cast<std::int64_t>(order.quantity)
-                                                     : -static_cast<std::int64_t>(order.quantity);
-            const std::int64_t new_position = position.current_position.load(std::memory_order_relaxed) +
-                                              position_change;
-
-            // Position limit check
-            if (static_cast<std::uint64_t>(std::abs(new_position)) > global_limits.max_position.load(
-                    std::memory_order_relaxed)) {
-                return RiskResult::rejected_position_limit;
-            }
-
-            // Notional limit check
-            const Value order_notional = calculate_notional(order.price, order.quantity);
-            const Value current_notional = position.current_notional.load(std::memory_order_relaxed);
-
-            // For position increases, check if we exceed notional limits
-            if ((new_position > 0 && position_change > 0) || (new_position < 0 && position_change < 0)) {
-                if (const Value new_notional = current_notional + order_notional;
-                    new_notional > global_limits.max_notional.load(std::memory_order_relaxed)) {
-                    return RiskResult::rejected_notional_limit;
-                }
+            const RiskResult result = check_exposure(*state, order, limits);
+            if (result == RiskResult::approved && order.action == OrderAction::New) {
+                bump(state->order_count, 1u);
             }
+            return result;
+        }
 
-            // Loss limit check
-            const std::int64_t current_pnl = position.realized_pnl.load(std::memory_order_relaxed);
-            if (current_pnl < -static_cast<std::int64_t>(global_limits.max_loss_per_day.
-                    load(std::memory_order_relaxed))) {
-                return RiskResult::rejected_loss_limit;
+        // Checks a burst with one timestamp and one bucket refill, vectorized
+        // size and price-deviation compares, then the stateful checks in order.
+        // Orders sharing a nonzero linkID pass only if all legCount legs are in
+        // the same MaxBatchSize chunk, share the matching shard in their IDs
+        // and every one passes; otherwise all legs get the first leg failure
+        // and the passing legs' tokens are returned.
+        // check_order() ignores linkID. Cancels and amends are treated as in
+        // check_order().
+        void check_orders(std::span<const Order> orders, std::span<RiskResult> results) noexcept {
+            const size_t count = std::min(orders.size(), results.size());
+            for (size_t offset = 0; offset < count; offset += MaxBatchSize) {
+                const size_t batch = std::min(MaxBatchSize, count - offset);
+                check_batch(orders.subspan(offset, batch), results.subspan(offset, batch));
             }
-
-            return RiskResult::approved;
         }
 
-        void update_position(const Trade &trade) noexcept {
-            std::unique_lock lock(positions_mutex);
-            PositionTracker &position = positions[trade.symbol_id];
 
-            // Determine position change based on which side we were on
-            std::int64_t position_change = 0;
-            Value notional_change = 0;
+        void update_position(const Trade &trade) noexcept {
+            SymbolRiskState *state = find_state(trade.symbol_id);
+            if (UNLIKELY(state == nullptr)) {
+                return; // Symbol directory full
+            }
 
             // This is simplified - in reality, we'd need to track which orders we own
             // For now, assume we're always the aggressor
-            if (trade.aggressor_side == Side::Buy) {
-                position_change = static_cast<std::int64_t>(trade.quantity);
-                notional_change = calculate_notional(trade.price, trade.quantity);
-            } else {
-                position_change = -static_cast<std::int64_t>(trade.quantity);
-                notional_change = calculate_notional(trade.price, trade.quantity);
-            }
+            const std::int64_t position_change = trade.aggressor_side == Side::Buy
+                                                     ? static_cast<std::int64_t>(trade.quantity)
+                                                     : -static_cast<std::int64_t>(trade.quantity);
+            const Value notional_change = calculate_notional(trade.price, trade.quantity);
 
-            // Update position
-            const std::int64_t old_position = position.current_position.fetch_add(
-                position_change, std::memory_order_relaxed);
+            state->position_lock.write_begin();
+            const std::int64_t old_position = state->position.load(std::memory_order_relaxed);
 
-            // Update VWAP
-            update_vwap(position, trade.price, trade.quantity);
-
-            // Calculate and update PnL if position is being reduced
+            // Calculate and update PnL if position is being reduced (against the pre-trade VWAP)
             if ((old_position > 0 && position_change < 0) || (old_position < 0 && position_change > 0)) {
-                const std::int64_t pnl_change = calculate_pnl_change(position, trade.price, std::abs(position_change));
-                position.realized_pnl.fetch_add(pnl_change, std::memory_order_relaxed);
+                bump(state->realized_pnl,
+                     calculate_pnl_change(*state, old_position, trade.price, std::abs(position_change)));
             }
 
+            state->position.store(old_position + position_change, std::memory_order_relaxed);
+
+            // Update VWAP
+            update_vwap(*state, trade.price, trade.quantity);
+
             // Update notional (only for position increases)
             if ((old_position >= 0 && position_change > 0) || (old_position <= 0 && position_change < 0)) {
-                position.current_notional.fetch_add(notional_change, std::memory_order_relaxed);
+                bump(state->notional, notional_change);
             } else {
                 // Position reduction - reduce notional proportionally
-                if (const Value current_notional = position.current_notional.load(std::memory_order_relaxed);
+                if (const Value current_notional = state->notional.load(std::memory_order_relaxed);
                     current_notional > 0) {
                     const Value notional_reduction =
                             notional_change * current_notional / (std::abs(old_position) * trade.price / PriceScale);
-                    position.current_notional.fetch_sub(
-                        std::min(notional_reduction, current_notional), std::memory_order_relaxed);
+                    state->notional.store(current_notional - std::min(notional_reduction, current_notional),
+                                          std::memory_order_relaxed);
                 }
             }
+            state->last_trade_id.store(trade.trade_id, std::memory_order_relaxed);
+            state->position_lock.write_end();
         }
 
-        void update_reference_price(SymbolID symbol_id, Price price) {
-            reference_prices[symbol_id].store(price, std::memory_order_relaxed);
+        void update_reference_price(SymbolID symbol_id, Price price) noexcept {
+            if (SymbolRiskState *state = find_state(symbol_id)) {
+                state->reference_price.store(price, std::memory_order_relaxed);
+            }
         }
 
+        // A symbol's position side as of the trade last_trade_id, for journal
+        // snapshots. Layout is part of the snapshot format.
+        struct PositionCheckpoint {
+            SymbolID symbol_id;
+            std::uint32_t reserved;
+            std::int64_t position;
+            Value notional;
+            std::int64_t realized_pnl;
+            Price vwap;
+            Quantity total_volume;
+            Price reference_price;
+            TradeID last_trade_id;
+        };
+
+        // Any thread; a consistent copy even while trades are being applied
+        [[nodiscard]] PositionCheckpoint checkpoint_position(const SymbolID symbol_id) const noexcept {
+            const SymbolRiskState *found = symbols.find(symbol_id);
+            const SymbolRiskState &state = found != nullptr ? *found : flat_state;
+
+            return state.position_lock.read([&state, symbol_id] {
+                return PositionCheckpoint{
+                    .symbol_id = symbol_id,
+                    .reserved = 0,
+                    .position = state.position.load(std::memory_order_relaxed),
+                    .notional = state.notional.load(std::memory_order_relaxed),
+                    .realized_pnl = state.realized_pnl.load(std::memory_order_relaxed),
+                    .vwap = state.vwap.load(std::memory_order_relaxed),
+                    .total_volume = state.total_volume.load(std::memory_order_relaxed),
+                    .reference_price = state.reference_price.load(std::memory_order_relaxed),
+                    .last_trade_id = state.last_trade_id.load(std::memory_order_relaxed)
+                };
+            });
+        }
+
+        // Recovery, before any trade is applied
+        void restore_position(const PositionCheckpoint &checkpoint) {
+            SymbolRiskState *state = get_or_create_state(checkpoint.symbol_id);
+            if (state == nullptr) {
+                return;
+            }
+            state->position_lock.write_begin();
+            state->position.store(checkpoint.position, std::memory_order_relaxed);
+            state->notional.store(checkpoint.notional, std::memory_order_relaxed);
+            state->realized_pnl.store(checkpoint.realized_pnl, std::memory_order_relaxed);
+            state->vwap.store(checkpoint.vwap, std::memory_order_relaxed);
+            state->total_volume.store(checkpoint.total_volume, std::memory_order_relaxed);
+            state->reference_price.store(checkpoint.reference_price, std::memory_order_relaxed);
+            state->last_trade_id.store(checkpoint.last_trade_id, std::memory_order_relaxed);
+            state->position_lock.write_end();
+        }
+
+        // Publishes a new limits version; checks in flight finish on the old one
         void set_global_limits(const RiskLimits &limits) {
-            global_limits.copy_from(limits);
+            global_limits.store(retain(limits), std::memory_order_release);
         }
 
         void set_symbol_limits(SymbolID symbol_id, const RiskLimits &limits) {
-            symbol_limits[symbol_id].copy_from(limits);
+            if (SymbolRiskState *state = get_or_create_state(symbol_id)) {
+                state->limits.store(retain(limits), std::memory_order_release);
+            }
+        }
+
+        [[nodiscard]] RiskLimits get_global_limits() const noexcept {
+            return *global_limits.load(std::memory_order_acquire);
         }
 
         struct PositionInfo {
@@ -256,21 +345,17 @@ namespace trading_engine {
             std::uint32_t order_count;
         };
 
+        // Fields are read individually and may straddle an update
         PositionInfo get_position_info(SymbolID symbol_id) const {
-            std::shared_lock lock(positions_mutex);
+            const SymbolRiskState *found = symbols.find(symbol_id);
+            const SymbolRiskState &state = found != nullptr ? *found : flat_state;
 
-            const auto it = positions.find(symbol_id);
-            if (it == positions.end()) {
-                return PositionInfo{0, 0, 0, 0, 0};
-            }
-
-            const PositionTracker &pos = it->second;
             return PositionInfo{
-                .position = pos.current_position.load(std::memory_order_relaxed),
-                .notional = pos.current_notional.load(std::memory_order_relaxed),
-                .pnl = pos.realized_pnl.load(std::memory_order_relaxed),
-                .vwap = pos.vwap.load(std::memory_order_relaxed),
-                .order_count = pos.order_count_today.load(std::memory_order_relaxed)
+                .position = state.position.load(std::memory_order_relaxed),
+                .notional = state.notional.load(std::memory_order_relaxed),
+                .pnl = state.realized_pnl.load(std::memory_order_relaxed),
+                .vwap = state.vwap.load(std::memory_order_relaxed),
+                .order_count = state.order_count.load(std::memory_order_relaxed)
             };
         }
 
@@ -287,98 +372,330 @@ namespace trading_engine {
         }
 
     private:
-        static bool check_rate_limit(RateLimiter &limiter) noexcept {
-            // Refill tokens based on elapsed time
-            const std::uint64_t current_time = TimestampManager::get_hardware_timestamp();
-            const std::uint64_t last_time = limiter.last_refill_time.load(std::memory_order_relaxed);
-
-            if (current_time > last_time) {
-                const std::uint64_t elapsed_ns = TimestampManager::tsc_to_nanoseconds(current_time - last_time).count();
-                const auto tokens_to_add = static_cast<std::uint32_t>(elapsed_ns * limiter.refill_rate / 1000000000ULL);
-
-                if (tokens_to_add > 0) {
-                    const std::uint32_t current_tokens = limiter.tokens.load(std::memory_order_relaxed);
-                    const std::uint32_t new_tokens = std::min(current_tokens + tokens_to_add, limiter.bucket_size);
-                    limiter.tokens.store(new_tokens, std::memory_order_relaxed);
-                    limiter.last_refill_time.store(current_time, std::memory_order_relaxed);
+        FORCE_INLINE SymbolRiskState *find_state(const SymbolID symbol_id) {
+            if (SymbolRiskState *state = symbols.find(symbol_id); LIKELY(state != nullptr)) {
+                return state;
+            }
+            return get_or_create_state(symbol_id); // Not pre-registered: cold path
+        }
+
+        SymbolRiskState *get_or_create_state(const SymbolID symbol_id) {
+            return symbols.get_or_create(symbol_id);
+        }
+
+        const RiskLimits *retain(const RiskLimits &limits) {
+            std::lock_guard lock(limits_mutex);
+            retired_limits.push_back(std::make_unique<const RiskLimits>(limits));
+            return retired_limits.back().get();
+        }
+
+        void sync_global_bucket(const RiskLimits &global) noexcept {
+            if (UNLIKELY(global_bucket_limits != &global)) {
+                global_bucket.configure(global.max_orders_per_second);
+                global_bucket_limits = &global;
+            }
+        }
+
+        static void sync_symbol_bucket(SymbolRiskState &state, const RiskLimits *symbol_override) noexcept {
+            if (UNLIKELY(state.bucket_limits != symbol_override || state.bucket.rate == 0)) {
+                state.bucket.configure(symbol_override != nullptr
+                                           ? symbol_override->max_orders_per_second
+                                           : DefaultSymbolOrdersPerSecond);
+                state.bucket_limits = symbol_override;
+            }
+        }
+
+        // Position, notional and loss checks against filled exposure
+        static RiskResult check_exposure(const SymbolRiskState &state, const Order &order,
+                                         const RiskLimits &limits) noexcept {
+            // Calculate new position
+            const std::int64_t position_change = order.side == Side::Buy
+                                                     ? static_cast<std::int64_t>(order.quantity)
+                                                     : -static_cast<std::int64_t>(order.quantity);
+            const std::int64_t new_position = state.position.load(std::memory_order_relaxed) + position_change;
+
+            // Position limit check
+            if (static_cast<std::uint64_t>(std::abs(new_position)) > limits.max_position) {
+                return RiskResult::rejected_position_limit;
+            }
+
+            // For position increases, check if we exceed notional limits
+            if ((new_position > 0 && position_change > 0) || (new_position < 0 && position_change < 0)) {
+                if (const Value new_notional = state.notional.load(std::memory_order_relaxed) +
+                                               calculate_notional(order.price, order.quantity);
+                    new_notional > limits.max_notional) {
+                    return RiskResult::rejected_notional_limit;
                 }
             }
 
-            // Try to consume a token
-            std::uint32_t current_tokens = limiter.tokens.load(std::memory_order_relaxed);
-            while (current_tokens > 0) {
-                if (limiter.tokens.compare_exchange_weak(
-                    current_tokens, current_tokens - 1, std::memory_order_relaxed)) {
-                    return true;
+            // Loss limit check
+            if (state.realized_pnl.load(std::memory_order_relaxed) <
+                -static_cast<std::int64_t>(limits.max_loss_per_day)) {
+                return RiskResult::rejected_loss_limit;
+            }
+
+            return RiskResult::approved;
+        }
+
+        // Stateless per-order limits, laid out for the vector pass
+        struct alignas(64) BatchLanes {
+            std::array<std::uint64_t, MaxBatchSize> quantity{};
+            std::array<std::uint64_t, MaxBatchSize> max_size{};
+            std::array<std::uint64_t, MaxBatchSize> price{};
+            std::array<std::uint64_t, MaxBatchSize> reference{};
+            std::array<std::uint64_t, MaxBatchSize> max_deviation{};
+        };
+
+        void check_batch(std::span<const Order> orders, std::span<RiskResult> results) noexcept {
+            MEASURE_LATENCY(LatencyProfiler::Risk_check);
+
+            const size_t count = orders.size();
+            const RiskLimits &global = *global_limits.load(std::memory_order_acquire);
+            const std::uint64_t now = TimestampManager::get_hardware_timestamp();
+
+            sync_global_bucket(global);
+            global_bucket.refill(now);
+
+            std::array<SymbolRiskState *, MaxBatchSize> states;
+            std::array<const RiskLimits *, MaxBatchSize> limits;
+            BatchLanes lanes;
+
+            // Gather: resolve state and effective limits, refill each bucket for this batch
+            std::uint64_t cancels = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const Order &order = orders[i];
+                if (UNLIKELY(order.action == OrderAction::Cancel)) {
+                    cancels |= 1ULL << i;
+                    states[i] = nullptr;
+                    continue;
+                }
+
+                SymbolRiskState *state = find_state(order.symbolID);
+                states[i] = state;
+                if (UNLIKELY(state == nullptr)) {
+                    continue; // Lanes stay zero and pass; rejected below
                 }
+
+                const RiskLimits *symbol_override = state->limits.load(std::memory_order_acquire);
+                limits[i] = symbol_override != nullptr ? symbol_override : &global;
+
+                sync_symbol_bucket(*state, symbol_override);
+                state->bucket.refill(now);
+
+                lanes.quantity[i] = order.quantity;
+                lanes.max_size[i] = limits[i]->max_order_size;
+                lanes.price[i] = order.price;
+                lanes.reference[i] = state->reference_price.load(std::memory_order_relaxed);
+                lanes.max_deviation[i] = limits[i]->max_price_deviation;
             }
 
-            return false;
+            std::uint64_t oversized = 0;
+            std::uint64_t off_price = 0;
+            evaluate_static_limits(lanes, count, oversized, off_price);
+
+            // Stateful checks, in the same order check_order applies them
+            std::uint64_t approved = 0;
+            for (size_t i = 0; i < count; ++i) {
+                SymbolRiskState *state = states[i];
+                const std::uint64_t bit = 1ULL << i;
+
+                if (UNLIKELY(cancels & bit)) {
+                    results[i] = RiskResult::approved; // Not counted as an order
+                    continue;
+                }
+
+                if (UNLIKELY(state == nullptr) || !global_bucket.try_take()) {
+                    results[i] = RiskResult::rejected_rate_limit;
+                } else if (!state->bucket.try_take()) {
+                    results[i] = RiskResult::rejected_rate_limit;
+                } else if (oversized & bit) {
+                    results[i] = RiskResult::rejected_order_size;
+                } else if (off_price & bit) {
+                    results[i] = RiskResult::rejected_price_limit;
+                } else {
+                    results[i] = check_exposure(*state, orders[i], *limits[i]);
+                }
+
+                if (results[i] == RiskResult::approved) {
+                    approved |= bit;
+                }
+            }
+
+            resolve_links(orders, results, states, approved);
+
+            for (size_t i = 0; i < count; ++i) {
+                if ((approved & (1ULL << i)) && orders[i].action == OrderAction::New) {
+                    bump(states[i]->order_count, 1u);
+                }
+            }
         }
 
-        RateLimiter &get_or_create_symbol_limiter(SymbolID symbol_id) {
-            const auto it = symbol_rate_limiters.find(symbol_id);
-            if (it == symbol_rate_limiters.end()) {
-                const auto result = symbol_rate_limiters.emplace(
-                    std::piecewise_construct,
-                    std::forward_as_tuple(symbol_id),
-                    std::forward_as_tuple(100, 100)
-                ); // Per-symbol limits
-                return result.first->second;
-            }
-            return it->second;
+        // All-or-nothing for linked legs; rolls back approved legs of failed groups
+        void resolve_links(std::span<const Order> orders, std::span<RiskResult> results,
+                           const std::array<SymbolRiskState *, MaxBatchSize> &states,
+                           std::uint64_t &approved) noexcept {
+            const size_t count = orders.size();
+            std::uint64_t resolved = 0;
+
+            for (size_t i = 0; i < count; ++i) {
+                const LinkID link = orders[i].linkID;
+                if (link == 0 || (resolved & (1ULL << i))) {
+                    continue;
+                }
+
+                std::uint64_t group = 0;
+                bool one_shard = true;
+                for (size_t j = i; j < count; ++j) {
+                    if (orders[j].linkID == link) {
+                        group |= 1ULL << j;
+                        one_shard = one_shard && shard_of(orders[j].orderID) == shard_of(orders[i].orderID);
+                    }
+                }
+                resolved |= group;
+
+                RiskResult verdict = std::popcount(group) != orders[i].legCount
+                                         ? RiskResult::rejected_incomplete_link
+                                         : one_shard
+                                               ? RiskResult::approved
+                                               : RiskResult::rejected_split_link;
+                for (std::uint64_t legs = group; legs != 0 && verdict == RiskResult::approved; legs &= legs - 1) {
+                    verdict = results[std::countr_zero(legs)];
+                }
+
+                if (verdict == RiskResult::approved) {
+                    continue;
+                }
+
+                for (std::uint64_t legs = group; legs != 0; legs &= legs - 1) {
+                    const int leg = std::countr_zero(legs);
+                    if (approved & (1ULL << leg)) {
+                        global_bucket.give_back();
+                        states[leg]->bucket.give_back();
+                    }
+                    results[leg] = verdict;
+                }
+                approved &= ~group;
+            }
         }
 
-        bool check_price_deviation(const Order &order) const {
-            const auto it = reference_prices.find(order.symbolID);
-            if (it == reference_prices.end()) {
-                return true; // No reference price set, allow order
+        // Bit i set in oversized / off_price when order i fails that check.
+        // A zero reference price means no reference yet and always passes.
+        static void evaluate_static_limits(const BatchLanes &lanes, const size_t count,
+                                           std::uint64_t &oversized, std::uint64_t &off_price) noexcept {
+            size_t i = 0;
+
+#if defined(__AVX512F__)
+            for (; i + 8 <= count; i += 8) {
+                const __m512i quantity = _mm512_load_si512(lanes.quantity.data() + i);
+                const __m512i max_size = _mm512_load_si512(lanes.max_size.data() + i);
+                const __m512i price = _mm512_load_si512(lanes.price.data() + i);
+                const __m512i reference = _mm512_load_si512(lanes.reference.data() + i);
+                const __m512i max_deviation = _mm512_load_si512(lanes.max_deviation.data() + i);
+
+                const __mmask8 above = _mm512_cmpgt_epu64_mask(price, reference);
+                const __m512i deviation = _mm512_mask_sub_epi64(_mm512_sub_epi64(reference, price), above,
+                                                                price, reference);
+                const __mmask8 has_reference = _mm512_test_epi64_mask(reference, reference);
+
+                oversized |= static_cast<std::uint64_t>(_mm512_cmpgt_epu64_mask(quantity, max_size)) << i;
+                off_price |= static_cast<std::uint64_t>(
+                    _mm512_mask_cmpgt_epu64_mask(has_reference, deviation, max_deviation)) << i;
             }
+#elif defined(__AVX2__)
+            // AVX2 only has a signed 64-bit compare, so bias both operands
+            const __m256i bias = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ULL));
+            const __m256i zero = _mm256_setzero_si256();
+            for (; i + 4 <= count; i += 4) {
+                const auto load = [i](const std::array<std::uint64_t, MaxBatchSize> &lane) {
+                    return _mm256_load_si256(reinterpret_cast<const __m256i *>(lane.data() + i));
+                };
+                const __m256i price = load(lanes.price);
+                const __m256i reference = load(lanes.reference);
+
+                const __m256i too_big = _mm256_cmpgt_epi64(_mm256_xor_si256(load(lanes.quantity), bias),
+                                                           _mm256_xor_si256(load(lanes.max_size), bias));
+
+                const __m256i above = _mm256_cmpgt_epi64(_mm256_xor_si256(price, bias),
+                                                         _mm256_xor_si256(reference, bias));
+                const __m256i deviation = _mm256_blendv_epi8(_mm256_sub_epi64(reference, price),
+                                                             _mm256_sub_epi64(price, reference), above);
+                const __m256i too_far = _mm256_andnot_si256(
+                    _mm256_cmpeq_epi64(reference, zero),
+                    _mm256_cmpgt_epi64(_mm256_xor_si256(deviation, bias),
+                                       _mm256_xor_si256(load(lanes.max_deviation), bias)));
+
+                oversized |= static_cast<std::uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(too_big))) << i;
+                off_price |= static_cast<std::uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(too_far))) << i;
+            }
+#endif
+
+            for (; i < count; ++i) {
+                const Price price = lanes.price[i];
+                const Price reference = lanes.reference[i];
+                const Price deviation = price > reference ? price - reference : reference - price;
 
-            const Price ref_price = it->second.load(std::memory_order_relaxed);
+                if (lanes.quantity[i] > lanes.max_size[i]) {
+                    oversized |= 1ULL << i;
+                }
+                if (reference != 0 && deviation > lanes.max_deviation[i]) {
+                    off_price |= 1ULL << i;
+                }
+            }
+        }
+
+        // Timestamps are TSC ticks once calibrated, nanoseconds before that
+        static std::uint64_t clock_ticks_per_second() noexcept {
+            const std::uint64_t frequency = TimestampManager::get_frequency();
+            return TimestampManager::is_reliable() && frequency != 0 ? frequency : 1000000000ULL;
+        }
+
+        // Single writer, so a plain load and store is enough
+        template<typename T, typename Delta>
+        static void bump(std::atomic<T> &field, const Delta delta) noexcept {
+            field.store(field.load(std::memory_order_relaxed) + static_cast<T>(delta), std::memory_order_relaxed);
+        }
+
+        static bool check_price_deviation(const SymbolRiskState &state, const Price price,
+                                          const RiskLimits &limits) noexcept {
+            const Price ref_price = state.reference_price.load(std::memory_order_relaxed);
             if (ref_price == 0) {
                 return true; // No valid reference price
             }
 
-            const Price max_deviation = global_limits.max_price_deviation.load(std::memory_order_relaxed);
-            const Price price_diff = (order.price > ref_price) ? (order.price - ref_price) : (ref_price - order.price);
-
-            return price_diff <= max_deviation;
+            const Price price_diff = (price > ref_price) ? (price - ref_price) : (ref_price - price);
+            return price_diff <= limits.max_price_deviation;
         }
 
-        static void update_vwap(PositionTracker &position, Price price, Quantity quantity) {
-            const Quantity old_volume = position.total_volume.fetch_add(quantity, std::memory_order_relaxed);
-            const Price old_vwap = position.vwap.load(std::memory_order_relaxed);
+        static void update_vwap(SymbolRiskState &state, Price price, Quantity quantity) noexcept {
+            const Quantity old_volume = state.total_volume.load(std::memory_order_relaxed);
+            const Price old_vwap = state.vwap.load(std::memory_order_relaxed);
 
             // Calculate new VWAP: (old_vwap * old_volume + price * quantity) / (old_volume + quantity)
             const Value old_total_value = old_vwap * old_volume / PriceScale;
             const Value new_value = price * quantity / PriceScale;
             const auto new_vwap = (old_total_value + new_value) * PriceScale / (old_volume + quantity);
 
-            position.vwap.store(new_vwap, std::memory_order_relaxed);
+            state.total_volume.store(old_volume + quantity, std::memory_order_relaxed);
+            state.vwap.store(new_vwap, std::memory_order_relaxed);
         }
 
-        static std::int64_t calculate_pnl_change(const PositionTracker &position, Price exit_price, Quantity quantity) {
-            Price entry_vwap = position.vwap.load(std::memory_order_relaxed);
+        static std::int64_t calculate_pnl_change(const SymbolRiskState &state, const std::int64_t current_pos,
+                                                 Price exit_price, Quantity quantity) noexcept {
+            const Price entry_vwap = state.vwap.load(std::memory_order_relaxed);
             if (entry_vwap == 0) {
                 return 0;
             }
 
             // PnL = (exit_price - entry_price) * quantity for long positions
             // For short positions, it's (entry_price - exit_price) * quantity
-            const std::int64_t current_pos = position.current_position.load(std::memory_order_relaxed);
-
             if (current_pos > 0) {
                 // Long position being reduced
-                return static_cast<std::int64_t>((exit_price - entry_vwap) * quantity / PriceScale);
+                return (static_cast<std::int64_t>(exit_price) - static_cast<std::int64_t>(entry_vwap)) *
+                       static_cast<std::int64_t>(quantity) / static_cast<std::int64_t>(PriceScale);
             }
             // Short position being reduced
-            return static_cast<std::int64_t>((entry_vwap - exit_price) * quantity / PriceScale);
+            return (static_cast<std::int64_t>(entry_vwap) - static_cast<std::int64_t>(exit_price)) *
+                   static_cast<std::int64_t>(quantity) / static_cast<std::int64_t>(PriceScale);
         }
     };
-
-    inline RiskManager::RateLimiter::RateLimiter(std::uint32_t rate, std::uint32_t size) : refill_rate(rate),
-        bucket_size(size) {
-        last_refill_time.store(TimestampManager::get_hardware_timestamp());
-    }
 }
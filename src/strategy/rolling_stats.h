@@ -0,0 +1,269 @@
+#pragma once
+
+#include "../core/types.h"
+#include "../core/memory.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace trading_engine {
+    namespace rolling_detail {
+#if defined(__SIZEOF_INT128__)
+        using WideSum = __int128; // Sums of squared price offsets, exact
+#else
+        using WideSum = double; // Exact while the squared offsets stay below 2^53
+#endif
+
+        // Running sums of a window's price offsets from an anchor, in price
+        // ticks. Integer sums do not drift: samples leave the window exactly
+        // as they entered it, so a window that goes flat reads a variance of
+        // exactly 0 however far the price travelled before.
+        struct WindowSums {
+            Price anchor{0};
+            int64_t offset_sum{0};
+            WideSum offset_squares{0};
+            uint32_t count{0};
+
+            FORCE_INLINE void add(const Price price) noexcept {
+                if (UNLIKELY(count == 0)) {
+                    anchor = price;
+                }
+                const auto offset = static_cast<int64_t>(price - anchor);
+                offset_sum += offset;
+                offset_squares += static_cast<WideSum>(offset) * offset;
+                ++count;
+            }
+
+            FORCE_INLINE void remove(const Price price) noexcept {
+                const auto offset = static_cast<int64_t>(price - anchor);
+                offset_sum -= offset;
+                offset_squares -= static_cast<WideSum>(offset) * offset;
+                --count;
+            }
+
+            // Moves the anchor to the window's mean tick, keeping offsets
+            // small as the price travels; O(1), the samples are not touched
+            FORCE_INLINE int64_t reanchor() noexcept {
+                const auto n = static_cast<int64_t>(count);
+                const int64_t shift = n > 0 ? offset_sum / n : 0;
+                offset_squares += static_cast<WideSum>(shift) * (n * shift - 2 * offset_sum);
+                offset_sum -= n * shift;
+                anchor += static_cast<Price>(shift);
+                return shift;
+            }
+
+            [[nodiscard]] FORCE_INLINE double mean() const noexcept {
+                return count > 0
+                           ? from_scaled_price(anchor) +
+                             static_cast<double>(offset_sum) / static_cast<double>(count) / PriceScale
+                           : 0.0;
+            }
+
+            // Population variance in price units squared
+            [[nodiscard]] FORCE_INLINE double variance() const noexcept {
+                if (count < 2) {
+                    return 0.0;
+                }
+                const auto n = static_cast<WideSum>(count);
+                const WideSum spread = n * offset_squares - static_cast<WideSum>(offset_sum) * offset_sum;
+                const double scale = static_cast<double>(count) * PriceScale;
+                return std::max(static_cast<double>(spread) / (scale * scale), 0.0);
+            }
+        };
+    }
+
+    // Mean, variance and VWAP over the last `window` samples plus an EMA,
+    // each updated in O(1) per sample
+    template<size_t Capacity = 128>
+    class RollingStats {
+        static_assert(Capacity >= 2, "A window needs at least two samples");
+
+        std::array<Price, Capacity> prices{};
+        std::array<Quantity, Capacity> quantities{};
+        size_t window;
+        size_t next{0};
+
+        rolling_detail::WindowSums sums;
+        rolling_detail::WideSum notional_offset{0}; // Sum of offset * quantity, for the VWAP
+        Quantity volume{0};
+
+        double ema_alpha;
+        double ema_value{0.0};
+
+    public:
+        // alpha 0 takes the usual 2 / (window + 1)
+        explicit RollingStats(const size_t window_size = Capacity, const double alpha = 0.0) noexcept
+            : window(std::clamp<size_t>(window_size, 2, Capacity)),
+              ema_alpha(alpha > 0.0 ? alpha : 2.0 / (static_cast<double>(window) + 1.0)) {
+        }
+
+        // Starts over with an empty window
+        void set_window(const size_t window_size, const double alpha = 0.0) noexcept {
+            *this = RollingStats(window_size, alpha);
+        }
+
+        void push(const Price price, const Quantity quantity = 0) noexcept {
+            if (UNLIKELY(sums.count == 0)) {
+                ema_value = from_scaled_price(price);
+            }
+
+            if (sums.count == window) {
+                // Full: the oldest sample leaves as this one arrives
+                notional_offset -= offset_of(prices[next]) * quantities[next];
+                volume -= quantities[next];
+                sums.remove(prices[next]);
+            }
+            sums.add(price);
+            notional_offset += offset_of(price) * quantity;
+            volume += quantity;
+            prices[next] = price;
+            quantities[next] = quantity;
+            ema_value += ema_alpha * (from_scaled_price(price) - ema_value);
+
+            if (++next == window) {
+                next = 0;
+                const int64_t shift = sums.reanchor();
+                notional_offset -= static_cast<rolling_detail::WideSum>(shift) * volume;
+            }
+        }
+
+        [[nodiscard]] size_t size() const noexcept { return sums.count; }
+        [[nodiscard]] size_t window_size() const noexcept { return window; }
+        [[nodiscard]] bool full() const noexcept { return sums.count == window; }
+
+        [[nodiscard]] double mean() const noexcept { return sums.mean(); }
+
+        // Population variance of the window, as a z-score wants it
+        [[nodiscard]] double variance() const noexcept { return sums.variance(); }
+
+        [[nodiscard]] double std_dev() const noexcept { return std::sqrt(sums.variance()); }
+
+        // 0 while the window has no spread
+        [[nodiscard]] double z_score(const Price price) const noexcept {
+            const double deviation = std_dev();
+            return deviation > 0.0 ? (from_scaled_price(price) - mean()) / deviation : 0.0;
+        }
+
+        [[nodiscard]] double ema() const noexcept { return ema_value; }
+
+        // Volume-weighted over the window; the mean while no quantity was pushed
+        [[nodiscard]] double vwap() const noexcept {
+            return volume > 0
+                       ? from_scaled_price(sums.anchor) +
+                         static_cast<double>(notional_offset) / static_cast<double>(volume) / PriceScale
+                       : mean();
+        }
+
+    private:
+        [[nodiscard]] rolling_detail::WideSum offset_of(const Price price) const noexcept {
+            return static_cast<rolling_detail::WideSum>(static_cast<int64_t>(price - sums.anchor));
+        }
+    };
+
+    // RollingStats' mean and deviation for Lanes symbols, so one strategy can
+    // follow a whole basket
+    //
+    // Samples arrive one lane at a time with push(), which keeps the lane's
+    // exact sums and refreshes its mean and inverse deviation in
+    // structure-of-arrays form. z_scores() then scores every lane's latest
+    // sample in one vectorised pass of a subtract and a multiply per lane.
+    template<size_t Lanes, size_t Capacity = 128>
+    class RollingStatsBank {
+        static_assert(Lanes > 0 && Capacity >= 2, "A bank needs a lane and a two-sample window");
+
+        template<typename T>
+        using LaneArray = std::array<T, Lanes>;
+
+        // What z_scores() reads, one array per field
+        alignas(CacheLineSize) LaneArray<double> latest{};
+        alignas(CacheLineSize) LaneArray<double> means{};
+        alignas(CacheLineSize) LaneArray<double> inverse_deviations{}; // 0 without a spread
+        alignas(CacheLineSize) LaneArray<double> counts{};
+
+        // What push() keeps
+        LaneArray<rolling_detail::WindowSums> sums{};
+        LaneArray<uint32_t> next{};
+        std::vector<Price> history; // Lane-major, Capacity samples per lane
+        size_t window;
+
+    public:
+        explicit RollingStatsBank(const size_t window_size = Capacity)
+            : history(Lanes * Capacity, 0), window(std::clamp<size_t>(window_size, 2, Capacity)) {
+        }
+
+        [[nodiscard]] static constexpr size_t lane_count() noexcept { return Lanes; }
+        [[nodiscard]] size_t window_size() const noexcept { return window; }
+        [[nodiscard]] size_t size(const size_t lane) const noexcept { return sums[lane].count; }
+        [[nodiscard]] double mean(const size_t lane) const noexcept { return means[lane]; }
+
+        [[nodiscard]] double std_dev(const size_t lane) const noexcept {
+            return inverse_deviations[lane] > 0.0 ? 1.0 / inverse_deviations[lane] : 0.0;
+        }
+
+        void push(const size_t lane, const Price price) noexcept {
+            rolling_detail::WindowSums &lane_sums = sums[lane];
+            Price *samples = history.data() + lane * Capacity;
+            uint32_t &slot = next[lane];
+
+            if (lane_sums.count == window) {
+                lane_sums.remove(samples[slot]);
+            }
+            lane_sums.add(price);
+            samples[slot] = price;
+            if (++slot == window) {
+                slot = 0;
+                (void) lane_sums.reanchor();
+            }
+
+            const double variance = lane_sums.variance();
+            latest[lane] = from_scaled_price(price);
+            means[lane] = lane_sums.mean();
+            inverse_deviations[lane] = variance > 0.0 ? 1.0 / std::sqrt(variance) : 0.0;
+            counts[lane] = static_cast<double>(lane_sums.count);
+        }
+
+        // scores[i]: lane i's latest sample in standard deviations from its
+        // window mean; 0 for a lane with fewer than min_samples samples or no
+        // spread. scores holds at least Lanes entries.
+        void z_scores(const std::span<double> scores, const size_t min_samples = 2) const noexcept {
+            const auto required = static_cast<double>(std::max<size_t>(min_samples, 2));
+            double *out = scores.data();
+
+#if defined(__AVX512F__)
+            constexpr size_t VectorEnd = Lanes - Lanes % 8;
+            const __m512d minimum = _mm512_set1_pd(required);
+            for (size_t i = 0; i < VectorEnd; i += 8) {
+                const __m512d distance = _mm512_sub_pd(_mm512_load_pd(latest.data() + i),
+                                                       _mm512_load_pd(means.data() + i));
+                const __m512d score = _mm512_mul_pd(distance, _mm512_load_pd(inverse_deviations.data() + i));
+                const __mmask8 scored = _mm512_cmp_pd_mask(_mm512_load_pd(counts.data() + i), minimum, _CMP_GE_OQ);
+                _mm512_storeu_pd(out + i, _mm512_maskz_mov_pd(scored, score));
+            }
+#elif defined(__AVX2__)
+            constexpr size_t VectorEnd = Lanes - Lanes % 4;
+            const __m256d minimum = _mm256_set1_pd(required);
+            for (size_t i = 0; i < VectorEnd; i += 4) {
+                const __m256d distance = _mm256_sub_pd(_mm256_load_pd(latest.data() + i),
+                                                       _mm256_load_pd(means.data() + i));
+                const __m256d score = _mm256_mul_pd(distance, _mm256_load_pd(inverse_deviations.data() + i));
+                const __m256d scored = _mm256_cmp_pd(_mm256_load_pd(counts.data() + i), minimum, _CMP_GE_OQ);
+                _mm256_storeu_pd(out + i, _mm256_and_pd(score, scored));
+            }
+#else
+            constexpr size_t VectorEnd = 0;
+#endif
+
+            for (size_t i = VectorEnd; i < Lanes; ++i) {
+                out[i] = counts[i] >= required ? (latest[i] - means[i]) * inverse_deviations[i] : 0.0;
+            }
+        }
+    };
+}
@@ -3,13 +3,22 @@
 #include "../core/types.h"
 #include "../core/memory.h"
 #include "../core/queue.h"
+#include "../core/symbol_directory.h"
 #include "../core/timing.h"
+#include "../core/tracing.h"
 #include "../market_data/order_book.h"
 
+#include "rolling_stats.h"
 #include "strategy_interface.h"
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <functional>
 #include <cmath>
+#include <array>
+#include <initializer_list>
+#include <span>
+#include <vector>
 
 namespace trading_engine {
     enum class StrategySignal {
@@ -20,14 +29,53 @@ namespace trading_engine {
         ReducePosition
     };
 
-    // Base strategy interface
-    template<typename StrategyImpl>
+    // One leg of a linked submission
+    struct OrderLeg {
+        SymbolID symbol;
+        Side side;
+        Price price;
+        Quantity quantity;
+        OrderType type{OrderType::Limit};
+    };
+
+    // Order IDs for every strategy type, so no two strategies' orders share one
+    inline std::atomic<OrderID> strategy_order_ids{1};
+
+    // Base strategy interface. TickQueueSize bounds the ticks that can wait
+    // between bursts; strategies following many symbols want more.
+    template<typename StrategyImpl, size_t TickQueueSize = 1024>
     class StrategyBase : public IStrategy {
     protected:
-        SymbolID symbol_id;
-        SPSCQueue<MarketTick, 1024> tick_queue;
+        static constexpr size_t MaxStrategySymbols = 16; // Conflation slots per strategy
+
+        SymbolID symbol_id; // Primary symbol, symbols[0]
+        std::vector<SymbolID> symbols;
+
+        // A strategy's symbols can sit on different gateway shards, so every
+        // shard thread may push ticks and snapshots; trades come from the
+        // notification thread alone
+        MPMCQueue<MarketTick, TickQueueSize> tick_queue;
         SPSCQueue<Trade, 256> trade_queue;
-        SPSCQueue<OrderBook<>::BookSnapshot, 128> snapshot_queue;
+        MPMCQueue<OrderBook<>::BookSnapshot, 128> snapshot_queue;
+
+        // Used instead of the queues when conflation is on
+        ConflationMode conflation_mode{ConflationMode::None};
+        ConflatingMailbox<MarketTick, MaxStrategySymbols * 2> tick_mailbox;
+        ConflatingMailbox<OrderBook<>::BookSnapshot, MaxStrategySymbols> snapshot_mailbox;
+
+        std::uint32_t active_trace_id{0}; // Trace of the tick being processed; copied onto its orders
+
+        struct FeedCounters {
+            std::atomic<uint64_t> ticks_received{0};
+            std::atomic<uint64_t> ticks_dropped{0};
+            std::atomic<uint64_t> ticks_conflated{0};
+            std::atomic<uint64_t> snapshots_received{0};
+            std::atomic<uint64_t> snapshots_dropped{0};
+            std::atomic<uint64_t> snapshots_conflated{0};
+            std::atomic<uint64_t> trades_dropped{0};
+        };
+
+        FeedCounters feed_counters;
 
         // Strategy state
         struct StrategyState {
@@ -40,16 +88,22 @@ namespace trading_engine {
 
         StrategyState state;
 
-        // Callbacks for order submission
-        std::function<void(const Order &)> order_callback;
+        // Callbacks for order submission. The order callback returns the ID
+        // the engine routes the order by, 0 if it was not queued.
+        std::function<OrderID(const Order &)> order_callback;
         std::function<void(OrderID)> cancel_callback;
 
     public:
         explicit StrategyBase(SymbolID symbol);
 
+        // Multi-symbol strategies; the first symbol is the primary one
+        explicit StrategyBase(std::initializer_list<SymbolID> symbol_list);
+
+        explicit StrategyBase(std::span<const SymbolID> symbol_list);
+
         ~StrategyBase() override = default;
 
-        void set_order_callback(std::function<void(const Order &)> callback) {
+        void set_order_callback(std::function<OrderID(const Order &)> callback) {
             order_callback = std::move(callback);
         }
 
@@ -57,35 +111,89 @@ namespace trading_engine {
             cancel_callback = std::move(callback);
         }
 
+        // Set before market data starts flowing
+        void set_conflation_mode(const ConflationMode mode) noexcept {
+            conflation_mode = mode;
+        }
+
+        [[nodiscard]] ConflationMode get_conflation_mode() const noexcept { return conflation_mode; }
+
         void on_market_data(const MarketTick &tick) override {
             if (!state.enabled.load(std::memory_order_acquire)) {
                 return;
             }
 
+            feed_counters.ticks_received.fetch_add(1, std::memory_order_relaxed);
+
+            if (conflates(conflation_mode, ConflationMode::Ticks)) {
+                if (const size_t slot = symbol_slot(tick.symbol_id); LIKELY(slot < MaxStrategySymbols)) {
+                    const size_t key = slot * 2 + (tick.side == Side::Buy ? 0 : 1);
+                    if (tick_mailbox.publish(key, tick)) {
+                        feed_counters.ticks_conflated.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    return;
+                }
+            }
+
             if (!tick_queue.try_push(tick)) {
+                feed_counters.ticks_dropped.fetch_add(1, std::memory_order_relaxed);
                 handle_data_overflow();
             }
         }
 
         void on_trade(const Trade &trade) override {
             if (!trade_queue.try_push(trade)) {
+                feed_counters.trades_dropped.fetch_add(1, std::memory_order_relaxed);
                 handle_trade_overflow();
             }
         }
 
-        void on_book_snapshot(const OrderBook<>::BookSnapshot &snapshot) override {
+        void on_book_snapshot(const SymbolID snapshot_symbol, const OrderBook<>::BookSnapshot &snapshot) override {
+            feed_counters.snapshots_received.fetch_add(1, std::memory_order_relaxed);
+
+            if (conflates(conflation_mode, ConflationMode::Snapshots)) {
+                if (const size_t slot = symbol_slot(snapshot_symbol); LIKELY(slot < MaxStrategySymbols)) {
+                    if (snapshot_mailbox.publish(slot, snapshot)) {
+                        feed_counters.snapshots_conflated.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    return;
+                }
+            }
+
             if (!snapshot_queue.try_push(snapshot)) {
                 // Snapshots are less critical, just drop
+                feed_counters.snapshots_dropped.fetch_add(1, std::memory_order_relaxed);
             }
         }
 
+        [[nodiscard]] StrategyFeedStats get_feed_stats() const override {
+            return StrategyFeedStats{
+                .ticks_received = feed_counters.ticks_received.load(std::memory_order_relaxed),
+                .ticks_dropped = feed_counters.ticks_dropped.load(std::memory_order_relaxed),
+                .ticks_conflated = feed_counters.ticks_conflated.load(std::memory_order_relaxed),
+                .snapshots_received = feed_counters.snapshots_received.load(std::memory_order_relaxed),
+                .snapshots_dropped = feed_counters.snapshots_dropped.load(std::memory_order_relaxed),
+                .snapshots_conflated = feed_counters.snapshots_conflated.load(std::memory_order_relaxed),
+                .trades_dropped = feed_counters.trades_dropped.load(std::memory_order_relaxed)
+            };
+        }
+
         void process_signals() override {
             MEASURE_LATENCY(LatencyProfiler::Strategy_signal);
 
             // Process market data updates
             MarketTick tick{};
             while (tick_queue.try_pop(tick)) {
-                static_cast<StrategyImpl *>(this)->process_tick(tick);
+                dispatch_tick(tick);
+            }
+
+            tick_mailbox.drain([this](size_t, const MarketTick &latest) {
+                dispatch_tick(latest);
+            });
+
+            // Strategies that score a whole basket do it once per burst, not per tick
+            if constexpr (requires(StrategyImpl &impl) { impl.process_tick_burst(); }) {
+                static_cast<StrategyImpl *>(this)->process_tick_burst();
             }
 
             // Process trade updates
@@ -100,6 +208,10 @@ namespace trading_engine {
             while (snapshot_queue.try_pop(snapshot)) {
                 static_cast<StrategyImpl *>(this)->process_snapshot(snapshot);
             }
+
+            snapshot_mailbox.drain([this](size_t, const OrderBook<>::BookSnapshot &latest) {
+                static_cast<StrategyImpl *>(this)->process_snapshot(latest);
+            });
         }
 
         void enable() { state.enabled.store(true, std::memory_order_release); }
@@ -107,14 +219,35 @@ namespace trading_engine {
         [[nodiscard]] bool is_enabled() const override { return state.enabled.load(std::memory_order_acquire); }
 
         [[nodiscard]] SymbolID get_symbol_id() const override { return symbol_id; }
+
+        [[nodiscard]] std::span<const SymbolID> get_subscribed_symbols() const override { return symbols; }
         [[nodiscard]] std::int64_t get_position() const { return state.position; }
         [[nodiscard]] std::uint64_t get_signal_count() const { return state.signal_count; }
 
     protected:
-        void submit_order(Side side, Price price, Quantity quantity, OrderType type = OrderType::Limit);
+        // Return the engine's ID for the order, the one cancel_order() takes;
+        // 0 if it was not submitted
+        OrderID submit_order(Side side, Price price, Quantity quantity, OrderType type = OrderType::Limit);
+
+        OrderID submit_order(SymbolID symbol, Side side, Price price, Quantity quantity,
+                             OrderType type = OrderType::Limit);
+
+        // Submits legs that risk approves or rejects together
+        void submit_linked_orders(std::span<const OrderLeg> legs);
 
         void cancel_order(OrderID order_id) const;
 
+        // Mailbox slot for a traded symbol, or MaxStrategySymbols if it has none
+        [[nodiscard]] size_t symbol_slot(const SymbolID symbol) const noexcept {
+            const size_t count = std::min(symbols.size(), MaxStrategySymbols);
+            for (size_t i = 0; i < count; ++i) {
+                if (symbols[i] == symbol) {
+                    return i;
+                }
+            }
+            return MaxStrategySymbols;
+        }
+
         virtual void handle_data_overflow() {
             // Default implementation - log error
         }
@@ -124,46 +257,107 @@ namespace trading_engine {
         }
 
     private:
+        void dispatch_tick(const MarketTick &tick) {
+            TickTracer::stamp(tick.trace_id, TickTracer::Stage::StrategySignal);
+            active_trace_id = tick.trace_id;
+            static_cast<StrategyImpl *>(this)->process_tick(tick);
+            active_trace_id = 0;
+        }
+
         static OrderID generate_order_id() {
-            static std::atomic<OrderID> counter{1};
-            return counter.fetch_add(1, std::memory_order_relaxed);
+            return strategy_order_ids.fetch_add(1, std::memory_order_relaxed);
         }
     };
 
-    template<typename StrategyImpl>
-    StrategyBase<StrategyImpl>::StrategyBase(const SymbolID symbol)
-        : symbol_id(symbol), tick_queue(), trade_queue(), snapshot_queue() {
+    template<typename StrategyImpl, size_t TickQueueSize>
+    StrategyBase<StrategyImpl, TickQueueSize>::StrategyBase(const SymbolID symbol)
+        : symbol_id(symbol), symbols{symbol}, tick_queue(), trade_queue(), snapshot_queue() {
     }
 
-    template<typename StrategyImpl>
-    void StrategyBase<StrategyImpl>::submit_order(
+    template<typename StrategyImpl, size_t TickQueueSize>
+    StrategyBase<StrategyImpl, TickQueueSize>::StrategyBase(const std::initializer_list<SymbolID> symbol_list)
+        : symbol_id(symbol_list.size() > 0 ? *symbol_list.begin() : 0), symbols(symbol_list),
+          tick_queue(), trade_queue(), snapshot_queue() {
+    }
+
+    template<typename StrategyImpl, size_t TickQueueSize>
+    StrategyBase<StrategyImpl, TickQueueSize>::StrategyBase(const std::span<const SymbolID> symbol_list)
+        : symbol_id(symbol_list.empty() ? 0 : symbol_list.front()), symbols(symbol_list.begin(), symbol_list.end()),
+          tick_queue(), trade_queue(), snapshot_queue() {
+    }
+
+    template<typename StrategyImpl, size_t TickQueueSize>
+    OrderID StrategyBase<StrategyImpl, TickQueueSize>::submit_order(
         const Side side, const Price price, const Quantity quantity,
         const OrderType type
+    ) {
+        return submit_order(symbol_id, side, price, quantity, type);
+    }
+
+    template<typename StrategyImpl, size_t TickQueueSize>
+    OrderID StrategyBase<StrategyImpl, TickQueueSize>::submit_order(
+        const SymbolID symbol, const Side side, const Price price, const Quantity quantity,
+        const OrderType type
     ) {
         if (!order_callback) {
-            return;
+            return 0;
         }
 
         Order order{
             .orderID = generate_order_id(),
-            .symbolID = symbol_id,
+            .symbolID = symbol,
             .side = side,
             .orderType = type,
-            .TimeInForce = TimeInForce::Ioc,
+            .timeInForce = TimeInForce::Ioc,
+            .status = OrderStatus::Incoming,
             .price = price,
             .quantity = quantity,
             .filledQuantity = 0,
-            .status = OrderStatus::Incoming,
+            .traceID = active_trace_id,
             .timestamp = TimestampManager::get_hardware_timestamp()
         };
 
-        order_callback(order);
+        TickTracer::stamp(order.traceID, TickTracer::Stage::OrderSubmitted);
+        const OrderID routed_id = order_callback(order);
         ++state.signal_count;
         state.last_signal_time = order.timestamp;
+        return routed_id;
+    }
+
+    template<typename StrategyImpl, size_t TickQueueSize>
+    void StrategyBase<StrategyImpl, TickQueueSize>::submit_linked_orders(const std::span<const OrderLeg> legs) {
+        if (!order_callback || legs.empty()) {
+            return;
+        }
+
+        const auto link_id = static_cast<LinkID>(generate_order_id());
+        const Timestamp now = TimestampManager::get_hardware_timestamp();
+        TickTracer::stamp(active_trace_id, TickTracer::Stage::OrderSubmitted);
+
+        for (const OrderLeg &leg: legs) {
+            order_callback(Order{
+                .orderID = generate_order_id(),
+                .symbolID = leg.symbol,
+                .side = leg.side,
+                .orderType = leg.type,
+                .timeInForce = TimeInForce::Ioc,
+                .legCount = static_cast<std::uint8_t>(legs.size()),
+                .status = OrderStatus::Incoming,
+                .price = leg.price,
+                .quantity = leg.quantity,
+                .filledQuantity = 0,
+                .traceID = active_trace_id,
+                .linkID = link_id,
+                .timestamp = now
+            });
+        }
+
+        ++state.signal_count;
+        state.last_signal_time = now;
     }
 
-    template<typename StrategyImpl>
-    void StrategyBase<StrategyImpl>::cancel_order(const OrderID order_id) const {
+    template<typename StrategyImpl, size_t TickQueueSize>
+    void StrategyBase<StrategyImpl, TickQueueSize>::cancel_order(const OrderID order_id) const {
         if (cancel_callback) {
             cancel_callback(order_id);
         }
@@ -181,38 +375,33 @@ namespace trading_engine {
         };
 
         Parameters params;
-        CircularBuffer<Price, 128> price_history;
-        std::atomic<double> current_mean{0.0};
-        std::atomic<double> current_std{0.0};
+        RollingStats<128> price_stats; // Over the last lookback_period ticks
 
     public:
-        explicit MeanReversionStrategy(SymbolID symbol) : StrategyBase(symbol), price_history() {
+        explicit MeanReversionStrategy(SymbolID symbol)
+            : StrategyBase(symbol), price_stats(static_cast<size_t>(params.lookback_period)) {
         }
 
+        // A new lookback starts the window over
         void set_parameters(const Parameters &new_params) {
             params = new_params;
+            price_stats.set_window(static_cast<size_t>(params.lookback_period));
         }
 
         void process_tick(const MarketTick &tick) {
             state.last_price = tick.price;
-            price_history.push(tick.price);
-
-            if (price_history.size() >= static_cast<size_t>(params.lookback_period)) {
-                update_statistics();
+            price_stats.push(tick.price, tick.quantity);
 
-                const double mean = current_mean.load(std::memory_order_relaxed);
-                const double std_dev = current_std.load(std::memory_order_relaxed);
-
-                if (std_dev > 0) {
-                    const double z_score = (from_scaled_price(tick.price) - mean) / std_dev;
-
-                    if (const StrategySignal signal = generate_signal(z_score); signal != StrategySignal::None) {
-                        execute_signal(signal, tick.price);
-                    }
+            if (price_stats.full() && price_stats.std_dev() > 0) {
+                if (const StrategySignal signal = generate_signal(price_stats.z_score(tick.price));
+                    signal != StrategySignal::None) {
+                    execute_signal(signal, tick.price);
                 }
             }
         }
 
+        [[nodiscard]] const RollingStats<128> &get_price_stats() const noexcept { return price_stats; }
+
         void process_trade(const Trade &trade) {
             // Update our position if this trade affects us
             // In a real implementation, we'd track our order IDs
@@ -238,33 +427,6 @@ namespace trading_engine {
         }
 
     private:
-        void update_statistics() {
-            if (price_history.size() < 2) {
-                return;
-            }
-
-            // Calculate mean
-            double sum = 0.0;
-            const size_t count = price_history.size();
-
-            for (size_t i = 0; i < count; ++i) {
-                sum += from_scaled_price(price_history[i]);
-            }
-
-            const double mean = sum / count;
-            current_mean.store(mean, std::memory_order_relaxed);
-
-            // Calculate standard deviation
-            double variance_sum = 0.0;
-            for (size_t i = 0; i < count; ++i) {
-                const double diff = from_scaled_price(price_history[i]) - mean;
-                variance_sum += diff * diff;
-            }
-
-            const double std_dev = std::sqrt(variance_sum / count);
-            current_std.store(std_dev, std::memory_order_relaxed);
-        }
-
         [[nodiscard]] StrategySignal generate_signal(const double z_score) const {
             // Check minimum time between signals
             if (const Timestamp current_time = TimestampManager::get_hardware_timestamp();
@@ -355,6 +517,160 @@ namespace trading_engine {
         }
     };
 
+    // Mean reversion over a basket of symbols from one strategy instance
+    //
+    // Each symbol is a lane of a RollingStatsBank. Ticks only update their
+    // lane; once per burst every lane is scored in one vectorised pass and
+    // the lanes that ticked are checked for a signal, so hundreds of symbols
+    // share one object, one set of queues and one scheduler slot.
+    //
+    // The basket spans every gateway shard, whose threads all push into the
+    // one multi-producer tick ring. Only the first MaxStrategySymbols lanes
+    // can conflate, so the ring is sized for a burst from the whole basket.
+    class BasketMeanReversionStrategy final : public StrategyBase<BasketMeanReversionStrategy, 8192> {
+    public:
+        static constexpr size_t MaxBasketSymbols = 512;
+
+    private:
+        struct Parameters {
+            size_t lookback_period = 20;
+            double entry_threshold = 2.0; // Standard deviations
+            double exit_threshold = 0.5;
+            Quantity max_position = 1000; // Per symbol
+            uint64_t min_signal_interval_ns = 1000000; // Per symbol, 1ms
+        };
+
+        struct BasketLane {
+            uint32_t lane;
+        };
+
+        template<typename T>
+        using LaneArray = std::array<T, MaxBasketSymbols>;
+
+        // Orders are IOC and a lane signals at most once per interval, so
+        // fills name one of the lane's last few orders
+        static constexpr size_t TrackedOrders = 4;
+
+        Parameters params;
+        SymbolDirectory<BasketLane, MaxBasketSymbols> lanes;
+        RollingStatsBank<MaxBasketSymbols> price_stats;
+        alignas(CacheLineSize) LaneArray<double> scores{};
+        LaneArray<Price> last_prices{};
+        LaneArray<int64_t> positions{};
+        LaneArray<std::array<OrderID, TrackedOrders> > own_orders{}; // Routed IDs, newest at own_order_slot - 1
+        LaneArray<uint8_t> own_order_slot{};
+        LaneArray<Timestamp> last_signal_times{};
+        std::array<uint64_t, MaxBasketSymbols / 64> ticked{}; // Lanes with a tick since the last burst
+
+    public:
+        // Symbols past MaxBasketSymbols are not followed
+        explicit BasketMeanReversionStrategy(const std::span<const SymbolID> basket)
+            : StrategyBase(basket.first(std::min(basket.size(), MaxBasketSymbols))),
+              price_stats(params.lookback_period) {
+            for (uint32_t lane = 0; lane < symbols.size(); ++lane) {
+                (void) lanes.get_or_create(symbols[lane], [lane](BasketLane &entry) { entry.lane = lane; });
+            }
+        }
+
+        // A new lookback starts every window over
+        void set_parameters(const Parameters &new_params) {
+            params = new_params;
+            price_stats = RollingStatsBank<MaxBasketSymbols>(params.lookback_period);
+        }
+
+        void process_tick(const MarketTick &tick) {
+            const BasketLane *entry = lanes.find(tick.symbol_id);
+            if (entry == nullptr) {
+                return;
+            }
+            state.last_price = tick.price;
+            last_prices[entry->lane] = tick.price;
+            price_stats.push(entry->lane, tick.price);
+            ticked[entry->lane / 64] |= 1ULL << (entry->lane % 64);
+        }
+
+        void process_tick_burst() {
+            if (std::ranges::all_of(ticked, [](const uint64_t word) { return word == 0; })) {
+                return;
+            }
+
+            price_stats.z_scores(scores, price_stats.window_size());
+            const Timestamp now = TimestampManager::get_hardware_timestamp();
+            for (size_t word = 0; word < ticked.size(); ++word) {
+                for (uint64_t bits = ticked[word]; bits != 0; bits &= bits - 1) {
+                    const size_t lane = word * 64 + static_cast<size_t>(std::countr_zero(bits));
+                    if (scores[lane] != 0.0 && now - last_signal_times[lane] >= params.min_signal_interval_ns) {
+                        evaluate_lane(lane, scores[lane], now);
+                    }
+                }
+                ticked[word] = 0;
+            }
+        }
+
+        // Every trade on a basket symbol arrives here; only fills of this
+        // strategy's own orders move a lane off flat
+        void process_trade(const Trade &trade) {
+            const BasketLane *entry = lanes.find(trade.symbol_id);
+            if (entry == nullptr) {
+                return;
+            }
+
+            const std::array<OrderID, TrackedOrders> &orders = own_orders[entry->lane];
+            const auto quantity = static_cast<int64_t>(trade.quantity);
+            int64_t change = 0;
+            if (std::ranges::find(orders, trade.buy_order_id) != orders.end()) {
+                change += quantity;
+            }
+            if (std::ranges::find(orders, trade.sell_order_id) != orders.end()) {
+                change -= quantity;
+            }
+            positions[entry->lane] += change;
+            state.position += change; // Net over the basket
+        }
+
+        static void process_snapshot(const OrderBook<>::BookSnapshot & /*snapshot*/) {
+        }
+
+        [[nodiscard]] int64_t get_symbol_position(const SymbolID symbol) const noexcept {
+            const BasketLane *entry = lanes.find(symbol);
+            return entry != nullptr ? positions[entry->lane] : 0;
+        }
+
+        void shutdown() override {
+        }
+
+    private:
+        void evaluate_lane(const size_t lane, const double z_score, const Timestamp now) {
+            constexpr Quantity base_size = 100;
+            const int64_t position = positions[lane];
+
+            // Entries only from flat, so a lane never holds more than one entry's size
+            Side side;
+            Quantity size;
+            if (position == 0 && std::abs(z_score) > params.entry_threshold) {
+                // Below the mean, expect reversion up; above it, down
+                side = z_score < 0 ? Side::Buy : Side::Sell;
+                size = std::min(base_size, params.max_position);
+            } else if (position > 0 && z_score > -params.exit_threshold) {
+                side = Side::Sell;
+                size = std::min(base_size, static_cast<Quantity>(position));
+            } else if (position < 0 && z_score < params.exit_threshold) {
+                side = Side::Buy;
+                size = std::min(base_size, static_cast<Quantity>(-position));
+            } else {
+                return;
+            }
+
+            if (const OrderID order_id = submit_order(symbols[lane], side, last_prices[lane], size, OrderType::Limit);
+                order_id != 0) {
+                uint8_t &slot = own_order_slot[lane];
+                own_orders[lane][slot] = order_id;
+                slot = static_cast<uint8_t>((slot + 1) % TrackedOrders);
+            }
+            last_signal_times[lane] = now;
+        }
+    };
+
     // Arbitrage strategy for cross-exchange opportunities
     class ArbitrageStrategy final : public StrategyBase<ArbitrageStrategy> {
         struct ArbitrageParams {
@@ -365,6 +681,10 @@ namespace trading_engine {
 
         ArbitrageParams params;
 
+        // The same instrument listed on two venues
+        SymbolID symbol_a;
+        SymbolID symbol_b;
+
         // Track prices from different sources/exchanges
         std::atomic<Price> exchange_a_bid{0};
         std::atomic<Price> exchange_a_ask{0};
@@ -372,7 +692,8 @@ namespace trading_engine {
         std::atomic<Price> exchange_b_ask{0};
 
     public:
-        explicit ArbitrageStrategy(SymbolID symbol) : StrategyBase(symbol) {
+        ArbitrageStrategy(SymbolID venue_a_symbol, SymbolID venue_b_symbol)
+            : StrategyBase({venue_a_symbol, venue_b_symbol}), symbol_a(venue_a_symbol), symbol_b(venue_b_symbol) {
         }
 
         void set_exchange_a_prices(Price bid, Price ask) {
@@ -388,16 +709,26 @@ namespace trading_engine {
         }
 
         void process_tick(const MarketTick &tick) {
-            // Update prices based on the tick source
-            // This is simplified - real implementation would track exchange IDs
+            // Bid-side ticks move the venue's bid, ask-side ticks its ask
             state.last_price = tick.price;
+
+            const bool is_bid = tick.side == Side::Buy;
+            if (tick.symbol_id == symbol_a) {
+                (is_bid ? exchange_a_bid : exchange_a_ask).store(tick.price, std::memory_order_relaxed);
+            } else if (tick.symbol_id == symbol_b) {
+                (is_bid ? exchange_b_bid : exchange_b_ask).store(tick.price, std::memory_order_relaxed);
+            } else {
+                return;
+            }
+
+            check_arbitrage_opportunity();
         }
 
         void process_trade(const Trade &trade) {
             update_position_from_trade(trade);
         }
 
-        static void process_snapshot(OrderBook<1000>::BookSnapshot & /*snapshot*/) {
+        static void process_snapshot(const OrderBook<1000>::BookSnapshot & /*snapshot*/) {
             // Use snapshot data to update one of our exchange feeds
         }
 
@@ -422,7 +753,7 @@ namespace trading_engine {
                                      from_scaled_price(b_ask)) * 10000.0;
 
                 if (profit_bps >= params.min_profit_bps) {
-                    execute_arbitrage(Side::Buy, b_ask, Side::Sell, a_bid);
+                    execute_arbitrage(symbol_b, b_ask, symbol_a, a_bid);
                 }
             } else if (b_bid > a_ask) {
                 // Buy on A, sell on B
@@ -430,16 +761,16 @@ namespace trading_engine {
                                      from_scaled_price(a_ask)) * 10000.0;
 
                 if (profit_bps >= params.min_profit_bps) {
-                    execute_arbitrage(Side::Buy, a_ask, Side::Sell, b_bid);
+                    execute_arbitrage(symbol_a, a_ask, symbol_b, b_bid);
                 }
             }
         }
 
-        void execute_arbitrage(Side buy_side, Price buy_price, Side sell_side, Price sell_price);
+        void execute_arbitrage(SymbolID buy_symbol, Price buy_price, SymbolID sell_symbol, Price sell_price);
 
         void update_position_from_trade(const Trade &trade) {
-            // Update position tracking
-            if (trade.symbol_id == symbol_id) {
+            // Update position tracking; the two listings net into one position
+            if (trade.symbol_id == symbol_a || trade.symbol_id == symbol_b) {
                 if (trade.aggressor_side == Side::Buy) {
                     state.position += static_cast<int64_t>(trade.quantity);
                 } else {
@@ -450,7 +781,7 @@ namespace trading_engine {
     };
 
     inline void ArbitrageStrategy::execute_arbitrage(
-        const Side buy_side, const Price buy_price, const Side sell_side,
+        const SymbolID buy_symbol, const Price buy_price, const SymbolID sell_symbol,
         Price sell_price
     ) {
         const Quantity size = std::min(
@@ -459,9 +790,14 @@ namespace trading_engine {
         );
 
         if (size > 0) {
-            // In a real implementation, these would go to different exchanges
-            submit_order(buy_side, buy_price, size, OrderType::Limit);
-            submit_order(sell_side, sell_price, size, OrderType::Limit);
+            // Buy the cheap listing, sell the rich one; neither leg goes out alone
+            const std::array<OrderLeg, 2> legs{
+                {
+                    {.symbol = buy_symbol, .side = Side::Buy, .price = buy_price, .quantity = size},
+                    {.symbol = sell_symbol, .side = Side::Sell, .price = sell_price, .quantity = size}
+                }
+            };
+            submit_linked_orders(legs);
         }
     }
 }
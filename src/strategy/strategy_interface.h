@@ -3,7 +3,42 @@
 #include "../core/types.h"
 #include "../market_data/order_book.h"
 
+#include <span>
+
 namespace trading_engine {
+    // How a strategy's inbound market data is buffered
+    enum class ConflationMode : uint8_t {
+        None = 0, // Queue every tick and snapshot; drops the newest when full
+        Ticks = 1, // Keep only the latest tick per (symbol, side)
+        Snapshots = 2, // Keep only the latest book snapshot per symbol
+        All = 3
+    };
+
+    [[nodiscard]] constexpr bool conflates(const ConflationMode mode, const ConflationMode what) noexcept {
+        return (static_cast<uint8_t>(mode) & static_cast<uint8_t>(what)) != 0;
+    }
+
+    struct StrategyFeedStats {
+        uint64_t ticks_received{0};
+        uint64_t ticks_dropped{0};
+        uint64_t ticks_conflated{0};
+        uint64_t snapshots_received{0};
+        uint64_t snapshots_dropped{0};
+        uint64_t snapshots_conflated{0};
+        uint64_t trades_dropped{0};
+
+        StrategyFeedStats &operator+=(const StrategyFeedStats &other) noexcept {
+            ticks_received += other.ticks_received;
+            ticks_dropped += other.ticks_dropped;
+            ticks_conflated += other.ticks_conflated;
+            snapshots_received += other.snapshots_received;
+            snapshots_dropped += other.snapshots_dropped;
+            snapshots_conflated += other.snapshots_conflated;
+            trades_dropped += other.trades_dropped;
+            return *this;
+        }
+    };
+
     class IStrategy {
     public:
         virtual ~IStrategy() = default;
@@ -14,12 +49,17 @@ namespace trading_engine {
 
         virtual SymbolID get_symbol_id() const = 0;
 
+        // Every symbol whose ticks, snapshots and trades the strategy receives
+        virtual std::span<const SymbolID> get_subscribed_symbols() const = 0;
+
         virtual void on_market_data(const MarketTick &tick) = 0;
 
-        virtual void on_book_snapshot(const OrderBook<>::BookSnapshot &snapshot) = 0;
+        virtual void on_book_snapshot(SymbolID symbol_id, const OrderBook<>::BookSnapshot &snapshot) = 0;
 
         virtual void on_trade(const Trade &trade) = 0;
 
+        virtual StrategyFeedStats get_feed_stats() const = 0;
+
         virtual void shutdown() = 0;
     };
 }
@@ -0,0 +1,1051 @@
+// Headless load generator for capacity planning
+//
+// Drives a full TradingEngine with an open-loop order flow (new orders,
+// cancels and replaces from a set of producer threads), plus a
+// synthetic market data feed, and measures what the engine sustains. With
+// --sweep the order rate steps up until the engine stops keeping up, for
+// every combination of pipeline mode, producer count and pinning layout.
+// Results go to stdout (or --output) as JSON; the engine's own logging is
+// sent to stderr.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "core/topology.h"
+#include "engine/trading_engine.h"
+
+using namespace trading_engine;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr Price TickSize = PriceScale / 100; // One cent
+
+    enum class PriceDistribution : uint8_t {
+        Uniform,
+        Normal
+    };
+
+    // Where producer threads and engine threads run. Engine roles take one
+    // core each in pipeline order (risk, matching, trade notifications,
+    // receiver, then the shards), wrapping when cores run out.
+    enum class PinLayout : uint8_t {
+        None, // Let the OS place everything
+        Compact, // Producers on the lowest cores, engine roles right after them
+        Spread // Engine roles on the lowest cores, producers from the top down
+    };
+
+    struct LoadConfig {
+        uint32_t symbols{16};
+        double order_rate{100000.0}; // Operations/s over all producers; 0 = as fast as possible
+        double tick_rate{20000.0}; // Market data messages/s over all symbols
+        double cancel_ratio{0.2}; // Share of operations that cancel a resting order
+        double replace_ratio{0.2}; // Share that cancel and resubmit at a new price
+        bool amend{false}; // Send replaces as native amends rather than cancel + new
+        PriceDistribution price_distribution{PriceDistribution::Normal};
+        uint32_t price_spread_ticks{10}; // Uniform half-width, or two normal sigmas
+        Quantity max_quantity{500};
+        uint32_t gateway_shards{1};
+        uint32_t matching_shards{1}; // Staged pipeline only
+        uint32_t trace_sample_rate{64}; // 1 in N orders traced submit to match
+        double warmup_seconds{0.5};
+        double duration_seconds{2.0};
+
+        std::vector<PipelineMode> pipelines{PipelineMode::Staged};
+        std::vector<uint32_t> producer_counts{1};
+        std::vector<PinLayout> layouts{PinLayout::None};
+        std::vector<WaitPolicy> wait_policies{WaitPolicy::SpinThenYield}; // Applied to every engine loop
+
+        bool sweep{false};
+        double rate_step{2.0};
+        double max_rate{50000000.0};
+        std::string output_path;
+    };
+
+    // One point of the matrix: what a single engine instance is started with
+    struct RunSetup {
+        PipelineMode pipeline;
+        uint32_t producers;
+        PinLayout layout;
+        WaitPolicy wait_policy;
+        double order_rate;
+    };
+
+    struct RunResult {
+        RunSetup setup;
+        double seconds;
+        uint64_t operations_offered; // Orders, cancels and replaces attempted
+        uint64_t messages_submitted; // Accepted into the engine's order queue
+        uint64_t queue_full; // Messages the order queue turned away
+        uint64_t orders_processed;
+        uint64_t orders_rejected;
+        uint64_t cancels_processed;
+        uint64_t amends_processed;
+        uint64_t trades_executed;
+        uint64_t ticks_processed;
+        uint64_t backlog; // Submitted but not yet handled when the window closed
+        bool sustained;
+        TickTracer::TraceReport traces;
+        LatencyProfiler::ProfileResults risk_check; // Per risk batch
+        LatencyProfiler::ProfileResults order_processing; // Per order on the matching thread
+        std::vector<WaitStats> waits; // Per engine loop, over the whole run including warmup
+    };
+
+    // Messages the engine finished with: matched, rejected, cancelled or amended
+    uint64_t handled(const RunResult &run) {
+        return run.orders_processed + run.orders_rejected + run.cancels_processed + run.amends_processed;
+    }
+
+    const char *to_string(const PipelineMode mode) {
+        return mode == PipelineMode::Inline ? "inline" : "staged";
+    }
+
+    const char *to_string(const PinLayout layout) {
+        switch (layout) {
+            case PinLayout::Compact: return "compact";
+            case PinLayout::Spread: return "spread";
+            default: return "none";
+        }
+    }
+
+    const char *to_string(const PriceDistribution distribution) {
+        return distribution == PriceDistribution::Uniform ? "uniform" : "normal";
+    }
+
+    Price symbol_mid(const SymbolID symbol_id) {
+        return to_scaled_price(100.0) + symbol_id * PriceScale;
+    }
+
+    // --- Market data ---------------------------------------------------------
+
+    // Synthetic incremental feed at a fixed message rate, round-robin over the
+    // symbols, each level a few ticks off its symbol's mid
+    class SyntheticFeedTransport final : public IFeedTransport {
+        static constexpr size_t MaxBatch = 64;
+
+        uint32_t symbol_count;
+        double rate;
+        Clock::time_point started{};
+        uint64_t sent{0};
+        uint32_t sequence{0};
+        std::mt19937 rng{17};
+        std::array<MDIncrementalMessage, MaxBatch> messages{};
+
+    public:
+        SyntheticFeedTransport(const uint32_t symbols, const double messages_per_second)
+            : symbol_count(std::max<uint32_t>(symbols, 1)), rate(messages_per_second) {
+        }
+
+        bool open() override {
+            started = Clock::now();
+            sent = 0;
+            return true;
+        }
+
+        void close() override {
+        }
+
+        size_t receive_batch(std::span<PacketView> packets) override {
+            if (rate <= 0.0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                return 0;
+            }
+
+            const double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+            const auto due = static_cast<uint64_t>(elapsed * rate);
+            if (due <= sent) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                return 0;
+            }
+
+            const size_t count = std::min({static_cast<size_t>(due - sent), packets.size(), MaxBatch});
+            for (size_t i = 0; i < count; ++i) {
+                const auto symbol_id = static_cast<SymbolID>(1 + sent % symbol_count);
+                const Side side = rng() % 2 == 0 ? Side::Buy : Side::Sell;
+                const Price offset = (1 + rng() % 10) * TickSize;
+                messages[i] = MDIncrementalMessage{
+                    .header = {
+                        .message_type = MessageType::MarketDataIncremental,
+                        .version = 1,
+                        .length = sizeof(MDIncrementalMessage),
+                        .sequence_number = sequence++
+                    },
+                    .symbol_id = symbol_id,
+                    .price = side == Side::Buy ? symbol_mid(symbol_id) - offset : symbol_mid(symbol_id) + offset,
+                    .quantity = 100 * (1 + rng() % 50),
+                    .side = side,
+                    .exchange_timestamp = TimestampManager::get_hardware_timestamp()
+                };
+                packets[i] = PacketView{
+                    .data = reinterpret_cast<const uint8_t *>(&messages[i]),
+                    .length = sizeof(MDIncrementalMessage),
+                    .channel = 0,
+                    .feed = 0,
+                    .hardware_timestamp = false,
+                    .rx_timestamp_ns = 0
+                };
+                ++sent;
+            }
+            return count;
+        }
+    };
+
+    // --- Order flow ----------------------------------------------------------
+
+    struct alignas(CacheLineSize) ProducerCounters {
+        std::atomic<uint64_t> operations{0};
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> queue_full{0};
+    };
+
+    // One order-entry thread. Open loop: a message the engine turns away is
+    // counted and dropped, never retried, so overload shows up as queue_full.
+    class OrderProducer {
+        static constexpr size_t TrackedOrders = 1024; // Recent orders cancels can target
+
+        struct TrackedOrder {
+            OrderID order_id;
+            SymbolID symbol_id;
+            Side side;
+            Price price;
+        };
+
+        TradingEngine &engine;
+        const LoadConfig &config;
+        const uint32_t index;
+        ProducerCounters &counters;
+        std::mt19937_64 rng;
+        OrderID next_order_id;
+        std::array<TrackedOrder, TrackedOrders> tracked{};
+        size_t tracked_count{0};
+
+    public:
+        OrderProducer(TradingEngine &trading_engine, const LoadConfig &load_config, const uint32_t producer_index,
+                      ProducerCounters &producer_counters)
+            : engine(trading_engine), config(load_config), index(producer_index), counters(producer_counters),
+              rng(1000 + producer_index),
+              next_order_id((static_cast<OrderID>(producer_index) + 1) << 40) {
+        }
+
+        // Paces itself to `rate` operations/s in small bursts, sleeping between
+        // them so producers don't starve the engine of cores
+        void run(const double rate, const std::atomic<bool> &running) {
+            const Clock::time_point started = Clock::now();
+            const auto max_burst = std::max<uint64_t>(static_cast<uint64_t>(rate / 1000.0), 1);
+            const auto max_backlog = static_cast<uint64_t>(rate / 10.0);
+            uint64_t done = 0;
+
+            while (running.load(std::memory_order_acquire)) {
+                if (rate <= 0.0) {
+                    for (int i = 0; i < 64; ++i) {
+                        step();
+                    }
+                    continue;
+                }
+
+                const double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+                const auto due = static_cast<uint64_t>(elapsed * rate);
+                if (due <= done) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(20));
+                    continue;
+                }
+
+                // A millisecond's worth at most per burst. Falling more than
+                // 100ms behind drops the excess, which shows as a low offered rate.
+                const uint64_t burst = std::min<uint64_t>(due - done, max_burst);
+                for (uint64_t i = 0; i < burst; ++i) {
+                    step();
+                }
+                done = std::max(done + burst, due - std::min(due, max_backlog));
+            }
+        }
+
+    private:
+        void step() {
+            counters.operations.fetch_add(1, std::memory_order_relaxed);
+
+            const double roll = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            if (roll < config.cancel_ratio && tracked_count > 0) {
+                send_cancel(untrack(rng() % tracked_count).order_id);
+            } else if (roll < config.cancel_ratio + config.replace_ratio && tracked_count > 0) {
+                const size_t slot = rng() % tracked_count;
+                const int64_t move = static_cast<int64_t>(rng() % 7) - 3;
+                const auto price = static_cast<Price>(std::max<int64_t>(
+                    static_cast<int64_t>(tracked[slot].price) + move * static_cast<int64_t>(TickSize),
+                    static_cast<int64_t>(TickSize)));
+                if (config.amend) {
+                    send_amend(tracked[slot], price);
+                } else {
+                    const TrackedOrder old = untrack(slot);
+                    send_cancel(old.order_id);
+                    send_new(old.symbol_id, old.side, price);
+                }
+            } else {
+                const auto symbol_id = static_cast<SymbolID>(1 + rng() % config.symbols);
+                const Side side = rng() % 2 == 0 ? Side::Buy : Side::Sell;
+                send_new(symbol_id, side, draw_price(symbol_id, side));
+            }
+        }
+
+        // Offsets are toward the other side, so positive draws are marketable
+        Price draw_price(const SymbolID symbol_id, const Side side) {
+            int64_t ticks;
+            const auto spread = static_cast<int64_t>(config.price_spread_ticks);
+            if (config.price_distribution == PriceDistribution::Uniform) {
+                ticks = std::uniform_int_distribution<int64_t>(-spread, spread)(rng);
+            } else {
+                ticks = std::llround(std::normal_distribution<double>(
+                    -1.0, std::max(static_cast<double>(spread) / 2.0, 1.0))(rng));
+            }
+
+            const int64_t offset = ticks * static_cast<int64_t>(TickSize);
+            const auto mid = static_cast<int64_t>(symbol_mid(symbol_id));
+            return static_cast<Price>(side == Side::Buy ? mid + offset : mid - offset);
+        }
+
+        void send_new(const SymbolID symbol_id, const Side side, const Price price) {
+            const Timestamp now = TimestampManager::get_hardware_timestamp();
+            const std::uint32_t trace_id = TickTracer::begin(now, now);
+            TickTracer::stamp(trace_id, TickTracer::Stage::OrderSubmitted);
+
+            const Order order{
+                .orderID = next_order_id++,
+                .symbolID = symbol_id,
+                .side = side,
+                .orderType = OrderType::Limit,
+                .timeInForce = TimeInForce::Day,
+                .price = price,
+                .quantity = 1 + rng() % config.max_quantity,
+                .traceID = trace_id,
+                .timestamp = now
+            };
+
+            // The engine stamps the matching shard into the ID; cancels must use that one
+            const OrderID routed_id = engine.submit_order(order);
+            if (routed_id == 0) {
+                counters.queue_full.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            counters.submitted.fetch_add(1, std::memory_order_relaxed);
+            track(TrackedOrder{routed_id, symbol_id, side, price});
+        }
+
+        void send_cancel(const OrderID order_id) {
+            if (!engine.cancel_order(order_id)) {
+                counters.queue_full.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            counters.submitted.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Keeps the order tracked at its new price; a miss in matching means it already filled
+        void send_amend(TrackedOrder &order, const Price price) {
+            if (!engine.modify_order(order.order_id, order.symbol_id, order.side, price,
+                                     1 + rng() % config.max_quantity)) {
+                counters.queue_full.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            counters.submitted.fetch_add(1, std::memory_order_relaxed);
+            order.price = price;
+        }
+
+        // Oldest entries are overwritten once full; those orders just never get cancelled
+        void track(const TrackedOrder &order) {
+            if (tracked_count < TrackedOrders) {
+                tracked[tracked_count++] = order;
+            } else {
+                tracked[rng() % TrackedOrders] = order;
+            }
+        }
+
+        TrackedOrder untrack(const size_t slot) {
+            const TrackedOrder order = tracked[slot];
+            tracked[slot] = tracked[--tracked_count];
+            return order;
+        }
+    };
+
+    // --- Runs ----------------------------------------------------------------
+
+    uint32_t core_count() {
+        return std::max(std::thread::hardware_concurrency(), 1U);
+    }
+
+    uint32_t producer_core(const PinLayout layout, const uint32_t producer) {
+        const uint32_t cores = core_count();
+        return layout == PinLayout::Compact ? producer % cores : (cores - 1 - producer % cores);
+    }
+
+    ThreadTopology engine_topology(const PinLayout layout, const LoadConfig &config, const uint32_t producers) {
+        ThreadTopology topology{};
+        if (layout == PinLayout::None) {
+            return topology;
+        }
+
+        uint32_t next = layout == PinLayout::Compact ? producers : 0;
+        const auto take = [&next] {
+            return ThreadPlacement{.cores = {next++ % core_count()}};
+        };
+        topology.risk = take();
+        topology.matching = take();
+        for (uint32_t shard = 1; shard < config.matching_shards; ++shard) {
+            topology.matching.cores.push_back(next++ % core_count());
+        }
+        topology.trade_notifications = take();
+        topology.receiver = take();
+        for (uint32_t shard = 0; shard < config.gateway_shards; ++shard) {
+            topology.gateway_shards.cores.push_back(next++ % core_count());
+        }
+        return topology;
+    }
+
+    // Every consumer loop of the engine idles the same way
+    EngineConfig engine_config_for(const LoadConfig &config, const RunSetup &setup) {
+        const WaitConfig wait{.policy = setup.wait_policy};
+        return EngineConfig{
+            .pipeline = setup.pipeline,
+            .gateway = GatewayConfig{
+                .shard_count = config.gateway_shards,
+                .receiver_wait = wait,
+                .shard_wait = wait
+            },
+            .scheduler = SchedulerConfig{.wait = wait},
+            .topology = engine_topology(setup.layout, config, setup.producers),
+            .matching_shards = config.matching_shards,
+            .risk_wait = wait,
+            .matching_wait = wait,
+            .trade_notification_wait = wait,
+            .trace_sample_rate = config.trace_sample_rate
+        };
+    }
+
+    // Opened up so risk runs every check but never rejects on volume
+    RiskLimits load_test_limits() {
+        constexpr auto unlimited = std::numeric_limits<std::uint64_t>::max() / 4;
+        return RiskLimits{
+            .max_position = unlimited,
+            .max_notional = unlimited,
+            .max_orders_per_second = std::numeric_limits<std::uint32_t>::max(),
+            .max_loss_per_day = unlimited,
+            .max_order_size = unlimited,
+            .max_price_deviation = unlimited
+        };
+    }
+
+    struct Counters {
+        TradingEngine::EngineStats engine;
+        uint64_t operations;
+        uint64_t submitted;
+        uint64_t queue_full;
+    };
+
+    Counters sample(const TradingEngine &engine, const std::vector<std::unique_ptr<ProducerCounters> > &producers) {
+        Counters counters{.engine = engine.get_statistics(), .operations = 0, .submitted = 0, .queue_full = 0};
+        for (const auto &producer: producers) {
+            counters.operations += producer->operations.load(std::memory_order_relaxed);
+            counters.submitted += producer->submitted.load(std::memory_order_relaxed);
+            counters.queue_full += producer->queue_full.load(std::memory_order_relaxed);
+        }
+        return counters;
+    }
+
+    uint64_t handled(const TradingEngine::EngineStats &stats) {
+        return stats.orders_processed + stats.orders_rejected + stats.cancels_processed + stats.amends_processed;
+    }
+
+    RunResult run_once(const LoadConfig &config, const RunSetup &setup) {
+        auto engine = std::make_unique<TradingEngine>(engine_config_for(config, setup));
+
+        const RiskLimits limits = load_test_limits();
+        engine->set_risk_limits(limits);
+        for (SymbolID symbol_id = 1; symbol_id <= config.symbols; ++symbol_id) {
+            engine->subscribe_symbol(symbol_id);
+            engine->set_symbol_risk_limits(symbol_id, limits);
+        }
+        engine->set_market_data_transport(std::make_unique<SyntheticFeedTransport>(config.symbols, config.tick_rate));
+
+        if (!engine->start()) {
+            std::cerr << "load generator: engine failed to start\n";
+            std::exit(1);
+        }
+
+        std::atomic<bool> running{true};
+        std::vector<std::unique_ptr<ProducerCounters> > counters;
+        std::vector<std::thread> producers;
+        for (uint32_t i = 0; i < setup.producers; ++i) {
+            counters.push_back(std::make_unique<ProducerCounters>());
+        }
+        for (uint32_t i = 0; i < setup.producers; ++i) {
+            producers.emplace_back([&, i] {
+                if (setup.layout != PinLayout::None) {
+                    pin_current_thread(producer_core(setup.layout, i));
+                }
+                OrderProducer producer(*engine, config, i, *counters[i]);
+                producer.run(setup.order_rate / setup.producers, running);
+            });
+        }
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(config.warmup_seconds));
+
+        LatencyHistogram risk_before = LatencyProfiler::snapshot(LatencyProfiler::Risk_check);
+        LatencyHistogram processing_before = LatencyProfiler::snapshot(LatencyProfiler::Order_processing);
+        TickTracer::reset();
+        const Counters before = sample(*engine, counters);
+        const Clock::time_point window_start = Clock::now();
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(config.duration_seconds));
+
+        const Counters after = sample(*engine, counters);
+        const double seconds = std::chrono::duration<double>(Clock::now() - window_start).count();
+        running.store(false, std::memory_order_release);
+        for (auto &producer: producers) {
+            producer.join();
+        }
+
+        RunResult result{
+            .setup = setup,
+            .seconds = seconds,
+            .operations_offered = after.operations - before.operations,
+            .messages_submitted = after.submitted - before.submitted,
+            .queue_full = after.queue_full - before.queue_full,
+            .orders_processed = after.engine.orders_processed - before.engine.orders_processed,
+            .orders_rejected = after.engine.orders_rejected - before.engine.orders_rejected,
+            .cancels_processed = after.engine.cancels_processed - before.engine.cancels_processed,
+            .amends_processed = after.engine.amends_processed - before.engine.amends_processed,
+            .trades_executed = after.engine.trades_executed - before.engine.trades_executed,
+            .ticks_processed = after.engine.market_data_stats.total_messages_processed -
+                               before.engine.market_data_stats.total_messages_processed,
+            .backlog = after.submitted - std::min(after.submitted, handled(after.engine)),
+            .sustained = false,
+            .traces = after.engine.trace_report,
+            .risk_check = LatencyProfiler::get_interval_stats(LatencyProfiler::Risk_check, risk_before),
+            .order_processing = LatencyProfiler::get_interval_stats(LatencyProfiler::Order_processing,
+                                                                    processing_before),
+            .waits = after.engine.wait_stats
+        };
+
+        // Sustained: the producers hit the target, the queue never turned
+        // messages away in any volume, and the engine kept up with arrivals
+        const double offered_rate = static_cast<double>(result.operations_offered) / seconds;
+        const uint64_t window_handled = handled(after.engine) - handled(before.engine);
+        result.sustained = setup.order_rate > 0.0 &&
+                           offered_rate >= 0.95 * setup.order_rate &&
+                           result.queue_full * 1000 <= result.operations_offered &&
+                           window_handled * 100 >= result.messages_submitted * 98;
+
+        engine->stop();
+        return result;
+    }
+
+    // --- Output --------------------------------------------------------------
+
+    // Minimal streaming JSON writer; keys and strings here never need escaping
+    class JsonWriter {
+        std::ostream &out;
+        std::vector<bool> first_in_scope{true};
+        int depth{0};
+
+        void separate() {
+            if (!first_in_scope.back()) {
+                out << ',';
+            }
+            first_in_scope.back() = false;
+            out << '\n' << std::string(static_cast<size_t>(depth) * 2, ' ');
+        }
+
+        void open(const char bracket) {
+            out << bracket;
+            first_in_scope.push_back(true);
+            ++depth;
+        }
+
+        void close(const char bracket) {
+            const bool empty = first_in_scope.back();
+            first_in_scope.pop_back();
+            --depth;
+            if (!empty) {
+                out << '\n' << std::string(static_cast<size_t>(depth) * 2, ' ');
+            }
+            out << bracket;
+        }
+
+    public:
+        explicit JsonWriter(std::ostream &stream) : out(stream) {
+        }
+
+        void begin_object() {
+            open('{');
+        }
+
+        void begin_object(const std::string_view key) {
+            separate();
+            out << '"' << key << "\": ";
+            open('{');
+        }
+
+        void end_object() {
+            close('}');
+        }
+
+        void begin_array(const std::string_view key) {
+            separate();
+            out << '"' << key << "\": ";
+            open('[');
+        }
+
+        void begin_array_object() {
+            separate();
+            open('{');
+        }
+
+        void end_array() {
+            close(']');
+        }
+
+        void field(const std::string_view key, const std::string_view value) {
+            separate();
+            out << '"' << key << "\": \"" << value << '"';
+        }
+
+        void field(const std::string_view key, const char *value) {
+            field(key, std::string_view(value));
+        }
+
+        void field(const std::string_view key, const bool value) {
+            separate();
+            out << '"' << key << "\": " << (value ? "true" : "false");
+        }
+
+        void field(const std::string_view key, const uint64_t value) {
+            separate();
+            out << '"' << key << "\": " << value;
+        }
+
+        void field(const std::string_view key, const uint32_t value) {
+            field(key, static_cast<uint64_t>(value));
+        }
+
+        void field(const std::string_view key, const double value) {
+            separate();
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.6g", std::isfinite(value) ? value : 0.0);
+            out << '"' << key << "\": " << buffer;
+        }
+
+        void finish() {
+            out << '\n';
+        }
+    };
+
+    void write_latency(JsonWriter &json, const std::string_view key, const LatencyProfiler::ProfileResults &latency) {
+        json.begin_object(key);
+        json.field("samples", latency.sample_count);
+        json.field("avg_us", latency.avg_latency_us);
+        json.field("p50_us", latency.p50_latency_us);
+        json.field("p90_us", latency.p90_latency_us);
+        json.field("p99_us", latency.p99_latency_us);
+        json.field("p999_us", latency.p999_latency_us);
+        json.field("p9999_us", latency.p9999_latency_us);
+        json.field("max_us", latency.max_latency_us);
+        json.end_object();
+    }
+
+    void write_waits(JsonWriter &json, const std::vector<WaitStats> &waits) {
+        double cpu_utilisation = 0.0;
+        json.begin_array("wait_loops");
+        for (const WaitStats &wait: waits) {
+            json.begin_array_object();
+            json.field("role", wait.role);
+            json.field("instance", wait.instance);
+            json.field("policy", to_string(wait.policy));
+            json.field("wakeups", wait.wakeups);
+            json.field("yields", wait.yields);
+            json.field("parks", wait.parks);
+            json.field("mean_wake_latency_ns", wait.mean_wake_latency_ns);
+            json.field("max_wake_latency_ns", wait.max_wake_latency_ns);
+            json.field("cpu_utilisation", wait.cpu_utilisation);
+            json.end_object();
+            cpu_utilisation += wait.cpu_utilisation;
+        }
+        json.end_array();
+        json.field("engine_cpu_cores", cpu_utilisation); // Cores' worth of CPU the loops used
+    }
+
+    void write_run(JsonWriter &json, const RunResult &run) {
+        const auto per_second = [&run](const uint64_t count) {
+            return static_cast<double>(count) / run.seconds;
+        };
+
+        json.begin_array_object();
+        json.field("pipeline", to_string(run.setup.pipeline));
+        json.field("producers", run.setup.producers);
+        json.field("layout", to_string(run.setup.layout));
+        json.field("wait_policy", to_string(run.setup.wait_policy));
+        json.field("target_order_rate", run.setup.order_rate);
+        json.field("seconds", run.seconds);
+        json.field("sustained", run.sustained);
+
+        json.field("operations_offered", run.operations_offered);
+        json.field("messages_submitted", run.messages_submitted);
+        json.field("queue_full", run.queue_full);
+        json.field("orders_processed", run.orders_processed);
+        json.field("orders_rejected", run.orders_rejected);
+        json.field("cancels_processed", run.cancels_processed);
+        json.field("amends_processed", run.amends_processed);
+        json.field("trades_executed", run.trades_executed);
+        json.field("ticks_processed", run.ticks_processed);
+        json.field("backlog", run.backlog);
+
+        json.field("offered_rate", per_second(run.operations_offered));
+        json.field("submitted_rate", per_second(run.messages_submitted));
+        json.field("processed_rate", per_second(handled(run)));
+        json.field("trade_rate", per_second(run.trades_executed));
+        json.field("tick_rate", per_second(run.ticks_processed));
+
+        json.begin_object("latency");
+        write_latency(json, "order_to_match", run.traces.tick_to_trade);
+        write_latency(json, "submit_to_risk_checked",
+                      run.traces.stage_latency[static_cast<size_t>(TickTracer::Stage::RiskChecked)]);
+        write_latency(json, "risk_checked_to_matched",
+                      run.traces.stage_latency[static_cast<size_t>(TickTracer::Stage::Matched)]);
+        write_latency(json, "risk_check_batch", run.risk_check);
+        write_latency(json, "order_processing", run.order_processing);
+        json.end_object();
+        json.field("traced_orders", run.traces.traces_completed);
+        write_waits(json, run.waits);
+        json.end_object();
+    }
+
+    void write_config(JsonWriter &json, const LoadConfig &config) {
+        json.begin_object("config");
+        json.field("symbols", config.symbols);
+        json.field("order_rate", config.order_rate);
+        json.field("tick_rate", config.tick_rate);
+        json.field("cancel_ratio", config.cancel_ratio);
+        json.field("replace_ratio", config.replace_ratio);
+        json.field("amend", config.amend);
+        json.field("price_distribution", to_string(config.price_distribution));
+        json.field("price_spread_ticks", config.price_spread_ticks);
+        json.field("max_quantity", static_cast<uint64_t>(config.max_quantity));
+        json.field("gateway_shards", config.gateway_shards);
+        json.field("matching_shards", config.matching_shards);
+        json.field("trace_sample_rate", config.trace_sample_rate);
+        json.field("warmup_seconds", config.warmup_seconds);
+        json.field("duration_seconds", config.duration_seconds);
+        json.field("sweep", config.sweep);
+        json.field("rate_step", config.rate_step);
+        json.field("max_rate", config.max_rate);
+        json.end_object();
+    }
+
+    // --- Command line --------------------------------------------------------
+
+    void print_usage() {
+        std::cerr <<
+                "Usage: TradingEngineLoadGen [options]\n"
+                "  --symbols N            Symbols to spread orders and ticks over (16)\n"
+                "  --order-rate R         Operations/s (new, cancel or replace) over all producers,\n"
+                "                         0 = unthrottled (100000)\n"
+                "                         With --sweep, the first rate of the sweep\n"
+                "  --tick-rate R          Market data messages/s (20000)\n"
+                "  --cancel-ratio F       Share of operations that cancel (0.2)\n"
+                "  --replace-ratio F      Share that cancel and resubmit at a new price (0.2)\n"
+                "  --amend                Send replaces as native amends instead of cancel + new\n"
+                "  --price-dist D         uniform | normal (normal)\n"
+                "  --price-spread T       Price spread around the mid in ticks (10)\n"
+                "  --max-qty Q            Largest order quantity (500)\n"
+                "  --gateway-shards N     Market data shard threads (1)\n"
+                "  --matching-shards N    Matching threads, symbols split between them (1)\n"
+                "  --trace-sample N       Trace 1 in N orders submit to match, 0 = off (64)\n"
+                "  --warmup S             Seconds before measuring (0.5)\n"
+                "  --duration S           Measured seconds per run (2)\n"
+                "  --pipelines LIST       Comma-separated: staged,inline (staged)\n"
+                "  --producers LIST       Comma-separated producer thread counts (1)\n"
+                "  --layouts LIST         Comma-separated: none,compact,spread (none)\n"
+                "  --wait-policies LIST   Comma-separated idle behaviour of every engine loop:\n"
+                "                         busy_spin,spin_pause,spin_then_yield,spin_then_park,block\n"
+                "                         (spin_then_yield)\n"
+                "  --sweep                Raise the rate by --rate-step until not sustained\n"
+                "  --rate-step F          Sweep multiplier (2)\n"
+                "  --max-rate R           Sweep ceiling (50000000)\n"
+                "  --output FILE          Write JSON there instead of stdout\n";
+    }
+
+    [[noreturn]] void usage_error(const std::string &message) {
+        std::cerr << "load generator: " << message << "\n\n";
+        print_usage();
+        std::exit(2);
+    }
+
+    std::vector<std::string> split_list(const std::string &list) {
+        std::vector<std::string> items;
+        std::stringstream stream(list);
+        for (std::string item; std::getline(stream, item, ',');) {
+            if (!item.empty()) {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+    double parse_number(const std::string &option, const std::string &text) {
+        char *end = nullptr;
+        const double value = std::strtod(text.c_str(), &end);
+        if (end == text.c_str() || *end != '\0' || value < 0.0 || !std::isfinite(value)) {
+            usage_error("bad value for " + option + ": " + text);
+        }
+        return value;
+    }
+
+    WaitPolicy parse_wait_policy(const std::string &name) {
+        for (const WaitPolicy policy: {WaitPolicy::BusySpin, WaitPolicy::SpinPause, WaitPolicy::SpinThenYield,
+                                       WaitPolicy::SpinThenPark, WaitPolicy::Block}) {
+            if (name == to_string(policy)) {
+                return policy;
+            }
+        }
+        usage_error("unknown wait policy: " + name);
+    }
+
+    LoadConfig parse_arguments(const int argc, char **argv) {
+        LoadConfig config;
+        for (int i = 1; i < argc; ++i) {
+            const std::string option = argv[i];
+            if (option == "--help" || option == "-h") {
+                print_usage();
+                std::exit(0);
+            }
+            if (option == "--sweep") {
+                config.sweep = true;
+                continue;
+            }
+            if (option == "--amend") {
+                config.amend = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                usage_error("missing value for " + option);
+            }
+
+            const std::string value = argv[++i];
+            const auto count = [&] {
+                return static_cast<uint32_t>(parse_number(option, value));
+            };
+
+            if (option == "--symbols") {
+                config.symbols = std::max<uint32_t>(count(), 1);
+            } else if (option == "--order-rate") {
+                config.order_rate = parse_number(option, value);
+            } else if (option == "--tick-rate") {
+                config.tick_rate = parse_number(option, value);
+            } else if (option == "--cancel-ratio") {
+                config.cancel_ratio = parse_number(option, value);
+            } else if (option == "--replace-ratio") {
+                config.replace_ratio = parse_number(option, value);
+            } else if (option == "--price-dist") {
+                if (value == "uniform") {
+                    config.price_distribution = PriceDistribution::Uniform;
+                } else if (value == "normal") {
+                    config.price_distribution = PriceDistribution::Normal;
+                } else {
+                    usage_error("unknown price distribution: " + value);
+                }
+            } else if (option == "--price-spread") {
+                config.price_spread_ticks = count();
+            } else if (option == "--max-qty") {
+                config.max_quantity = std::max<Quantity>(count(), 1);
+            } else if (option == "--gateway-shards") {
+                config.gateway_shards = std::max<uint32_t>(count(), 1);
+            } else if (option == "--matching-shards") {
+                config.matching_shards = std::max<uint32_t>(count(), 1);
+            } else if (option == "--trace-sample") {
+                config.trace_sample_rate = count();
+            } else if (option == "--warmup") {
+                config.warmup_seconds = parse_number(option, value);
+            } else if (option == "--duration") {
+                config.duration_seconds = std::max(parse_number(option, value), 0.1);
+            } else if (option == "--pipelines") {
+                config.pipelines.clear();
+                for (const std::string &item: split_list(value)) {
+                    if (item == "staged") {
+                        config.pipelines.push_back(PipelineMode::Staged);
+                    } else if (item == "inline") {
+                        config.pipelines.push_back(PipelineMode::Inline);
+                    } else {
+                        usage_error("unknown pipeline: " + item);
+                    }
+                }
+            } else if (option == "--producers") {
+                config.producer_counts.clear();
+                for (const std::string &item: split_list(value)) {
+                    config.producer_counts.push_back(std::max<uint32_t>(
+                        static_cast<uint32_t>(parse_number(option, item)), 1));
+                }
+            } else if (option == "--layouts") {
+                config.layouts.clear();
+                for (const std::string &item: split_list(value)) {
+                    if (item == "none") {
+                        config.layouts.push_back(PinLayout::None);
+                    } else if (item == "compact") {
+                        config.layouts.push_back(PinLayout::Compact);
+                    } else if (item == "spread") {
+                        config.layouts.push_back(PinLayout::Spread);
+                    } else {
+                        usage_error("unknown layout: " + item);
+                    }
+                }
+            } else if (option == "--wait-policies") {
+                config.wait_policies.clear();
+                for (const std::string &item: split_list(value)) {
+                    config.wait_policies.push_back(parse_wait_policy(item));
+                }
+            } else if (option == "--rate-step") {
+                config.rate_step = parse_number(option, value);
+            } else if (option == "--max-rate") {
+                config.max_rate = parse_number(option, value);
+            } else if (option == "--output") {
+                config.output_path = value;
+            } else {
+                usage_error("unknown option: " + option);
+            }
+        }
+
+        if (config.cancel_ratio + config.replace_ratio > 1.0) {
+            usage_error("--cancel-ratio plus --replace-ratio must not exceed 1");
+        }
+        if (config.pipelines.empty() || config.producer_counts.empty() || config.layouts.empty() ||
+            config.wait_policies.empty()) {
+            usage_error("--pipelines, --producers, --layouts and --wait-policies need at least one entry");
+        }
+        if (config.sweep && (config.rate_step <= 1.0 || config.order_rate <= 0.0)) {
+            usage_error("--sweep needs --rate-step above 1 and a nonzero starting --order-rate");
+        }
+        return config;
+    }
+
+    void report_progress(const RunResult &run) {
+        std::fprintf(stderr, "[loadgen] %s producers=%u layout=%s wait=%s target=%.0f/s -> processed %.0f/s, "
+                     "queue_full=%llu, p99 order_to_match=%.2fus%s\n",
+                     to_string(run.setup.pipeline), run.setup.producers, to_string(run.setup.layout),
+                     to_string(run.setup.wait_policy), run.setup.order_rate,
+                     static_cast<double>(handled(run)) / run.seconds,
+                     static_cast<unsigned long long>(run.queue_full), run.traces.tick_to_trade.p99_latency_us,
+                     run.sustained ? " (sustained)" : "");
+    }
+}
+
+int main(const int argc, char **argv) {
+    const LoadConfig config = parse_arguments(argc, argv);
+
+    // Keep stdout for the JSON; the engine logs through std::cout
+    std::ostream json_stdout(std::cout.rdbuf());
+    std::cout.rdbuf(std::cerr.rdbuf());
+
+    TimestampManager::initialize();
+    LatencyProfiler::initialize();
+
+    struct Summary {
+        RunSetup setup;
+        double max_sustained_rate;
+        double peak_processed_rate;
+    };
+
+    std::vector<RunResult> runs;
+    std::vector<Summary> summaries;
+
+    for (const PipelineMode pipeline: config.pipelines) {
+        for (const uint32_t producers: config.producer_counts) {
+            for (const PinLayout layout: config.layouts) {
+                for (const WaitPolicy wait_policy: config.wait_policies) {
+                    RunSetup setup{.pipeline = pipeline, .producers = producers, .layout = layout,
+                                   .wait_policy = wait_policy, .order_rate = config.order_rate};
+                    Summary summary{.setup = setup, .max_sustained_rate = 0.0, .peak_processed_rate = 0.0};
+
+                    const auto record = [&](const RunResult &run) {
+                        report_progress(run);
+                        const double processed = static_cast<double>(handled(run)) / run.seconds;
+                        summary.peak_processed_rate = std::max(summary.peak_processed_rate, processed);
+                        if (run.sustained) {
+                            summary.max_sustained_rate = std::max(summary.max_sustained_rate, run.setup.order_rate);
+                        }
+                        runs.push_back(run);
+                    };
+
+                    if (!config.sweep) {
+                        record(run_once(config, setup));
+                    } else {
+                        // Step up until the engine falls behind, then one unthrottled run for the peak
+                        for (double rate = config.order_rate; rate <= config.max_rate; rate *= config.rate_step) {
+                            setup.order_rate = rate;
+                            const RunResult run = run_once(config, setup);
+                            record(run);
+                            if (!run.sustained) {
+                                break;
+                            }
+                        }
+                        setup.order_rate = 0.0;
+                        record(run_once(config, setup));
+                    }
+                    summaries.push_back(summary);
+                }
+            }
+        }
+    }
+
+    std::ofstream file;
+    if (!config.output_path.empty()) {
+        file.open(config.output_path);
+        if (!file) {
+            std::cerr << "load generator: cannot write " << config.output_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = config.output_path.empty() ? json_stdout : file;
+
+    JsonWriter json(out);
+    json.begin_object();
+    json.field("tool", "TradingEngineLoadGen");
+    json.field("hardware_threads", core_count());
+    json.field("tsc_frequency_hz", TimestampManager::get_frequency());
+    write_config(json, config);
+
+    json.begin_array("runs");
+    for (const RunResult &run: runs) {
+        write_run(json, run);
+    }
+    json.end_array();
+
+    json.begin_array("summary");
+    for (const Summary &summary: summaries) {
+        json.begin_array_object();
+        json.field("pipeline", to_string(summary.setup.pipeline));
+        json.field("producers", summary.setup.producers);
+        json.field("layout", to_string(summary.setup.layout));
+        json.field("wait_policy", to_string(summary.setup.wait_policy));
+        json.field("max_sustained_order_rate", summary.max_sustained_rate);
+        json.field("peak_processed_rate", summary.peak_processed_rate);
+        json.end_object();
+    }
+    json.end_array();
+    json.end_object();
+    json.finish();
+
+    std::cout.rdbuf(json_stdout.rdbuf());
+    return 0;
+}